@@ -263,7 +263,8 @@ class InfoCmd : public Cmd {
     kInfoAll,
     kInfoDebug,
     kInfoCommandStats,
-    kInfoCache
+    kInfoCache,
+    kInfoMemory
   };
   InfoCmd(const std::string& name, int arity, uint32_t flag) : Cmd(name, arity, flag) {}
   void Do() override;
@@ -291,6 +292,7 @@ class InfoCmd : public Cmd {
   const static std::string kDebugSection;
   const static std::string kCommandStatsSection;
   const static std::string kCacheSection;
+  const static std::string kMemorySection;
 
   void DoInitial() override;
   void Clear() override {
@@ -311,6 +313,7 @@ class InfoCmd : public Cmd {
   void InfoDebug(std::string& info);
   void InfoCommandStats(std::string& info);
   void InfoCache(std::string& info, std::shared_ptr<DB> db);
+  void InfoMemory(std::string& info);
 
   std::string CacheStatusToString(int status);
 };
@@ -51,6 +51,11 @@ class Binlog : public pstd::noncopyable {
   void Lock() { mutex_.lock(); }
   void Unlock() { mutex_.unlock(); }
 
+  /*
+   * Append one item, concurrent callers are group committed: the first
+   * of them becomes the leader and appends the items of all writers
+   * queued behind it under a single hold of mutex_, in queue order
+   */
   pstd::Status Put(const std::string& item);
   pstd::Status IsOpened();
   pstd::Status GetProducerStatus(uint32_t* filenum, uint64_t* pro_offset, uint32_t* term = nullptr, uint64_t* logic_id = nullptr);
@@ -78,13 +83,44 @@ class Binlog : public pstd::noncopyable {
   void Close();
 
  private:
-  pstd::Status Put(const char* item, int len);
+  enum WriterState { kWriterPending = 0, kWriterLeader = 1, kWriterDone = 2 };
+
+  struct Writer {
+    explicit Writer(const std::string* _item) : item(_item) {}
+    const std::string* item;
+    pstd::Status status;
+    // set before the writer is published, never changed afterwards
+    // except by the leader handing leadership to it
+    Writer* link_older = nullptr;
+    // filled in lazily by the leader
+    Writer* link_newer = nullptr;
+    std::atomic<int> state{kWriterPending};
+    pstd::Mutex mu;
+    pstd::CondVar cv;
+  };
+
+  // Returns true if w was linked to an empty queue and is the leader
+  bool LinkWriter(Writer* w);
+  static void AwaitState(Writer* w);
+  static void SetState(Writer* w, int state);
+  static void CreateMissingNewerLinks(Writer* head);
+  // Group w and the writers queued behind it, returns the newest one
+  Writer* BuildGroup(Writer* leader);
+  // Need to hold mutex_
+  void WriteGroup(Writer* leader, Writer* last);
+  void ExitAsGroupLeader(Writer* leader, Writer* last);
+
+  // Append item at pro_offset of the current file, rolling to a new file
+  // first if it is full, and move pro_offset past it. The producer status
+  // is left to the caller, logic_id is the id of the last item written
+  pstd::Status Put(const char* item, int len, uint64_t logic_id, uint64_t* pro_offset);
   pstd::Status EmitPhysicalRecord(RecordType t, const char* ptr, size_t n, int* temp_pro_offset);
   static pstd::Status AppendPadding(pstd::WritableFile* file, uint64_t* len);
   void InitLogFile();
 
   /*
-   * Produce
+   * Produce, pro_offset is where item starts in the file and
+   * where it ends when done
    */
   pstd::Status Produce(const pstd::Slice& item, int* pro_offset);
 
@@ -108,6 +144,9 @@ class Binlog : public pstd::noncopyable {
   std::string filename_;
 
   std::atomic<bool> binlog_io_error_;
+
+  // lock free stack of the writers waiting for a group commit
+  std::atomic<Writer*> newest_writer_{nullptr};
 };
 
 #endif
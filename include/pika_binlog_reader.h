@@ -11,11 +11,38 @@
 #include <string>
 
 #include "pstd/include/env.h"
+#include "pstd/include/noncopyable.h"
 #include "pstd/include/pstd_slice.h"
 #include "pstd/include/pstd_status.h"
 
 #include "include/pika_binlog.h"
 
+/*
+ * A read only mapping of a binlog file, shared by every reader of the
+ * file, so N slaves catching up from the same offset fault each page in
+ * once. The writer appends through a MAP_SHARED mapping too, so the
+ * blocks it wrote recently are served straight from the page cache
+ */
+class PikaBinlogMappedFile : public pstd::noncopyable {
+ public:
+  ~PikaBinlogMappedFile();
+
+  // Points file at a mapping of path which covers at least min_size bytes.
+  // Returns EndFile if the file is empty or shorter than that, IOError if
+  // it can't be opened or mapped
+  static pstd::Status Open(const std::string& path, uint64_t min_size, std::shared_ptr<PikaBinlogMappedFile>* file);
+
+  const char* data() const { return data_; }
+  uint64_t size() const { return size_; }
+
+ private:
+  PikaBinlogMappedFile(const char* data, uint64_t size, uint64_t ino) : data_(data), size_(size), ino_(ino) {}
+
+  const char* data_;
+  uint64_t size_;
+  uint64_t ino_;
+};
+
 class PikaBinlogReader {
  public:
   PikaBinlogReader(uint32_t cur_filenum, uint64_t cur_offset);
@@ -32,6 +59,13 @@ class PikaBinlogReader {
   unsigned int ReadPhysicalRecord(pstd::Slice* result, uint32_t* filenum, uint64_t* offset);
   // Returns scratch binflog and corresponding offset
   pstd::Status Consume(std::string* scratch, uint32_t* filenum, uint64_t* offset);
+  // Point the reader at the start of binlog file filenum
+  void OpenFile(uint32_t filenum);
+  // Returns a slice of the next n bytes in the mapping. EndFile if they
+  // were not written to the file yet or are past the end of a finished
+  // file, IOError if the file can't be mapped, Corruption if a finished
+  // file ends inside them
+  pstd::Status Read(uint64_t n, pstd::Slice* result);
 
   std::shared_mutex rwlock_;
   uint32_t cur_filenum_ = 0;
@@ -39,10 +73,12 @@ class PikaBinlogReader {
   uint64_t last_record_offset_ = 0;
 
   std::shared_ptr<Binlog> logger_;
-  std::unique_ptr<pstd::SequentialFile> queue_;
-
-  std::unique_ptr<char[]> const backing_store_;
-  pstd::Slice buffer_;
+  std::string filename_;
+  std::shared_ptr<PikaBinlogMappedFile> file_;
+  // position of the next Read in the file
+  uint64_t read_pos_ = 0;
+  // bytes of the file known to be written, never read past it
+  uint64_t read_limit_ = 0;
 };
 
 #endif  // PIKA_BINLOG_READER_H_
@@ -76,10 +76,13 @@ class PikaClientConn : public net::RedisConn {
 
   bool IsInterceptedByRTC(std::string& opt);
 
-  void ProcessRedisCmds(const std::vector<net::RedisCmdArgsType>& argvs, bool async, std::string* response) override;
+  void ProcessRedisCmds(std::vector<net::RedisCmdArgsType>&& argvs, bool async, std::string* response) override;
+  net::WriteStatus SendReply() override;
 
   bool ReadCmdInCache(const net::RedisCmdArgsType& argv, const std::string& opt);
   void BatchExecRedisCmd(const std::vector<net::RedisCmdArgsType>& argvs, bool cache_miss_in_rtc);
+  bool CanRunToCompletion(const std::vector<net::RedisCmdArgsType>& argvs);
+  void RunToCompletion(const std::vector<net::RedisCmdArgsType>& argvs);
   int DealMessage(const net::RedisCmdArgsType& argv, std::string* response) override { return 0; }
   static void DoBackgroundTask(void* arg);
 
@@ -14,7 +14,8 @@
 
 class PikaClientProcessor {
  public:
-  PikaClientProcessor(size_t worker_num, size_t max_queue_size, const std::string& name_prefix = "CliProcessor");
+  PikaClientProcessor(size_t worker_num, size_t max_queue_size, const std::string& name_prefix = "CliProcessor",
+                      bool work_stealing = false);
   ~PikaClientProcessor();
   int Start();
   void Stop();
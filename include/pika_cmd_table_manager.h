@@ -18,9 +18,13 @@ struct CommandStatistics {
   CommandStatistics(const CommandStatistics& other) {
     cmd_time_consuming.store(other.cmd_time_consuming.load());
     cmd_count.store(other.cmd_count.load());
+    rtc_suspended_until.store(other.rtc_suspended_until.load());
   }
   std::atomic<uint64_t> cmd_count = 0;
   std::atomic<uint64_t> cmd_time_consuming = 0;
+  // run-to-completion is skipped for the command until this time(us)
+  // after an inline execution exceeded the budget
+  std::atomic<uint64_t> rtc_suspended_until = 0;
 };
 
 class PikaCmdTableManager {
@@ -32,6 +36,8 @@ class PikaCmdTableManager {
   void InitCmdTable(void);
   void RenameCommand(const std::string before, const std::string after);
   std::shared_ptr<Cmd> GetCmd(const std::string& opt);
+  // flag of the command without cloning it, 0 if it does not exist
+  uint32_t GetCmdFlag(const std::string& opt);
   bool CmdExist(const std::string& cmd) const;
   CmdTable* GetCmdTable();
   uint32_t GetMaxCmdId();
@@ -45,6 +51,11 @@ class PikaCmdTableManager {
 
  private:
   std::shared_ptr<Cmd> NewCommand(const std::string& opt);
+  // Take a cmd flagged kCmdFlagsPooled from the free list of the current
+  // thread, it goes back to the free list of the thread that drops the
+  // last reference
+  static std::shared_ptr<Cmd> AcquirePooledCmd(Cmd* prototype);
+  static void RecyclePooledCmd(Cmd* cmd);
 
   void InsertCurrentThreadDistributionMap();
   bool CheckCurrentThreadDistributionMapExist(const std::thread::id& tid);
@@ -257,6 +257,13 @@ constexpr const char* ErrTypeMessage = "Invalid argument: WRONGTYPE";
 using PikaCmdArgsType = net::RedisCmdArgsType;
 static const int RAW_ARGS_LEN = 1024 * 1024;
 
+/* Cmd pool */
+// free instances kept per command in every thread
+constexpr size_t kCmdPoolMaxFreePerCmd = 16;
+// cmds that carried larger arguments are freed instead of pooled
+constexpr size_t kCmdPoolMaxArgvBytes = 16 * 1024;
+constexpr size_t kCmdPoolMaxReplyCapacity = 16 * 1024;
+
 enum CmdFlagsMask {
   kCmdFlagsMaskRW = 1,
   kCmdFlagsMaskLocal = (1 << 1),
@@ -290,7 +297,8 @@ enum CmdFlags {
   kCmdFlagsOperateKey = (1 << 19),  // redis keySpace
   kCmdFlagsStream = (1 << 20),
   kCmdFlagsFast = (1 << 21),
-  kCmdFlagsSlow = (1 << 22)
+  kCmdFlagsSlow = (1 << 22),
+  kCmdFlagsPooled = (1 << 23),  // instances are recycled through Cmd::Reset instead of Clone per request
 };
 
 void inline RedisAppendContent(std::string& str, const std::string& value);
@@ -346,6 +354,12 @@ class CmdRes {
     message_.clear();
     ret_ = kNone;
   }
+  // drop the buffer of a large reply before the cmd is pooled
+  void ShrinkToFit(size_t max_capacity) {
+    if (message_.capacity() > max_capacity) {
+      std::string().swap(message_);
+    }
+  }
   bool CacheMiss() const { return ret_ == kCacheMiss; }
   std::string raw_message() const { return message_; }
   std::string message() const {
@@ -537,6 +551,11 @@ class Cmd : public std::enable_shared_from_this<Cmd> {
   int8_t SubCmdIndex(const std::string& cmdName);  // if the command no subCommand，return -1；
 
   void Initial(const PikaCmdArgsType& argv, const std::string& db_name);
+  // Bring a pooled cmd back to the state of a fresh Clone(): drops argv,
+  // reply, db and connection references, then lets the derived class clear
+  // its own per-request members through Clear(). Members that DoInitial
+  // always assigns keep their buffers for the next request.
+  void Reset();
   uint32_t flag() const;
   bool hasFlag(uint32_t flag) const;
   bool is_read() const;
@@ -292,6 +292,34 @@ class PikaConf : public pstd::BaseConf {
     std::shared_lock l(rwlock_);
     return small_compaction_duration_threshold_;
   }
+  int multi_key_fanout_min_batch() {
+    std::shared_lock l(rwlock_);
+    return multi_key_fanout_min_batch_;
+  }
+  int zset_rank_index_min_members() {
+    std::shared_lock l(rwlock_);
+    return zset_rank_index_min_members_;
+  }
+  int list_node_max_elements() {
+    std::shared_lock l(rwlock_);
+    return list_node_max_elements_;
+  }
+  int inline_collection_max_entries() {
+    std::shared_lock l(rwlock_);
+    return inline_collection_max_entries_;
+  }
+  int64_t compaction_meta_cache_size() {
+    std::shared_lock l(rwlock_);
+    return compaction_meta_cache_size_;
+  }
+  bool compaction_meta_scan() {
+    std::shared_lock l(rwlock_);
+    return compaction_meta_scan_;
+  }
+  int64_t range_delete_min_entries() {
+    std::shared_lock l(rwlock_);
+    return range_delete_min_entries_;
+  }
   int max_background_flushes() {
     std::shared_lock l(rwlock_);
     return max_background_flushes_;
@@ -332,6 +360,23 @@ class PikaConf : public pstd::BaseConf {
     std::shared_lock l(rwlock_);
     return share_block_cache_;
   }
+  std::vector<std::string> prefix_bloom_types() {
+    std::shared_lock l(rwlock_);
+    return prefix_bloom_types_;
+  }
+  bool memory_governor() {
+    std::shared_lock l(rwlock_);
+    return memory_governor_;
+  }
+  std::string memory_governor_weights() {
+    std::shared_lock l(rwlock_);
+    return memory_governor_weights_;
+  }
+  // indexed by storage::ColumnFamilyIndex
+  std::vector<uint32_t> memory_governor_cf_weights() {
+    std::shared_lock l(rwlock_);
+    return memory_governor_cf_weights_;
+  }
   bool wash_data() {
     std::shared_lock l(rwlock_);
     return wash_data_;
@@ -393,6 +438,12 @@ class PikaConf : public pstd::BaseConf {
   int cache_mode() { return cache_mode_; }
   int sync_window_size() { return sync_window_size_.load(); }
   int max_conn_rbuf_size() { return max_conn_rbuf_size_.load(); }
+  std::string replication_binlog_compression() {
+    std::shared_lock l(rwlock_);
+    return replication_binlog_compression_;
+  }
+  int replication_batch_bytes() { return replication_batch_bytes_.load(); }
+  int replication_batch_latency_ms() { return replication_batch_latency_ms_.load(); }
   int consensus_level() { return consensus_level_.load(); }
   int replication_num() { return replication_num_.load(); }
   int rate_limiter_mode() {
@@ -455,6 +506,10 @@ class PikaConf : public pstd::BaseConf {
   int64_t rsync_timeout_ms() {
       return rsync_timeout_ms_.load(std::memory_order::memory_order_relaxed);
   }
+  std::string rsync_checksum_type() {
+    std::shared_lock l(rwlock_);
+    return rsync_checksum_type_;
+  }
 
   // Slow Commands configuration
   const std::string GetSlowCmd() {
@@ -485,6 +540,9 @@ class PikaConf : public pstd::BaseConf {
   // Immutable config items, we don't use lock.
   bool daemonize() { return daemonize_; }
   bool rtc_cache_read_enabled() { return rtc_cache_read_enabled_; }
+  bool thread_pool_work_stealing() { return thread_pool_work_stealing_; }
+  bool run_to_completion() { return run_to_completion_; }
+  uint64_t run_to_completion_budget_us() { return run_to_completion_budget_us_; }
   std::string pidfile() { return pidfile_; }
   int binlog_file_size() { return binlog_file_size_; }
   std::vector<rocksdb::CompressionType> compression_per_level();
@@ -570,7 +628,42 @@ class PikaConf : public pstd::BaseConf {
     TryPushDiffCommands("small-compaction-duration-threshold", std::to_string(value));
     small_compaction_duration_threshold_ = value;
   }
-  void SetMaxClientResponseSize(const int value) {
+  void SetMultiKeyFanoutMinBatch(const int value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("multi-key-fanout-min-batch", std::to_string(value));
+    multi_key_fanout_min_batch_ = value;
+  }
+  void SetZSetRankIndexMinMembers(const int value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("zset-rank-index-min-members", std::to_string(value));
+    zset_rank_index_min_members_ = value;
+  }
+  void SetListNodeMaxElements(const int value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("list-node-max-elements", std::to_string(value));
+    list_node_max_elements_ = value;
+  }
+  void SetInlineCollectionMaxEntries(const int value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("inline-collection-max-entries", std::to_string(value));
+    inline_collection_max_entries_ = value;
+  }
+  void SetCompactionMetaCacheSize(const int64_t value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("compaction-meta-cache-size", std::to_string(value));
+    compaction_meta_cache_size_ = value;
+  }
+  void SetCompactionMetaScan(const bool value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("compaction-meta-scan", value ? "yes" : "no");
+    compaction_meta_scan_ = value;
+  }
+  void SetRangeDeleteMinEntries(const int64_t value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("range-delete-min-entries", std::to_string(value));
+    range_delete_min_entries_ = value;
+  }
+  void SetMaxClientResponseSize(const int64_t value) {
     std::lock_guard l(rwlock_);
     TryPushDiffCommands("max-client-response-size", std::to_string(value));
     max_client_response_size_ = value;
@@ -723,6 +816,19 @@ class PikaConf : public pstd::BaseConf {
     TryPushDiffCommands("max-conn-rbuf-size", std::to_string(value));
     max_conn_rbuf_size_.store(value);
   }
+  void SetReplicationBinlogCompression(const std::string& value) {
+    std::lock_guard l(rwlock_);
+    TryPushDiffCommands("replication-binlog-compression", value);
+    replication_binlog_compression_ = value;
+  }
+  void SetReplicationBatchBytes(const int& value) {
+    TryPushDiffCommands("replication-batch-bytes", std::to_string(value));
+    replication_batch_bytes_.store(value);
+  }
+  void SetReplicationBatchLatencyMs(const int& value) {
+    TryPushDiffCommands("replication-batch-latency-ms", std::to_string(value));
+    replication_batch_latency_ms_.store(value);
+  }
   void SetMaxCacheFiles(const int& value) {
     std::lock_guard l(rwlock_);
     TryPushDiffCommands("max-cache-files", std::to_string(value));
@@ -952,6 +1058,9 @@ class PikaConf : public pstd::BaseConf {
   int64_t max_client_response_size_ = 0;
   bool daemonize_ = false;
   bool rtc_cache_read_enabled_ = false;
+  bool thread_pool_work_stealing_ = false;
+  bool run_to_completion_ = false;
+  uint64_t run_to_completion_budget_us_ = 200;
   int timeout_ = 0;
   std::string server_id_;
   std::string run_id_;
@@ -987,6 +1096,13 @@ class PikaConf : public pstd::BaseConf {
   int max_cache_statistic_keys_ = 0;
   int small_compaction_threshold_ = 0;
   int small_compaction_duration_threshold_ = 0;
+  int multi_key_fanout_min_batch_ = 64;
+  int zset_rank_index_min_members_ = 0;
+  int list_node_max_elements_ = 0;
+  int inline_collection_max_entries_ = 0;
+  int64_t compaction_meta_cache_size_ = 0;
+  bool compaction_meta_scan_ = false;
+  int64_t range_delete_min_entries_ = 0;
   int max_background_flushes_ = -1;
   int max_background_compactions_ = -1;
   int max_background_jobs_ = 0;
@@ -999,6 +1115,10 @@ class PikaConf : public pstd::BaseConf {
   int64_t block_cache_ = 0;
   int64_t num_shard_bits_ = 0;
   bool share_block_cache_ = false;
+  std::vector<std::string> prefix_bloom_types_;
+  bool memory_governor_ = false;
+  std::string memory_governor_weights_;
+  std::vector<uint32_t> memory_governor_cf_weights_;
   bool enable_partitioned_index_filters_ = false;
   bool cache_index_and_filter_blocks_ = false;
   bool pin_l0_filter_and_index_blocks_in_cache_ = false;
@@ -1012,6 +1132,9 @@ class PikaConf : public pstd::BaseConf {
 
   std::atomic<int> sync_window_size_;
   std::atomic<int> max_conn_rbuf_size_;
+  std::string replication_binlog_compression_ = "none";
+  std::atomic<int> replication_batch_bytes_ = 0;
+  std::atomic<int> replication_batch_latency_ms_ = kReplBatchLatencyDefaultMs;
   std::atomic<int> consensus_level_;
   std::atomic<int> replication_num_;
 
@@ -1073,6 +1196,7 @@ class PikaConf : public pstd::BaseConf {
   int throttle_bytes_per_second_ = 200 << 20; // 200MB/s
   int max_rsync_parallel_num_ = kMaxRsyncParallelNum;
   std::atomic_int64_t rsync_timeout_ms_ = 1000;
+  std::string rsync_checksum_type_ = "crc32c";
 
   //Internal used metrics Persisted by pika.conf
   std::unordered_set<std::string> internal_used_unfinished_full_sync_;
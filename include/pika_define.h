@@ -43,8 +43,23 @@ const std::string kDefaultRsyncAuth = "default";
 
 /* Rsync */
 const int kMaxRsyncParallelNum = 4;
+// Chunk requests a rsync reader keeps in flight for one file
+const int kRsyncWindowSize = 4;
 constexpr int kMaxRsyncInitReTryTimes = 64;
 
+/* Run to completion */
+// longer pipelines always go to the thread pool
+constexpr size_t kRunToCompletionMaxBatch = 32;
+// how long a command stays in the thread pool after it exceeded the budget
+constexpr uint64_t kRunToCompletionSuspendUs = 1000000;
+
+/* Replica apply */
+// binlog entries a slave collects before dispatching them to the write db workers
+constexpr size_t kReplApplyMaxBatch = 256;
+// how long a master holds binlog back to fill replication-batch-bytes
+constexpr int kReplBatchLatencyDefaultMs = 5;
+constexpr int kReplBatchLatencyMaxMs = 1000;
+
 struct DBStruct {
   DBStruct(std::string tn, int32_t inst_num)
       : db_name(std::move(tn)), db_instance_num(inst_num) {}
@@ -327,7 +342,8 @@ enum RecordType {
   kLastType = 4,
   kEof = 5,
   kBadRecord = 6,
-  kOldRecord = 7
+  kOldRecord = 7,
+  kReadError = 8
 };
 
 /*
@@ -347,6 +363,12 @@ static const size_t kHeaderSize = 1 + 3 + 4;
  */
 const int64_t kPoolSize = 1073741824;
 
+/*
+ * the most bytes of binlog items a group commit leader appends for
+ * itself and the writers queued behind it
+ */
+const size_t kBinlogGroupCommitMaxBytes = 1024 * 1024;
+
 const std::string kBinlogPrefix = "write2file";
 const size_t kBinlogPrefixLen = 10;
 
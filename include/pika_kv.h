@@ -43,6 +43,7 @@ class SetCmd : public Cmd {
   void DoInitial() override;
   void Clear() override {
     ttl_millsec = 0;
+    has_ttl_ = false;
     success_ = 0;
     condition_ = kNONE;
   }
@@ -73,6 +74,7 @@ class GetCmd : public Cmd {
   std::string value_;
   int64_t ttl_millsec_ = 0;
   void DoInitial() override;
+  void Clear() override { ttl_millsec_ = 0; }
   rocksdb::Status s_;
 };
 
@@ -116,6 +118,10 @@ class IncrCmd : public Cmd {
   std::string key_;
   int64_t new_value_ = 0;
   void DoInitial() override;
+  void Clear() override {
+    new_value_ = 0;
+    expired_timestamp_millsec_ = 0;
+  }
   rocksdb::Status s_;
   int64_t expired_timestamp_millsec_ = 0;
   std::string ToRedisProtocol() override;
@@ -141,6 +147,11 @@ class IncrbyCmd : public Cmd {
   std::string key_;
   int64_t by_ = 0, new_value_ = 0;
   void DoInitial() override;
+  void Clear() override {
+    by_ = 0;
+    new_value_ = 0;
+    expired_timestamp_millsec_ = 0;
+  }
   rocksdb::Status s_;
   int64_t expired_timestamp_millsec_ = 0;
   std::string ToRedisProtocol() override;
@@ -191,6 +202,7 @@ class DecrCmd : public Cmd {
   std::string key_;
   int64_t new_value_ = 0;
   void DoInitial() override;
+  void Clear() override { new_value_ = 0; }
   rocksdb::Status s_;
 };
 
@@ -214,6 +226,10 @@ class DecrbyCmd : public Cmd {
   std::string key_;
   int64_t by_ = 0, new_value_ = 0;
   void DoInitial() override;
+  void Clear() override {
+    by_ = 0;
+    new_value_ = 0;
+  }
   rocksdb::Status s_;
 };
 
@@ -261,6 +277,10 @@ class AppendCmd : public Cmd {
   std::string value_;
   std::string new_value_;
   void DoInitial() override;
+  void Clear() override {
+    new_value_.clear();
+    expired_timestamp_millsec_ = 0;
+  }
   rocksdb::Status s_;
   int64_t expired_timestamp_millsec_ = 0;
   std::string ToRedisProtocol() override;
@@ -544,6 +564,7 @@ class StrlenCmd : public Cmd {
   std::string value_;
   int64_t ttl_millsec = 0;
   void DoInitial() override;
+  void Clear() override { ttl_millsec = 0; }
   rocksdb::Status s_;
 };
 
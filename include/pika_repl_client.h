@@ -6,9 +6,13 @@
 #ifndef PIKA_REPL_CLIENT_H_
 #define PIKA_REPL_CLIENT_H_
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "net/include/client_thread.h"
 #include "net/include/net_conn.h"
@@ -42,10 +46,11 @@ struct ReplClientWriteBinlogTaskArg {
       : res(_res), conn(_conn), res_private_data(_res_private_data), worker(_worker) {}
 };
 
+// A group of binlog commands that share keys, applied in order by one write db worker
 struct ReplClientWriteDBTaskArg {
-  const std::shared_ptr<Cmd> cmd_ptr;
-  explicit ReplClientWriteDBTaskArg(std::shared_ptr<Cmd> _cmd_ptr)
-      : cmd_ptr(std::move(_cmd_ptr)) {}
+  const std::vector<std::shared_ptr<Cmd>> cmd_ptrs;
+  explicit ReplClientWriteDBTaskArg(std::vector<std::shared_ptr<Cmd>> _cmd_ptrs)
+      : cmd_ptrs(std::move(_cmd_ptrs)) {}
   ~ReplClientWriteDBTaskArg() = default;
 };
 
@@ -65,6 +70,9 @@ class PikaReplClient {
   void ScheduleWriteBinlogTask(const std::string& db_name, const std::shared_ptr<InnerMessage::InnerResponse>& res,
                                const std::shared_ptr<net::PbConn>& conn, void* res_private_data);
   void ScheduleWriteDBTask(const std::shared_ptr<Cmd>& cmd_ptr, const std::string& db_name);
+  // Dispatch the commands ScheduleWriteDBTask collected for db_name to the write db workers,
+  // must be called from the binlog worker of db_name
+  void FlushWriteDBTasks(const std::string& db_name);
 
   pstd::Status SendMetaSync();
   pstd::Status SendDBSync(const std::string& ip, uint32_t port, const std::string& db_name,
@@ -97,6 +105,10 @@ class PikaReplClient {
  private:
   size_t GetBinlogWorkerIndexByDBName(const std::string &db_name);
   size_t GetHashIndexByKey(const std::string& key);
+  void DispatchWriteDBGroups(const std::string& db_name, const std::vector<std::shared_ptr<Cmd>>& cmds);
+  void DispatchWriteDBGroup(const std::string& db_name, std::vector<std::shared_ptr<Cmd>> group,
+                            std::vector<std::string> keys);
+  void FinishWriteDBGroup(const std::string& db_name, const std::vector<std::string>& keys, int32_t cmd_num);
   void UpdateNextAvail() { next_avail_ = (next_avail_ + 1) % static_cast<int32_t>(write_binlog_workers_.size()); }
 
   std::unique_ptr<PikaReplClientThread> client_thread_;
@@ -108,6 +120,14 @@ class PikaReplClient {
   // util this count drop to zero. you can also check pika discussion #2807 to know more
   // it is only used in slaveNode when consuming binlog
   std::atomic<int32_t> async_write_db_task_counts_[MAX_DB_NUM];
+
+  // binlog commands not yet handed to write_db_workers_, only touched by the binlog worker of each db
+  std::vector<std::shared_ptr<Cmd>> pending_write_db_cmds_[MAX_DB_NUM];
+  // db_name + key -> {write db worker index, queued groups touching the key}, a command is only
+  // dispatched to the worker that already holds its keys so commands on the same key keep their order
+  std::mutex inflight_keys_mu_;
+  std::condition_variable inflight_keys_cv_;
+  std::unordered_map<std::string, std::pair<size_t, int32_t>> inflight_keys_;
   // [NOTICE] write_db_workers_ must be declared after async_write_db_task_counts_ to ensure write_db_workers_ will be destroyed before async_write_db_task_counts_
   // when PikaReplClient is de-constructing, because some of the async task that exec by write_db_workers_ will manipulate async_write_db_task_counts_
   std::vector<std::unique_ptr<PikaReplBgWorker>> write_binlog_workers_;
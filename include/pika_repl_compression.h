@@ -0,0 +1,36 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef PIKA_REPL_COMPRESSION_H_
+#define PIKA_REPL_COMPRESSION_H_
+
+#include <string>
+#include <vector>
+
+#include "pstd/include/pstd_status.h"
+#include "pika_inner_message.pb.h"
+
+// Binlog sync responses smaller than this are sent as they are,
+// keepalives and single small writes do not compress
+const size_t kMinCompressBinlogBytes = 512;
+
+// Compressions a slave can decode, advertised to the master in meta sync
+std::vector<InnerMessage::BinlogCompression> SupportedBinlogCompressions();
+
+// Maps the replication-binlog-compression option, kCompressionNone for unknown names
+InnerMessage::BinlogCompression BinlogCompressionFromString(const std::string& name);
+std::string BinlogCompressionToString(InnerMessage::BinlogCompression compression);
+
+// Moves the binlog_sync entries of response into a compressed binlog_sync_batch.
+// Leaves response untouched and returns false if compression does not pay off,
+// otherwise *saved_bytes is what the batch saves over the plain entries.
+bool CompressBinlogSync(InnerMessage::BinlogCompression compression, InnerMessage::InnerResponse* response,
+                        size_t* saved_bytes);
+
+// Restores the binlog_sync entries from binlog_sync_batch, a batch expanding
+// past max_raw_size is treated as corrupted
+pstd::Status DecompressBinlogSync(InnerMessage::InnerResponse* response, size_t max_raw_size);
+
+#endif
@@ -38,6 +38,7 @@ class PikaReplServer {
   void BuildBinlogSyncResp(const std::vector<WriteTask>& tasks, InnerMessage::InnerResponse* resp);
   void Schedule(net::TaskFunc func, void* arg);
   void UpdateClientConnMap(const std::string& ip_port, int fd);
+  void UpdateClientBinlogCompression(const std::string& ip_port, InnerMessage::BinlogCompression compression);
   void RemoveClientConn(int fd);
   void KillAllConns();
 
@@ -46,6 +47,8 @@ class PikaReplServer {
   std::unique_ptr<PikaReplServerThread> pika_repl_server_thread_ = nullptr;
   std::shared_mutex client_conn_rwlock_;
   std::map<std::string, int> client_conn_map_;
+  // compression agreed on in meta sync, slaves not in the map get plain binlog
+  std::map<std::string, InnerMessage::BinlogCompression> client_compression_map_;
 };
 
 #endif
@@ -117,6 +117,8 @@ class SyncSlaveDB : public SyncDB {
   void StopRsync();
   pstd::Status ActivateRsync();
   bool IsRsyncExited() { return rsync_cli_->IsExitedFromRunning(); }
+  uint64_t RsyncReusedFileCount() { return rsync_cli_->ReusedFileCount(); }
+  uint64_t RsyncReusedBytes() { return rsync_cli_->ReusedBytes(); }
 
  private:
   std::unique_ptr<rsync::RsyncClient> rsync_cli_;
@@ -127,6 +129,14 @@ class SyncSlaveDB : public SyncDB {
   std::string local_ip_;
 };
 
+// Binlog waiting to be sent to one db of a slave
+struct SlaveWriteQueue {
+  std::queue<WriteTask> tasks;
+  size_t bytes = 0;
+  // when the oldest task in tasks was produced
+  uint64_t oldest_time_us = 0;
+};
+
 class PikaReplicaManager {
  public:
   PikaReplicaManager();
@@ -177,6 +187,8 @@ class PikaReplicaManager {
   void DropItemInOneWriteQueue(const std::string& ip, int port, const std::string& db_name);
   void DropItemInWriteQueue(const std::string& ip, int port);
   int ConsumeWriteQueue();
+  // Whether the last ConsumeWriteQueue held binlog back to fill replication-batch-bytes
+  bool HasHeldBinlog() const { return has_held_binlog_; }
 
   // Schedule Task
   void ScheduleReplServerBGTask(net::TaskFunc func, void* arg);
@@ -185,9 +197,11 @@ class PikaReplicaManager {
                                const std::shared_ptr<InnerMessage::InnerResponse>& res,
                                const std::shared_ptr<net::PbConn>& conn, void* res_private_data);
   void ScheduleWriteDBTask(const std::shared_ptr<Cmd>& cmd_ptr, const std::string& db_name);
+  void FlushWriteDBTasks(const std::string& db_name);
   void ScheduleReplClientBGTaskByDBName(net::TaskFunc , void* arg, const std::string &db_name);
   void ReplServerRemoveClientConn(int fd);
   void ReplServerUpdateClientConnMap(const std::string& ip_port, int fd);
+  void ReplServerUpdateClientBinlogCompression(const std::string& ip_port, InnerMessage::BinlogCompression compression);
 
   std::shared_mutex& GetDBLock() { return dbs_rw_; }
 
@@ -220,7 +234,9 @@ class PikaReplicaManager {
   pstd::Mutex write_queue_mu_;
 
   // every host owns a queue, the key is "ip + port"
-  std::unordered_map<std::string, std::unordered_map<std::string, std::queue<WriteTask>>> write_queues_;
+  std::unordered_map<std::string, std::unordered_map<std::string, SlaveWriteQueue>> write_queues_;
+  // only used by the auxiliary thread, which is the one consuming write_queues_
+  bool has_held_binlog_ = false;
   std::unique_ptr<PikaReplClient> pika_repl_client_;
   std::unique_ptr<PikaReplServer> pika_repl_server_;
 };
@@ -99,6 +99,7 @@ class PikaServer : public pstd::noncopyable {
   void SetDispatchQueueLimit(int queue_limit);
   void SetSlowCmdThreadPoolFlag(bool flag);
   storage::StorageOptions storage_options();
+  std::shared_ptr<storage::MemoryGovernor> memory_governor();
   std::unique_ptr<PikaDispatchThread>& pika_dispatch_thread() {
     return pika_dispatch_thread_;
   }
@@ -138,6 +139,13 @@ class PikaServer : public pstd::noncopyable {
   void DBSetMaxCacheStatisticKeys(uint32_t max_cache_statistic_keys);
   void DBSetSmallCompactionThreshold(uint32_t small_compaction_threshold);
   void DBSetSmallCompactionDurationThreshold(uint32_t small_compaction_duration_threshold);
+  void DBSetMultiKeyFanoutMinBatch(uint32_t multi_key_fanout_min_batch);
+  void DBSetZSetRankIndexMinMembers(uint32_t zset_rank_index_min_members);
+  void DBSetListNodeMaxElements(uint32_t list_node_max_elements);
+  void DBSetInlineCollectionMaxEntries(uint32_t inline_collection_max_entries);
+  void DBSetCompactionMetaCacheSize(size_t compaction_meta_cache_size);
+  void DBSetCompactionMetaScan(bool compaction_meta_scan);
+  void DBSetRangeDeleteMinEntries(uint64_t range_delete_min_entries);
   bool GetDBBinlogOffset(const std::string& db_name, BinlogOffset* boffset);
   pstd::Status DoSameThingEveryDB(const TaskType& type);
 
@@ -277,6 +285,7 @@ class PikaServer : public pstd::noncopyable {
   size_t NetOutputBytes();
   size_t NetReplInputBytes();
   size_t NetReplOutputBytes();
+  size_t NetReplSavedBytes();
   float InstantaneousInputKbps();
   float InstantaneousOutputKbps();
   float InstantaneousInputReplKbps();
@@ -525,6 +534,7 @@ class PikaServer : public pstd::noncopyable {
   void AutoUpdateNetworkMetric();
   void PrintThreadPoolQueueStatus();
   void StatDiskUsage();
+  void RebalanceMemory();
   int64_t GetLastSaveTime(const std::string& dump_dir);
 
   std::string host_;
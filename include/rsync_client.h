@@ -69,11 +69,15 @@ class RsyncClient : public net::Thread {
     return state_.load() == STOP;
   }
   bool IsIdle() { return state_.load() == IDLE;}
+  uint64_t ReusedFileCount() { return reused_file_count_.load(); }
+  uint64_t ReusedBytes() { return reused_bytes_.load(); }
   void OnReceive(RsyncService::RsyncResponse* resp);
 private:
   bool ComparisonUpdate();
   Status CopyRemoteFile(const std::string& filename, int index);
-  Status PullRemoteMeta(std::string* snapshot_uuid, std::set<std::string>* file_set);
+  Status PullRemoteMeta(std::string* snapshot_uuid, std::set<std::string>* file_set,
+                        std::map<std::string, RsyncService::FileMeta>* file_metas);
+  void ReuseLocalFiles(const std::map<std::string, RsyncService::FileMeta>& file_metas);
   Status LoadLocalMeta(std::string* snapshot_uuid, std::map<std::string, std::string>* file_map);
   std::string GetLocalMetaFilePath();
   Status FlushMetaTable();
@@ -97,6 +101,13 @@ private:
   std::atomic<State> state_;
   std::atomic<bool> error_stopped_{false};
   std::atomic<bool> all_worker_exited_{true};
+  // table files of the last full sync linked from the local db instead of fetched
+  std::atomic<uint64_t> reused_file_count_{0};
+  std::atomic<uint64_t> reused_bytes_{0};
+  // chunk requests a worker keeps in flight, as granted by the master
+  uint32_t window_size_ = 1;
+  // sizes of the dump files the master reported, to preallocate them
+  std::map<std::string, uint64_t> remote_file_sizes_;
   int max_retries_ = 10;
   std::unique_ptr<WaitObjectManager> wo_mgr_;
   std::condition_variable cond_;
@@ -134,12 +145,26 @@ class RsyncWriter {
     }
     return Status::OK();
   }
+  // Reserves the blocks of a file whose size is known up front, so a big
+  // SST lands in few extents. The file size is kept as the writes append.
+  void Preallocate(uint64_t size) {
+#if defined(__linux__)
+    if (size > 0 && fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(size)) != 0) {
+      LOG(WARNING) << "fallocate failed, filename: " << filepath_ << " error: " << strerror(errno);
+    }
+#endif
+  }
   Status Close() {
     close(fd_);
     return Status::OK();
   }
+  // Also drops the synced pages from the page cache, the checkpoint is not
+  // read again until the db is reopened on it and would only evict hot data
   Status Fsync() {
     fsync(fd_);
+#if defined(__linux__)
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED);
+#endif
     return Status::OK();
   }
 
@@ -150,47 +175,70 @@ class RsyncWriter {
 
 class WaitObject {
  public:
-  WaitObject() : filename_(""), type_(RsyncService::kRsyncMeta), offset_(0), resp_(nullptr) {}
+  WaitObject() : filename_(""), type_(RsyncService::kRsyncMeta), resp_(nullptr) {}
   ~WaitObject() {}
 
-  void Reset(const std::string& filename, RsyncService::Type t, size_t offset) {
+  // Drops the responses still in flight for the previous file, a worker keeps
+  // up to kRsyncWindowSize chunk requests of one file outstanding
+  void Reset(const std::string& filename, RsyncService::Type t) {
     std::lock_guard<std::mutex> guard(mu_);
     resp_.reset();
+    pending_.clear();
     filename_ = filename;
     type_ = t;
-    offset_ = offset;
   }
 
-  pstd::Status Wait(ResponseSPtr& resp) {
+  void Expect(size_t offset) {
+    std::lock_guard<std::mutex> guard(mu_);
+    pending_[offset] = nullptr;
+  }
+
+  pstd::Status Wait(size_t offset, ResponseSPtr& resp) {
     auto timeout = g_pika_conf->rsync_timeout_ms();
     std::unique_lock<std::mutex> lock(mu_);
-    auto cv_s = cond_.wait_for(lock, std::chrono::milliseconds(timeout), [this] {
-      return resp_.get() != nullptr;
+    auto cv_s = cond_.wait_for(lock, std::chrono::milliseconds(timeout), [this, offset] {
+      auto iter = pending_.find(offset);
+      return resp_.get() != nullptr || (iter != pending_.end() && iter->second.get() != nullptr);
     });
     if (!cv_s) {
       std::string timout_info("timeout during(in ms) is ");
       timout_info.append(std::to_string(timeout));
       return pstd::Status::Timeout("rsync timeout", timout_info);
     }
-    resp = resp_;
+    // an error response fails whatever chunk is waited on
+    if (resp_.get() != nullptr) {
+      resp = resp_;
+      return pstd::Status::OK();
+    }
+    resp = pending_[offset];
+    pending_.erase(offset);
     return pstd::Status::OK();
   }
 
   void WakeUp(RsyncService::RsyncResponse* resp) {
     std::unique_lock<std::mutex> lock(mu_);
-    resp_.reset(resp);
-    offset_ = kInvalidOffset;
+    if (resp->code() != RsyncService::kOk) {
+      resp_.reset(resp);
+      cond_.notify_all();
+      return;
+    }
+    size_t offset = resp->type() == RsyncService::kRsyncFile ? resp->file_resp().offset() : kInvalidOffset;
+    auto iter = pending_.find(offset);
+    if (iter == pending_.end() || iter->second.get() != nullptr) {
+      delete resp;
+      return;
+    }
+    iter->second.reset(resp);
     cond_.notify_all();
   }
 
   std::string Filename() {return filename_;}
   RsyncService::Type Type() {return type_;}
-  size_t Offset() {return offset_;}
  private:
   std::string filename_;
   RsyncService::Type type_;
-  size_t offset_ = kInvalidOffset;
   ResponseSPtr resp_ = nullptr;
+  std::map<size_t, ResponseSPtr> pending_;
   std::condition_variable cond_;
   std::mutex mu_;
 };
@@ -210,17 +258,17 @@ class WaitObjectManager {
     }
   }
 
-  WaitObject* UpdateWaitObject(int worker_index, const std::string& filename,
-                               RsyncService::Type type, size_t offset) {
+  WaitObject* UpdateWaitObject(int worker_index, const std::string& filename, RsyncService::Type type) {
     std::lock_guard<std::mutex> guard(mu_);
-    wo_vec_[worker_index]->Reset(filename, type, offset);
+    wo_vec_[worker_index]->Reset(filename, type);
     return wo_vec_[worker_index];
   }
 
   void WakeUp(RsyncService::RsyncResponse* resp) {
     std::lock_guard<std::mutex> guard(mu_);
     int index = resp->reader_index();
-    if (wo_vec_[index] == nullptr || resp->type() != wo_vec_[index]->Type()) {
+    if (index < 0 || index >= wo_vec_.size() || wo_vec_[index] == nullptr ||
+        resp->type() != wo_vec_[index]->Type()) {
       delete resp;
       return;
     }
@@ -231,8 +279,7 @@ class WaitObjectManager {
     }
 
     if (resp->type() == RsyncService::kRsyncFile &&
-        ((resp->file_resp().filename() != wo_vec_[index]->Filename()) ||
-	 (resp->file_resp().offset() != wo_vec_[index]->Offset()))) {
+        resp->file_resp().filename() != wo_vec_[index]->Filename()) {
       delete resp;
       return;
     }
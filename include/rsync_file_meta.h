@@ -0,0 +1,50 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef RSYNC_FILE_META_H_
+#define RSYNC_FILE_META_H_
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "pstd/include/pstd_status.h"
+#include "rsync_service.pb.h"
+
+namespace rsync {
+
+// Bytes read from the end of a table file to fingerprint it
+const size_t kFingerprintTailBytes = 32 << 10;
+const size_t kMaxCachedFingerprints = 1 << 20;
+
+// Only table files are immutable once written, so they are the only files
+// a replica may keep from its own db instead of fetching them again
+bool IsReusableFile(const std::string& filename);
+
+// Fingerprints a file by its size and the MD5 of its last kFingerprintTailBytes.
+// A block based table ends with its properties block (db session id, original
+// file number, entry counts), the metaindex block and the footer, so the tail
+// tells two tables apart without reading them whole.
+pstd::Status GetFileFingerprint(const std::string& filepath, uint64_t* size, std::string* checksum);
+
+// Checksum of a rsync chunk, empty for kChecksumNone
+void ChunkChecksum(RsyncService::ChecksumType type, const char* data, size_t n, std::string* checksum);
+// Same checksum over len bytes of fd from offset, read through a mapping of the page cache
+pstd::Status ChunkChecksum(RsyncService::ChecksumType type, int fd, off_t offset, size_t len, std::string* checksum);
+
+// Dump checkpoints hard link the table files of the live db, so the same inode
+// shows up in every dump until it gets compacted away. Caching by inode keeps
+// the meta request cheap on a master that serves many full syncs.
+class FileFingerprintCache {
+ public:
+  pstd::Status Get(const std::string& filepath, uint64_t* size, std::string* checksum);
+
+ private:
+  std::mutex mu_;
+  std::unordered_map<std::string, std::pair<uint64_t, std::string>> fingerprints_;
+};
+
+}  // namespace rsync
+#endif
@@ -11,6 +11,8 @@
 #include <string.h>
 #include <errno.h>
 
+#include <algorithm>
+
 #include "net/include/net_conn.h"
 #include "net/include/net_thread.h"
 #include "net/include/pb_conn.h"
@@ -106,34 +108,77 @@ class RsyncReader {
                     const size_t count, char* data, size_t* bytes_read,
                     std::string* checksum, bool* is_eof) {
     std::lock_guard<std::mutex> guard(mu_);
-    pstd::Status s = readAhead(filepath, offset);
+    // A chunk may span read ahead blocks, only the end of file cuts it short.
+    // Pipelined requests may also start past the end of a small file.
+    size_t copied = 0;
+    while (copied < count) {
+      size_t read_offset = offset + copied;
+      pstd::Status s = readAhead(filepath, read_offset);
+      if (!s.ok()) {
+        return s;
+      }
+      if (read_offset >= total_size_ || read_offset >= end_offset_) {
+        break;
+      }
+      size_t offset_in_block = read_offset % kBlockSize;
+      size_t copy_count = std::min(count - copied, end_offset_ - read_offset);
+      memcpy(data + copied, block_data_ + offset_in_block, copy_count);
+      copied += copy_count;
+    }
+    *bytes_read = copied;
+    *is_eof = (offset + copied >= total_size_);
+    return pstd::Status::OK();
+  }
+
+  // Hands out the file region of a chunk instead of reading it, for framed
+  // responses whose payload is sent from the page cache. The caller owns fd.
+  pstd::Status ReadRegion(const std::string filepath, const size_t offset,
+                          const size_t count, int* fd, size_t* len, bool* is_eof) {
+    std::lock_guard<std::mutex> guard(mu_);
+    pstd::Status s = openFile(filepath);
     if (!s.ok()) {
       return s;
     }
-    size_t offset_in_block = offset % kBlockSize;
-    size_t copy_count = count > (end_offset_ - offset) ? end_offset_ - offset : count;
-    memcpy(data, block_data_ + offset_in_block, copy_count);
-    *bytes_read = copy_count;
-    *is_eof = (offset + copy_count == total_size_);
+    *len = offset >= total_size_ ? 0 : std::min(count, total_size_ - offset);
+    *is_eof = (offset + *len >= total_size_);
+    *fd = dup(fd_);
+    if (*fd < 0) {
+      return pstd::Status::IOError("dup file [" + filepath +  "] failed! error: " + strerror(errno));
+    }
     return pstd::Status::OK();
   }
 
 private:
+  pstd::Status openFile(const std::string& filepath) {
+    if (filepath == filepath_) {
+      return pstd::Status::OK();
+    }
+    Reset();
+    fd_ = open(filepath.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+      LOG(ERROR) << "open file [" << filepath <<  "] failed! error: " << strerror(errno);
+      return pstd::Status::IOError("open file [" + filepath +  "] failed! error: " + strerror(errno));
+    }
+#if defined(__linux__)
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    filepath_ = filepath;
+    struct stat buf;
+    stat(filepath.c_str(), &buf);
+    total_size_ = buf.st_size;
+    return pstd::Status::OK();
+  }
+
   pstd::Status readAhead(const std::string filepath, const size_t offset) {
     if (filepath == filepath_ && offset >= start_offset_ && offset < end_offset_) {
       return pstd::Status::OK();
     }
-    if (filepath != filepath_) {
-      Reset();
-      fd_ = open(filepath.c_str(), O_RDONLY);
-      if (fd_ < 0) {
-        LOG(ERROR) << "open file [" << filepath <<  "] failed! error: " << strerror(errno);
-        return pstd::Status::IOError("open file [" + filepath +  "] failed! error: " + strerror(errno));
-      }
-      filepath_ = filepath;
-      struct stat buf;
-      stat(filepath.c_str(), &buf);
-      total_size_ = buf.st_size;
+    pstd::Status s = openFile(filepath);
+    if (!s.ok()) {
+      return s;
+    }
+    if (offset >= total_size_) {
+      return pstd::Status::OK();
     }
     start_offset_ = (offset / kBlockSize) * kBlockSize;
 
@@ -161,10 +206,10 @@ private:
     total_size_ = -1;
     start_offset_ = 0xFFFFFFFF;
     end_offset_ = 0xFFFFFFFF;
-    memset(block_data_, 0, kBlockSize);
-    md5_.reset(new pstd::MD5());
     filepath_ = "";
-    close(fd_);
+    if (fd_ >= 0) {
+      close(fd_);
+    }
     fd_ = -1;
   }
 
@@ -179,7 +224,6 @@ private:
 
   int fd_ = -1;
   std::string filepath_;
-  std::unique_ptr<pstd::MD5> md5_;
 };
 
 } //end namespace rsync
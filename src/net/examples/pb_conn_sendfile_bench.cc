@@ -0,0 +1,114 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "net/include/net_stats.h"
+#include "net/include/pb_conn.h"
+
+using namespace net;
+using namespace std::chrono;
+
+extern std::unique_ptr<NetworkStatistic> g_network_statistic;
+
+const size_t CHUNK_SIZE = 4 << 20;
+const std::string HEADER(64, 'h');
+const std::string FILE_PATH = "./pb_conn_sendfile_bench.data";
+
+class BenchConn : public PbConn {
+ public:
+  BenchConn(int fd) : PbConn(fd, "127.0.0.1:" + std::to_string(fd), nullptr) {}
+
+  int DealMessage() override { return 0; }
+};
+
+// Drains the client end until the server end shuts down
+static void Drain(int fd) {
+  char buf[1 << 20];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+}
+
+static double ThreadCpuSeconds() {
+  struct rusage usage;
+  getrusage(RUSAGE_THREAD, &usage);
+  return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+         static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000;
+}
+
+// Serves the whole file in CHUNK_SIZE replies, returns the CPU seconds the
+// serving thread spent per GB. The copy mode reads every chunk and copies it
+// into the reply like a serialized protobuf, the zero copy mode hands the
+// file region to sendfile(2).
+static double Run(bool zero_copy, int file_fd, size_t file_size) {
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    std::cout << "socketpair failed" << std::endl;
+    return 0;
+  }
+  fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+  std::thread reader(Drain, fds[1]);
+
+  BenchConn conn(fds[0]);
+  std::string buffer(CHUNK_SIZE, 0);
+  double start = ThreadCpuSeconds();
+  for (size_t offset = 0; offset < file_size; offset += CHUNK_SIZE) {
+    size_t len = std::min(CHUNK_SIZE, file_size - offset);
+    if (zero_copy) {
+      conn.WriteResp(HEADER, dup(file_fd), static_cast<off_t>(offset), len);
+    } else {
+      pread(file_fd, buffer.data(), len, static_cast<off_t>(offset));
+      std::string data(buffer.data(), len);
+      conn.WriteResp(HEADER + data);
+    }
+    WriteStatus status;
+    while ((status = conn.SendReply()) == kWriteHalf) {
+      struct pollfd pfd = {fds[0], POLLOUT, 0};
+      poll(&pfd, 1, 100);
+    }
+    if (status != kWriteAll) {
+      std::cout << "send reply failed" << std::endl;
+      break;
+    }
+  }
+  double cpu = ThreadCpuSeconds() - start;
+
+  shutdown(fds[0], SHUT_WR);
+  reader.join();
+  close(fds[0]);
+  close(fds[1]);
+  return cpu / (static_cast<double>(file_size) / (1 << 30));
+}
+
+// Sends a 1GB (or argv[1] MB) file from the page cache over a local socket,
+// reports the server CPU per GB with and without sendfile(2)
+int main(int argc, char** argv) {
+  size_t file_size = (argc > 1 ? std::stoul(argv[1]) : 1024) << 20;
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+
+  int file_fd = open(FILE_PATH.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  std::string block(CHUNK_SIZE, 'x');
+  for (size_t written = 0; written < file_size; written += block.size()) {
+    write(file_fd, block.data(), std::min(block.size(), file_size - written));
+  }
+
+  double copy_cpu = Run(false, file_fd, file_size);
+  double zero_copy_cpu = Run(true, file_fd, file_size);
+  std::cout << "file size: " << (file_size >> 20) << "MB, chunk size: " << (CHUNK_SIZE >> 20) << "MB" << std::endl;
+  std::cout << "copy into reply: " << copy_cpu << " cpu seconds/GB" << std::endl;
+  std::cout << "sendfile: " << zero_copy_cpu << " cpu seconds/GB" << std::endl;
+
+  close(file_fd);
+  unlink(FILE_PATH.c_str());
+  return 0;
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "net/include/net_pubsub.h"
+#include "net/include/net_stats.h"
+#include "net/include/redis_conn.h"
+
+using namespace net;
+using namespace std::chrono;
+
+extern std::unique_ptr<NetworkStatistic> g_network_statistic;
+
+const int CHANNEL_NUM = 1000;
+const int MESSAGES_PER_PUBLISHER = 100000;
+const std::vector<int> PUBLISHER_NUMS = {1, 4, 16};
+const std::string MESSAGE(32, 'm');
+
+class SubscriberConn : public RedisConn {
+ public:
+  SubscriberConn(int fd, Thread* thread) : RedisConn(fd, "127.0.0.1:" + std::to_string(fd), thread) {}
+
+  int DealMessage(const RedisCmdArgsType& argv, std::string* response) override { return 0; }
+  const std::string& GetCurrentTable() override { return table_; }
+
+ private:
+  std::string table_ = "db0";
+};
+
+static int64_t BulkSize(const std::string& str) {
+  return 1 + static_cast<int64_t>(std::to_string(str.size()).size()) + 2 + static_cast<int64_t>(str.size()) + 2;
+}
+
+// The size of the message a subscriber of channel receives
+static int64_t RespSize(const std::string& channel) {
+  return 4 + BulkSize("message") + BulkSize(channel) + BulkSize(MESSAGE);
+}
+
+static std::atomic<int64_t> received_bytes{0};
+static std::atomic<bool> should_exit{false};
+
+// Drains the client ends of the subscriber connections
+static void ReadSubscribers(const std::vector<int>& fds) {
+  int epfd = epoll_create1(0);
+  for (int fd : fds) {
+    struct epoll_event ev = {EPOLLIN, {.fd = fd}};
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+  }
+  std::vector<struct epoll_event> events(1024);
+  char buf[64 * 1024];
+  while (!should_exit.load()) {
+    int n = epoll_wait(epfd, events.data(), static_cast<int>(events.size()), 100);
+    for (int i = 0; i < n; ++i) {
+      ssize_t nread = 0;
+      while ((nread = read(events[i].data.fd, buf, sizeof(buf))) > 0) {
+        received_bytes.fetch_add(nread);
+      }
+    }
+  }
+  close(epfd);
+}
+
+// PUBLISH to 1k channels with 10k subscribers (or argv[1]) from 1, 4 and
+// 16 threads, reports the PUBLISH throughput and the time until every
+// subscriber got every message
+int main(int argc, char** argv) {
+  int subscriber_num = argc > 1 ? atoi(argv[1]) : 10000;
+  struct rlimit limit;
+  getrlimit(RLIMIT_NOFILE, &limit);
+  limit.rlim_cur = limit.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &limit);
+  if (limit.rlim_cur < static_cast<rlim_t>(subscriber_num) * 2 + 64) {
+    std::cout << "open files limit " << limit.rlim_cur << " is too low for " << subscriber_num << " subscribers"
+              << std::endl;
+    return -1;
+  }
+
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+  PubSubThread pubsub;
+  pubsub.StartThread();
+
+  std::vector<int> client_fds;
+  int64_t resp_bytes = 0;
+  for (int i = 0; i < subscriber_num; ++i) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      std::cout << "socketpair failed" << std::endl;
+      return -1;
+    }
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+    client_fds.push_back(fds[1]);
+
+    std::string channel = "channel_" + std::to_string(i % CHANNEL_NUM);
+    std::vector<std::pair<std::string, int>> result;
+    pubsub.Subscribe(std::make_shared<SubscriberConn>(fds[0], &pubsub), {channel}, false, &result);
+    pubsub.UpdateConnReadyState(fds[0], PubSubThread::kReady);
+  }
+  std::thread reader(ReadSubscribers, client_fds);
+
+  for (int publisher_num : PUBLISHER_NUMS) {
+    received_bytes.store(0);
+    std::atomic<int64_t> expect_bytes{0};
+    auto start = steady_clock::now();
+    std::vector<std::thread> publishers;
+    for (int p = 0; p < publisher_num; ++p) {
+      publishers.emplace_back([&pubsub, &expect_bytes, p]() {
+        std::mt19937 rng(p);
+        for (int i = 0; i < MESSAGES_PER_PUBLISHER; ++i) {
+          std::string channel = "channel_" + std::to_string(rng() % CHANNEL_NUM);
+          int receivers = pubsub.Publish(channel, MESSAGE);
+          expect_bytes.fetch_add(receivers * RespSize(channel));
+        }
+      });
+    }
+    for (auto& publisher : publishers) {
+      publisher.join();
+    }
+    auto publish_cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+    while (received_bytes.load() < expect_bytes.load()) {
+      std::this_thread::sleep_for(milliseconds(1));
+    }
+    auto deliver_cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+    int64_t total = static_cast<int64_t>(publisher_num) * MESSAGES_PER_PUBLISHER;
+    std::cout << publisher_num << " publishers, " << subscriber_num << " subscribers, publish: "
+              << total * 1000000 / std::max<int64_t>(publish_cost, 1) << " msg/s, delivered: "
+              << total * 1000000 / std::max<int64_t>(deliver_cost, 1) << " msg/s" << std::endl;
+    resp_bytes += expect_bytes.load();
+  }
+
+  should_exit.store(true);
+  reader.join();
+  auto stop_start = steady_clock::now();
+  pubsub.StopThread();
+  auto stop_cost = duration_cast<microseconds>(steady_clock::now() - stop_start).count();
+  std::cout << "delivered " << resp_bytes << " bytes, StopThread took " << stop_cost << " us" << std::endl;
+  return 0;
+}
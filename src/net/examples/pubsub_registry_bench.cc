@@ -0,0 +1,135 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "net/include/net_pubsub.h"
+#include "net/include/net_stats.h"
+#include "net/include/redis_conn.h"
+
+using namespace net;
+using namespace std::chrono;
+
+extern std::unique_ptr<NetworkStatistic> g_network_statistic;
+
+const int CONN_NUM = 1000;
+const int CHANNEL_NUM = 100000;
+const int PATTERN_NUM = 5000;
+const int CHURN_OPS = 200000;
+const int PUBLISH_OPS = 200000;
+const std::vector<int> THREAD_NUMS = {1, 4, 16};
+
+class SubscriberConn : public RedisConn {
+ public:
+  SubscriberConn(int fd, Thread* thread) : RedisConn(fd, "127.0.0.1:" + std::to_string(fd), thread) {}
+
+  int DealMessage(const RedisCmdArgsType& argv, std::string* response) override { return 0; }
+  const std::string& GetCurrentTable() override { return table_; }
+
+ private:
+  std::string table_ = "db0";
+};
+
+static std::string Channel(uint32_t i) { return "news." + std::to_string(i % 100) + ".item_" + std::to_string(i); }
+
+// Patterns with 100 different literal prefixes, like news.42.*
+static std::string Pattern(uint32_t i) {
+  return "news." + std::to_string(i % 100) + ".item_" + std::to_string(i / 100) + "*";
+}
+
+template <typename F>
+static int64_t RunThreads(int thread_num, int ops, F func) {
+  auto start = steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&func, t, thread_num, ops]() {
+      std::mt19937 rng(t);
+      for (int i = 0; i < ops / thread_num; ++i) {
+        func(&rng);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+  return static_cast<int64_t>(ops) * 1000000 / std::max<int64_t>(cost, 1);
+}
+
+// 1k connections subscribed to 100k channels and 5k patterns, reports
+// the SUBSCRIBE/UNSUBSCRIBE churn and PUBLISH lookup throughput
+// from 1, 4 and 16 threads
+int main(int argc, char** argv) {
+  struct rlimit limit;
+  getrlimit(RLIMIT_NOFILE, &limit);
+  limit.rlim_cur = limit.rlim_max;
+  setrlimit(RLIMIT_NOFILE, &limit);
+  if (limit.rlim_cur < CONN_NUM * 2 + 64) {
+    std::cout << "open files limit " << limit.rlim_cur << " is too low" << std::endl;
+    return -1;
+  }
+
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+  PubSubThread pubsub;
+  pubsub.StartThread();
+
+  std::vector<std::shared_ptr<NetConn>> conns;
+  std::vector<int> client_fds;
+  for (int i = 0; i < CONN_NUM; ++i) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+      std::cout << "socketpair failed" << std::endl;
+      return -1;
+    }
+    client_fds.push_back(fds[1]);
+    conns.push_back(std::make_shared<SubscriberConn>(fds[0], &pubsub));
+  }
+
+  auto start = steady_clock::now();
+  for (uint32_t i = 0; i < CHANNEL_NUM; ++i) {
+    std::vector<std::pair<std::string, int>> result;
+    pubsub.Subscribe(conns[i % CONN_NUM], {Channel(i)}, false, &result);
+  }
+  for (uint32_t i = 0; i < PATTERN_NUM; ++i) {
+    std::vector<std::pair<std::string, int>> result;
+    pubsub.Subscribe(conns[i % CONN_NUM], {Pattern(i)}, true, &result);
+  }
+  auto setup_cost = duration_cast<milliseconds>(steady_clock::now() - start).count();
+  std::cout << CHANNEL_NUM << " channels, " << PATTERN_NUM << " patterns subscribed in " << setup_cost << "ms"
+            << std::endl;
+
+  for (int thread_num : THREAD_NUMS) {
+    // every thread owns the channels of its own conns, as a conn
+    // only ever sends SUBSCRIBE/UNSUBSCRIBE from its own worker
+    int64_t churn = RunThreads(thread_num, CHURN_OPS, [&](std::mt19937* rng) {
+      uint32_t channel = CHANNEL_NUM + (*rng)() % CHANNEL_NUM;
+      const auto& conn = conns[(*rng)() % CONN_NUM];
+      std::vector<std::pair<std::string, int>> result;
+      pubsub.Subscribe(conn, {Channel(channel)}, false, &result);
+      result.clear();
+      pubsub.UnSubscribe(conn, {Channel(channel)}, false, &result);
+    });
+    int64_t publish = RunThreads(thread_num, PUBLISH_OPS, [&](std::mt19937* rng) {
+      // conns are never ready, so only the lookup and the queue are measured
+      pubsub.Publish(Channel((*rng)() % CHANNEL_NUM), "m");
+    });
+    std::cout << thread_num << " threads, subscribe+unsubscribe: " << churn << " ops/s, publish: " << publish
+              << " msg/s" << std::endl;
+  }
+
+  pubsub.StopThread();
+  for (int fd : client_fds) {
+    close(fd);
+  }
+  return 0;
+}
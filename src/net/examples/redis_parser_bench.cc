@@ -0,0 +1,110 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "net/include/redis_parser.h"
+
+using namespace net;
+using namespace std::chrono;
+
+// every copy of a partial argument lands in a new or grown string, so the
+// bytes allocated while parsing are the copy volume of the parser
+static std::atomic<bool> counting{false};
+static std::atomic<int64_t> allocated_bytes{0};
+
+void* operator new(size_t size) {
+  if (counting.load(std::memory_order_relaxed)) {
+    allocated_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+  }
+  void* p = malloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+const std::vector<size_t> VALUE_SIZES = {16 * 1024, 256 * 1024, 1024 * 1024, 8 * 1024 * 1024};
+const std::vector<size_t> READ_SIZES = {REDIS_IOBUF_LEN, 64 * 1024};
+
+static int64_t parsed_cmds = 0;
+
+// takes the batch the way RedisConn::ParserCompleteCb does
+static int Complete(RedisParser* parser, std::vector<RedisCmdArgsType>& argvs) {
+  std::vector<RedisCmdArgsType> taken = std::move(argvs);
+  parsed_cmds += static_cast<int64_t>(taken.size());
+  return 0;
+}
+
+static std::string Multibulk(const RedisCmdArgsType& argv) {
+  std::string req = "*" + std::to_string(argv.size()) + "\r\n";
+  for (const auto& arg : argv) {
+    req += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+  }
+  return req;
+}
+
+// Feeds SET and HSET requests with large values to a RedisParser in reads
+// of 16KB (a connection's read buffer) and 64KB, reports the bytes the
+// parser copies per byte of request and the parse time per command
+int main(int argc, char** argv) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 10;
+
+  printf("%-5s %10s %8s %14s %12s\n", "cmd", "value", "read", "copied/req", "us/cmd");
+  for (const char* cmd : {"SET", "HSET"}) {
+    for (size_t value_size : VALUE_SIZES) {
+      RedisCmdArgsType args = {cmd, "bench_key"};
+      if (std::string(cmd) == "HSET") {
+        args.emplace_back("bench_field");
+      }
+      args.emplace_back(value_size, 'v');
+      std::string req = Multibulk(args);
+
+      for (size_t read_size : READ_SIZES) {
+        RedisParser parser;
+        RedisParserSettings settings;
+        settings.Complete = Complete;
+        parser.RedisParserInit(REDIS_PARSER_REQUEST, settings);
+        parsed_cmds = 0;
+
+        std::vector<char> rbuf(read_size);
+        allocated_bytes = 0;
+        counting = true;
+        auto start = steady_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+          for (size_t pos = 0; pos < req.size(); pos += read_size) {
+            size_t len = std::min(read_size, req.size() - pos);
+            memcpy(rbuf.data(), req.data() + pos, len);
+            int parsed_len = 0;
+            if (parser.ProcessInputBuffer(rbuf.data(), static_cast<int>(len), &parsed_len) == kRedisParserError) {
+              std::cerr << "parse error " << parser.get_error_code() << std::endl;
+              return 1;
+            }
+          }
+        }
+        auto cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+        counting = false;
+        if (parsed_cmds != rounds) {
+          std::cerr << "parsed " << parsed_cmds << " commands, expected " << rounds << std::endl;
+          return 1;
+        }
+        printf("%-5s %9zuK %7zuK %13.2fx %12.1f\n", cmd, value_size / 1024, read_size / 1024,
+               static_cast<double>(allocated_bytes.load()) / static_cast<double>(req.size() * rounds),
+               static_cast<double>(cost) / rounds);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "net/include/net_stats.h"
+#include "net/include/redis_conn.h"
+#include "net/include/server_thread.h"
+
+using namespace net;
+using namespace std::chrono;
+
+extern std::unique_ptr<NetworkStatistic> g_network_statistic;
+
+const int PORT = 19221;
+const int WORKER_NUM = 4;
+const int PIPELINE_DEPTH = 100;
+
+static size_t value_size = 64;
+
+// Answers every command with a bulk of value_size bytes. The replies are
+// built per command and handed over the way PikaClientConn does after its
+// commands ran in the thread pool
+class BenchConn : public RedisConn {
+ public:
+  BenchConn(int fd, const std::string& ip_port, Thread* thread, NetMultiplexer* net_mpx)
+      : RedisConn(fd, ip_port, thread, net_mpx, kAsynchronous) {}
+
+  void ProcessRedisCmds(std::vector<RedisCmdArgsType>&& argvs, bool async, std::string* response) override {
+    for (size_t i = 0; i < argvs.size(); ++i) {
+      auto resp = std::make_shared<std::string>();
+      resp->reserve(value_size + 32);
+      resp->append("$" + std::to_string(value_size) + "\r\n");
+      resp->append(value_size, 'v');
+      resp->append("\r\n");
+      WriteResp(resp);
+    }
+    NotifyEpoll(true);
+  }
+  int DealMessage(const RedisCmdArgsType& argv, std::string* response) override { return 0; }
+  const std::string& GetCurrentTable() override { return table_; }
+
+ private:
+  std::string table_ = "db0";
+};
+
+class BenchConnFactory : public ConnFactory {
+ public:
+  std::shared_ptr<NetConn> NewNetConn(int connfd, const std::string& ip_port, Thread* thread,
+                                      void* worker_specific_data, NetMultiplexer* net_mpx) const override {
+    return std::make_shared<BenchConn>(connfd, ip_port, thread, net_mpx);
+  }
+};
+
+static int64_t RssKB() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmRSS:") == 0) {
+      return std::stoll(line.substr(6));
+    }
+  }
+  return 0;
+}
+
+static std::atomic<bool> should_exit{false};
+static std::atomic<int64_t> replied{0};
+
+// Sends PIPELINE_DEPTH GETs in one write and reads all replies before the
+// next batch
+static void RunClient() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+    std::cerr << "connect failed" << std::endl;
+    exit(1);
+  }
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  std::string batch;
+  for (int i = 0; i < PIPELINE_DEPTH; ++i) {
+    batch.append("*2\r\n$3\r\nGET\r\n$8\r\nbench_ke\r\n");
+  }
+  size_t batch_reply_len = PIPELINE_DEPTH * (1 + std::to_string(value_size).size() + 2 + value_size + 2);
+  std::vector<char> buf(256 * 1024);
+  while (!should_exit.load()) {
+    if (write(fd, batch.data(), batch.size()) != static_cast<ssize_t>(batch.size())) {
+      std::cerr << "write failed" << std::endl;
+      exit(1);
+    }
+    size_t received = 0;
+    while (received < batch_reply_len) {
+      ssize_t nread = read(fd, buf.data(), buf.size());
+      if (nread <= 0) {
+        std::cerr << "read failed" << std::endl;
+        exit(1);
+      }
+      received += nread;
+    }
+    replied.fetch_add(PIPELINE_DEPTH);
+  }
+  close(fd);
+}
+
+// GETs pipelined 100 deep by 50 clients (or argv[2]) for 10 seconds (or
+// argv[3]) against a server replying with argv[1] bytes, reports the
+// throughput and the peak RSS growth of the process. Run it once per
+// value size, the RSS of one run carries over to the next in one process
+int main(int argc, char** argv) {
+  value_size = argc > 1 ? atoi(argv[1]) : 64;
+  int client_num = argc > 2 ? atoi(argv[2]) : 50;
+  int seconds = argc > 3 ? atoi(argv[3]) : 10;
+  g_network_statistic = std::make_unique<NetworkStatistic>();
+
+  BenchConnFactory conn_factory;
+  std::unique_ptr<ServerThread> server(NewDispatchThread(PORT, WORKER_NUM, &conn_factory, 1000));
+  if (server->StartThread() != 0) {
+    std::cerr << "StartThread failed" << std::endl;
+    return 1;
+  }
+  sleep(1);
+
+  int64_t base_rss = RssKB();
+  std::vector<std::thread> clients;
+  for (int i = 0; i < client_num; ++i) {
+    clients.emplace_back(RunClient);
+  }
+  int64_t peak_rss = base_rss;
+  auto start = steady_clock::now();
+  while (steady_clock::now() - start < seconds * 1s) {
+    std::this_thread::sleep_for(10ms);
+    peak_rss = std::max(peak_rss, RssKB());
+  }
+  should_exit.store(true);
+  auto cost = duration_cast<milliseconds>(steady_clock::now() - start).count();
+  for (auto& client : clients) {
+    client.join();
+  }
+  server->StopThread();
+
+  printf("value %zu bytes, %d clients, pipeline %d: %.0f GET/s, %.1f MB/s, peak RSS +%.1f MB\n", value_size,
+         client_num, PIPELINE_DEPTH, replied.load() * 1000.0 / cost,
+         replied.load() * static_cast<double>(value_size) / 1024 / 1024 * 1000.0 / cost,
+         (peak_rss - base_rss) / 1024.0);
+  return 0;
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "net/include/thread_pool.h"
+
+using namespace std::chrono;
+
+const size_t WORKER_NUM = 8;
+const size_t MAX_QUEUE_SIZE = 100000;
+const int TASKS_PER_PRODUCER = 200000;
+const std::vector<int> PRODUCER_NUMS = {1, 4, 16};
+
+static std::atomic<int64_t> finished_tasks{0};
+
+// a tiny task, so the cost is dominated by queueing
+static void task(void* arg) {
+  volatile uint64_t x = reinterpret_cast<uintptr_t>(arg);
+  for (int i = 0; i < 64; ++i) {
+    x = x * 31 + i;
+  }
+  finished_tasks.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Returns the throughput in tasks per second
+static int64_t RunBench(bool work_stealing, int producer_num) {
+  net::ThreadPool pool(WORKER_NUM, MAX_QUEUE_SIZE, "BenchPool", work_stealing);
+  pool.start_thread_pool();
+  finished_tasks.store(0);
+  int64_t total = static_cast<int64_t>(producer_num) * TASKS_PER_PRODUCER;
+
+  auto start = steady_clock::now();
+  std::vector<std::thread> producers;
+  for (int p = 0; p < producer_num; ++p) {
+    producers.emplace_back([&pool]() {
+      for (int i = 0; i < TASKS_PER_PRODUCER; ++i) {
+        pool.Schedule(task, reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  while (finished_tasks.load() < total) {
+    std::this_thread::yield();
+  }
+  auto cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+  pool.stop_thread_pool();
+  return cost == 0 ? 0 : total * 1000000 / cost;
+}
+
+// Schedule throughput of the mutex queue and the work-stealing
+// queues with 1, 4 and 16 producer threads and 8 workers
+int main() {
+  for (int producer_num : PRODUCER_NUMS) {
+    int64_t mutex_tps = RunBench(false, producer_num);
+    int64_t stealing_tps = RunBench(true, producer_num);
+    std::cout << producer_num << " producers, " << WORKER_NUM << " workers, mutex queue: " << mutex_tps
+              << " tasks/s, work stealing: " << stealing_tps << " tasks/s" << std::endl;
+  }
+  return 0;
+}
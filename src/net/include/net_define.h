@@ -26,6 +26,12 @@ const int kProtoMaxMessage = 512 * 1024 * 1024;  // 512MB
 
 const int kCommandHeaderLength = 4;
 
+/*
+ * Published messages the pubsub thread may lag behind by
+ * before PUBLISH waits for it
+ */
+const size_t kPubSubMaxPendingMessages = 100000;
+
 /*
  * The socket block type
  */
@@ -10,6 +10,7 @@
 #include <atomic>
 #include <functional>
 #include <map>
+#include <memory>
 #include <queue>
 #include <set>
 #include <string>
@@ -23,6 +24,7 @@
 #include "net/include/net_define.h"
 #include "net/include/net_thread.h"
 #include "net/src/net_multiplexer.h"
+#include "net/src/pubsub_registry.h"
 
 namespace net {
 
@@ -35,8 +37,13 @@ class PubSubThread : public Thread {
 
   ~PubSubThread() override;
 
+  // Also wakes the publishers waiting on a full queue and the poll loop
+  int StopThread() override;
+
   // PubSub
 
+  // Queue msg for the subscribers of channel and return the number of
+  // them, the message is delivered later by the pubsub thread
   int Publish(const std::string& channel, const std::string& msg);
 
   void Subscribe(const std::shared_ptr<NetConn>& conn, const std::vector<std::string>& channels, bool pattern,
@@ -84,6 +91,8 @@ class PubSubThread : public Thread {
   void CloseConn(const std::shared_ptr<NetConn>& conn);
   void CloseAllConns();
   int ClientChannelSize(const std::shared_ptr<NetConn>& conn);
+  // Fan the queued messages out to the subscribers
+  void DeliverMessages();
 
   int msg_pfd_[2];
   bool should_exit_;
@@ -92,9 +101,33 @@ class PubSubThread : public Thread {
   std::map<int, std::shared_ptr<ConnHandle>> conns_;
   std::atomic<bool> close_all_conn_sig_{false};
 
+  /*
+   * Messages published but not delivered yet, an intrusive lock-free
+   * MPSC list (Vyukov): a publisher links its node in with one exchange
+   * on pub_head_, the pubsub thread pops from pub_tail_. Publishers only
+   * take pub_mutex_ to wait when more than kPubSubMaxPendingMessages
+   * pile up
+   */
+  struct PubMessage {
+    PubMessage() = default;
+    PubMessage(const std::string& _channel, const std::string& _msg) : channel(_channel), msg(_msg) {}
+    std::atomic<PubMessage*> next{nullptr};
+    std::string channel;
+    std::string msg;
+  };
+  void PushPubMessage(PubMessage* message);
+  // pubsub thread only, nullptr when empty or a publisher is half way in
+  PubMessage* PopPubMessage();
+
+  PubMessage pub_stub_;
+  std::atomic<PubMessage*> pub_head_{&pub_stub_};
+  PubMessage* pub_tail_ = &pub_stub_;
+  std::atomic<size_t> pub_pending_{0};
+  // set by the first publish after a delivery, that one writes msg_pfd_
+  std::atomic<bool> pub_signaled_{false};
+  std::atomic<int> pub_waiters_{0};
   pstd::Mutex pub_mutex_;
-  pstd::CondVar receiver_rsignal_;
-  pstd::Mutex receiver_mutex_;
+  pstd::CondVar pub_cond_;
 
   /*
    * receive fd from worker thread
@@ -102,10 +135,6 @@ class PubSubThread : public Thread {
   pstd::Mutex mutex_;
   std::queue<NetItem> queue_;
 
-  std::string channel_;
-  std::string message_;
-  int receivers_{-1};
-
   /*
    * The epoll handler
    */
@@ -117,11 +146,7 @@ class PubSubThread : public Thread {
   void Cleanup();
 
   // PubSub
-  pstd::Mutex channel_mutex_;
-  pstd::Mutex pattern_mutex_;
-
-  std::map<std::string, std::vector<std::shared_ptr<NetConn>>> pubsub_channel_;  // channel <---> conns
-  std::map<std::string, std::vector<std::shared_ptr<NetConn>>> pubsub_pattern_;  // channel <---> conns
+  PubSubRegistry registry_;
 
 };  // class PubSubThread
 
@@ -19,16 +19,19 @@ class NetworkStatistic {
   size_t NetOutputBytes();
   size_t NetReplInputBytes();
   size_t NetReplOutputBytes();
+  size_t NetReplSavedBytes();
   void IncrRedisInputBytes(uint64_t bytes);
   void IncrRedisOutputBytes(uint64_t bytes);
   void IncrReplInputBytes(uint64_t bytes);
   void IncrReplOutputBytes(uint64_t bytes);
+  void IncrReplSavedBytes(uint64_t bytes);
 
  private:
   std::atomic<size_t> stat_net_input_bytes {0}; /* Bytes read from network. */
   std::atomic<size_t> stat_net_output_bytes {0}; /* Bytes written to network. */
   std::atomic<size_t> stat_net_repl_input_bytes {0}; /* Bytes read during replication, added to stat_net_input_bytes in 'info'. */
   std::atomic<size_t> stat_net_repl_output_bytes {0}; /* Bytes written during replication, added to stat_net_output_bytes in 'info'. */
+  std::atomic<size_t> stat_net_repl_saved_bytes {0}; /* Bytes binlog compression kept off the network during replication. */
 };
 
 }
@@ -21,9 +21,18 @@ using pstd::Status;
 
 class PbConn : public NetConn {
  public:
+  // A queued reply, data followed by file_len bytes of file_fd from
+  // file_offset, which are sent straight from the page cache
+  struct WriteItem {
+    WriteItem(std::string d) : data(std::move(d)) {}
+    std::string data;
+    int file_fd = -1;
+    off_t file_offset = 0;
+    size_t file_len = 0;
+  };
   struct WriteBuf {
     WriteBuf(const size_t item_pos = 0) : item_pos_(item_pos) {}
-    std::queue<std::string> queue_;
+    std::queue<WriteItem> queue_;
     size_t item_pos_;
   };
   PbConn(int fd, const std::string& ip_port, Thread* thread, NetMultiplexer* net_mpx = nullptr);
@@ -33,6 +42,9 @@ class PbConn : public NetConn {
   WriteStatus SendReply() override;
   void TryResizeBuffer() override;
   int WriteResp(const std::string& resp) override;
+  // Sends resp and file_len bytes of file_fd from file_offset as one message,
+  // the file part goes out with sendfile(2). Takes ownership of file_fd.
+  int WriteResp(const std::string& resp, int file_fd, off_t file_offset, size_t file_len);
   void NotifyWrite();
   void NotifyClose();
   void set_is_reply(bool reply) override;
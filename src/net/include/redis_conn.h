@@ -6,7 +6,9 @@
 #ifndef NET_INCLUDE_REDIS_CONN_H_
 #define NET_INCLUDE_REDIS_CONN_H_
 
+#include <deque>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -30,12 +32,21 @@ class RedisConn : public NetConn {
   ReadStatus GetRequest() override;
   WriteStatus SendReply() override;
   int WriteResp(const std::string& resp) override;
+  // Queue a reply without copying it when it is large, the buffer is
+  // referenced until the socket took all of it
+  int WriteResp(std::shared_ptr<std::string> resp);
+  // Close the connection once more than max_bytes of replies are waiting
+  // for a slow reader, 0 means no limit
+  void SetMaxReplyBytes(size_t max_bytes) { max_reply_bytes_ = max_bytes; }
+  // bytes of replies queued and not yet taken by the socket
+  size_t PendingReplyBytes() const { return reply_bytes_; }
 
   void TryResizeBuffer() override;
   void SetHandleType(const HandleType& handle_type);
   HandleType GetHandleType();
 
-  virtual void ProcessRedisCmds(const std::vector<RedisCmdArgsType>& argvs, bool async, std::string* response);
+  // argvs are owned by the callee, move them to keep them beyond the call
+  virtual void ProcessRedisCmds(std::vector<RedisCmdArgsType>&& argvs, bool async, std::string* response);
   void NotifyEpoll(bool success);
 
   virtual int DealMessage(const RedisCmdArgsType& argv, std::string* response) = 0;
@@ -43,8 +54,10 @@ class RedisConn : public NetConn {
 
  private:
   static int ParserDealMessageCb(RedisParser* parser, const RedisCmdArgsType& argv);
-  static int ParserCompleteCb(RedisParser* parser, const std::vector<RedisCmdArgsType>& argvs);
+  static int ParserCompleteCb(RedisParser* parser, std::vector<RedisCmdArgsType>& argvs);
   ReadStatus ParseRedisParserStatus(RedisParserStatus status);
+  void AppendReply(const char* data, size_t len);
+  void RecycleChunk(std::shared_ptr<std::string> buf);
 
   HandleType handle_type_ = kSynchronous;
 
@@ -54,9 +67,20 @@ class RedisConn : public NetConn {
   int msg_peak_ = 0;
   int command_len_ = 0;
 
-  uint32_t wbuf_pos_ = 0;
+  // filled by synchronous handlers, moved to reply_queue_ in SendReply
   std::string response_;
 
+  // replies waiting for the socket, flushed with writev
+  std::deque<std::shared_ptr<std::string>> reply_queue_;
+  // bytes of reply_queue_.front() already written
+  size_t reply_pos_ = 0;
+  size_t reply_bytes_ = 0;
+  size_t max_reply_bytes_ = 0;
+  // reply_queue_.back() is a buffer of this conn which small replies are appended to
+  bool reply_tail_writable_ = false;
+  // a written chunk kept for the next small replies, dropped when the conn is idle
+  std::shared_ptr<std::string> spare_chunk_;
+
   // For Redis Protocol parser
   int last_read_pos_ = -1;
   RedisParser redis_parser_;
@@ -19,7 +19,8 @@ class RedisParser;
 
 using RedisCmdArgsType = std::vector<std::string>;
 using RedisParserDataCb = int (*)(RedisParser *, const RedisCmdArgsType &);
-using RedisParserMultiDataCb = int (*)(RedisParser *, const std::vector<RedisCmdArgsType> &);
+// the callee may take the parsed arguments by moving them out
+using RedisParserMultiDataCb = int (*)(RedisParser *, std::vector<RedisCmdArgsType> &);
 using RedisParserCb = int (*)(RedisParser *);
 using RedisParserType = int;
 
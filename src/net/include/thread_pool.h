@@ -8,8 +8,10 @@
 
 #include <pthread.h>
 #include <atomic>
+#include <memory>
 #include <queue>
 #include <string>
+#include <vector>
 
 #include "net/include/net_define.h"
 #include "pstd/include/pstd_mutex.h"
@@ -33,11 +35,23 @@ struct TimeTask {
   bool operator<(const TimeTask& task) const { return exec_time > task.exec_time; }
 };
 
+class TaskInjectionQueue;
+class TaskDeque;
+
+/*
+ * By default all workers share one mutex protected queue.
+ *
+ * With work_stealing, every worker owns a bounded lock-free deque and
+ * external producers push to a lock-free injection queue. An idle worker
+ * drains its own deque, then grabs a batch from the injection queue, then
+ * steals from its peers, and spins a little before parking on rsignal_.
+ * Tasks scheduled from a worker go to its own deque.
+ */
 class ThreadPool : public pstd::noncopyable {
  public:
   class Worker {
    public:
-    explicit Worker(ThreadPool* tp) : start_(false), thread_pool_(tp){};
+    explicit Worker(ThreadPool* tp, size_t index = 0) : start_(false), thread_pool_(tp), index_(index){};
     static void* WorkerMain(void* arg);
 
     int start();
@@ -47,10 +61,12 @@ class ThreadPool : public pstd::noncopyable {
     pthread_t thread_id_;
     std::atomic<bool> start_;
     ThreadPool* const thread_pool_;
+    const size_t index_;
     std::string worker_name_;
   };
 
-  explicit ThreadPool(size_t worker_num, size_t max_queue_size, std::string  thread_pool_name = "ThreadPool");
+  explicit ThreadPool(size_t worker_num, size_t max_queue_size, std::string  thread_pool_name = "ThreadPool",
+                      bool work_stealing = false);
   virtual ~ThreadPool();
 
   int start_thread_pool();
@@ -65,9 +81,16 @@ class ThreadPool : public pstd::noncopyable {
   void cur_queue_size(size_t* qsize);
   void cur_time_queue_size(size_t* qsize);
   std::string thread_pool_name();
+  bool work_stealing() const { return work_stealing_; }
 
  private:
   void runInThread();
+  void runInThreadWorkStealing(size_t index);
+  void ScheduleWorkStealing(TaskFunc func, void* arg);
+  bool TakeTask(size_t index, Task* task);
+  bool RunDueTimeTask();
+  void Park();
+  void NotifyProducers();
 
   size_t worker_num_;
   size_t max_queue_size_;
@@ -82,6 +105,16 @@ class ThreadPool : public pstd::noncopyable {
   pstd::CondVar rsignal_;
   pstd::CondVar wsignal_;
 
+  // work-stealing mode only
+  bool work_stealing_;
+  std::unique_ptr<TaskInjectionQueue> inject_queue_;
+  std::vector<std::unique_ptr<TaskDeque>> local_queues_;
+  // tasks scheduled but not taken by a worker yet
+  std::atomic<size_t> queue_size_{0};
+  std::atomic<size_t> parked_workers_{0};
+  std::atomic<size_t> waiting_producers_{0};
+  // exec time of time_queue_.top(), UINT64_MAX if empty, guarded by mu_ for writes
+  std::atomic<uint64_t> next_time_task_{UINT64_MAX};
 };
 
 }  // namespace net
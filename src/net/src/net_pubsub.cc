@@ -11,6 +11,7 @@
 
 #include "net/include/net_conn.h"
 #include "net/include/net_pubsub.h"
+#include "net/include/redis_conn.h"
 
 namespace net {
 
@@ -41,6 +42,16 @@ static std::string ConstructPublishResp(const std::string& subscribe_channel, co
   return resp.str();
 }
 
+// The reply of a large message is referenced by every subscriber
+// instead of copied into each reply buffer
+static void WritePublishResp(const std::shared_ptr<NetConn>& conn, const std::shared_ptr<std::string>& resp) {
+  if (auto redis_conn = std::dynamic_pointer_cast<RedisConn>(conn); redis_conn) {
+    redis_conn->WriteResp(resp);
+  } else {
+    conn->WriteResp(*resp);
+  }
+}
+
 void CloseFd(const std::shared_ptr<NetConn>& conn) { close(conn->fd()); }
 
 void PubSubThread::ConnHandle::UpdateReadyState(const ReadyState& state) { ready_state = state; }
@@ -60,7 +71,25 @@ PubSubThread::PubSubThread() {
   net_multiplexer_->NetAddEvent(msg_pfd_[0], kReadable);
 }
 
-PubSubThread::~PubSubThread() { StopThread(); }
+PubSubThread::~PubSubThread() {
+  StopThread();
+  while (PubMessage* message = PopPubMessage()) {
+    delete message;
+  }
+}
+
+int PubSubThread::StopThread() {
+  set_should_stop();
+  {
+    // a publisher checks should_stop() under the lock before it waits
+    std::lock_guard lock(pub_mutex_);
+  }
+  pub_cond_.notify_all();
+  // wake NetPoll instead of waiting out NET_CRON_INTERVAL
+  ssize_t n = write(msg_pfd_[1], "", 1);
+  (void)(n);
+  return Thread::StopThread();
+}
 
 void PubSubThread::MoveConnOut(const std::shared_ptr<NetConn>& conn) {
   RemoveConn(conn);
@@ -101,54 +130,14 @@ bool PubSubThread::IsReady(int fd) {
 }
 
 int PubSubThread::ClientPubSubChannelSize(const std::shared_ptr<NetConn>& conn) {
-  int subscribed = 0;
-  std::lock_guard l(channel_mutex_);
-  for (auto& channel : pubsub_channel_) {
-    auto conn_ptr = std::find(channel.second.begin(), channel.second.end(), conn);
-    if (conn_ptr != channel.second.end()) {
-      subscribed++;
-    }
-  }
-  return subscribed;
+  return registry_.ConnSubscriptionNum(conn, false);
 }
 
 int PubSubThread::ClientPubSubChannelPatternSize(const std::shared_ptr<NetConn>& conn) {
-  int subscribed = 0;
-  std::lock_guard l(pattern_mutex_);
-  for (auto& channel : pubsub_pattern_) {
-    auto conn_ptr = std::find(channel.second.begin(), channel.second.end(), conn);
-    if (conn_ptr != channel.second.end()) {
-      subscribed++;
-    }
-  }
-  return subscribed;
+  return registry_.ConnSubscriptionNum(conn, true);
 }
 
-void PubSubThread::RemoveConn(const std::shared_ptr<NetConn>& conn) {
-  {
-    std::lock_guard lock(pattern_mutex_);
-    for (auto& it : pubsub_pattern_) {
-      for (auto conn_ptr = it.second.begin(); conn_ptr != it.second.end(); conn_ptr++) {
-        if ((*conn_ptr) == conn) {
-          conn_ptr = it.second.erase(conn_ptr);
-          break;
-        }
-      }
-    }
-  }
-
-  {
-    std::lock_guard lock(channel_mutex_);
-    for (auto& it : pubsub_channel_) {
-      for (auto conn_ptr = it.second.begin(); conn_ptr != it.second.end(); conn_ptr++) {
-        if ((*conn_ptr) == conn) {
-          conn_ptr = it.second.erase(conn_ptr);
-          break;
-        }
-      }
-    }
-  }
-}
+void PubSubThread::RemoveConn(const std::shared_ptr<NetConn>& conn) { registry_.RemoveConn(conn); }
 
 void PubSubThread::CloseConn(const std::shared_ptr<NetConn>& conn) {
   net_multiplexer_->NetDelEvent(conn->fd(), 0);
@@ -160,14 +149,7 @@ void PubSubThread::CloseConn(const std::shared_ptr<NetConn>& conn) {
 }
 
 void PubSubThread::CloseAllConns() {
-  {
-    std::lock_guard l(channel_mutex_);
-    pubsub_channel_.clear();
-  }
-  {
-    std::lock_guard l(pattern_mutex_);
-    pubsub_pattern_.clear();
-  }
+  registry_.Clear();
   {
     std::lock_guard l(rwlock_);
     for (auto& pair : conns_) {
@@ -180,47 +162,119 @@ void PubSubThread::CloseAllConns() {
 }
 
 int PubSubThread::Publish(const std::string& channel, const std::string& msg) {
-  // TODO(LIBA-S): change the Publish Mode to Asynchronous
-  std::lock_guard lk(pub_mutex_);
-  channel_ = channel;
-  message_ = msg;
-  // Send signal to ThreadMain()
-  ssize_t n = write(msg_pfd_[1], "", 1);
-  (void)(n);
-  std::unique_lock lock(receiver_mutex_);
-  receiver_rsignal_.wait(lock, [this]() { return receivers_ != -1; });
-
-  int receivers = receivers_;
-  receivers_ = -1;
+  int receivers = registry_.CountReceivers(channel);
+  if (receivers == 0) {
+    return 0;
+  }
 
+  if (pub_pending_.load() >= kPubSubMaxPendingMessages) {
+    std::unique_lock lock(pub_mutex_);
+    pub_waiters_++;
+    pub_cond_.wait(lock, [this]() { return pub_pending_.load() < kPubSubMaxPendingMessages || should_stop(); });
+    pub_waiters_--;
+  }
+  // concurrent publishers may pass the check together, the bound is soft
+  pub_pending_++;
+  PushPubMessage(new PubMessage(channel, msg));
+  // ThreadMain() drains every message linked in before it cleared the
+  // flag, only the first message of a batch needs to send a signal
+  if (!pub_signaled_.exchange(true)) {
+    // Send signal to ThreadMain()
+    ssize_t n = write(msg_pfd_[1], "", 1);
+    (void)(n);
+  }
   return receivers;
 }
 
-/*
- * return the number of channels that the specific connection currently subscribed
- */
-int PubSubThread::ClientChannelSize(const std::shared_ptr<NetConn>& conn) {
-  int subscribed = 0;
+void PubSubThread::PushPubMessage(PubMessage* message) {
+  message->next.store(nullptr, std::memory_order_relaxed);
+  PubMessage* prev = pub_head_.exchange(message, std::memory_order_acq_rel);
+  prev->next.store(message, std::memory_order_release);
+}
 
-  channel_mutex_.lock();
-  for (auto& channel : pubsub_channel_) {
-    auto conn_ptr = std::find(channel.second.begin(), channel.second.end(), conn);
-    if (conn_ptr != channel.second.end()) {
-      subscribed++;
+PubSubThread::PubMessage* PubSubThread::PopPubMessage() {
+  PubMessage* tail = pub_tail_;
+  PubMessage* next = tail->next.load(std::memory_order_acquire);
+  if (tail == &pub_stub_) {
+    if (next == nullptr) {
+      return nullptr;
     }
+    pub_tail_ = next;
+    tail = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+  if (next != nullptr) {
+    pub_tail_ = next;
+    return tail;
   }
-  channel_mutex_.unlock();
+  if (tail != pub_head_.load(std::memory_order_acquire)) {
+    // a publisher swapped the head but has not linked its node yet, it
+    // signals again once it has
+    return nullptr;
+  }
+  // tail is the last node, put the stub behind it so tail can be handed out
+  PushPubMessage(&pub_stub_);
+  next = tail->next.load(std::memory_order_acquire);
+  if (next != nullptr) {
+    pub_tail_ = next;
+    return tail;
+  }
+  return nullptr;
+}
 
-  pattern_mutex_.lock();
-  for (auto& channel : pubsub_pattern_) {
-    auto conn_ptr = std::find(channel.second.begin(), channel.second.end(), conn);
-    if (conn_ptr != channel.second.end()) {
-      subscribed++;
+void PubSubThread::DeliverMessages() {
+  // a publish that comes after this exchange signals again, one before it
+  // linked its message in before setting the flag
+  pub_signaled_.exchange(false);
+  std::vector<std::unique_ptr<PubMessage>> messages;
+  while (PubMessage* message = PopPubMessage()) {
+    messages.emplace_back(message);
+  }
+  if (messages.empty()) {
+    return;
+  }
+  pub_pending_ -= messages.size();
+  if (pub_waiters_.load() > 0) {
+    {
+      // a waiter counted itself under the lock before checking pub_pending_
+      std::lock_guard lock(pub_mutex_);
     }
+    pub_cond_.notify_all();
   }
-  pattern_mutex_.unlock();
 
-  return subscribed;
+  // Append the whole batch to the reply buffers first,
+  // every receiver is then sent its share with one SendReply
+  std::map<int, std::shared_ptr<NetConn>> receivers;
+  for (const auto& message : messages) {
+    registry_.ForEachReceiver(message->channel, [&](const std::string& name, const PubSubRegistry::ConnSet& conns,
+                                                    bool pattern) {
+      auto resp = std::make_shared<std::string>(ConstructPublishResp(name, message->channel, message->msg, pattern));
+      for (const auto& conn : conns) {
+        if (IsReady(conn->fd())) {
+          WritePublishResp(conn, resp);
+          receivers.emplace(conn->fd(), conn);
+        }
+      }
+    });
+  }
+
+  for (const auto& receiver : receivers) {
+    const std::shared_ptr<NetConn>& conn = receiver.second;
+    WriteStatus write_status = conn->SendReply();
+    if (write_status == kWriteHalf) {
+      net_multiplexer_->NetModEvent(conn->fd(), kReadable, kWritable);
+    } else if (write_status == kWriteError) {
+      MoveConnOut(conn);
+      CloseFd(conn);
+    }
+  }
+}
+
+/*
+ * return the number of channels that the specific connection currently subscribed
+ */
+int PubSubThread::ClientChannelSize(const std::shared_ptr<NetConn>& conn) {
+  return registry_.ConnSubscriptionNum(conn, false) + registry_.ConnSubscriptionNum(conn, true);
 }
 
 void PubSubThread::Subscribe(const std::shared_ptr<NetConn>& conn, const std::vector<std::string>& channels,
@@ -232,35 +286,10 @@ void PubSubThread::Subscribe(const std::shared_ptr<NetConn>& conn, const std::ve
   }
 
   for (const auto& channel : channels) {
-    if (pattern) {  // if pattern mode, register channel to map
-      std::lock_guard channel_lock(pattern_mutex_);
-      if (pubsub_pattern_.find(channel) != pubsub_pattern_.end()) {
-        auto conn_ptr = std::find(pubsub_pattern_[channel].begin(), pubsub_pattern_[channel].end(), conn);
-        if (conn_ptr == pubsub_pattern_[channel].end()) {  // the connection first subscrbied
-          pubsub_pattern_[channel].push_back(conn);
-          ++subscribed;
-        }
-      } else {  // the channel first subscribed
-        std::vector<std::shared_ptr<NetConn>> conns = {conn};
-        pubsub_pattern_[channel] = conns;
-        ++subscribed;
-      }
-      result->emplace_back(channel, subscribed);
-    } else {  // if general mode, reigster channel to map
-      std::lock_guard channel_lock(channel_mutex_);
-      if (pubsub_channel_.find(channel) != pubsub_channel_.end()) {
-        auto conn_ptr = std::find(pubsub_channel_[channel].begin(), pubsub_channel_[channel].end(), conn);
-        if (conn_ptr == pubsub_channel_[channel].end()) {  // the connection first subscribed
-          pubsub_channel_[channel].push_back(conn);
-          ++subscribed;
-        }
-      } else {  // the channel first subscribed
-        std::vector<std::shared_ptr<NetConn>> conns = {conn};
-        pubsub_channel_[channel] = conns;
-        ++subscribed;
-      }
-      result->emplace_back(channel, subscribed);
+    if (registry_.Subscribe(conn, channel, pattern)) {  // the connection first subscribed
+      ++subscribed;
     }
+    result->emplace_back(channel, subscribed);
   }
 }
 
@@ -276,22 +305,8 @@ int PubSubThread::UnSubscribe(const std::shared_ptr<NetConn>& conn, const std::v
     exist = false;
   }
   if (channels.empty()) {  // if client want to unsubscribe all of channels
-    if (pattern) {         // all of pattern channels
-      std::lock_guard l(pattern_mutex_);
-      for (auto& channel : pubsub_pattern_) {
-        auto conn_ptr = std::find(channel.second.begin(), channel.second.end(), conn);
-        if (conn_ptr != channel.second.end()) {
-          result->emplace_back(channel.first, --subscribed);
-        }
-      }
-    } else {
-      std::lock_guard l(channel_mutex_);
-      for (auto& channel : pubsub_channel_) {
-        auto conn_ptr = std::find(channel.second.begin(), channel.second.end(), conn);
-        if (conn_ptr != channel.second.end()) {
-          result->emplace_back(channel.first, --subscribed);
-        }
-      }
+    for (const auto& channel : registry_.ConnSubscriptions(conn, pattern)) {
+      result->emplace_back(channel, --subscribed);
     }
     if (exist) {
       MoveConnOut(conn);
@@ -300,37 +315,10 @@ int PubSubThread::UnSubscribe(const std::shared_ptr<NetConn>& conn, const std::v
   }
 
   for (const auto& channel : channels) {
-    if (pattern) {  // if pattern mode, unsubscribe the channels of specified
-      std::lock_guard l(pattern_mutex_);
-      auto channel_ptr = pubsub_pattern_.find(channel);
-      if (channel_ptr != pubsub_pattern_.end()) {
-        auto it = std::find(channel_ptr->second.begin(), channel_ptr->second.end(), conn);
-        if (it != channel_ptr->second.end()) {
-          channel_ptr->second.erase(std::remove(channel_ptr->second.begin(), channel_ptr->second.end(), conn),
-                                    channel_ptr->second.end());
-          result->emplace_back(channel, --subscribed);
-        } else {
-          result->emplace_back(channel, subscribed);
-        }
-      } else {
-        result->emplace_back(channel, 0);
-      }
-    } else {  // if general mode, unsubscribe the channels of specified
-      std::lock_guard l(channel_mutex_);
-      auto channel_ptr = pubsub_channel_.find(channel);
-      if (channel_ptr != pubsub_channel_.end()) {
-        auto it = std::find(channel_ptr->second.begin(), channel_ptr->second.end(), conn);
-        if (it != channel_ptr->second.end()) {
-          channel_ptr->second.erase(std::remove(channel_ptr->second.begin(), channel_ptr->second.end(), conn),
-                                    channel_ptr->second.end());
-          result->emplace_back(channel, --subscribed);
-        } else {
-          result->emplace_back(channel, subscribed);
-        }
-      } else {
-        result->emplace_back(channel, 0);
-      }
+    if (registry_.UnSubscribe(conn, channel, pattern)) {
+      --subscribed;
     }
+    result->emplace_back(channel, subscribed);
   }
   // The number of channels this client currently subscibred
   // include general mode and pattern mode
@@ -342,87 +330,48 @@ int PubSubThread::UnSubscribe(const std::shared_ptr<NetConn>& conn, const std::v
 }
 
 void PubSubThread::PubSubChannels(const std::string& pattern, std::vector<std::string>* result) {
-  if (pattern.empty()) {
-    std::lock_guard l(channel_mutex_);
-    for (auto& channel : pubsub_channel_) {
-      if (!channel.second.empty()) {
-        result->push_back(channel.first);
-      }
-    }
-  } else {
-    std::lock_guard l(channel_mutex_);
-    for (auto& channel : pubsub_channel_) {
-      if (pstd::stringmatchlen(channel.first.c_str(), static_cast<int32_t>(channel.first.size()), pattern.c_str(),
-                               static_cast<int32_t>(pattern.size()), 0)) {
-        if (!channel.second.empty()) {
-          result->push_back(channel.first);
-        }
-      }
-    }
-  }
+  registry_.Channels(pattern, result);
 }
 
 void PubSubThread::PubSubNumSub(const std::vector<std::string>& channels,
                                 std::vector<std::pair<std::string, int>>* result) {
-  int subscribed;
-  std::lock_guard l(channel_mutex_);
-  for (const auto& i : channels) {
-    subscribed = 0;
-    for (auto& channel : pubsub_channel_) {
-      if (channel.first == i) {
-        subscribed = static_cast<int32_t>(channel.second.size());
-      }
-    }
-    result->emplace_back(i, subscribed);
+  for (const auto& channel : channels) {
+    result->emplace_back(channel, registry_.NumSub(channel));
   }
 }
 
-int PubSubThread::PubSubNumPat() {
-  int subscribed = 0;
-  std::lock_guard l(pattern_mutex_);
-  for (auto& channel : pubsub_pattern_) {
-    subscribed += static_cast<int32_t>(channel.second.size());
-  }
-  return subscribed;
-}
+int PubSubThread::PubSubNumPat() { return registry_.NumPat(); }
 
 void PubSubThread::ConnCanSubscribe(const std::vector<std::string>& allChannel,
                                     const std::function<bool(const std::shared_ptr<NetConn>&)>& func) {
-  {
-    std::lock_guard l(channel_mutex_);
-    for (auto& item : pubsub_channel_) {
-      for (auto it = item.second.rbegin(); it != item.second.rend(); it++) {
-        if (func(*it) && (allChannel.empty() || !std::count(allChannel.begin(), allChannel.end(), item.first))) {
-          item.second.erase(std::next(it).base());
-          CloseConn(*it);
-        }
-      }  // for end
+  for (const auto& conn : registry_.Conns()) {
+    if (!func(conn)) {
+      continue;
     }
-  }
-
-  {
-    std::lock_guard l(pattern_mutex_);
-    for (auto& item : pubsub_pattern_) {
-      for (auto it = item.second.rbegin(); it != item.second.rend(); it++) {
-        bool kill = false;
-        if (func(*it)) {
-          if (allChannel.empty()) {
-            kill = true;
-          }
-          for (const auto& channelName : allChannel) {
-            if (kill || !pstd::stringmatchlen(channelName.c_str(), static_cast<int32_t>(channelName.size()),
-                                              item.first.c_str(), static_cast<int32_t>(item.first.size()), 0)) {
-              kill = true;
-              break;
-            }
-          }
-        }
-        if (kill) {
-          item.second.erase(std::next(it).base());
-          CloseConn(*it);
+    bool kill = false;
+    for (const auto& channel : registry_.ConnSubscriptions(conn, false)) {
+      if (allChannel.empty() || !std::count(allChannel.begin(), allChannel.end(), channel)) {
+        kill = true;
+        break;
+      }
+    }
+    for (const auto& pattern : registry_.ConnSubscriptions(conn, true)) {
+      if (kill || allChannel.empty()) {
+        kill = true;
+        break;
+      }
+      for (const auto& channelName : allChannel) {
+        if (!pstd::stringmatchlen(channelName.c_str(), static_cast<int32_t>(channelName.size()), pattern.c_str(),
+                                  static_cast<int32_t>(pattern.size()), 0)) {
+          kill = true;
+          break;
         }
       }
     }
+    if (kill) {
+      RemoveConn(conn);
+      CloseConn(conn);
+    }
   }
 }
 
@@ -468,76 +417,7 @@ void* PubSubThread::ThreadMain() {
         if (pfe->mask & kReadable) {
           ssize_t n = read(msg_pfd_[0], triger, 1);
           (void)(n);
-          std::string channel;
-          std::string msg;
-          int32_t receivers = 0;
-          channel = channel_;
-          msg = message_;
-          channel_.clear();
-          message_.clear();
-
-          // Send message to a channel's clients
-          channel_mutex_.lock();
-          auto it = pubsub_channel_.find(channel);
-          if (it != pubsub_channel_.end()) {
-            for (size_t i = 0; i < it->second.size(); i++) {
-              auto& conn = it->second[i];
-              if (!IsReady(conn->fd())) {
-                continue;
-              }
-              std::string resp = ConstructPublishResp(it->first, channel, msg, false);
-              conn->WriteResp(resp);
-              WriteStatus write_status = conn->SendReply();
-              if (write_status == kWriteHalf) {
-                net_multiplexer_->NetModEvent(conn->fd(), kReadable, kWritable);
-              } else if (write_status == kWriteError) {
-                channel_mutex_.unlock();
-
-                MoveConnOut(conn);
-
-                channel_mutex_.lock();
-                CloseFd(conn);
-              } else if (write_status == kWriteAll) {
-                receivers++;
-              }
-            }
-          }
-          channel_mutex_.unlock();
-
-          // Send message to a channel pattern's clients
-          pattern_mutex_.lock();
-          for (auto& it : pubsub_pattern_) {
-            if (pstd::stringmatchlen(it.first.c_str(), static_cast<int32_t>(it.first.size()), channel.c_str(),
-                                     static_cast<int32_t>(channel.size()), 0)) {
-              for (size_t i = 0; i < it.second.size(); i++) {
-                auto& conn = it.second[i];
-                if (!IsReady(conn->fd())) {
-                  continue;
-                }
-                std::string resp = ConstructPublishResp(it.first, channel, msg, true);
-                conn->WriteResp(resp);
-                WriteStatus write_status = conn->SendReply();
-                if (write_status == kWriteHalf) {
-                  net_multiplexer_->NetModEvent(conn->fd(), kReadable, kWritable);
-                } else if (write_status == kWriteError) {
-                  pattern_mutex_.unlock();
-
-                  MoveConnOut(conn);
-
-                  pattern_mutex_.lock();
-                  CloseFd(conn);
-                } else if (write_status == kWriteAll) {
-                  receivers++;
-                }
-              }
-            }
-          }
-          pattern_mutex_.unlock();
-
-          receiver_mutex_.lock();
-          receivers_ = receivers;
-          receiver_rsignal_.notify_one();
-          receiver_mutex_.unlock();
+          DeliverMessages();
         } else {
           continue;
         }
@@ -27,6 +27,10 @@ size_t NetworkStatistic::NetReplOutputBytes() {
   return stat_net_repl_output_bytes.load(std::memory_order_relaxed);
 }
 
+size_t NetworkStatistic::NetReplSavedBytes() {
+  return stat_net_repl_saved_bytes.load(std::memory_order_relaxed);
+}
+
 void NetworkStatistic::IncrRedisInputBytes(uint64_t bytes) {
   stat_net_input_bytes.fetch_add(bytes, std::memory_order_relaxed);
 }
@@ -43,4 +47,8 @@ void NetworkStatistic::IncrReplOutputBytes(uint64_t bytes) {
   stat_net_repl_output_bytes.fetch_add(bytes, std::memory_order_relaxed);
 }
 
+void NetworkStatistic::IncrReplSavedBytes(uint64_t bytes) {
+  stat_net_repl_saved_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
 }
\ No newline at end of file
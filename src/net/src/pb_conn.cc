@@ -6,6 +6,11 @@
 #include "net/include/pb_conn.h"
 
 #include <arpa/inet.h>
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+#include <unistd.h>
+#include <algorithm>
 #include <string>
 
 #include <glog/logging.h>
@@ -27,7 +32,15 @@ PbConn::PbConn(const int fd, const std::string& ip_port, Thread* thread, NetMult
   rbuf_len_ = PB_IOBUF_LEN;
 }
 
-PbConn::~PbConn() { free(rbuf_); }
+PbConn::~PbConn() {
+  free(rbuf_);
+  while (!write_buf_.queue_.empty()) {
+    if (write_buf_.queue_.front().file_fd >= 0) {
+      close(write_buf_.queue_.front().file_fd);
+    }
+    write_buf_.queue_.pop();
+  }
+}
 
 // Msg is [ length(COMMAND_HEADER_LENGTH) | body(length bytes) ]
 //   step 1. kHeader, we read COMMAND_HEADER_LENGTH bytes;
@@ -113,24 +126,55 @@ ReadStatus PbConn::GetRequest() {
   return kReadHalf;
 }
 
+// Writes the part of a file region at file_pos to fd, with sendfile(2) where
+// the platform has it
+static ssize_t SendFileRegion(int fd, const PbConn::WriteItem& item, size_t file_pos) {
+  size_t len = item.file_len - file_pos;
+#if defined(__linux__)
+  off_t offset = item.file_offset + static_cast<off_t>(file_pos);
+  ssize_t nwritten = sendfile(fd, item.file_fd, &offset, len);
+#else
+  char buf[64 * 1024];
+  ssize_t nwritten = pread(item.file_fd, buf, std::min(len, sizeof(buf)), item.file_offset + file_pos);
+  if (nwritten > 0) {
+    nwritten = write(fd, buf, nwritten);
+  }
+#endif
+  if (nwritten == 0) {
+    // the file got truncated under us, the message can not be completed
+    errno = EIO;
+    return -1;
+  }
+  return nwritten;
+}
+
 WriteStatus PbConn::SendReply() {
   ssize_t nwritten = 0;
   size_t item_len;
   std::lock_guard l(resp_mu_);
   while (!write_buf_.queue_.empty()) {
-    std::string item = write_buf_.queue_.front();
-    item_len = item.size();
+    const WriteItem& item = write_buf_.queue_.front();
+    size_t data_len = item.data.size();
+    item_len = data_len + item.file_len;
     while (item_len - write_buf_.item_pos_ > 0) {
-      nwritten = write(fd(), item.data() + write_buf_.item_pos_, item_len - write_buf_.item_pos_);
+      if (write_buf_.item_pos_ < data_len) {
+        nwritten = write(fd(), item.data.data() + write_buf_.item_pos_, data_len - write_buf_.item_pos_);
+      } else {
+        nwritten = SendFileRegion(fd(), item, write_buf_.item_pos_ - data_len);
+      }
       if (nwritten <= 0) {
         break;
       }
       g_network_statistic->IncrReplOutputBytes(nwritten);
       write_buf_.item_pos_ += nwritten;
       if (write_buf_.item_pos_ == item_len) {
+        if (item.file_fd >= 0) {
+          close(item.file_fd);
+        }
         write_buf_.queue_.pop();
         write_buf_.item_pos_ = 0;
         item_len = 0;
+        break;
       }
     }
     if (nwritten == -1) {
@@ -175,6 +219,18 @@ int PbConn::WriteResp(const std::string& resp) {
   return 0;
 }
 
+int PbConn::WriteResp(const std::string& resp, int file_fd, off_t file_offset, size_t file_len) {
+  uint32_t resp_size = htonl(static_cast<uint32_t>(resp.size() + file_len));
+  WriteItem item(std::string(reinterpret_cast<char*>(&resp_size), sizeof(resp_size)) + resp);
+  item.file_fd = file_fd;
+  item.file_offset = file_offset;
+  item.file_len = file_len;
+  std::lock_guard l(resp_mu_);
+  write_buf_.queue_.push(std::move(item));
+  set_is_reply(true);
+  return 0;
+}
+
 void PbConn::BuildInternalTag(const std::string& resp, std::string* tag) {
   uint32_t resp_size = resp.size();
   resp_size = htonl(resp_size);
@@ -0,0 +1,234 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/src/pubsub_registry.h"
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "pstd/include/pstd_string.h"
+
+namespace net {
+
+bool PubSubRegistry::Subscribe(const std::shared_ptr<NetConn>& conn, const std::string& channel, bool pattern) {
+  ConnShard& shard = GetConnShard(conn);
+  std::lock_guard l(shard.mu);
+  Subscriptions& subscriptions = shard.conns[conn];
+  auto& names = pattern ? subscriptions.patterns : subscriptions.channels;
+  if (!names.insert(channel).second) {
+    return false;
+  }
+  AddReceiver(conn, channel, pattern);
+  return true;
+}
+
+bool PubSubRegistry::UnSubscribe(const std::shared_ptr<NetConn>& conn, const std::string& channel, bool pattern) {
+  ConnShard& shard = GetConnShard(conn);
+  std::lock_guard l(shard.mu);
+  auto it = shard.conns.find(conn);
+  if (it == shard.conns.end()) {
+    return false;
+  }
+  auto& names = pattern ? it->second.patterns : it->second.channels;
+  if (names.erase(channel) == 0) {
+    return false;
+  }
+  RemoveReceiver(conn, channel, pattern);
+  if (it->second.channels.empty() && it->second.patterns.empty()) {
+    shard.conns.erase(it);
+  }
+  return true;
+}
+
+void PubSubRegistry::RemoveConn(const std::shared_ptr<NetConn>& conn) {
+  ConnShard& shard = GetConnShard(conn);
+  std::lock_guard l(shard.mu);
+  auto it = shard.conns.find(conn);
+  if (it == shard.conns.end()) {
+    return;
+  }
+  for (const auto& channel : it->second.channels) {
+    RemoveReceiver(conn, channel, false);
+  }
+  for (const auto& pattern : it->second.patterns) {
+    RemoveReceiver(conn, pattern, true);
+  }
+  shard.conns.erase(it);
+}
+
+void PubSubRegistry::Clear() {
+  for (auto& shard : conn_shards_) {
+    std::lock_guard l(shard.mu);
+    shard.conns.clear();
+  }
+  for (auto& shard : channel_shards_) {
+    std::lock_guard l(shard.mu);
+    shard.channels.clear();
+  }
+  std::lock_guard l(pattern_mu_);
+  pattern_groups_.clear();
+  prefix_lengths_.clear();
+  pattern_subscriptions_ = 0;
+}
+
+std::vector<std::string> PubSubRegistry::ConnSubscriptions(const std::shared_ptr<NetConn>& conn, bool pattern) {
+  std::vector<std::string> result;
+  ConnShard& shard = GetConnShard(conn);
+  std::lock_guard l(shard.mu);
+  auto it = shard.conns.find(conn);
+  if (it != shard.conns.end()) {
+    const auto& names = pattern ? it->second.patterns : it->second.channels;
+    result.assign(names.begin(), names.end());
+  }
+  return result;
+}
+
+int PubSubRegistry::ConnSubscriptionNum(const std::shared_ptr<NetConn>& conn, bool pattern) {
+  ConnShard& shard = GetConnShard(conn);
+  std::lock_guard l(shard.mu);
+  auto it = shard.conns.find(conn);
+  if (it == shard.conns.end()) {
+    return 0;
+  }
+  return static_cast<int>(pattern ? it->second.patterns.size() : it->second.channels.size());
+}
+
+std::vector<std::shared_ptr<NetConn>> PubSubRegistry::Conns() {
+  std::vector<std::shared_ptr<NetConn>> result;
+  for (auto& shard : conn_shards_) {
+    std::lock_guard l(shard.mu);
+    for (const auto& item : shard.conns) {
+      result.push_back(item.first);
+    }
+  }
+  return result;
+}
+
+int PubSubRegistry::CountReceivers(const std::string& channel) {
+  int receivers = 0;
+  ForEachReceiver(channel, [&receivers](const std::string& name, const ConnSet& conns, bool pattern) {
+    receivers += static_cast<int>(conns.size());
+  });
+  return receivers;
+}
+
+void PubSubRegistry::ForEachReceiver(const std::string& channel, const ReceiverFunc& func) {
+  {
+    ChannelShard& shard = GetChannelShard(channel);
+    std::shared_lock l(shard.mu);
+    auto it = shard.channels.find(channel);
+    if (it != shard.channels.end()) {
+      func(it->first, it->second, false);
+    }
+  }
+
+  std::shared_lock l(pattern_mu_);
+  for (const auto& prefix_length : prefix_lengths_) {
+    if (prefix_length.first > channel.size()) {
+      break;
+    }
+    auto group = pattern_groups_.find(channel.substr(0, prefix_length.first));
+    if (group == pattern_groups_.end()) {
+      continue;
+    }
+    for (const auto& pattern : group->second) {
+      if (pstd::stringmatchlen(pattern.first.c_str(), static_cast<int32_t>(pattern.first.size()), channel.c_str(),
+                               static_cast<int32_t>(channel.size()), 0) != 0) {
+        func(pattern.first, pattern.second, true);
+      }
+    }
+  }
+}
+
+void PubSubRegistry::Channels(const std::string& pattern, std::vector<std::string>* result) {
+  for (auto& shard : channel_shards_) {
+    std::shared_lock l(shard.mu);
+    for (const auto& channel : shard.channels) {
+      if (pattern.empty() ||
+          pstd::stringmatchlen(pattern.c_str(), static_cast<int32_t>(pattern.size()), channel.first.c_str(),
+                               static_cast<int32_t>(channel.first.size()), 0) != 0) {
+        result->push_back(channel.first);
+      }
+    }
+  }
+}
+
+int PubSubRegistry::NumSub(const std::string& channel) {
+  ChannelShard& shard = GetChannelShard(channel);
+  std::shared_lock l(shard.mu);
+  auto it = shard.channels.find(channel);
+  return it == shard.channels.end() ? 0 : static_cast<int>(it->second.size());
+}
+
+int PubSubRegistry::NumPat() {
+  std::shared_lock l(pattern_mu_);
+  return pattern_subscriptions_;
+}
+
+std::string PubSubRegistry::LiteralPrefix(const std::string& pattern) {
+  size_t pos = pattern.find_first_of("*?[\\");
+  return pos == std::string::npos ? pattern : pattern.substr(0, pos);
+}
+
+PubSubRegistry::ConnShard& PubSubRegistry::GetConnShard(const std::shared_ptr<NetConn>& conn) {
+  return conn_shards_[std::hash<NetConn*>()(conn.get()) % kPubSubShards];
+}
+
+PubSubRegistry::ChannelShard& PubSubRegistry::GetChannelShard(const std::string& channel) {
+  return channel_shards_[std::hash<std::string>()(channel) % kPubSubShards];
+}
+
+void PubSubRegistry::AddReceiver(const std::shared_ptr<NetConn>& conn, const std::string& channel, bool pattern) {
+  if (!pattern) {
+    ChannelShard& shard = GetChannelShard(channel);
+    std::lock_guard l(shard.mu);
+    shard.channels[channel].insert(conn);
+    return;
+  }
+  std::string prefix = LiteralPrefix(channel);
+  std::lock_guard l(pattern_mu_);
+  auto group = pattern_groups_.find(prefix);
+  if (group == pattern_groups_.end()) {
+    group = pattern_groups_.emplace(prefix, PatternGroup()).first;
+    prefix_lengths_[prefix.size()]++;
+  }
+  group->second[channel].insert(conn);
+  pattern_subscriptions_++;
+}
+
+void PubSubRegistry::RemoveReceiver(const std::shared_ptr<NetConn>& conn, const std::string& channel, bool pattern) {
+  if (!pattern) {
+    ChannelShard& shard = GetChannelShard(channel);
+    std::lock_guard l(shard.mu);
+    auto it = shard.channels.find(channel);
+    if (it != shard.channels.end() && it->second.erase(conn) != 0 && it->second.empty()) {
+      shard.channels.erase(it);
+    }
+    return;
+  }
+  std::string prefix = LiteralPrefix(channel);
+  std::lock_guard l(pattern_mu_);
+  auto group = pattern_groups_.find(prefix);
+  if (group == pattern_groups_.end()) {
+    return;
+  }
+  auto it = group->second.find(channel);
+  if (it == group->second.end() || it->second.erase(conn) == 0) {
+    return;
+  }
+  pattern_subscriptions_--;
+  if (!it->second.empty()) {
+    return;
+  }
+  group->second.erase(it);
+  if (group->second.empty()) {
+    pattern_groups_.erase(group);
+    if (--prefix_lengths_[prefix.size()] == 0) {
+      prefix_lengths_.erase(prefix.size());
+    }
+  }
+}
+
+}  // namespace net
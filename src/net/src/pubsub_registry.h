@@ -0,0 +1,101 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef NET_SRC_PUBSUB_REGISTRY_H_
+#define NET_SRC_PUBSUB_REGISTRY_H_
+
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "pstd/include/pstd_mutex.h"
+
+namespace net {
+
+class NetConn;
+
+/*
+ * The subscriptions of the pubsub thread.
+ *
+ * Channels are spread over kPubSubShards shards by hash, each with its own
+ * lock. Patterns are grouped by their literal prefix, the part before the
+ * first glob character, so a channel is only matched against the patterns
+ * whose prefix it starts with. Every connection also keeps the set of its
+ * own channels and patterns, so the per-connection queries and removing a
+ * connection cost its own subscriptions instead of a walk over all of them.
+ *
+ * Lock order: connection shard, then channel shard or the pattern lock.
+ */
+class PubSubRegistry {
+ public:
+  using ConnSet = std::unordered_set<std::shared_ptr<NetConn>>;
+  // name is the channel or the pattern the conns subscribed to
+  using ReceiverFunc = std::function<void(const std::string& name, const ConnSet& conns, bool pattern)>;
+
+  // Returns false if conn already subscribed to channel
+  bool Subscribe(const std::shared_ptr<NetConn>& conn, const std::string& channel, bool pattern);
+  // Returns false if conn didn't subscribe to channel
+  bool UnSubscribe(const std::shared_ptr<NetConn>& conn, const std::string& channel, bool pattern);
+  // Unsubscribe conn from all its channels and patterns
+  void RemoveConn(const std::shared_ptr<NetConn>& conn);
+  void Clear();
+
+  // The channels or patterns conn subscribed to
+  std::vector<std::string> ConnSubscriptions(const std::shared_ptr<NetConn>& conn, bool pattern);
+  int ConnSubscriptionNum(const std::shared_ptr<NetConn>& conn, bool pattern);
+  std::vector<std::shared_ptr<NetConn>> Conns();
+
+  // Number of subscribers a message published to channel reaches
+  int CountReceivers(const std::string& channel);
+  // Call func for the subscribers of channel and of each pattern matching it,
+  // func runs under the locks and must not change the registry
+  void ForEachReceiver(const std::string& channel, const ReceiverFunc& func);
+
+  // Channels with subscribers matching pattern, all of them if it is empty
+  void Channels(const std::string& pattern, std::vector<std::string>* result);
+  int NumSub(const std::string& channel);
+  int NumPat();
+
+ private:
+  static const size_t kPubSubShards = 64;
+
+  struct Subscriptions {
+    std::unordered_set<std::string> channels;
+    std::unordered_set<std::string> patterns;
+  };
+  struct ConnShard {
+    pstd::Mutex mu;
+    std::unordered_map<std::shared_ptr<NetConn>, Subscriptions> conns;
+  };
+  struct ChannelShard {
+    pstd::RWMutex mu;
+    std::unordered_map<std::string, ConnSet> channels;
+  };
+  // patterns with the same literal prefix
+  using PatternGroup = std::unordered_map<std::string, ConnSet>;
+
+  static std::string LiteralPrefix(const std::string& pattern);
+  ConnShard& GetConnShard(const std::shared_ptr<NetConn>& conn);
+  ChannelShard& GetChannelShard(const std::string& channel);
+  // The caller holds the connection shard of conn
+  void AddReceiver(const std::shared_ptr<NetConn>& conn, const std::string& channel, bool pattern);
+  void RemoveReceiver(const std::shared_ptr<NetConn>& conn, const std::string& channel, bool pattern);
+
+  std::array<ConnShard, kPubSubShards> conn_shards_;
+  std::array<ChannelShard, kPubSubShards> channel_shards_;
+
+  pstd::RWMutex pattern_mu_;
+  std::unordered_map<std::string, PatternGroup> pattern_groups_;  // literal prefix <---> patterns
+  std::map<size_t, int> prefix_lengths_;                          // literal prefix length <---> groups
+  int pattern_subscriptions_ = 0;
+};
+
+}  // namespace net
+#endif  // NET_SRC_PUBSUB_REGISTRY_H_
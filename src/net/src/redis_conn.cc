@@ -5,6 +5,9 @@
 
 #include "net/include/redis_conn.h"
 
+#include <sys/uio.h>
+
+#include <algorithm>
 #include <cstdlib>
 #include <sstream>
 
@@ -18,6 +21,13 @@ extern std::unique_ptr<net::NetworkStatistic> g_network_statistic;
 
 namespace net {
 
+// replies smaller than this are copied into a shared chunk,
+// larger ones are queued by reference
+static constexpr size_t kReplyCopyThreshold = 4 * 1024;
+static constexpr size_t kReplyChunkSize = 16 * 1024;
+// iovecs handed to one writev
+static constexpr int kReplyMaxIovecs = 64;
+
 RedisConn::RedisConn(const int fd, const std::string& ip_port, Thread* thread, NetMultiplexer* net_mpx,
                      const HandleType& handle_type, const int rbuf_max_len)
     : NetConn(fd, ip_port, thread, net_mpx),
@@ -126,45 +136,105 @@ ReadStatus RedisConn::GetRequest() {
 }
 
 WriteStatus RedisConn::SendReply() {
+  if (!response_.empty()) {
+    reply_bytes_ += response_.size();
+    reply_queue_.push_back(std::make_shared<std::string>(std::move(response_)));
+    reply_tail_writable_ = true;
+    response_.clear();
+  }
+
   ssize_t nwritten = 0;
-  size_t wbuf_len = response_.size();
-  while (wbuf_len > 0) {
-    nwritten = write(fd(), response_.data() + wbuf_pos_, wbuf_len - wbuf_pos_);
+  while (!reply_queue_.empty()) {
+    struct iovec iov[kReplyMaxIovecs];
+    int iovcnt = 0;
+    size_t offset = reply_pos_;
+    for (auto iter = reply_queue_.begin(); iter != reply_queue_.end() && iovcnt < kReplyMaxIovecs; ++iter) {
+      iov[iovcnt].iov_base = (*iter)->data() + offset;
+      iov[iovcnt].iov_len = (*iter)->size() - offset;
+      offset = 0;
+      ++iovcnt;
+    }
+    nwritten = writev(fd(), iov, iovcnt);
     if (nwritten <= 0) {
       break;
     }
     g_network_statistic->IncrRedisOutputBytes(nwritten);
-    wbuf_pos_ += nwritten;
-    if (wbuf_pos_ == wbuf_len) {
-      // Have sended all response data
-      if (wbuf_len > DEFAULT_WBUF_SIZE) {
-        std::string buf;
-        buf.reserve(DEFAULT_WBUF_SIZE);
-        response_.swap(buf);
+    reply_bytes_ -= nwritten;
+    auto left = static_cast<size_t>(nwritten);
+    while (left > 0) {
+      size_t front_left = reply_queue_.front()->size() - reply_pos_;
+      if (left < front_left) {
+        reply_pos_ += left;
+        break;
       }
-      response_.clear();
-
-      wbuf_len = 0;
-      wbuf_pos_ = 0;
+      // Have sended all data of this reply
+      left -= front_left;
+      RecycleChunk(std::move(reply_queue_.front()));
+      reply_queue_.pop_front();
+      reply_pos_ = 0;
     }
   }
-  if (nwritten == -1) {
-    if (errno == EAGAIN || errno == EWOULDBLOCK) {
-      return kWriteHalf;
+  if (reply_queue_.empty()) {
+    reply_tail_writable_ = false;
+    return kWriteAll;
+  }
+  if (nwritten == -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+    // Here we should close the connection
+    return kWriteError;
+  }
+  if (max_reply_bytes_ > 0 && reply_bytes_ > max_reply_bytes_) {
+    LOG(WARNING) << "close conn " << ip_port() << ", pending reply bytes " << reply_bytes_ << " exceed "
+                 << max_reply_bytes_;
+    return kWriteError;
+  }
+  return kWriteHalf;
+}
+
+void RedisConn::AppendReply(const char* data, size_t len) {
+  if (!reply_tail_writable_ || reply_queue_.back()->size() + len > kReplyChunkSize) {
+    std::shared_ptr<std::string> chunk;
+    if (spare_chunk_ && len <= kReplyChunkSize) {
+      chunk = std::move(spare_chunk_);
     } else {
-      // Here we should close the connection
-      return kWriteError;
+      chunk = std::make_shared<std::string>();
+      chunk->reserve(std::max(len, kReplyChunkSize));
     }
+    reply_queue_.push_back(std::move(chunk));
+    reply_tail_writable_ = true;
   }
-  if (wbuf_len == 0) {
-    return kWriteAll;
-  } else {
-    return kWriteHalf;
+  reply_queue_.back()->append(data, len);
+  reply_bytes_ += len;
+}
+
+void RedisConn::RecycleChunk(std::shared_ptr<std::string> buf) {
+  // keep a written buffer nobody else references if it is about the size
+  // of a chunk, larger ones are freed
+  if (spare_chunk_ || buf.use_count() != 1 || buf->capacity() < kReplyChunkSize ||
+      buf->capacity() > 2 * kReplyChunkSize) {
+    return;
   }
+  buf->clear();
+  spare_chunk_ = std::move(buf);
 }
 
 int RedisConn::WriteResp(const std::string& resp) {
-  response_.append(resp);
+  if (!resp.empty()) {
+    AppendReply(resp.data(), resp.size());
+  }
+  set_is_reply(true);
+  return 0;
+}
+
+int RedisConn::WriteResp(std::shared_ptr<std::string> resp) {
+  if (resp->size() < kReplyCopyThreshold) {
+    if (!resp->empty()) {
+      AppendReply(resp->data(), resp->size());
+    }
+  } else {
+    reply_bytes_ += resp->size();
+    reply_queue_.push_back(std::move(resp));
+    reply_tail_writable_ = false;
+  }
   set_is_reply(true);
   return 0;
 }
@@ -182,13 +252,16 @@ void RedisConn::TryResizeBuffer() {
     }
     msg_peak_ = 0;
   }
+  if (idletime > 2) {
+    spare_chunk_.reset();
+  }
 }
 
 void RedisConn::SetHandleType(const HandleType& handle_type) { handle_type_ = handle_type; }
 
 HandleType RedisConn::GetHandleType() { return handle_type_; }
 
-void RedisConn::ProcessRedisCmds(const std::vector<RedisCmdArgsType>& argvs, bool async, std::string* response) {}
+void RedisConn::ProcessRedisCmds(std::vector<RedisCmdArgsType>&& argvs, bool async, std::string* response) {}
 
 void RedisConn::NotifyEpoll(bool success) {
   NetItem ti(fd(), ip_port(), success ? kNotiEpolloutAndEpollin : kNotiClose);
@@ -204,10 +277,10 @@ int RedisConn::ParserDealMessageCb(RedisParser* parser, const RedisCmdArgsType&
   }
 }
 
-int RedisConn::ParserCompleteCb(RedisParser* parser, const std::vector<RedisCmdArgsType>& argvs) {
+int RedisConn::ParserCompleteCb(RedisParser* parser, std::vector<RedisCmdArgsType>& argvs) {
   auto conn = reinterpret_cast<RedisConn*>(parser->data);
   bool async = conn->GetHandleType() == HandleType::kAsynchronous;
-  conn->ProcessRedisCmds(argvs, async, &(conn->response_));
+  conn->ProcessRedisCmds(std::move(argvs), async, &(conn->response_));
   return 0;
 }
 
@@ -182,8 +182,14 @@ void RedisParser::SetParserStatus(RedisParserStatus status, RedisParserError err
 }
 
 void RedisParser::CacheHalfArgv() {
-  std::string tmp(input_buf_ + cur_pos_, length_ - cur_pos_);
-  half_argv_ = tmp;
+  if (input_buf_ == input_str_.data()) {
+    // parsing from the previous half, keep its buffer instead of copying
+    // the pending bytes again, cur_pos_ is 0 while a big bulk streams in
+    input_str_.erase(0, cur_pos_);
+    half_argv_.swap(input_str_);
+  } else {
+    half_argv_.assign(input_buf_ + cur_pos_, length_ - cur_pos_);
+  }
   cur_pos_ = length_;
 }
 
@@ -312,11 +318,17 @@ void RedisParser::PrintCurrentStatus() {
 
 RedisParserStatus RedisParser::ProcessInputBuffer(const char* input_buf, int length, int* parsed_len) {
   if (status_code_ == kRedisParserInitDone || status_code_ == kRedisParserHalf || status_code_ == kRedisParserDone) {
-    // TODO(): AZ: avoid copy
-    std::string tmp_str(input_buf, length);
-    input_str_ = half_argv_ + tmp_str;
-    input_buf_ = input_str_.c_str();
-    length_ = static_cast<int32_t>(length + half_argv_.size());
+    if (half_argv_.empty()) {
+      // parse the caller's buffer in place
+      input_buf_ = input_buf;
+      length_ = length;
+    } else {
+      half_argv_.append(input_buf, length);
+      input_str_.swap(half_argv_);
+      half_argv_.clear();
+      input_buf_ = input_str_.data();
+      length_ = static_cast<int32_t>(input_str_.size());
+    }
     if (redis_parser_type_ == REDIS_PARSER_REQUEST) {
       ProcessRequestBuffer();
     } else if (redis_parser_type_ == REDIS_PARSER_RESPONSE) {
@@ -367,13 +379,13 @@ RedisParserStatus RedisParser::ProcessRequestBuffer() {
       return kRedisParserError;
     }
     if (!argv_.empty()) {
-      argvs_.push_back(argv_);
       if (parser_settings_.DealMessage) {
         if (parser_settings_.DealMessage(this, argv_) != 0) {
           SetParserStatus(kRedisParserError, kRedisParserDealError);
           return status_code_;
         }
       }
+      argvs_.push_back(std::move(argv_));
     }
     argv_.clear();
     // Reset
@@ -5,7 +5,9 @@
 
 #include "net/include/thread_pool.h"
 #include "net/src/net_thread_name.h"
+#include "net/src/work_stealing_queue.h"
 
+#include <sched.h>
 #include <sys/time.h>
 
 #include <string>
@@ -13,15 +15,36 @@
 
 namespace net {
 
+// capacity of every worker's own deque in work-stealing mode
+static constexpr size_t kLocalQueueSize = 256;
+// tasks moved from the injection queue to the local deque at once
+static constexpr size_t kInjectBatchSize = 8;
+// rounds of looking for work before an idle worker parks
+static constexpr int kSpinRounds = 64;
+
+// the work-stealing pool and worker index of the current thread
+static thread_local ThreadPool* tls_thread_pool = nullptr;
+static thread_local size_t tls_worker_index = 0;
+
+static uint64_t NowMicros() {
+  auto now = std::chrono::system_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+}
+
 void* ThreadPool::Worker::WorkerMain(void* arg) {
-  auto tp = static_cast<ThreadPool*>(arg);
-  tp->runInThread();
+  auto worker = static_cast<Worker*>(arg);
+  ThreadPool* tp = worker->thread_pool_;
+  if (tp->work_stealing()) {
+    tp->runInThreadWorkStealing(worker->index_);
+  } else {
+    tp->runInThread();
+  }
   return nullptr;
 }
 
 int ThreadPool::Worker::start() {
   if (!start_.load()) {
-    if (pthread_create(&thread_id_, nullptr, &WorkerMain, thread_pool_) != 0) {
+    if (pthread_create(&thread_id_, nullptr, &WorkerMain, this) != 0) {
       return -1;
     } else {
       start_.store(true);
@@ -43,12 +66,22 @@ int ThreadPool::Worker::stop() {
   return 0;
 }
 
-ThreadPool::ThreadPool(size_t worker_num, size_t max_queue_size, std::string  thread_pool_name)
+ThreadPool::ThreadPool(size_t worker_num, size_t max_queue_size, std::string  thread_pool_name,
+                       bool work_stealing)
     : worker_num_(worker_num),
       max_queue_size_(max_queue_size),
       thread_pool_name_(std::move(thread_pool_name)),
       running_(false),
-      should_stop_(false) {}
+      should_stop_(false),
+      work_stealing_(work_stealing) {
+  if (work_stealing_) {
+    // queue_size_ never exceeds max_queue_size_, so the injection queue never overflows
+    inject_queue_ = std::make_unique<TaskInjectionQueue>(max_queue_size_);
+    for (size_t i = 0; i < worker_num_; ++i) {
+      local_queues_.emplace_back(std::make_unique<TaskDeque>(kLocalQueueSize));
+    }
+  }
+}
 
 ThreadPool::~ThreadPool() { stop_thread_pool(); }
 
@@ -56,7 +89,7 @@ int ThreadPool::start_thread_pool() {
   if (!running_.load()) {
     should_stop_.store(false);
     for (size_t i = 0; i < worker_num_; ++i) {
-      workers_.push_back(new Worker(this));
+      workers_.push_back(new Worker(this, i));
       int res = workers_[i]->start();
       if (res != 0) {
         return kCreateThreadError;
@@ -70,9 +103,12 @@ int ThreadPool::start_thread_pool() {
 int ThreadPool::stop_thread_pool() {
   int res = 0;
   if (running_.load()) {
-    should_stop_.store(true);
-    rsignal_.notify_all();
-    wsignal_.notify_all();
+    {
+      std::lock_guard lock(mu_);
+      should_stop_.store(true);
+      rsignal_.notify_all();
+      wsignal_.notify_all();
+    }
     for (const auto worker : workers_) {
       res = worker->stop();
       if (res != 0) {
@@ -92,6 +128,10 @@ bool ThreadPool::should_stop() { return should_stop_.load(); }
 void ThreadPool::set_should_stop() { should_stop_.store(true); }
 
 void ThreadPool::Schedule(TaskFunc func, void* arg) {
+  if (work_stealing_) {
+    ScheduleWorkStealing(func, arg);
+    return;
+  }
   std::unique_lock lock(mu_);
   wsignal_.wait(lock, [this]() { return queue_.size() < max_queue_size_ || should_stop(); });
 
@@ -112,6 +152,7 @@ void ThreadPool::DelaySchedule(uint64_t timeout, TaskFunc func, void* arg) {
   std::lock_guard lock(mu_);
   if (!should_stop()) {
     time_queue_.emplace(exec_time, func, arg);
+    next_time_task_.store(time_queue_.top().exec_time);
     rsignal_.notify_all();
   }
 }
@@ -119,6 +160,10 @@ void ThreadPool::DelaySchedule(uint64_t timeout, TaskFunc func, void* arg) {
 size_t ThreadPool::max_queue_size() { return max_queue_size_; }
 
 void ThreadPool::cur_queue_size(size_t* qsize) {
+  if (work_stealing_) {
+    *qsize = queue_size_.load();
+    return;
+  }
   std::lock_guard lock(mu_);
   *qsize = queue_.size();
 }
@@ -164,4 +209,133 @@ void ThreadPool::runInThread() {
     }
   }
 }
+
+void ThreadPool::ScheduleWorkStealing(TaskFunc func, void* arg) {
+  // reserve a slot first, queue_size_ bounds what sits in all the queues
+  size_t size = queue_size_.load();
+  while (true) {
+    if (should_stop()) {
+      return;
+    }
+    if (size < max_queue_size_) {
+      if (queue_size_.compare_exchange_weak(size, size + 1)) {
+        break;
+      }
+      continue;
+    }
+    std::unique_lock lock(mu_);
+    waiting_producers_.fetch_add(1);
+    wsignal_.wait(lock, [this]() { return queue_size_.load() < max_queue_size_ || should_stop(); });
+    waiting_producers_.fetch_sub(1);
+    size = queue_size_.load();
+  }
+
+  Task task(func, arg);
+  if (tls_thread_pool != this || !local_queues_[tls_worker_index]->Push(task)) {
+    while (!inject_queue_->Push(task)) {
+      sched_yield();
+    }
+  }
+  if (parked_workers_.load() > 0) {
+    std::lock_guard lock(mu_);
+    rsignal_.notify_one();
+  }
+}
+
+bool ThreadPool::TakeTask(size_t index, Task* task) {
+  TaskDeque* local_queue = local_queues_[index].get();
+  if (local_queue->Pop(task)) {
+    return true;
+  }
+  if (inject_queue_->Pop(task)) {
+    Task extra;
+    for (size_t i = 1; i < kInjectBatchSize; ++i) {
+      if (!inject_queue_->Pop(&extra)) {
+        break;
+      }
+      if (!local_queue->Push(extra)) {
+        while (!inject_queue_->Push(extra)) {
+          sched_yield();
+        }
+        break;
+      }
+    }
+    return true;
+  }
+  for (size_t i = 1; i < worker_num_; ++i) {
+    if (local_queues_[(index + i) % worker_num_]->Steal(task)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::RunDueTimeTask() {
+  if (NowMicros() < next_time_task_.load()) {
+    return false;
+  }
+  std::unique_lock lock(mu_);
+  if (time_queue_.empty() || NowMicros() < time_queue_.top().exec_time) {
+    return false;
+  }
+  auto [exec_time, func, arg] = time_queue_.top();
+  time_queue_.pop();
+  next_time_task_.store(time_queue_.empty() ? UINT64_MAX : time_queue_.top().exec_time);
+  lock.unlock();
+  (*func)(arg);
+  return true;
+}
+
+void ThreadPool::NotifyProducers() {
+  if (waiting_producers_.load() > 0) {
+    std::lock_guard lock(mu_);
+    wsignal_.notify_one();
+  }
+}
+
+void ThreadPool::Park() {
+  std::unique_lock lock(mu_);
+  parked_workers_.fetch_add(1);
+  // a producer bumps queue_size_ before it checks parked_workers_,
+  // so either it sees us parked or we see its task here
+  if (queue_size_.load() == 0 && !should_stop()) {
+    if (time_queue_.empty()) {
+      rsignal_.wait(lock);
+    } else {
+      uint64_t unow = NowMicros();
+      uint64_t exec_time = time_queue_.top().exec_time;
+      if (unow < exec_time) {
+        rsignal_.wait_for(lock, std::chrono::microseconds(exec_time - unow));
+      }
+    }
+  }
+  parked_workers_.fetch_sub(1);
+}
+
+void ThreadPool::runInThreadWorkStealing(size_t index) {
+  tls_thread_pool = this;
+  tls_worker_index = index;
+  Task task;
+  int idle_rounds = 0;
+  while (!should_stop()) {
+    if (RunDueTimeTask()) {
+      continue;
+    }
+    if (TakeTask(index, &task)) {
+      idle_rounds = 0;
+      queue_size_.fetch_sub(1);
+      NotifyProducers();
+      (*task.func)(task.arg);
+      continue;
+    }
+    if (++idle_rounds < kSpinRounds) {
+      sched_yield();
+      continue;
+    }
+    idle_rounds = 0;
+    Park();
+  }
+  tls_thread_pool = nullptr;
+}
+
 }  // namespace net
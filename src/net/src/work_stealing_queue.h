@@ -0,0 +1,171 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef NET_SRC_WORK_STEALING_QUEUE_H_
+#define NET_SRC_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "net/include/thread_pool.h"
+#include "pstd/include/noncopyable.h"
+
+namespace net {
+
+static constexpr size_t kCacheLineSize = 64;
+
+inline size_t RoundUpPowerOfTwo(size_t n) {
+  size_t capacity = 1;
+  while (capacity < n) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+/*
+ * Bounded lock-free multi-producer multi-consumer queue, the global
+ * injection queue of a work-stealing ThreadPool (Vyukov's sequence
+ * numbered ring buffer).
+ */
+class TaskInjectionQueue : public pstd::noncopyable {
+ public:
+  explicit TaskInjectionQueue(size_t capacity)
+      : mask_(RoundUpPowerOfTwo(capacity < 2 ? 2 : capacity) - 1), cells_(new Cell[mask_ + 1]) {
+    for (size_t i = 0; i <= mask_; ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns false when the queue is full
+  bool Push(const Task& task) {
+    Cell* cell;
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->task = task;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Returns false when the queue is empty
+  bool Pop(Task* task) {
+    Cell* cell;
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      cell = &cells_[pos & mask_];
+      size_t seq = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    *task = cell->task;
+    cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    Task task;
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_{0};
+};
+
+/*
+ * Bounded Chase-Lev deque owned by one worker of a work-stealing
+ * ThreadPool. Only the owner calls Push and Pop (LIFO end, keeps the
+ * cache warm), any other worker may Steal from the FIFO end.
+ */
+class TaskDeque : public pstd::noncopyable {
+ public:
+  explicit TaskDeque(size_t capacity)
+      : mask_(RoundUpPowerOfTwo(capacity < 2 ? 2 : capacity) - 1), slots_(new Slot[mask_ + 1]) {}
+
+  // Owner only, returns false when the deque is full
+  bool Push(const Task& task) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    if (b - t > static_cast<int64_t>(mask_)) {
+      return false;
+    }
+    Slot& slot = slots_[b & mask_];
+    slot.func.store(task.func, std::memory_order_relaxed);
+    slot.arg.store(task.arg, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Owner only
+  bool Pop(Task* task) {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_seq_cst);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    Slot& slot = slots_[b & mask_];
+    task->func = slot.func.load(std::memory_order_relaxed);
+    task->arg = slot.arg.load(std::memory_order_relaxed);
+    if (t == b) {
+      // the last task, race the thieves for it
+      bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  bool Steal(Task* task) {
+    int64_t t = top_.load(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_seq_cst);
+    if (t >= b) {
+      return false;
+    }
+    Slot& slot = slots_[t & mask_];
+    task->func = slot.func.load(std::memory_order_relaxed);
+    task->arg = slot.arg.load(std::memory_order_relaxed);
+    return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+  }
+
+ private:
+  struct Slot {
+    std::atomic<TaskFunc> func{nullptr};
+    std::atomic<void*> arg{nullptr};
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  alignas(kCacheLineSize) std::atomic<int64_t> top_{0};
+  alignas(kCacheLineSize) std::atomic<int64_t> bottom_{0};
+};
+
+}  // namespace net
+
+#endif  // NET_SRC_WORK_STEALING_QUEUE_H_
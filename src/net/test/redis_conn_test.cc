@@ -0,0 +1,170 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/include/redis_conn.h"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "net/include/net_stats.h"
+
+extern std::unique_ptr<net::NetworkStatistic> g_network_statistic;
+
+namespace {
+
+class ReplyConn : public net::RedisConn {
+ public:
+  explicit ReplyConn(int fd) : RedisConn(fd, "127.0.0.1:0", nullptr) {}
+  int DealMessage(const net::RedisCmdArgsType& argv, std::string* response) override { return 0; }
+  const std::string& GetCurrentTable() override { return table_; }
+
+ private:
+  std::string table_ = "db0";
+};
+
+// the conn writes to fds_[0] through a small send buffer, the test reads
+// what it wrote from fds_[1]
+class RedisConnTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!g_network_statistic) {
+      g_network_statistic = std::make_unique<net::NetworkStatistic>();
+    }
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    int sndbuf = 4096;
+    ASSERT_EQ(0, setsockopt(fds_[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, fcntl(fds_[0], F_GETFL) | O_NONBLOCK));
+    ASSERT_EQ(0, fcntl(fds_[1], F_SETFL, fcntl(fds_[1], F_GETFL) | O_NONBLOCK));
+    conn_ = std::make_unique<ReplyConn>(fds_[0]);
+  }
+
+  void TearDown() override {
+    conn_.reset();
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  // reads everything the conn has written so far
+  void Drain() {
+    char buf[64 * 1024];
+    ssize_t nread = 0;
+    while ((nread = read(fds_[1], buf, sizeof(buf))) > 0) {
+      received_.append(buf, nread);
+    }
+    ASSERT_TRUE(nread == -1 && (errno == EAGAIN || errno == EWOULDBLOCK));
+  }
+
+  // a reply whose bytes tell where it sits in the stream
+  static std::string Reply(int seq, size_t size) {
+    std::string reply = "$" + std::to_string(seq) + ":";
+    while (reply.size() < size) {
+      reply.push_back(static_cast<char>('a' + (seq + reply.size()) % 26));
+    }
+    reply.resize(size);
+    return reply;
+  }
+
+  int fds_[2] = {-1, -1};
+  std::unique_ptr<ReplyConn> conn_;
+  std::string received_;
+};
+
+}  // namespace
+
+// small replies copied into chunks and large ones queued by reference,
+// more of them than fit in one writev, flushed through a send buffer that
+// takes a few KB per call, every short write ends inside some buffer
+TEST_F(RedisConnTest, PartialWritevTest) {
+  std::string expected;
+  for (int seq = 0; seq < 300; seq++) {
+    size_t size = seq % 7 == 0 ? 5000 + seq * 13 : 20 + seq % 50;
+    std::string reply = Reply(seq, size);
+    expected += reply;
+    if (seq % 3 == 0) {
+      conn_->WriteResp(std::make_shared<std::string>(reply));
+    } else {
+      conn_->WriteResp(reply);
+    }
+  }
+  ASSERT_EQ(expected.size(), conn_->PendingReplyBytes());
+
+  int short_writes = 0;
+  net::WriteStatus status = net::kWriteHalf;
+  while (status == net::kWriteHalf) {
+    status = conn_->SendReply();
+    Drain();
+    if (status == net::kWriteHalf) {
+      short_writes++;
+      ASSERT_GT(conn_->PendingReplyBytes(), 0U);
+    }
+    // every byte the socket took left the pending count
+    ASSERT_EQ(expected.size() - received_.size(), conn_->PendingReplyBytes());
+    // the bytes written so far are the head of the replies in order
+    ASSERT_EQ(expected.substr(0, received_.size()), received_);
+  }
+  ASSERT_EQ(net::kWriteAll, status);
+  ASSERT_GT(short_writes, 10);
+  ASSERT_EQ(0U, conn_->PendingReplyBytes());
+  ASSERT_EQ(expected, received_);
+}
+
+// replies queued while the front buffer is partly written go after it
+TEST_F(RedisConnTest, AppendAfterShortWriteTest) {
+  std::string expected = Reply(0, 256 * 1024);
+  conn_->WriteResp(std::make_shared<std::string>(expected));
+  ASSERT_EQ(net::kWriteHalf, conn_->SendReply());
+  Drain();
+  ASSERT_LT(received_.size(), expected.size());
+
+  for (int seq = 1; seq < 100; seq++) {
+    std::string reply = Reply(seq, 10 + seq);
+    expected += reply;
+    conn_->WriteResp(reply);
+    ASSERT_EQ(expected.size() - received_.size(), conn_->PendingReplyBytes());
+  }
+  net::WriteStatus status = net::kWriteHalf;
+  while (status == net::kWriteHalf) {
+    status = conn_->SendReply();
+    Drain();
+    ASSERT_EQ(expected.size() - received_.size(), conn_->PendingReplyBytes());
+  }
+  ASSERT_EQ(net::kWriteAll, status);
+  ASSERT_EQ(expected, received_);
+}
+
+// a reader that stops reading gets its connection closed once the pending
+// replies pass the limit, not before
+TEST_F(RedisConnTest, MaxReplyBytesTest) {
+  conn_->SetMaxReplyBytes(512 * 1024);
+  std::string reply = Reply(0, 64 * 1024);
+  net::WriteStatus status = net::kWriteHalf;
+  size_t queued = 0;
+  while (status == net::kWriteHalf && queued < 4 * 1024 * 1024) {
+    conn_->WriteResp(std::make_shared<std::string>(reply));
+    queued += reply.size();
+    status = conn_->SendReply();
+    if (status == net::kWriteHalf) {
+      ASSERT_LE(conn_->PendingReplyBytes(), 512U * 1024);
+    }
+  }
+  ASSERT_EQ(net::kWriteError, status);
+  ASSERT_GT(conn_->PendingReplyBytes(), 512U * 1024);
+
+}
+
+TEST_F(RedisConnTest, NoMaxReplyBytesTest) {
+  std::string reply = Reply(0, 64 * 1024);
+  for (int i = 0; i < 64; i++) {
+    conn_->WriteResp(std::make_shared<std::string>(reply));
+  }
+  ASSERT_EQ(net::kWriteHalf, conn_->SendReply());
+  ASSERT_GT(conn_->PendingReplyBytes(), 512U * 1024);
+}
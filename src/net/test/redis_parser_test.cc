@@ -0,0 +1,196 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/include/redis_parser.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using net::RedisCmdArgsType;
+using net::RedisParser;
+using net::RedisParserSettings;
+using net::RedisParserStatus;
+
+namespace {
+
+struct ParsedCmds {
+  std::vector<RedisCmdArgsType> dealt;
+  std::vector<RedisCmdArgsType> completed;
+  int complete_calls = 0;
+  bool swap_argvs = false;
+  // handed back to the parser by a swapping Complete callback
+  std::vector<RedisCmdArgsType> spare;
+};
+
+int DealMessage(RedisParser* parser, const RedisCmdArgsType& argv) {
+  reinterpret_cast<ParsedCmds*>(parser->data)->dealt.push_back(argv);
+  return 0;
+}
+
+int Complete(RedisParser* parser, std::vector<RedisCmdArgsType>& argvs) {
+  auto cmds = reinterpret_cast<ParsedCmds*>(parser->data);
+  cmds->complete_calls++;
+  if (cmds->swap_argvs) {
+    // take the batch the way RedisConn does and leave a used vector behind
+    cmds->spare.swap(argvs);
+    for (auto& argv : cmds->spare) {
+      cmds->completed.push_back(std::move(argv));
+    }
+    cmds->spare.assign(3, RedisCmdArgsType{"stale", "argv"});
+  } else {
+    for (auto& argv : argvs) {
+      cmds->completed.push_back(std::move(argv));
+    }
+  }
+  return 0;
+}
+
+class RedisParserTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    RedisParserSettings settings;
+    settings.DealMessage = DealMessage;
+    settings.Complete = Complete;
+    ASSERT_EQ(net::kRedisParserInitDone, parser_.RedisParserInit(REDIS_PARSER_REQUEST, settings));
+    parser_.data = &cmds_;
+  }
+
+  // feeds the pieces one read at a time, each read gets its own buffer so
+  // the parser can not keep pointers into an earlier one
+  RedisParserStatus Feed(const std::vector<std::string>& pieces) {
+    RedisParserStatus status = net::kRedisParserNone;
+    for (const auto& piece : pieces) {
+      std::vector<char> buf(piece.begin(), piece.end());
+      int parsed_len = 0;
+      status = parser_.ProcessInputBuffer(buf.data(), static_cast<int>(buf.size()), &parsed_len);
+      if (status == net::kRedisParserError) {
+        break;
+      }
+      std::fill(buf.begin(), buf.end(), 'x');
+    }
+    return status;
+  }
+
+  RedisParser parser_;
+  ParsedCmds cmds_;
+};
+
+std::string Multibulk(const RedisCmdArgsType& argv) {
+  std::string req = "*" + std::to_string(argv.size()) + "\r\n";
+  for (const auto& arg : argv) {
+    req += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+  }
+  return req;
+}
+
+const std::vector<RedisCmdArgsType> kPipeline = {
+    {"SET", "key", "value"},
+    {"HSET", "hash", "field", std::string(100, 'v')},
+    {"GET", ""},
+    {"MSET", "a", "1", "b", "22", "c", "333"},
+};
+
+std::string PipelineRequest() {
+  std::string req;
+  for (const auto& argv : kPipeline) {
+    req += Multibulk(argv);
+  }
+  return req;
+}
+
+}  // namespace
+
+TEST_F(RedisParserTest, WholeRequestTest) {
+  ASSERT_EQ(net::kRedisParserDone, Feed({PipelineRequest()}));
+  ASSERT_EQ(kPipeline, cmds_.completed);
+  ASSERT_EQ(kPipeline, cmds_.dealt);
+  ASSERT_EQ(1, cmds_.complete_calls);
+
+  ASSERT_EQ(net::kRedisParserDone, Feed({"PING\r\n", "set  k \"v 1\"\r\n"}));
+  ASSERT_EQ(kPipeline.size() + 2, cmds_.completed.size());
+  ASSERT_EQ((RedisCmdArgsType{"PING"}), cmds_.completed[kPipeline.size()]);
+  ASSERT_EQ((RedisCmdArgsType{"set", "k", "v 1"}), cmds_.completed[kPipeline.size() + 1]);
+}
+
+// the pipeline cut into two reads at every offset, the cut lands inside the
+// multibulk header, a bulk header, a bulk and between commands
+TEST_F(RedisParserTest, ArgvSplitAcrossReadsTest) {
+  std::string req = PipelineRequest();
+  for (size_t cut = 1; cut < req.size(); cut++) {
+    cmds_ = ParsedCmds();
+    ASSERT_EQ(net::kRedisParserDone, Feed({req.substr(0, cut), req.substr(cut)})) << "cut at " << cut;
+    ASSERT_EQ(kPipeline, cmds_.completed) << "cut at " << cut;
+    ASSERT_EQ(kPipeline, cmds_.dealt) << "cut at " << cut;
+  }
+}
+
+// a command cut into three reads at every pair of offsets, and fed a byte
+// per read, every boundary of a bulk string is a read boundary once
+TEST_F(RedisParserTest, BulkSplitAtEveryBoundaryTest) {
+  RedisCmdArgsType argv = {"SET", "k", "0123456789abcdef", ""};
+  std::string req = Multibulk(argv);
+  for (size_t first = 1; first < req.size(); first++) {
+    for (size_t second = first + 1; second < req.size(); second++) {
+      cmds_ = ParsedCmds();
+      ASSERT_EQ(net::kRedisParserDone,
+                Feed({req.substr(0, first), req.substr(first, second - first), req.substr(second)}))
+          << "cut at " << first << " and " << second;
+      ASSERT_EQ(std::vector<RedisCmdArgsType>{argv}, cmds_.completed) << "cut at " << first << " and " << second;
+    }
+  }
+
+  cmds_ = ParsedCmds();
+  std::string req2 = req + req;
+  std::vector<std::string> bytes;
+  for (char c : req2) {
+    bytes.emplace_back(1, c);
+  }
+  ASSERT_EQ(net::kRedisParserDone, Feed(bytes));
+  ASSERT_EQ((std::vector<RedisCmdArgsType>{argv, argv}), cmds_.completed);
+  // Complete runs only for reads that end on a command boundary
+  ASSERT_EQ(2, cmds_.complete_calls);
+}
+
+// a bulk bigger than the reads streams in over many of them, as a large
+// SET value arrives through the connection's read buffer
+TEST_F(RedisParserTest, LargeBulkAcrossReadsTest) {
+  RedisCmdArgsType argv = {"SET", "big", std::string(1 << 20, 'b')};
+  argv[2][0] = 'x';
+  argv[2][argv[2].size() - 1] = 'y';
+  std::string req = Multibulk(argv) + Multibulk({"GET", "big"});
+  std::vector<std::string> reads;
+  for (size_t pos = 0; pos < req.size(); pos += 16 * 1024 - 7) {
+    reads.push_back(req.substr(pos, 16 * 1024 - 7));
+  }
+  ASSERT_EQ(net::kRedisParserDone, Feed(reads));
+  ASSERT_EQ((std::vector<RedisCmdArgsType>{argv, {"GET", "big"}}), cmds_.completed);
+}
+
+// the Complete callback swaps the batch out and hands the parser a vector
+// it has used, the parser must start the next batch from an empty one
+TEST_F(RedisParserTest, SwappedArgvReuseTest) {
+  cmds_.swap_argvs = true;
+  std::string req = PipelineRequest();
+  size_t cut = req.size() / 2;
+  for (int round = 0; round < 3; round++) {
+    ASSERT_EQ(net::kRedisParserHalf, Feed({req.substr(0, cut)}));
+    ASSERT_EQ(net::kRedisParserDone, Feed({req.substr(cut)}));
+  }
+  std::vector<RedisCmdArgsType> expected;
+  for (int round = 0; round < 3; round++) {
+    expected.insert(expected.end(), kPipeline.begin(), kPipeline.end());
+  }
+  ASSERT_EQ(expected, cmds_.completed);
+  ASSERT_EQ(expected, cmds_.dealt);
+  ASSERT_EQ(3, cmds_.complete_calls);
+}
+
+TEST_F(RedisParserTest, ProtocolErrorTest) {
+  ASSERT_EQ(net::kRedisParserError, Feed({"*2\r\n$3\r\nGET\r\n", "+3\r\nkey\r\n"}));
+  ASSERT_EQ(net::kRedisParserProtoError, parser_.get_error_code());
+  ASSERT_TRUE(cmds_.completed.empty());
+}
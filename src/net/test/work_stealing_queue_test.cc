@@ -0,0 +1,307 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "net/src/work_stealing_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using net::Task;
+using net::TaskDeque;
+using net::TaskInjectionQueue;
+
+namespace {
+
+void Noop(void* arg) {}
+
+// items are numbered from 0, arg holds the number plus one so no item is null
+Task MakeTask(uint64_t item) { return {Noop, reinterpret_cast<void*>(static_cast<uintptr_t>(item + 1))}; }
+
+uint64_t ItemOf(const Task& task) { return reinterpret_cast<uintptr_t>(task.arg) - 1; }
+
+// counts how often every item was taken, each must be taken exactly once
+class ItemCounter {
+ public:
+  explicit ItemCounter(uint64_t items) : items_(items), counts_(new std::atomic<int>[items]) {
+    for (uint64_t i = 0; i < items_; i++) {
+      counts_[i].store(0);
+    }
+  }
+
+  void Take(const Task& task) {
+    ASSERT_EQ(reinterpret_cast<net::TaskFunc>(Noop), task.func);
+    uint64_t item = ItemOf(task);
+    ASSERT_LT(item, items_);
+    counts_[item].fetch_add(1);
+    taken_.fetch_add(1);
+  }
+
+  uint64_t taken() const { return taken_.load(); }
+
+  void ExpectEachOnce() const {
+    for (uint64_t i = 0; i < items_; i++) {
+      ASSERT_EQ(1, counts_[i].load()) << "item " << i;
+    }
+  }
+
+ private:
+  uint64_t items_;
+  std::unique_ptr<std::atomic<int>[]> counts_;
+  std::atomic<uint64_t> taken_{0};
+};
+
+}  // namespace
+
+TEST(TaskDequeTest, OwnerAndThiefEndsTest) {
+  TaskDeque deque(4);
+  Task task;
+  ASSERT_FALSE(deque.Pop(&task));
+  ASSERT_FALSE(deque.Steal(&task));
+
+  for (uint64_t i = 0; i < 4; i++) {
+    ASSERT_TRUE(deque.Push(MakeTask(i)));
+  }
+  ASSERT_FALSE(deque.Push(MakeTask(4)));
+
+  // the owner pops the newest, thieves take the oldest
+  ASSERT_TRUE(deque.Pop(&task));
+  ASSERT_EQ(3U, ItemOf(task));
+  ASSERT_TRUE(deque.Steal(&task));
+  ASSERT_EQ(0U, ItemOf(task));
+  ASSERT_TRUE(deque.Steal(&task));
+  ASSERT_EQ(1U, ItemOf(task));
+  ASSERT_TRUE(deque.Pop(&task));
+  ASSERT_EQ(2U, ItemOf(task));
+  ASSERT_FALSE(deque.Pop(&task));
+  ASSERT_FALSE(deque.Steal(&task));
+}
+
+// the owner pushes and pops while thieves steal, no item is lost or taken twice
+TEST(TaskDequeTest, PopAgainstStealTest) {
+  const uint64_t items = 1000000;
+  const int thieves = 4;
+  TaskDeque deque(256);
+  ItemCounter counter(items);
+  std::atomic<bool> done{false};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thieves; i++) {
+    threads.emplace_back([&]() {
+      Task task;
+      while (!done.load()) {
+        if (deque.Steal(&task)) {
+          counter.Take(task);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  Task task;
+  for (uint64_t item = 0; item < items; item++) {
+    while (!deque.Push(MakeTask(item))) {
+      if (deque.Pop(&task)) {
+        counter.Take(task);
+      }
+    }
+    // pop one of every three so both ends stay busy
+    if (item % 3 == 0 && deque.Pop(&task)) {
+      counter.Take(task);
+    }
+  }
+  while (deque.Pop(&task)) {
+    counter.Take(task);
+  }
+  done.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // a steal that lost its race returned false, whatever is left was taken
+  while (deque.Steal(&task)) {
+    counter.Take(task);
+  }
+  ASSERT_EQ(items, counter.taken());
+  counter.ExpectEachOnce();
+}
+
+// one task in the deque, the owner's Pop and a thief's Steal start together,
+// exactly one of them gets it
+TEST(TaskDequeTest, LastElementRaceTest) {
+  const int rounds = 20000;
+  TaskDeque deque(16);
+  std::atomic<int> round{-1};
+  std::atomic<int> stolen_round{-1};
+  std::atomic<bool> stolen{false};
+  Task stolen_task;
+
+  std::thread thief([&]() {
+    for (int r = 0; r < rounds; r++) {
+      while (round.load() != r) {
+        std::this_thread::yield();
+      }
+      Task task;
+      bool won = deque.Steal(&task);
+      if (won) {
+        stolen_task = task;
+      }
+      stolen.store(won);
+      stolen_round.store(r);
+    }
+  });
+
+  int pops = 0;
+  int steals = 0;
+  for (int r = 0; r < rounds; r++) {
+    ASSERT_TRUE(deque.Push(MakeTask(r)));
+    round.store(r);
+    // vary who starts first, a single core only interleaves them on a yield
+    if (r % 2 == 1) {
+      std::this_thread::yield();
+    }
+    Task task;
+    bool popped = deque.Pop(&task);
+    while (stolen_round.load() != r) {
+      std::this_thread::yield();
+    }
+    ASSERT_NE(popped, stolen.load()) << "round " << r;
+    ASSERT_EQ(static_cast<uint64_t>(r), ItemOf(popped ? task : stolen_task));
+    popped ? pops++ : steals++;
+    ASSERT_FALSE(deque.Pop(&task));
+    ASSERT_FALSE(deque.Steal(&task));
+  }
+  thief.join();
+  // both sides must have won some rounds for the race to have been tested
+  ASSERT_GT(pops, 0);
+  ASSERT_GT(steals, 0);
+}
+
+// the deque is a fixed ring, a full deque refuses Push until a steal frees
+// a slot, and the indices wrap the ring many times under concurrent steals
+TEST(TaskDequeTest, WrapAroundUnderStealTest) {
+  TaskDeque deque(8);
+  Task task;
+  for (uint64_t i = 0; i < 8; i++) {
+    ASSERT_TRUE(deque.Push(MakeTask(i)));
+  }
+  ASSERT_FALSE(deque.Push(MakeTask(8)));
+  ASSERT_TRUE(deque.Steal(&task));
+  ASSERT_EQ(0U, ItemOf(task));
+  ASSERT_TRUE(deque.Push(MakeTask(8)));
+  ASSERT_FALSE(deque.Push(MakeTask(9)));
+  for (uint64_t i = 1; i <= 8; i++) {
+    ASSERT_TRUE(deque.Steal(&task));
+    ASSERT_EQ(i, ItemOf(task));
+  }
+
+  const uint64_t items = 500000;
+  const int thieves = 3;
+  ItemCounter counter(items);
+  std::atomic<bool> done{false};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thieves; i++) {
+    threads.emplace_back([&]() {
+      Task stolen_task;
+      uint64_t last = 0;
+      bool first = true;
+      while (!done.load()) {
+        if (deque.Steal(&stolen_task)) {
+          // steals come from the FIFO end, one thief sees them in push order
+          if (!first) {
+            ASSERT_GT(ItemOf(stolen_task), last);
+          }
+          first = false;
+          last = ItemOf(stolen_task);
+          counter.Take(stolen_task);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  uint64_t full = 0;
+  for (uint64_t item = 0; item < items; item++) {
+    while (!deque.Push(MakeTask(item))) {
+      full++;
+      std::this_thread::yield();
+    }
+  }
+  while (counter.taken() < items) {
+    std::this_thread::yield();
+  }
+  done.store(true);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_GT(full, 0U);
+  counter.ExpectEachOnce();
+}
+
+TEST(TaskInjectionQueueTest, FullAndEmptyTest) {
+  // the capacity rounds up to a power of two
+  TaskInjectionQueue queue(5);
+  Task task;
+  ASSERT_FALSE(queue.Pop(&task));
+  for (uint64_t i = 0; i < 8; i++) {
+    ASSERT_TRUE(queue.Push(MakeTask(i)));
+  }
+  ASSERT_FALSE(queue.Push(MakeTask(8)));
+  for (uint64_t i = 0; i < 8; i++) {
+    ASSERT_TRUE(queue.Pop(&task));
+    ASSERT_EQ(i, ItemOf(task));
+  }
+  ASSERT_FALSE(queue.Pop(&task));
+}
+
+// several producers and consumers through a small queue, every item is
+// popped once and one consumer sees the items of one producer in order
+TEST(TaskInjectionQueueTest, MultiProducerMultiConsumerTest) {
+  const int producers = 4;
+  const int consumers = 4;
+  const uint64_t items_per_producer = 200000;
+  const uint64_t items = producers * items_per_producer;
+  TaskInjectionQueue queue(64);
+  ItemCounter counter(items);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([&, p]() {
+      for (uint64_t i = 0; i < items_per_producer; i++) {
+        while (!queue.Push(MakeTask(p * items_per_producer + i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (int c = 0; c < consumers; c++) {
+    threads.emplace_back([&]() {
+      std::vector<int64_t> last(producers, -1);
+      Task task;
+      while (counter.taken() < items) {
+        if (!queue.Pop(&task)) {
+          std::this_thread::yield();
+          continue;
+        }
+        uint64_t item = ItemOf(task);
+        int p = static_cast<int>(item / items_per_producer);
+        auto seq = static_cast<int64_t>(item % items_per_producer);
+        ASSERT_GT(seq, last[p]);
+        last[p] = seq;
+        counter.Take(task);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  Task task;
+  ASSERT_FALSE(queue.Pop(&task));
+  counter.ExpectEachOnce();
+}
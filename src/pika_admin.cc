@@ -843,6 +843,7 @@ const std::string InfoCmd::kRocksDBSection = "rocksdb";
 const std::string InfoCmd::kDebugSection = "debug";
 const std::string InfoCmd::kCommandStatsSection = "commandstats";
 const std::string InfoCmd::kCacheSection = "cache";
+const std::string InfoCmd::kMemorySection = "memory";
 
 
 const std::string ClientCmd::KILLTYPE_NORMAL = "normal";
@@ -928,6 +929,8 @@ void InfoCmd::DoInitial() {
     info_section_ = kInfoCommandStats;
   } else if (strcasecmp(argv_[1].data(), kCacheSection.data()) == 0) {
     info_section_ = kInfoCache;
+  } else if (strcasecmp(argv_[1].data(), kMemorySection.data()) == 0) {
+    info_section_ = kInfoMemory;
   } else {
     info_section_ = kInfoErr;
   }
@@ -976,6 +979,8 @@ void InfoCmd::Do() {
       InfoKeyspace(info);
       info.append("\r\n");
       InfoRocksDB(info);
+      info.append("\r\n");
+      InfoMemory(info);
       break;
     case kInfoServer:
       InfoServer(info);
@@ -1013,6 +1018,9 @@ void InfoCmd::Do() {
     case kInfoCache:
       InfoCache(info, db_);
       break;
+    case kInfoMemory:
+      InfoMemory(info);
+      break;
     default:
       // kInfoErr is nothing
       break;
@@ -1080,6 +1088,7 @@ void InfoCmd::InfoStats(std::string& info) {
              << "\r\n";
   tmp_stream << "total_net_repl_input_bytes:" << g_pika_server->NetReplInputBytes() << "\r\n";
   tmp_stream << "total_net_repl_output_bytes:" << g_pika_server->NetReplOutputBytes() << "\r\n";
+  tmp_stream << "total_net_repl_saved_bytes:" << g_pika_server->NetReplSavedBytes() << "\r\n";
   tmp_stream << "instantaneous_input_kbps:" << g_pika_server->InstantaneousInputKbps() << "\r\n";
   tmp_stream << "instantaneous_output_kbps:" << g_pika_server->InstantaneousOutputKbps() << "\r\n";
   tmp_stream << "instantaneous_input_repl_kbps:" << g_pika_server->InstantaneousInputReplKbps() << "\r\n";
@@ -1157,6 +1166,8 @@ void InfoCmd::InfoReplication(std::string& info) {
   std::stringstream out_of_sync;
   std::stringstream repl_connect_status;
   int32_t syncing_full_count = 0;
+  uint64_t reused_file_count = 0;
+  uint64_t reused_bytes = 0;
   bool all_db_sync = true;
   std::shared_lock db_rwl(g_pika_server->dbs_rw_);
   for (const auto& db_item : g_pika_server->GetDB()) {
@@ -1166,6 +1177,8 @@ void InfoCmd::InfoReplication(std::string& info) {
       out_of_sync << "(" << db_item.first << ": InternalError)";
       continue;
     }
+    reused_file_count += slave_db->RsyncReusedFileCount();
+    reused_bytes += slave_db->RsyncReusedBytes();
     repl_connect_status << db_item.first << ":";
     if (slave_db->State() != ReplState::kConnected) {
       all_db_sync = false;
@@ -1230,6 +1243,8 @@ void InfoCmd::InfoReplication(std::string& info) {
       tmp_stream << "repl_connect_status:\r\n"  << repl_connect_status.str();
       tmp_stream << "slave_priority:" << g_pika_conf->slave_priority() << "\r\n";
       tmp_stream << "slave_read_only:" << g_pika_conf->slave_read_only() << "\r\n";
+      tmp_stream << "full_sync_reused_files:" << reused_file_count << "\r\n";
+      tmp_stream << "full_sync_reused_bytes:" << reused_bytes << "\r\n";
       if (!all_db_sync) {
         tmp_stream << "db_repl_state:" << out_of_sync.str() << "\r\n";
       }
@@ -1242,6 +1257,8 @@ void InfoCmd::InfoReplication(std::string& info) {
                  << "\r\n";
       tmp_stream << "repl_connect_status:\r\n"  << repl_connect_status.str();
       tmp_stream << "slave_read_only:" << g_pika_conf->slave_read_only() << "\r\n";
+      tmp_stream << "full_sync_reused_files:" << reused_file_count << "\r\n";
+      tmp_stream << "full_sync_reused_bytes:" << reused_bytes << "\r\n";
       if (!all_db_sync) {
         tmp_stream << "db_repl_state:" << out_of_sync.str() << "\r\n";
       }
@@ -1424,6 +1441,55 @@ void InfoCmd::InfoRocksDB(std::string& info) {
   info.append(tmp_stream.str());
 }
 
+void InfoCmd::InfoMemory(std::string& info) {
+  std::stringstream tmp_stream;
+  tmp_stream << "# Memory"
+             << "\r\n";
+
+  std::shared_ptr<storage::MemoryGovernor> governor = g_pika_server->memory_governor();
+  tmp_stream << "memory_governor:" << (governor != nullptr ? "yes" : "no") << "\r\n";
+  if (governor == nullptr) {
+    info.append(tmp_stream.str());
+    return;
+  }
+
+  // the memtables of each column family of every db
+  std::vector<uint64_t> memtable_usages(storage::kColumnFamilyNum, 0);
+  {
+    std::shared_lock db_rwl(g_pika_server->dbs_rw_);
+    for (const auto& db_item : g_pika_server->dbs_) {
+      if (!db_item.second) {
+        continue;
+      }
+      std::vector<uint64_t> db_memtable_usages;
+      db_item.second->DBLockShared();
+      db_item.second->storage()->GetColumnFamilyUsage(storage::PROPERTY_TYPE_ROCKSDB_CUR_SIZE_ALL_MEM_TABLES,
+                                                      &db_memtable_usages);
+      db_item.second->DBUnlockShared();
+      for (int cf = 0; cf < storage::kColumnFamilyNum; ++cf) {
+        memtable_usages[cf] += db_memtable_usages[cf];
+      }
+    }
+  }
+
+  size_t memtable_usage = governor->MemtableUsage();
+  tmp_stream << "memory_budget:" << governor->budget() << "\r\n";
+  tmp_stream << "memtable_budget:" << governor->memtable_budget() << "\r\n";
+  tmp_stream << "memtable_usage:" << memtable_usage << "\r\n";
+  tmp_stream << "block_cache_budget:" << governor->budget() - std::min(memtable_usage, governor->budget()) << "\r\n";
+  for (int cf = 0; cf < storage::kColumnFamilyNum; ++cf) {
+    std::string name = storage::kColumnFamilyNames[cf];
+    const auto& block_cache = governor->BlockCache(cf);
+    tmp_stream << name << "_weight:" << governor->Weight(cf) << "\r\n";
+    tmp_stream << name << "_block_cache_usage:" << block_cache->GetUsage() << "\r\n";
+    tmp_stream << name << "_block_cache_capacity:" << block_cache->GetCapacity() << "\r\n";
+    tmp_stream << name << "_block_cache_share:" << governor->BlockCacheShare(cf) << "\r\n";
+    tmp_stream << name << "_memtable_usage:" << memtable_usages[cf] << "\r\n";
+    tmp_stream << name << "_memtable_share:" << governor->MemtableShare(cf) << "\r\n";
+  }
+  info.append(tmp_stream.str());
+}
+
 void InfoCmd::InfoDebug(std::string& info) {
   std::stringstream tmp_stream;
   tmp_stream << "# Synchronization Status"
@@ -1614,6 +1680,24 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeNumber(&config_body, g_pika_conf->admin_thread_pool_size());
   }
 
+  if (pstd::stringmatch(pattern.data(), "thread-pool-work-stealing", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "thread-pool-work-stealing");
+    EncodeString(&config_body, g_pika_conf->thread_pool_work_stealing() ? "yes" : "no");
+  }
+
+  if (pstd::stringmatch(pattern.data(), "run-to-completion", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "run-to-completion");
+    EncodeString(&config_body, g_pika_conf->run_to_completion() ? "yes" : "no");
+  }
+
+  if (pstd::stringmatch(pattern.data(), "run-to-completion-budget-us", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "run-to-completion-budget-us");
+    EncodeNumber(&config_body, g_pika_conf->run_to_completion_budget_us());
+  }
+
   if (pstd::stringmatch(pattern.data(), "userblacklist", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "userblacklist");
@@ -1797,6 +1881,48 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeNumber(&config_body, g_pika_conf->small_compaction_duration_threshold());
   }
 
+  if (pstd::stringmatch(pattern.data(), "multi-key-fanout-min-batch", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "multi-key-fanout-min-batch");
+    EncodeNumber(&config_body, g_pika_conf->multi_key_fanout_min_batch());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "zset-rank-index-min-members", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "zset-rank-index-min-members");
+    EncodeNumber(&config_body, g_pika_conf->zset_rank_index_min_members());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "list-node-max-elements", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "list-node-max-elements");
+    EncodeNumber(&config_body, g_pika_conf->list_node_max_elements());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "inline-collection-max-entries", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "inline-collection-max-entries");
+    EncodeNumber(&config_body, g_pika_conf->inline_collection_max_entries());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "compaction-meta-cache-size", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "compaction-meta-cache-size");
+    EncodeNumber(&config_body, g_pika_conf->compaction_meta_cache_size());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "compaction-meta-scan", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "compaction-meta-scan");
+    EncodeString(&config_body, g_pika_conf->compaction_meta_scan() ? "yes" : "no");
+  }
+
+  if (pstd::stringmatch(pattern.data(), "range-delete-min-entries", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "range-delete-min-entries");
+    EncodeNumber(&config_body, g_pika_conf->range_delete_min_entries());
+  }
+
   if (pstd::stringmatch(pattern.data(), "max-background-flushes", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "max-background-flushes");
@@ -1845,6 +1971,24 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeString(&config_body, g_pika_conf->share_block_cache() ? "yes" : "no");
   }
 
+  if (pstd::stringmatch(pattern.data(), "prefix-bloom-types", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "prefix-bloom-types");
+    EncodeString(&config_body, pstd::StringConcat(g_pika_conf->prefix_bloom_types(), COMMA));
+  }
+
+  if (pstd::stringmatch(pattern.data(), "memory-governor", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "memory-governor");
+    EncodeString(&config_body, g_pika_conf->memory_governor() ? "yes" : "no");
+  }
+
+  if (pstd::stringmatch(pattern.data(), "memory-governor-weights", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "memory-governor-weights");
+    EncodeString(&config_body, g_pika_conf->memory_governor_weights());
+  }
+
   if (pstd::stringmatch(pattern.data(), "enable-partitioned-index-filters", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "enable-partitioned-index-filters");
@@ -2035,6 +2179,24 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeNumber(&config_body, g_pika_conf->max_conn_rbuf_size());
   }
 
+  if (pstd::stringmatch(pattern.data(), "replication-binlog-compression", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "replication-binlog-compression");
+    EncodeString(&config_body, g_pika_conf->replication_binlog_compression());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "replication-batch-bytes", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "replication-batch-bytes");
+    EncodeNumber(&config_body, g_pika_conf->replication_batch_bytes());
+  }
+
+  if (pstd::stringmatch(pattern.data(), "replication-batch-latency-ms", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "replication-batch-latency-ms");
+    EncodeNumber(&config_body, g_pika_conf->replication_batch_latency_ms());
+  }
+
   if (pstd::stringmatch(pattern.data(), "replication-num", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "replication-num");
@@ -2190,6 +2352,12 @@ void ConfigCmd::ConfigGet(std::string& ret) {
     EncodeNumber(&config_body, g_pika_conf->max_rsync_parallel_num());
   }
 
+  if (pstd::stringmatch(pattern.data(), "rsync-checksum-type", 1) != 0) {
+    elements += 2;
+    EncodeString(&config_body, "rsync-checksum-type");
+    EncodeString(&config_body, g_pika_conf->rsync_checksum_type());
+  }
+
   if (pstd::stringmatch(pattern.data(), "replication-id", 1) != 0) {
     elements += 2;
     EncodeString(&config_body, "replication-id");
@@ -2302,6 +2470,13 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
         "max-cache-statistic-keys",
         "small-compaction-threshold",
         "small-compaction-duration-threshold",
+        "multi-key-fanout-min-batch",
+        "zset-rank-index-min-members",
+        "list-node-max-elements",
+        "inline-collection-max-entries",
+        "compaction-meta-cache-size",
+        "compaction-meta-scan",
+        "range-delete-min-entries",
         "max-client-response-size",
         "db-sync-speed",
         "compact-cron",
@@ -2332,6 +2507,9 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
         "zset-cache-field-num-per-key",
         "cache-lfu-decay-time",
         "max-conn-rbuf-size",
+        "replication-binlog-compression",
+        "replication-batch-bytes",
+        "replication-batch-latency-ms",
     });
     res_.AppendStringVector(replyVt);
     return;
@@ -2496,6 +2674,67 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
     g_pika_conf->SetSmallCompactionDurationThreshold(static_cast<int>(ival));
     g_pika_server->DBSetSmallCompactionDurationThreshold(static_cast<int>(ival));
     res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "multi-key-fanout-min-batch") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival < 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'multi-key-fanout-min-batch'\r\n");
+      return;
+    }
+    g_pika_conf->SetMultiKeyFanoutMinBatch(static_cast<int>(ival));
+    g_pika_server->DBSetMultiKeyFanoutMinBatch(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "zset-rank-index-min-members") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival < 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'zset-rank-index-min-members'\r\n");
+      return;
+    }
+    g_pika_conf->SetZSetRankIndexMinMembers(static_cast<int>(ival));
+    g_pika_server->DBSetZSetRankIndexMinMembers(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "list-node-max-elements") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival < 0 || ival > 8192) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'list-node-max-elements'\r\n");
+      return;
+    }
+    g_pika_conf->SetListNodeMaxElements(static_cast<int>(ival));
+    g_pika_server->DBSetListNodeMaxElements(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "inline-collection-max-entries") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival < 0 || ival > 512) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'inline-collection-max-entries'\r\n");
+      return;
+    }
+    g_pika_conf->SetInlineCollectionMaxEntries(static_cast<int>(ival));
+    g_pika_server->DBSetInlineCollectionMaxEntries(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "compaction-meta-cache-size") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival < 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'compaction-meta-cache-size'\r\n");
+      return;
+    }
+    g_pika_conf->SetCompactionMetaCacheSize(ival);
+    g_pika_server->DBSetCompactionMetaCacheSize(static_cast<size_t>(ival));
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "compaction-meta-scan") {
+    bool compaction_meta_scan;
+    if (value == "yes") {
+      compaction_meta_scan = true;
+    } else if (value == "no") {
+      compaction_meta_scan = false;
+    } else {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'compaction-meta-scan'\r\n");
+      return;
+    }
+    g_pika_conf->SetCompactionMetaScan(compaction_meta_scan);
+    g_pika_server->DBSetCompactionMetaScan(compaction_meta_scan);
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "range-delete-min-entries") {
+    if ((pstd::string2int(value.data(), value.size(), &ival) == 0) || ival < 0) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'range-delete-min-entries'\r\n");
+      return;
+    }
+    g_pika_conf->SetRangeDeleteMinEntries(ival);
+    g_pika_server->DBSetRangeDeleteMinEntries(static_cast<uint64_t>(ival));
+    res_.AppendStringRaw("+OK\r\n");
   } else if (set_item == "disable_auto_compactions") {
     if (value != "true" && value != "false") {
       res_.AppendStringRaw("-ERR invalid disable_auto_compactions (true or false)\r\n");
@@ -2551,7 +2790,7 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
       res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'max-client-response-size'\r\n");
       return;
     }
-    g_pika_conf->SetMaxClientResponseSize(static_cast<int>(ival));
+    g_pika_conf->SetMaxClientResponseSize(ival);
     res_.AppendStringRaw("+OK\r\n");
   } else if (set_item == "write-binlog") {
     int role = g_pika_server->role();
@@ -2973,6 +3212,27 @@ void ConfigCmd::ConfigSet(std::shared_ptr<DB> db) {
     }
     g_pika_conf->SetMaxConnRbufSize(static_cast<int>(ival));
     res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "replication-binlog-compression") {
+    if (value != "none" && value != "lz4" && value != "zstd") {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'replication-binlog-compression'\r\n");
+      return;
+    }
+    g_pika_conf->SetReplicationBinlogCompression(value);
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "replication-batch-bytes") {
+    if (pstd::string2int(value.data(), value.size(), &ival) == 0 || ival < 0 || ival > PIKA_MAX_CONN_RBUF_LB) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'replication-batch-bytes'\r\n");
+      return;
+    }
+    g_pika_conf->SetReplicationBatchBytes(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
+  } else if (set_item == "replication-batch-latency-ms") {
+    if (pstd::string2int(value.data(), value.size(), &ival) == 0 || ival <= 0 || ival > kReplBatchLatencyMaxMs) {
+      res_.AppendStringRaw("-ERR Invalid argument \'" + value + "\' for CONFIG SET 'replication-batch-latency-ms'\r\n");
+      return;
+    }
+    g_pika_conf->SetReplicationBatchLatencyMs(static_cast<int>(ival));
+    res_.AppendStringRaw("+OK\r\n");
   } else {
     res_.AppendStringRaw("-ERR Unsupported CONFIG parameter: " + set_item + "\r\n");
   }
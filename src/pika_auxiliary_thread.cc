@@ -41,9 +41,13 @@ void* PikaAuxiliaryThread::ThreadMain() {
     // send to peer
     int res = g_pika_server->SendToPeer();
     if (res == 0) {
-      // sleep 100 ms
+      // sleep 100 ms, or until the binlog held back for batching is due
       std::unique_lock lock(mu_);
-      cv_.wait_for(lock, 100ms);
+      if (g_pika_rm->HasHeldBinlog()) {
+        cv_.wait_for(lock, std::chrono::milliseconds(g_pika_conf->replication_batch_latency_ms()));
+      } else {
+        cv_.wait_for(lock, 100ms);
+      }
     } else {
       // LOG_EVERY_N(INFO, 1000) << "Consume binlog number " << res;
     }
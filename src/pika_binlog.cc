@@ -171,38 +171,153 @@ Status Binlog::GetProducerStatus(uint32_t* filenum, uint64_t* pro_offset, uint32
   return Status::OK();
 }
 
-// Note: mutex lock should be held
 Status Binlog::Put(const std::string& item) {
   if (!opened_.load()) {
     return Status::Busy("Binlog is not open yet");
   }
+
+  Writer w(&item);
+  if (!LinkWriter(&w)) {
+    AwaitState(&w);
+    if (w.state.load(std::memory_order_acquire) == kWriterDone) {
+      return w.status;
+    }
+  }
+
+  // We are the leader now, w is the oldest writer in the queue
+  Writer* last = BuildGroup(&w);
+  {
+    Lock();
+    DEFER {
+      Unlock();
+    };
+    WriteGroup(&w, last);
+  }
+  ExitAsGroupLeader(&w, last);
+  return w.status;
+}
+
+bool Binlog::LinkWriter(Writer* w) {
+  Writer* writers = newest_writer_.load(std::memory_order_relaxed);
+  while (true) {
+    w->link_older = writers;
+    if (newest_writer_.compare_exchange_weak(writers, w, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+      return writers == nullptr;
+    }
+  }
+}
+
+void Binlog::AwaitState(Writer* w) {
+  // most groups are short, spin a little before going to sleep
+  for (int i = 0; i < 128; ++i) {
+    if (w->state.load(std::memory_order_acquire) != kWriterPending) {
+      break;
+    }
+  }
+  // always pass through mu, SetState may still be holding it
+  std::unique_lock l(w->mu);
+  w->cv.wait(l, [w] { return w->state.load(std::memory_order_acquire) != kWriterPending; });
+}
+
+void Binlog::SetState(Writer* w, int state) {
+  // w may be gone as soon as it sees the new state, notify under its lock
+  std::lock_guard l(w->mu);
+  w->state.store(state, std::memory_order_release);
+  w->cv.notify_one();
+}
+
+void Binlog::CreateMissingNewerLinks(Writer* head) {
+  while (head->link_older != nullptr && head->link_older->link_newer == nullptr) {
+    head->link_older->link_newer = head;
+    head = head->link_older;
+  }
+}
+
+Binlog::Writer* Binlog::BuildGroup(Writer* leader) {
+  Writer* newest = newest_writer_.load(std::memory_order_acquire);
+  CreateMissingNewerLinks(newest);
+
+  Writer* last = leader;
+  size_t group_bytes = leader->item->size();
+  while (last != newest) {
+    Writer* next = last->link_newer;
+    group_bytes += next->item->size();
+    if (group_bytes > kBinlogGroupCommitMaxBytes) {
+      break;
+    }
+    last = next;
+  }
+  return last;
+}
+
+// Note: mutex lock should be held
+void Binlog::WriteGroup(Writer* leader, Writer* last) {
   uint32_t filenum = 0;
   uint32_t term = 0;
   uint64_t offset = 0;
   uint64_t logic_id = 0;
-
-  Lock();
-  DEFER {
-    Unlock();
-  };
-
   Status s = GetProducerStatus(&filenum, &offset, &term, &logic_id);
-  if (!s.ok()) {
-    return s;
+  const uint64_t first_logic_id = logic_id;
+  for (Writer* w = leader; ; w = w->link_newer) {
+    // keep the order of logic_id, once an item failed the rest fail too
+    if (s.ok()) {
+      std::string data = PikaBinlogTransverter::BinlogEncode(BinlogType::TypeFirst,
+          time(nullptr), term, logic_id + 1, filenum, offset, *w->item, {});
+      s = Put(data.c_str(), static_cast<int>(data.size()), logic_id, &offset);
+      if (s.ok()) {
+        logic_id++;
+        filenum = pro_num_;
+      } else {
+        binlog_io_error_.store(true);
+      }
+    }
+    w->status = s;
+    if (w == last) {
+      break;
+    }
   }
-  logic_id++;
-  std::string data = PikaBinlogTransverter::BinlogEncode(BinlogType::TypeFirst,
-      time(nullptr), term, logic_id, filenum, offset, item, {});
+  // the items written are published and saved once for the whole group
+  if (logic_id != first_logic_id) {
+    std::lock_guard l(version_->rwlock_);
+    version_->pro_offset_ = offset;
+    version_->logic_id_ = logic_id;
+    version_->StableSave();
+  }
+  if (s.ok()) {
+    s = queue_->Flush();
+    if (!s.ok()) {
+      binlog_io_error_.store(true);
+      for (Writer* w = leader; ; w = w->link_newer) {
+        w->status = s;
+        if (w == last) {
+          break;
+        }
+      }
+    }
+  }
+}
 
-  s = Put(data.c_str(), static_cast<int>(data.size()));
-  if (!s.ok()) {
-    binlog_io_error_.store(true);
+void Binlog::ExitAsGroupLeader(Writer* leader, Writer* last) {
+  Writer* head = last;
+  if (!newest_writer_.compare_exchange_strong(head, nullptr, std::memory_order_acq_rel, std::memory_order_acquire)) {
+    // more writers queued up behind the group, hand the leadership
+    // to the oldest of them
+    CreateMissingNewerLinks(head);
+    Writer* next_leader = last->link_newer;
+    next_leader->link_older = nullptr;
+    SetState(next_leader, kWriterLeader);
+  }
+  // wake up the followers, newest first since they may free
+  // themselves as soon as they are done
+  for (Writer* w = last; w != leader;) {
+    Writer* older = w->link_older;
+    SetState(w, kWriterDone);
+    w = older;
   }
-  return s;
 }
 
 // Note: mutex lock should be held
-Status Binlog::Put(const char* item, int len) {
+Status Binlog::Put(const char* item, int len, uint64_t logic_id, uint64_t* pro_offset) {
   Status s;
 
   /* Check to roll log file */
@@ -218,23 +333,23 @@ Status Binlog::Put(const char* item, int len) {
     queue_.reset();
     queue_ = std::move(queue);
     pro_num_++;
+    *pro_offset = 0;
 
     {
       std::lock_guard l(version_->rwlock_);
       version_->pro_offset_ = 0;
       version_->pro_num_ = pro_num_;
+      // the items of the group in the previous file are saved with it
+      version_->logic_id_ = logic_id;
       version_->StableSave();
     }
     InitLogFile();
   }
 
-  int pro_offset;
-  s = Produce(pstd::Slice(item, len), &pro_offset);
+  int temp_pro_offset = static_cast<int>(*pro_offset);
+  s = Produce(pstd::Slice(item, len), &temp_pro_offset);
   if (s.ok()) {
-    std::lock_guard l(version_->rwlock_);
-    version_->pro_offset_ = pro_offset;
-    version_->logic_id_++;
-    version_->StableSave();
+    *pro_offset = temp_pro_offset;
   }
 
   return s;
@@ -262,10 +377,8 @@ Status Binlog::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n, int*
 
   s = queue_->Append(pstd::Slice(buf, kHeaderSize));
   if (s.ok()) {
+    // flushed once per group by WriteGroup
     s = queue_->Append(pstd::Slice(ptr, n));
-    if (s.ok()) {
-      s = queue_->Flush();
-    }
   }
   block_offset_ += static_cast<int32_t>(kHeaderSize + n);
 
@@ -279,7 +392,6 @@ Status Binlog::Produce(const pstd::Slice& item, int* temp_pro_offset) {
   size_t left = item.size();
   bool begin = true;
 
-  *temp_pro_offset = static_cast<int>(version_->pro_offset_);
   do {
     const int leftover = static_cast<int>(kBlockSize) - block_offset_;
     assert(leftover >= 0);
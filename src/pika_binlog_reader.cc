@@ -5,19 +5,89 @@
 
 #include "include/pika_binlog_reader.h"
 
+#include <fcntl.h>
 #include <glog/logging.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <unordered_map>
 
 using pstd::Status;
 
+namespace {
+
+// path => the newest mapping of the file, kept alive by its readers
+pstd::Mutex mapped_files_mu;
+std::unordered_map<std::string, std::weak_ptr<PikaBinlogMappedFile>> mapped_files;
+
+}  // namespace
+
+PikaBinlogMappedFile::~PikaBinlogMappedFile() {
+  munmap(const_cast<char*>(data_), size_);
+}
+
+Status PikaBinlogMappedFile::Open(const std::string& path, uint64_t min_size,
+                                  std::shared_ptr<PikaBinlogMappedFile>* file) {
+  file->reset();
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    LOG(WARNING) << "Binlog reader: open " << path << " failed, errno: " << errno;
+    return Status::IOError("open binlog failed", path);
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    LOG(WARNING) << "Binlog reader: fstat " << path << " failed, errno: " << errno;
+    close(fd);
+    return Status::IOError("fstat binlog failed", path);
+  }
+  if (st.st_size == 0 || static_cast<uint64_t>(st.st_size) < min_size) {
+    close(fd);
+    return Status::EndFile("binlog shorter than required", path);
+  }
+  const auto file_size = static_cast<uint64_t>(st.st_size);
+
+  std::lock_guard l(mapped_files_mu);
+  auto iter = mapped_files.find(path);
+  if (iter != mapped_files.end()) {
+    std::shared_ptr<PikaBinlogMappedFile> mapped = iter->second.lock();
+    // a mapping made before the file was trimmed or recreated can't be used,
+    // touching its pages past the end of the file raises SIGBUS
+    if (mapped && mapped->ino_ == st.st_ino && mapped->size_ >= min_size && mapped->size_ <= file_size) {
+      close(fd);
+      *file = std::move(mapped);
+      return Status::OK();
+    }
+  }
+
+  void* ptr = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) {  // NOLINT
+    LOG(WARNING) << "Binlog reader: mmap " << path << " failed, errno: " << errno;
+    return Status::IOError("mmap binlog failed", path);
+  }
+  madvise(ptr, file_size, MADV_SEQUENTIAL);
+  file->reset(new PikaBinlogMappedFile(static_cast<const char*>(ptr), file_size, static_cast<uint64_t>(st.st_ino)));
+
+  // forget the files nobody reads any more
+  for (auto it = mapped_files.begin(); it != mapped_files.end();) {
+    if (it->second.expired()) {
+      it = mapped_files.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  mapped_files[path] = *file;
+  return Status::OK();
+}
+
 PikaBinlogReader::PikaBinlogReader(uint32_t cur_filenum, uint64_t cur_offset)
     : cur_filenum_(cur_filenum),
-      cur_offset_(cur_offset),
-      backing_store_(std::make_unique<char[]>(kBlockSize)),
-      buffer_() {
+      cur_offset_(cur_offset) {
   last_record_offset_ = cur_offset % kBlockSize;
 }
 
-PikaBinlogReader::PikaBinlogReader() : backing_store_(std::make_unique<char[]>(kBlockSize)), buffer_() {
+PikaBinlogReader::PikaBinlogReader() {
   last_record_offset_ = 0 % kBlockSize;
 }
 
@@ -41,25 +111,16 @@ int PikaBinlogReader::Seek(const std::shared_ptr<Binlog>& logger, uint32_t filen
     LOG(WARNING) << confile << " not exits";
     return -1;
   }
-  std::unique_ptr<pstd::SequentialFile> readfile;
-  if (!pstd::NewSequentialFile(confile, readfile).ok()) {
-    LOG(WARNING) << "New swquential " << confile << " failed";
-    return -1;
-  }
-  if (queue_) {
-    queue_.reset();
-  }
-  queue_ = std::move(readfile);
   logger_ = logger;
+  OpenFile(filenum);
 
   std::lock_guard l(rwlock_);
   cur_filenum_ = filenum;
   cur_offset_ = offset;
   last_record_offset_ = cur_filenum_ % kBlockSize;
 
-  pstd::Status s;
   uint64_t start_block = (cur_offset_ / kBlockSize) * kBlockSize;
-  s = queue_->Skip((cur_offset_ / kBlockSize) * kBlockSize);
+  read_pos_ = start_block;
   uint64_t block_offset = cur_offset_ % kBlockSize;
   uint64_t ret = 0;
   uint64_t res = 0;
@@ -81,20 +142,65 @@ int PikaBinlogReader::Seek(const std::shared_ptr<Binlog>& logger, uint32_t filen
   return 0;
 }
 
+void PikaBinlogReader::OpenFile(uint32_t filenum) {
+  filename_ = NewFileName(logger_->filename(), filenum);
+  file_.reset();
+  read_pos_ = 0;
+  read_limit_ = 0;
+}
+
+Status PikaBinlogReader::Read(uint64_t n, pstd::Slice* result) {
+  if (read_pos_ + n > read_limit_) {
+    uint32_t pro_num = 0;
+    uint64_t pro_offset = 0;
+    logger_->GetProducerStatus(&pro_num, &pro_offset);
+    if (pro_num < cur_filenum_) {
+      return Status::EndFile("Not written yet");
+    }
+    Status s;
+    if (pro_num == cur_filenum_) {
+      // the file is still being written, only the bytes
+      // before the producer offset are complete
+      if (read_pos_ + n > pro_offset) {
+        return Status::EndFile("Not written yet");
+      }
+      if (!file_ || file_->size() < pro_offset) {
+        s = PikaBinlogMappedFile::Open(filename_, pro_offset, &file_);
+      }
+      read_limit_ = file_ ? pro_offset : 0;
+    } else {
+      // the writer trims a file to its final size before rolling
+      // to the next one, map it again to get that size
+      s = PikaBinlogMappedFile::Open(filename_, 0, &file_);
+      read_limit_ = file_ ? file_->size() : 0;
+      if (s.ok() && read_pos_ + n > read_limit_) {
+        // only the end of the final file moves the reader to the next one,
+        // a record cut short by it is not
+        return read_pos_ >= read_limit_ ? Status::EndFile("End of binlog")
+                                        : Status::Corruption("Binlog record truncated", filename_);
+      }
+    }
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  *result = pstd::Slice(file_->data() + read_pos_, n);
+  read_pos_ += n;
+  return Status::OK();
+}
+
 bool PikaBinlogReader::GetNext(uint64_t* size) {
   uint64_t offset = 0;
-  pstd::Status s;
+  pstd::Slice buffer;
   bool is_error = false;
 
   while (true) {
-    buffer_.clear();
-    s = queue_->Read(kHeaderSize, &buffer_, backing_store_.get());
-    if (!s.ok()) {
+    if (!Read(kHeaderSize, &buffer).ok()) {
       is_error = true;
       return is_error;
     }
 
-    const char* header = buffer_.data();
+    const char* header = buffer.data();
     const uint32_t a = static_cast<uint32_t>(header[0]) & 0xff;
     const uint32_t b = static_cast<uint32_t>(header[1]) & 0xff;
     const uint32_t c = static_cast<uint32_t>(header[2]) & 0xff;
@@ -106,21 +212,36 @@ bool PikaBinlogReader::GetNext(uint64_t* size) {
     }
 
     if (type == kFullType) {
-      s = queue_->Read(length, &buffer_, backing_store_.get());
+      if (!Read(length, &buffer).ok()) {
+        is_error = true;
+        break;
+      }
       offset += kHeaderSize + length;
       break;
     } else if (type == kFirstType) {
-      s = queue_->Read(length, &buffer_, backing_store_.get());
+      if (!Read(length, &buffer).ok()) {
+        is_error = true;
+        break;
+      }
       offset += kHeaderSize + length;
     } else if (type == kMiddleType) {
-      s = queue_->Read(length, &buffer_, backing_store_.get());
+      if (!Read(length, &buffer).ok()) {
+        is_error = true;
+        break;
+      }
       offset += kHeaderSize + length;
     } else if (type == kLastType) {
-      s = queue_->Read(length, &buffer_, backing_store_.get());
+      if (!Read(length, &buffer).ok()) {
+        is_error = true;
+        break;
+      }
       offset += kHeaderSize + length;
       break;
     } else if (type == kBadRecord) {
-      s = queue_->Read(length, &buffer_, backing_store_.get());
+      if (!Read(length, &buffer).ok()) {
+        is_error = true;
+        break;
+      }
       offset += kHeaderSize + length;
       break;
     } else {
@@ -133,22 +254,19 @@ bool PikaBinlogReader::GetNext(uint64_t* size) {
 }
 
 unsigned int PikaBinlogReader::ReadPhysicalRecord(pstd::Slice* result, uint32_t* filenum, uint64_t* offset) {
-  pstd::Status s;
   if (kBlockSize - last_record_offset_ <= kHeaderSize) {
-    queue_->Skip(kBlockSize - last_record_offset_);
+    read_pos_ += kBlockSize - last_record_offset_;
     std::lock_guard l(rwlock_);
     cur_offset_ += (kBlockSize - last_record_offset_);
     last_record_offset_ = 0;
   }
-  buffer_.clear();
-  s = queue_->Read(kHeaderSize, &buffer_, backing_store_.get());
-  if (s.IsEndFile()) {
-    return kEof;
-  } else if (!s.ok()) {
-    return kBadRecord;
+  pstd::Slice buffer;
+  Status s = Read(kHeaderSize, &buffer);
+  if (!s.ok()) {
+    return s.IsEndFile() ? kEof : kReadError;
   }
 
-  const char* header = buffer_.data();
+  const char* header = buffer.data();
   const uint32_t a = static_cast<uint32_t>(header[0]) & 0xff;
   const uint32_t b = static_cast<uint32_t>(header[1]) & 0xff;
   const uint32_t c = static_cast<uint32_t>(header[2]) & 0xff;
@@ -160,15 +278,18 @@ unsigned int PikaBinlogReader::ReadPhysicalRecord(pstd::Slice* result, uint32_t*
   }
 
   if (type == kZeroType || length == 0) {
-    buffer_.clear();
+    read_pos_ -= kHeaderSize;
     return kOldRecord;
   }
 
-  buffer_.clear();
-  s = queue_->Read(length, &buffer_, backing_store_.get());
-  *result = pstd::Slice(buffer_.data(), buffer_.size());
+  // a slice of the mapping, no copy
+  s = Read(length, result);
+  if (!s.ok()) {
+    read_pos_ -= kHeaderSize;
+    return s.IsEndFile() ? kEof : kReadError;
+  }
   last_record_offset_ += kHeaderSize + length;
-  if (s.ok()) {
+  {
     std::lock_guard l(rwlock_);
     *filenum = cur_filenum_;
     cur_offset_ += (kHeaderSize + length);
@@ -186,7 +307,7 @@ Status PikaBinlogReader::Consume(std::string* scratch, uint32_t* filenum, uint64
 
     switch (record_type) {
       case kFullType:
-        *scratch = std::string(fragment.data(), fragment.size());
+        scratch->assign(fragment.data(), fragment.size());
         s = Status::OK();
         break;
       case kFirstType:
@@ -209,6 +330,8 @@ Status PikaBinlogReader::Consume(std::string* scratch, uint32_t* filenum, uint64
         return Status::IOError("Data Corruption");
       case kOldRecord:
         return Status::EndFile("Eof");
+      case kReadError:
+        return Status::IOError("Read binlog failed");
       default:
         return Status::IOError("Unknow reason");
     }
@@ -224,7 +347,7 @@ Status PikaBinlogReader::Consume(std::string* scratch, uint32_t* filenum, uint64
 // Append to scratch;
 // the status will be OK, IOError or Corruption, EndFile;
 Status PikaBinlogReader::Get(std::string* scratch, uint32_t* filenum, uint64_t* offset) {
-  if (!logger_ || !queue_) {
+  if (!logger_ || filename_.empty()) {
     return Status::Corruption("Not seek");
   }
   scratch->clear();
@@ -234,8 +357,16 @@ Status PikaBinlogReader::Get(std::string* scratch, uint32_t* filenum, uint64_t*
     if (ReadToTheEnd()) {
       return Status::EndFile("End of cur log file");
     }
+    uint32_t pro_num = 0;
+    uint64_t pro_offset = 0;
+    logger_->GetProducerStatus(&pro_num, &pro_offset);
     s = Consume(scratch, filenum, offset);
     if (s.IsEndFile()) {
+      // only a file the writer had left before it was read is finished,
+      // otherwise the rest of it is still to come
+      if (pro_num <= cur_filenum_) {
+        return s;
+      }
       std::string confile = NewFileName(logger_->filename(), cur_filenum_ + 1);
 
       // sleep 10ms wait produce thread generate the new binlog
@@ -244,10 +375,7 @@ Status PikaBinlogReader::Get(std::string* scratch, uint32_t* filenum, uint64_t*
       // Roll to next file need retry;
       if (pstd::FileExists(confile)) {
         DLOG(INFO) << "BinlogSender roll to new binlog" << confile;
-        queue_.reset();
-        queue_ = nullptr;
-
-        pstd::NewSequentialFile(confile, queue_);
+        OpenFile(cur_filenum_ + 1);
         {
           std::lock_guard l(rwlock_);
           cur_filenum_++;
@@ -262,5 +390,5 @@ Status PikaBinlogReader::Get(std::string* scratch, uint32_t* filenum, uint64_t*
     }
   } while (s.IsEndFile());
 
-  return Status::OK();
+  return s;
 }
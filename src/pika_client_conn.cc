@@ -35,6 +35,13 @@ PikaClientConn::PikaClientConn(int fd, const std::string& ip_port, net::Thread*
   time_stat_.reset(new TimeStat());
 }
 
+net::WriteStatus PikaClientConn::SendReply() {
+  // read on every send, so CONFIG SET max-client-response-size also
+  // applies to connections that are already waiting for a slow reader
+  SetMaxReplyBytes(g_pika_conf->max_client_response_size());
+  return RedisConn::SendReply();
+}
+
 std::shared_ptr<Cmd> PikaClientConn::DoCmd(const PikaCmdArgsType& argv, const std::string& opt,
                                            const std::shared_ptr<std::string>& resp_ptr, bool cache_miss_in_rtc) {
   // Get command info
@@ -269,13 +276,79 @@ bool PikaClientConn::IsInterceptedByRTC(std::string& opt) {
   return false;
 }
 
-void PikaClientConn::ProcessRedisCmds(const std::vector<net::RedisCmdArgsType>& argvs, bool async,
+/*
+ * Fast reads execute inline on the net worker thread, which saves the
+ * BgTaskArg allocation, the argv copy and the two thread switches.
+ * Writes always go to the thread pool, they wait for the record lock of
+ * their keys, the binlog and the db lock, and would stall every other
+ * connection of the net thread meanwhile. For the same reason a read
+ * that may fill the cache, which locks its key on a miss, goes there
+ * too. A command whose inline execution exceeded the budget goes back
+ * to the thread pool for a while, see RunToCompletion.
+ */
+bool PikaClientConn::CanRunToCompletion(const std::vector<net::RedisCmdArgsType>& argvs) {
+  if (!g_pika_conf->run_to_completion() || argvs.size() > kRunToCompletionMaxBatch || IsInTxn() || IsPubSub()) {
+    return false;
+  }
+  uint64_t now = pstd::NowMicros();
+  auto cmdstat_map = g_pika_cmd_table_manager->GetCommandStatMap();
+  for (const auto& argv : argvs) {
+    if (argv.empty()) {
+      return false;
+    }
+    std::string opt = argv[0];
+    pstd::StringToLower(opt);
+    uint32_t flag = g_pika_cmd_table_manager->GetCmdFlag(opt);
+    if (!(flag & kCmdFlagsFast) || (flag & (kCmdFlagsWrite | kCmdFlagsSuspend | kCmdFlagsPubSub)) != 0 ||
+        g_pika_conf->is_slow_cmd(opt) || g_pika_conf->is_admin_cmd(opt)) {
+      return false;
+    }
+    if ((flag & kCmdFlagsDoThroughDB) && g_pika_conf->cache_mode() != PIKA_CACHE_NONE) {
+      return false;
+    }
+    auto iter = cmdstat_map->find(opt);
+    if (iter != cmdstat_map->end() && now < iter->second.rtc_suspended_until.load(std::memory_order_relaxed)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PikaClientConn::RunToCompletion(const std::vector<net::RedisCmdArgsType>& argvs) {
+  time_stat_->enqueue_ts_ = time_stat_->before_queue_ts_ = time_stat_->dequeue_ts_ = pstd::NowMicros();
+  uint64_t budget = g_pika_conf->run_to_completion_budget_us();
+  auto cmdstat_map = g_pika_cmd_table_manager->GetCommandStatMap();
+  resp_num.store(static_cast<int32_t>(argvs.size()));
+  for (const auto& argv : argvs) {
+    std::shared_ptr<std::string> resp_ptr = std::make_shared<std::string>();
+    resp_array.push_back(resp_ptr);
+    uint64_t start_us = pstd::NowMicros();
+    ExecRedisCmd(argv, resp_ptr, false);
+    uint64_t end_us = pstd::NowMicros();
+    if (end_us - start_us > budget) {
+      // it stalled the net thread, let the thread pool run it for a while
+      std::string opt = argv[0];
+      pstd::StringToLower(opt);
+      auto iter = cmdstat_map->find(opt);
+      if (iter != cmdstat_map->end()) {
+        iter->second.rtc_suspended_until.store(end_us + kRunToCompletionSuspendUs, std::memory_order_relaxed);
+      }
+    }
+  }
+  time_stat_->process_done_ts_ = pstd::NowMicros();
+  TryWriteResp();
+}
+
+void PikaClientConn::ProcessRedisCmds(std::vector<net::RedisCmdArgsType>&& argvs, bool async,
                                       std::string* response) {
   time_stat_->Reset();
+  if (async && CanRunToCompletion(argvs)) {
+    RunToCompletion(argvs);
+    return;
+  }
   if (async) {
     auto arg = new BgTaskArg();
     arg->cache_miss_in_rtc_ = false;
-    arg->redis_cmds = argvs;
     time_stat_->enqueue_ts_ = time_stat_->before_queue_ts_ = pstd::NowMicros();
     arg->conn_ptr = std::dynamic_pointer_cast<PikaClientConn>(shared_from_this());
     /**
@@ -303,6 +376,8 @@ void PikaClientConn::ProcessRedisCmds(const std::vector<net::RedisCmdArgsType>&
       time_stat_->before_queue_ts_ = pstd::NowMicros();
     }
 
+    // the parser handed the arguments over, no need to copy them
+    arg->redis_cmds = std::move(argvs);
     g_pika_server->ScheduleClientPool(&DoBackgroundTask, arg, is_slow_cmd, is_admin_cmd);
     return;
   }
@@ -390,7 +465,7 @@ void PikaClientConn::TryWriteResp() {
   int expected = 0;
   if (resp_num.compare_exchange_strong(expected, -1)) {
     for (auto& resp : resp_array) {
-      WriteResp(*resp);
+      WriteResp(resp);
     }
     if (write_completed_cb_) {
       write_completed_cb_();
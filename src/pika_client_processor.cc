@@ -7,8 +7,9 @@
 
 #include <glog/logging.h>
 
-PikaClientProcessor::PikaClientProcessor(size_t worker_num, size_t max_queue_size, const std::string& name_prefix) {
-  pool_ = std::make_unique<net::ThreadPool>(worker_num, max_queue_size, name_prefix + "Pool");
+PikaClientProcessor::PikaClientProcessor(size_t worker_num, size_t max_queue_size, const std::string& name_prefix,
+                                         bool work_stealing) {
+  pool_ = std::make_unique<net::ThreadPool>(worker_num, max_queue_size, name_prefix + "Pool", work_stealing);
 }
 
 PikaClientProcessor::~PikaClientProcessor() {
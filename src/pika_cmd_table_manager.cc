@@ -14,6 +14,55 @@
 
 extern std::unique_ptr<PikaConf> g_pika_conf;
 
+namespace {
+
+// Per thread free lists of pooled cmds, indexed by cmd id
+class CmdFreeLists {
+ public:
+  CmdFreeLists() = default;
+  ~CmdFreeLists() {
+    destroyed = true;
+    for (auto& free_list : free_lists_) {
+      for (Cmd* cmd : free_list) {
+        delete cmd;
+      }
+    }
+  }
+
+  Cmd* Pop(uint32_t cmd_id) {
+    if (cmd_id >= free_lists_.size() || free_lists_[cmd_id].empty()) {
+      return nullptr;
+    }
+    Cmd* cmd = free_lists_[cmd_id].back();
+    free_lists_[cmd_id].pop_back();
+    return cmd;
+  }
+
+  bool Push(Cmd* cmd) {
+    uint32_t cmd_id = cmd->GetCmdId();
+    if (cmd_id >= free_lists_.size()) {
+      free_lists_.resize(cmd_id + 1);
+    }
+    if (free_lists_[cmd_id].size() >= kCmdPoolMaxFreePerCmd) {
+      return false;
+    }
+    free_lists_[cmd_id].push_back(cmd);
+    return true;
+  }
+
+  // set once the free lists are gone at thread exit, a cmd released
+  // by another thread local's destructor is freed then
+  static thread_local bool destroyed;
+
+ private:
+  std::vector<std::vector<Cmd*>> free_lists_;
+};
+
+thread_local bool CmdFreeLists::destroyed = false;
+thread_local CmdFreeLists tls_cmd_free_lists;
+
+}  // namespace
+
 PikaCmdTableManager::PikaCmdTableManager() {
   cmds_ = std::make_unique<CmdTable>();
   cmds_->reserve(300);
@@ -72,14 +121,45 @@ std::shared_ptr<Cmd> PikaCmdTableManager::GetCmd(const std::string& opt) {
   return NewCommand(internal_opt);
 }
 
+uint32_t PikaCmdTableManager::GetCmdFlag(const std::string& opt) {
+  Cmd* cmd = GetCmdFromDB(opt, *cmds_);
+  return cmd ? cmd->flag() : 0;
+}
+
 std::shared_ptr<Cmd> PikaCmdTableManager::NewCommand(const std::string& opt) {
   Cmd* cmd = GetCmdFromDB(opt, *cmds_);
   if (cmd) {
+    if (cmd->hasFlag(kCmdFlagsPooled)) {
+      return AcquirePooledCmd(cmd);
+    }
     return std::shared_ptr<Cmd>(cmd->Clone());
   }
   return nullptr;
 }
 
+std::shared_ptr<Cmd> PikaCmdTableManager::AcquirePooledCmd(Cmd* prototype) {
+  Cmd* cmd = CmdFreeLists::destroyed ? nullptr : tls_cmd_free_lists.Pop(prototype->GetCmdId());
+  if (!cmd) {
+    cmd = prototype->Clone();
+  }
+  return std::shared_ptr<Cmd>(cmd, &PikaCmdTableManager::RecyclePooledCmd);
+}
+
+void PikaCmdTableManager::RecyclePooledCmd(Cmd* cmd) {
+  size_t argv_bytes = 0;
+  for (const auto& arg : cmd->argv()) {
+    argv_bytes += arg.size();
+  }
+  if (argv_bytes > kCmdPoolMaxArgvBytes || CmdFreeLists::destroyed) {
+    delete cmd;
+    return;
+  }
+  cmd->Reset();
+  if (!tls_cmd_free_lists.Push(cmd)) {
+    delete cmd;
+  }
+}
+
 CmdTable* PikaCmdTableManager::GetCmdTable() { return cmds_.get(); }
 
 uint32_t PikaCmdTableManager::GetMaxCmdId() { return cmdId_; }
@@ -13,6 +13,7 @@
 #include "include/pika_cmd_table_manager.h"
 #include "include/pika_conf.h"
 #include "include/pika_define.h"
+#include "storage/memory_governor.h"
 
 using pstd::Status;
 extern std::unique_ptr<PikaCmdTableManager> g_pika_cmd_table_manager;
@@ -178,6 +179,10 @@ int PikaConf::Load() {
     admin_thread_pool_size_ = 4;
   }
 
+  std::string work_stealing;
+  GetConfStr("thread-pool-work-stealing", &work_stealing);
+  thread_pool_work_stealing_ = work_stealing == "yes";
+
   std::string slow_cmd_list;
   GetConfStr("slow-cmd-list", &slow_cmd_list);
   SetSlowCmd(slow_cmd_list);
@@ -457,6 +462,50 @@ int PikaConf::Load() {
     small_compaction_duration_threshold_ = 1000000;
   }
 
+  multi_key_fanout_min_batch_ = 64;
+  GetConfInt("multi-key-fanout-min-batch", &multi_key_fanout_min_batch_);
+  if (multi_key_fanout_min_batch_ < 0) {
+    multi_key_fanout_min_batch_ = 0;
+  }
+
+  zset_rank_index_min_members_ = 0;
+  GetConfInt("zset-rank-index-min-members", &zset_rank_index_min_members_);
+  if (zset_rank_index_min_members_ < 0) {
+    zset_rank_index_min_members_ = 0;
+  }
+
+  list_node_max_elements_ = 0;
+  GetConfInt("list-node-max-elements", &list_node_max_elements_);
+  if (list_node_max_elements_ < 0) {
+    list_node_max_elements_ = 0;
+  } else if (list_node_max_elements_ > 8192) {
+    list_node_max_elements_ = 8192;
+  }
+
+  inline_collection_max_entries_ = 0;
+  GetConfInt("inline-collection-max-entries", &inline_collection_max_entries_);
+  if (inline_collection_max_entries_ < 0) {
+    inline_collection_max_entries_ = 0;
+  } else if (inline_collection_max_entries_ > 512) {
+    inline_collection_max_entries_ = 512;
+  }
+
+  compaction_meta_cache_size_ = 0;
+  GetConfInt64("compaction-meta-cache-size", &compaction_meta_cache_size_);
+  if (compaction_meta_cache_size_ < 0) {
+    compaction_meta_cache_size_ = 0;
+  }
+
+  std::string cms;
+  GetConfStr("compaction-meta-scan", &cms);
+  compaction_meta_scan_ = cms == "yes";
+
+  range_delete_min_entries_ = 0;
+  GetConfInt64("range-delete-min-entries", &range_delete_min_entries_);
+  if (range_delete_min_entries_ < 0) {
+    range_delete_min_entries_ = 0;
+  }
+
   // max-background-flushes and max-background-compactions should both be -1 or both not
   GetConfInt("max-background-flushes", &max_background_flushes_);
   if (max_background_flushes_ <= 0 && max_background_flushes_ != -1) {
@@ -520,6 +569,57 @@ int PikaConf::Load() {
   GetConfStr("share-block-cache", &sbc);
   share_block_cache_ = sbc == "yes";
 
+  std::string pbt;
+  GetConfStr("prefix-bloom-types", &pbt);
+  pstd::StringToLower(pbt);
+  pbt.erase(remove_if(pbt.begin(), pbt.end(), isspace), pbt.end());
+  std::vector<std::string> prefix_bloom_types;
+  pstd::StringSplit(pbt, COMMA, prefix_bloom_types);
+  prefix_bloom_types_.clear();
+  for (const auto& type : prefix_bloom_types) {
+    if (type == "hash" || type == "set" || type == "list" || type == "zset" || type == "streams") {
+      prefix_bloom_types_.push_back(type);
+    }
+  }
+
+  std::string mg;
+  GetConfStr("memory-governor", &mg);
+  memory_governor_ = mg == "yes";
+
+  // type:weight pairs, the zset weight goes to both zset column families
+  memory_governor_weights_.clear();
+  GetConfStr("memory-governor-weights", &memory_governor_weights_);
+  memory_governor_weights_.erase(
+      remove_if(memory_governor_weights_.begin(), memory_governor_weights_.end(), isspace),
+      memory_governor_weights_.end());
+  memory_governor_cf_weights_.assign(storage::kColumnFamilyNum, 1);
+  std::vector<std::string> cf_weights;
+  pstd::StringSplit(memory_governor_weights_, COMMA, cf_weights);
+  for (const auto& cf_weight : cf_weights) {
+    size_t colon = cf_weight.find(':');
+    long weight = 0;
+    if (colon == std::string::npos ||
+        pstd::string2int(cf_weight.data() + colon + 1, cf_weight.size() - colon - 1, &weight) == 0 || weight <= 0) {
+      continue;
+    }
+    std::string type = cf_weight.substr(0, colon);
+    pstd::StringToLower(type);
+    if (type == "meta") {
+      memory_governor_cf_weights_[storage::kMetaCF] = static_cast<uint32_t>(weight);
+    } else if (type == "hash") {
+      memory_governor_cf_weights_[storage::kHashesDataCF] = static_cast<uint32_t>(weight);
+    } else if (type == "set") {
+      memory_governor_cf_weights_[storage::kSetsDataCF] = static_cast<uint32_t>(weight);
+    } else if (type == "list") {
+      memory_governor_cf_weights_[storage::kListsDataCF] = static_cast<uint32_t>(weight);
+    } else if (type == "zset") {
+      memory_governor_cf_weights_[storage::kZsetsDataCF] = static_cast<uint32_t>(weight);
+      memory_governor_cf_weights_[storage::kZsetsScoreCF] = static_cast<uint32_t>(weight);
+    } else if (type == "streams") {
+      memory_governor_cf_weights_[storage::kStreamsDataCF] = static_cast<uint32_t>(weight);
+    }
+  }
+
   std::string epif;
   GetConfStr("enable-partitioned-index-filters", &epif);
   enable_partitioned_index_filters_ = epif == "yes";
@@ -550,6 +650,16 @@ int PikaConf::Load() {
   GetConfStr("rtc-cache-read", &rtc_enabled);
   rtc_cache_read_enabled_ = rtc_enabled != "no";
 
+  // execute fast commands in Net worker threads
+  std::string run_to_completion;
+  GetConfStr("run-to-completion", &run_to_completion);
+  run_to_completion_ = run_to_completion == "yes";
+  int run_to_completion_budget_us = 0;
+  GetConfInt("run-to-completion-budget-us", &run_to_completion_budget_us);
+  if (run_to_completion_budget_us > 0) {
+    run_to_completion_budget_us_ = run_to_completion_budget_us;
+  }
+
   // binlog
   std::string wb;
   GetConfStr("write-binlog", &wb);
@@ -684,6 +794,27 @@ int PikaConf::Load() {
     max_conn_rbuf_size_.store(tmp_max_conn_rbuf_size);
   }
 
+  // binlog batching and compression towards slaves
+  GetConfStr("replication-binlog-compression", &replication_binlog_compression_);
+  if (replication_binlog_compression_ != "lz4" && replication_binlog_compression_ != "zstd") {
+    replication_binlog_compression_ = "none";
+  }
+  int tmp_replication_batch_bytes = 0;
+  GetConfIntHuman("replication-batch-bytes", &tmp_replication_batch_bytes);
+  if (tmp_replication_batch_bytes < 0) {
+    replication_batch_bytes_.store(0);
+  } else if (tmp_replication_batch_bytes > PIKA_MAX_CONN_RBUF_LB) {
+    replication_batch_bytes_.store(PIKA_MAX_CONN_RBUF_LB);
+  } else {
+    replication_batch_bytes_.store(tmp_replication_batch_bytes);
+  }
+  int tmp_replication_batch_latency_ms = kReplBatchLatencyDefaultMs;
+  GetConfInt("replication-batch-latency-ms", &tmp_replication_batch_latency_ms);
+  if (tmp_replication_batch_latency_ms <= 0 || tmp_replication_batch_latency_ms > kReplBatchLatencyMaxMs) {
+    tmp_replication_batch_latency_ms = kReplBatchLatencyDefaultMs;
+  }
+  replication_batch_latency_ms_.store(tmp_replication_batch_latency_ms);
+
   // rocksdb blob configure
   GetConfBool("enable-blob-files", &enable_blob_files_);
   GetConfInt64Human("min-blob-size", &min_blob_size_);
@@ -718,6 +849,11 @@ int PikaConf::Load() {
     max_rsync_parallel_num_ = kMaxRsyncParallelNum;
   }
 
+  GetConfStr("rsync-checksum-type", &rsync_checksum_type_);
+  if (rsync_checksum_type_ != "none" && rsync_checksum_type_ != "md5") {
+    rsync_checksum_type_ = "crc32c";
+  }
+
   // rocksdb_statistics_tickers
   std::string open_tickers;
   GetConfStr("enable-db-statistics", &open_tickers);
@@ -801,7 +937,14 @@ int PikaConf::ConfigRewrite() {
   SetConfInt("max-cache-statistic-keys", max_cache_statistic_keys_);
   SetConfInt("small-compaction-threshold", small_compaction_threshold_);
   SetConfInt("small-compaction-duration-threshold", small_compaction_duration_threshold_);
-  SetConfInt("max-client-response-size", static_cast<int32_t>(max_client_response_size_));
+  SetConfInt("multi-key-fanout-min-batch", multi_key_fanout_min_batch_);
+  SetConfInt("zset-rank-index-min-members", zset_rank_index_min_members_);
+  SetConfInt("list-node-max-elements", list_node_max_elements_);
+  SetConfInt("inline-collection-max-entries", inline_collection_max_entries_);
+  SetConfInt64("compaction-meta-cache-size", compaction_meta_cache_size_);
+  SetConfStr("compaction-meta-scan", compaction_meta_scan_ ? "yes" : "no");
+  SetConfInt64("range-delete-min-entries", range_delete_min_entries_);
+  SetConfInt64("max-client-response-size", max_client_response_size_);
   SetConfInt("db-sync-speed", db_sync_speed_);
   SetConfStr("compact-cron", compact_cron_);
   SetConfStr("compact-interval", compact_interval_);
@@ -819,6 +962,9 @@ int PikaConf::ConfigRewrite() {
   SetConfInt("replication-num", replication_num_.load());
   SetConfStr("slow-cmd-list", pstd::Set2String(slow_cmd_set_, ','));
   SetConfInt("max-conn-rbuf-size", max_conn_rbuf_size_.load());
+  SetConfStr("replication-binlog-compression", replication_binlog_compression_);
+  SetConfInt("replication-batch-bytes", replication_batch_bytes_.load());
+  SetConfInt("replication-batch-latency-ms", replication_batch_latency_ms_.load());
   // options for storage engine
   SetConfInt("max-cache-files", max_cache_files_);
   SetConfInt("max-background-compactions", max_background_compactions_);
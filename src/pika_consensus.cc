@@ -355,6 +355,7 @@ Status ConsensusCoordinator::ProcessLeaderLog(const std::shared_ptr<Cmd>& cmd_pt
   } else {
     // this is a flushdb-binlog, both apply binlog and apply db are in sync way
     // ensure all writeDB task that submitted before has finished before we exec this flushdb
+    g_pika_rm->FlushWriteDBTasks(db_name_);
     int32_t wait_ms = 250;
     while (g_pika_rm->GetUnfinishedAsyncWriteDBTaskCount(db_name_) > 0) {
       std::this_thread::sleep_for(std::chrono::milliseconds(wait_ms));
@@ -111,6 +111,11 @@ void PikaReplBgWorker::HandleBGWorkerWriteBinlog(void* arg) {
     return;
   }
 
+  // apply what has been appended to binlog, even if the rest of the response is dropped
+  DEFER {
+    g_pika_rm->FlushWriteDBTasks(db_name);
+  };
+
   for (int i : *index) {
     const InnerMessage::InnerResponse::BinlogSync& binlog_res = res->binlog_sync(i);
     // if pika are not current a slave or DB not in
@@ -208,8 +213,9 @@ int PikaReplBgWorker::HandleWriteBinlog(net::RedisParser* parser, const net::Red
 
 void PikaReplBgWorker::HandleBGWorkerWriteDB(void* arg) {
   std::unique_ptr<ReplClientWriteDBTaskArg> task_arg(static_cast<ReplClientWriteDBTaskArg*>(arg));
-  const std::shared_ptr<Cmd> c_ptr = task_arg->cmd_ptr;
-  WriteDBInSyncWay(c_ptr);
+  for (const auto& c_ptr : task_arg->cmd_ptrs) {
+    WriteDBInSyncWay(c_ptr);
+  }
 }
 
 void PikaReplBgWorker::WriteDBInSyncWay(const std::shared_ptr<Cmd>& c_ptr) {
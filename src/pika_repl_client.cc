@@ -9,6 +9,8 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 
+#include <algorithm>
+#include <numeric>
 #include <utility>
 
 #include "net/include/net_cli.h"
@@ -17,6 +19,7 @@
 #include "pstd/include/pstd_coding.h"
 #include "pstd/include/pstd_string.h"
 
+#include "include/pika_repl_compression.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
 
@@ -119,18 +122,144 @@ void PikaReplClient::ScheduleWriteBinlogTask(const std::string& db_name,
 }
 
 void PikaReplClient::ScheduleWriteDBTask(const std::shared_ptr<Cmd>& cmd_ptr, const std::string& db_name) {
-  const PikaCmdArgsType& argv = cmd_ptr->argv();
-  std::string dispatch_key = argv.size() >= 2 ? argv[1] : argv[0];
-  size_t index = GetHashIndexByKey(dispatch_key);
-  auto task_arg = new ReplClientWriteDBTaskArg(cmd_ptr);
+  int32_t db_index = db_name.back() - '0';
+  assert(db_index >= 0 && db_index <= 7);
+  std::vector<std::shared_ptr<Cmd>>& pending_cmds = pending_write_db_cmds_[db_index];
+  pending_cmds.push_back(cmd_ptr);
+  if (pending_cmds.size() >= kReplApplyMaxBatch) {
+    FlushWriteDBTasks(db_name);
+  }
+}
+
+void PikaReplClient::FlushWriteDBTasks(const std::string& db_name) {
+  int32_t db_index = db_name.back() - '0';
+  assert(db_index >= 0 && db_index <= 7);
+  std::vector<std::shared_ptr<Cmd>> cmds;
+  cmds.swap(pending_write_db_cmds_[db_index]);
+
+  // a command without key may touch any key of the db, so everything before it
+  // has to be applied first and it is applied in sync way, just like flushdb
+  size_t begin = 0;
+  for (size_t i = 0; i < cmds.size(); ++i) {
+    std::vector<std::string> keys = cmds[i]->current_key();
+    if (!keys.empty() && std::find(keys.begin(), keys.end(), "") == keys.end()) {
+      continue;
+    }
+    DispatchWriteDBGroups(db_name, {cmds.begin() + static_cast<int64_t>(begin), cmds.begin() + static_cast<int64_t>(i)});
+    while (GetUnfinishedAsyncWriteDBTaskCount(db_name) > 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(300));
+    }
+    PikaReplBgWorker::WriteDBInSyncWay(cmds[i]);
+    begin = i + 1;
+  }
+  DispatchWriteDBGroups(db_name, {cmds.begin() + static_cast<int64_t>(begin), cmds.end()});
+}
+
+void PikaReplClient::DispatchWriteDBGroups(const std::string& db_name, const std::vector<std::shared_ptr<Cmd>>& cmds) {
+  // union the commands sharing any key into one group, the groups have no key in common
+  // and can be applied in parallel, each group keeps the binlog order of its commands
+  std::vector<size_t> parent(cmds.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find_root = [&parent](size_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+  std::vector<std::vector<std::string>> cmd_keys(cmds.size());
+  std::unordered_map<std::string, size_t> key_owner;
+  for (size_t i = 0; i < cmds.size(); ++i) {
+    cmd_keys[i] = cmds[i]->current_key();
+    for (const auto& key : cmd_keys[i]) {
+      auto iter = key_owner.emplace(key, i).first;
+      parent[find_root(i)] = find_root(iter->second);
+    }
+  }
+
+  std::unordered_map<size_t, size_t> group_index;
+  std::vector<std::vector<std::shared_ptr<Cmd>>> groups;
+  std::vector<std::vector<std::string>> group_keys;
+  for (size_t i = 0; i < cmds.size(); ++i) {
+    auto iter = group_index.emplace(find_root(i), groups.size()).first;
+    if (iter->second == groups.size()) {
+      groups.emplace_back();
+      group_keys.emplace_back();
+    }
+    groups[iter->second].push_back(cmds[i]);
+    for (const auto& key : cmd_keys[i]) {
+      // every key is added once, by the first command touching it
+      if (key_owner[key] == i) {
+        group_keys[iter->second].push_back(key);
+      }
+    }
+  }
 
-  IncrAsyncWriteDBTaskCount(db_name, 1);
-  std::function<void()> task_finish_call_back = [this, db_name]() { this->DecrAsyncWriteDBTaskCount(db_name, 1); };
+  for (size_t i = 0; i < groups.size(); ++i) {
+    DispatchWriteDBGroup(db_name, std::move(groups[i]), std::move(group_keys[i]));
+  }
+}
+
+void PikaReplClient::DispatchWriteDBGroup(const std::string& db_name, std::vector<std::shared_ptr<Cmd>> group,
+                                          std::vector<std::string> keys) {
+  for (auto& key : keys) {
+    key.insert(0, db_name);
+  }
+  size_t hash_index = GetHashIndexByKey(keys.front());
+  size_t index = hash_index;
+  {
+    // commands of earlier batches on the same keys may still be queued, the group has to go
+    // to the worker holding them, or wait until they are spread over one worker at most
+    std::unique_lock lock(inflight_keys_mu_);
+    inflight_keys_cv_.wait(lock, [&] {
+      index = hash_index;
+      bool held = false;
+      for (const auto& key : keys) {
+        auto iter = inflight_keys_.find(key);
+        if (iter == inflight_keys_.end()) {
+          continue;
+        }
+        if (held && iter->second.first != index) {
+          return false;
+        }
+        index = iter->second.first;
+        held = true;
+      }
+      return true;
+    });
+    for (const auto& key : keys) {
+      auto& inflight_key = inflight_keys_[key];
+      inflight_key.first = index;
+      inflight_key.second++;
+    }
+  }
+
+  auto cmd_num = static_cast<int32_t>(group.size());
+  auto task_arg = new ReplClientWriteDBTaskArg(std::move(group));
+  IncrAsyncWriteDBTaskCount(db_name, cmd_num);
+  std::function<void()> task_finish_call_back = [this, db_name, keys = std::move(keys), cmd_num]() {
+    this->FinishWriteDBGroup(db_name, keys, cmd_num);
+  };
 
   write_db_workers_[index]->Schedule(&PikaReplBgWorker::HandleBGWorkerWriteDB, static_cast<void*>(task_arg),
                                      task_finish_call_back);
 }
 
+void PikaReplClient::FinishWriteDBGroup(const std::string& db_name, const std::vector<std::string>& keys,
+                                        int32_t cmd_num) {
+  {
+    std::lock_guard lock(inflight_keys_mu_);
+    for (const auto& key : keys) {
+      auto iter = inflight_keys_.find(key);
+      if (iter != inflight_keys_.end() && --iter->second.second == 0) {
+        inflight_keys_.erase(iter);
+      }
+    }
+  }
+  inflight_keys_cv_.notify_all();
+  DecrAsyncWriteDBTaskCount(db_name, cmd_num);
+}
+
 size_t PikaReplClient::GetBinlogWorkerIndexByDBName(const std::string &db_name) {
     char db_num_c = db_name.back();
     int32_t db_num = db_num_c - '0';
@@ -187,6 +316,9 @@ Status PikaReplClient::SendMetaSync() {
   if (!masterauth.empty()) {
     meta_sync->set_auth(masterauth);
   }
+  for (auto compression : SupportedBinlogCompressions()) {
+    meta_sync->add_binlog_compressions(compression);
+  }
 
   std::string to_send;
   std::string master_ip = g_pika_server->master_ip();
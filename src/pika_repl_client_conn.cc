@@ -9,6 +9,7 @@
 #include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <sys/time.h>
 
+#include "include/pika_repl_compression.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
 #include "pstd/include/pstd_string.h"
@@ -72,6 +73,11 @@ int PikaReplClientConn::DealMessage() {
       break;
     }
     case InnerMessage::kBinlogSync: {
+      Status s = DecompressBinlogSync(response.get(), g_pika_conf->max_conn_rbuf_size());
+      if (!s.ok()) {
+        LOG(WARNING) << "Decompress binlog sync response failed: " << s.ToString();
+        return -1;
+      }
       DispatchBinlogRes(response);
       break;
     }
@@ -149,6 +155,10 @@ void PikaReplClientConn::HandleMetaSyncResponse(void* arg) {
     g_pika_conf->ConfigRewriteReplicationID();
   }
 
+  if (meta_sync.has_binlog_compression()) {
+    LOG(INFO) << "Master binlog compression: " << BinlogCompressionToString(meta_sync.binlog_compression());
+  }
+
   g_pika_conf->SetWriteBinlog("yes");
   g_pika_server->PrepareDBTrySync();
   g_pika_server->FinishMetaSync();
@@ -0,0 +1,142 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "include/pika_repl_compression.h"
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <lz4.h>
+#include <zstd.h>
+
+#include <memory>
+
+using pstd::Status;
+
+// The fastest zstd level, binlog is sent as it is produced
+const int kZstdBinlogLevel = 1;
+// Upper bound of the tags, compression and raw_size of a BinlogSyncBatch
+const size_t kBinlogSyncBatchHeaderBytes = 16;
+
+std::vector<InnerMessage::BinlogCompression> SupportedBinlogCompressions() {
+  return {InnerMessage::kCompressionLz4, InnerMessage::kCompressionZstd};
+}
+
+InnerMessage::BinlogCompression BinlogCompressionFromString(const std::string& name) {
+  if (name == "lz4") {
+    return InnerMessage::kCompressionLz4;
+  }
+  if (name == "zstd") {
+    return InnerMessage::kCompressionZstd;
+  }
+  return InnerMessage::kCompressionNone;
+}
+
+std::string BinlogCompressionToString(InnerMessage::BinlogCompression compression) {
+  switch (compression) {
+    case InnerMessage::kCompressionLz4:
+      return "lz4";
+    case InnerMessage::kCompressionZstd:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+static bool Compress(InnerMessage::BinlogCompression compression, const std::string& raw, std::string* compressed) {
+  switch (compression) {
+    case InnerMessage::kCompressionLz4: {
+      if (raw.size() > LZ4_MAX_INPUT_SIZE) {
+        return false;
+      }
+      compressed->resize(LZ4_compressBound(static_cast<int>(raw.size())));
+      int n = LZ4_compress_default(raw.data(), compressed->data(), static_cast<int>(raw.size()),
+                                   static_cast<int>(compressed->size()));
+      if (n <= 0) {
+        return false;
+      }
+      compressed->resize(n);
+      return true;
+    }
+    case InnerMessage::kCompressionZstd: {
+      // creating a context costs more than compressing a small batch, keep one per sending thread
+      thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx(ZSTD_createCCtx(), ZSTD_freeCCtx);
+      compressed->resize(ZSTD_compressBound(raw.size()));
+      size_t n = ZSTD_compressCCtx(cctx.get(), compressed->data(), compressed->size(), raw.data(), raw.size(),
+                                   kZstdBinlogLevel);
+      if (ZSTD_isError(n) != 0) {
+        return false;
+      }
+      compressed->resize(n);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+bool CompressBinlogSync(InnerMessage::BinlogCompression compression, InnerMessage::InnerResponse* response,
+                        size_t* saved_bytes) {
+  if (compression == InnerMessage::kCompressionNone || response->binlog_sync_size() == 0) {
+    return false;
+  }
+  InnerMessage::InnerResponse entries;
+  entries.mutable_binlog_sync()->Swap(response->mutable_binlog_sync());
+  std::string raw;
+  std::string compressed;
+  if (!entries.SerializePartialToString(&raw) || raw.size() < kMinCompressBinlogBytes ||
+      !Compress(compression, raw, &compressed) || compressed.size() + kBinlogSyncBatchHeaderBytes >= raw.size()) {
+    response->mutable_binlog_sync()->Swap(entries.mutable_binlog_sync());
+    return false;
+  }
+
+  InnerMessage::InnerResponse::BinlogSyncBatch* batch = response->mutable_binlog_sync_batch();
+  batch->set_compression(compression);
+  batch->set_raw_size(static_cast<uint32_t>(raw.size()));
+  batch->set_data(std::move(compressed));
+  *saved_bytes = raw.size() - batch->data().size();
+  return true;
+}
+
+Status DecompressBinlogSync(InnerMessage::InnerResponse* response, size_t max_raw_size) {
+  if (!response->has_binlog_sync_batch()) {
+    return Status::OK();
+  }
+  const InnerMessage::InnerResponse::BinlogSyncBatch& batch = response->binlog_sync_batch();
+  if (batch.raw_size() > max_raw_size) {
+    return Status::Corruption("binlog sync batch of " + std::to_string(batch.raw_size()) + " bytes exceeds limit");
+  }
+  std::string raw(batch.raw_size(), '\0');
+  switch (batch.compression()) {
+    case InnerMessage::kCompressionLz4: {
+      int n = LZ4_decompress_safe(batch.data().data(), raw.data(), static_cast<int>(batch.data().size()),
+                                  static_cast<int>(raw.size()));
+      if (n != static_cast<int>(raw.size())) {
+        return Status::Corruption("lz4 binlog sync batch decompress failed");
+      }
+      break;
+    }
+    case InnerMessage::kCompressionZstd: {
+      thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(ZSTD_createDCtx(), ZSTD_freeDCtx);
+      size_t n = ZSTD_decompressDCtx(dctx.get(), raw.data(), raw.size(), batch.data().data(), batch.data().size());
+      if (ZSTD_isError(n) != 0 || n != raw.size()) {
+        return Status::Corruption("zstd binlog sync batch decompress failed");
+      }
+      break;
+    }
+    default:
+      return Status::NotSupported("binlog sync batch compression " + std::to_string(batch.compression()));
+  }
+
+  InnerMessage::InnerResponse entries;
+  ::google::protobuf::io::ArrayInputStream input(raw.data(), static_cast<int>(raw.size()));
+  ::google::protobuf::io::CodedInputStream decoder(&input);
+  decoder.SetTotalBytesLimit(static_cast<int>(max_raw_size));
+  if (!entries.MergePartialFromCodedStream(&decoder) || !decoder.ConsumedEntireMessage()) {
+    return Status::Corruption("binlog sync batch parse failed");
+  }
+  response->mutable_binlog_sync()->Swap(entries.mutable_binlog_sync());
+  response->clear_binlog_sync_batch();
+  return Status::OK();
+}
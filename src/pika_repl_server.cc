@@ -7,7 +7,9 @@
 
 #include <glog/logging.h>
 
+#include "net/include/net_stats.h"
 #include "include/pika_conf.h"
+#include "include/pika_repl_compression.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
 
@@ -15,6 +17,7 @@ using pstd::Status;
 
 extern PikaServer* g_pika_server;
 extern std::unique_ptr<PikaReplicaManager> g_pika_rm;
+extern std::unique_ptr<net::NetworkStatistic> g_network_statistic;
 
 PikaReplServer::PikaReplServer(const std::set<std::string>& ips, int port, int cron_interval) {
   server_tp_ = std::make_unique<net::ThreadPool>(PIKA_REPL_SERVER_TP_SIZE, 100000, "PikaReplServer");
@@ -56,11 +59,31 @@ pstd::Status PikaReplServer::SendSlaveBinlogChips(const std::string& ip, int por
   InnerMessage::InnerResponse response;
   BuildBinlogSyncResp(tasks, &response);
 
+  InnerMessage::BinlogCompression compression = InnerMessage::kCompressionNone;
+  {
+    std::shared_lock l(client_conn_rwlock_);
+    auto iter = client_compression_map_.find(pstd::IpPortString(ip, port));
+    if (iter != client_compression_map_.end()) {
+      compression = iter->second;
+    }
+  }
+
   std::string binlog_chip_pb;
   if (!response.SerializeToString(&binlog_chip_pb)) {
     return Status::Corruption("Serialized Failed");
   }
 
+  // the slave decompresses into a buffer of the same limit, so it applies to the plain size
+  if (binlog_chip_pb.size() <= static_cast<size_t>(g_pika_conf->max_conn_rbuf_size())) {
+    size_t saved_bytes = 0;
+    if (CompressBinlogSync(compression, &response, &saved_bytes)) {
+      if (!response.SerializeToString(&binlog_chip_pb)) {
+        return Status::Corruption("Serialized Failed");
+      }
+      g_network_statistic->IncrReplSavedBytes(saved_bytes);
+    }
+  }
+
   if (binlog_chip_pb.size() > static_cast<size_t>(g_pika_conf->max_conn_rbuf_size())) {
     for (const auto& task : tasks) {
       InnerMessage::InnerResponse response;
@@ -134,11 +157,18 @@ void PikaReplServer::UpdateClientConnMap(const std::string& ip_port, int fd) {
   client_conn_map_[ip_port] = fd;
 }
 
+void PikaReplServer::UpdateClientBinlogCompression(const std::string& ip_port,
+                                                   InnerMessage::BinlogCompression compression) {
+  std::lock_guard l(client_conn_rwlock_);
+  client_compression_map_[ip_port] = compression;
+}
+
 void PikaReplServer::RemoveClientConn(int fd) {
   std::lock_guard l(client_conn_rwlock_);
   auto iter = client_conn_map_.begin();
   while (iter != client_conn_map_.end()) {
     if (iter->second == fd) {
+      client_compression_map_.erase(iter->first);
       iter = client_conn_map_.erase(iter);
       break;
     }
@@ -7,6 +7,9 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
+#include "include/pika_repl_compression.h"
 #include "include/pika_rm.h"
 #include "include/pika_server.h"
 
@@ -55,6 +58,16 @@ void PikaReplServerConn::HandleMetaSyncRequest(void* arg) {
       meta_sync->set_classic_mode(g_pika_conf->classic_mode());
       meta_sync->set_run_id(g_pika_conf->run_id());
       meta_sync->set_replication_id(g_pika_conf->replication_id());
+      // compress binlog only if the slave is able to decode it
+      InnerMessage::BinlogCompression compression =
+          BinlogCompressionFromString(g_pika_conf->replication_binlog_compression());
+      const auto& slave_compressions = meta_sync_request.binlog_compressions();
+      if (std::find(slave_compressions.begin(), slave_compressions.end(), compression) == slave_compressions.end()) {
+        compression = InnerMessage::kCompressionNone;
+      }
+      meta_sync->set_binlog_compression(compression);
+      g_pika_rm->ReplServerUpdateClientBinlogCompression(ip_port, compression);
+      LOG(INFO) << "Slave " << ip_port << " binlog compression: " << BinlogCompressionToString(compression);
       for (const auto& db_struct : db_structs) {
         InnerMessage::InnerResponse_MetaSync_DBInfo* db_info = meta_sync->add_dbs_info();
         db_info->set_db_name(db_struct.db_name);
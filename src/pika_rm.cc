@@ -175,7 +175,7 @@ Status SyncMasterDB::ReadBinlogFileToWq(const std::shared_ptr<SlaveNode>& slave_
     slave_ptr->sync_win.Push(SyncWinItem(sent_offset, msg.size()));
     slave_ptr->SetLastSendTime(pstd::NowMicros());
     RmNode rm_node(slave_ptr->Ip(), slave_ptr->Port(), slave_ptr->DBName(), slave_ptr->SessionId());
-    WriteTask task(rm_node, BinlogChip(sent_offset, msg), slave_ptr->sent_offset);
+    WriteTask task(rm_node, BinlogChip(sent_offset, std::move(msg)), slave_ptr->sent_offset);
     tasks.push_back(task);
     slave_ptr->sent_offset = sent_offset;
   }
@@ -583,37 +583,53 @@ void PikaReplicaManager::ProduceWriteQueue(const std::string& ip, int port, std:
                                            const std::vector<WriteTask>& tasks) {
   std::lock_guard l(write_queue_mu_);
   std::string index = ip + ":" + std::to_string(port);
+  SlaveWriteQueue& queue = write_queues_[index][db_name];
+  if (queue.tasks.empty()) {
+    queue.oldest_time_us = pstd::NowMicros();
+  }
   for (auto& task : tasks) {
-    write_queues_[index][db_name].push(task);
+    queue.bytes += task.binlog_chip_.binlog_.size();
+    queue.tasks.push(task);
   }
 }
 
 int PikaReplicaManager::ConsumeWriteQueue() {
   std::unordered_map<std::string, std::vector<std::vector<WriteTask>>> to_send_map;
   int counter = 0;
+  auto batch_bytes = static_cast<size_t>(g_pika_conf->replication_batch_bytes());
+  auto batch_latency_us = static_cast<uint64_t>(g_pika_conf->replication_batch_latency_ms()) * 1000;
+  uint64_t now = pstd::NowMicros();
+  has_held_binlog_ = false;
   {
     std::lock_guard l(write_queue_mu_);
     for (auto& iter : write_queues_) {
       const std::string& ip_port = iter.first;
-      std::unordered_map<std::string, std::queue<WriteTask>>& p_map = iter.second;
+      std::unordered_map<std::string, SlaveWriteQueue>& p_map = iter.second;
       for (auto& db_queue : p_map) {
-        std::queue<WriteTask>& queue = db_queue.second;
+        SlaveWriteQueue& queue = db_queue.second;
+        // hold a little binlog back so it leaves as one batch, which compresses
+        // better, unless its oldest entry already waited for the latency cap
+        if (!queue.tasks.empty() && queue.bytes < batch_bytes && now < queue.oldest_time_us + batch_latency_us) {
+          has_held_binlog_ = true;
+          continue;
+        }
         for (int i = 0; i < kBinlogSendPacketNum; ++i) {
-          if (queue.empty()) {
+          if (queue.tasks.empty()) {
             break;
           }
-          size_t batch_index = queue.size() > kBinlogSendBatchNum ? kBinlogSendBatchNum : queue.size();
           std::vector<WriteTask> to_send;
           size_t batch_size = 0;
-          for (size_t i = 0; i < batch_index; ++i) {
-            WriteTask& task = queue.front();
+          // a packet takes kBinlogSendBatchNum tasks, or more if it is still short of batch_bytes
+          while (!queue.tasks.empty() && (to_send.size() < kBinlogSendBatchNum || batch_size < batch_bytes)) {
+            WriteTask& task = queue.tasks.front();
             batch_size += task.binlog_chip_.binlog_.size();
             // make sure SerializeToString will not over 2G
             if (batch_size > PIKA_MAX_CONN_RBUF_HB) {
               break;
             }
+            queue.bytes -= task.binlog_chip_.binlog_.size();
             to_send.push_back(task);
-            queue.pop();
+            queue.tasks.pop();
             counter++;
           }
           if (!to_send.empty()) {
@@ -687,12 +703,21 @@ void PikaReplicaManager::ScheduleWriteDBTask(const std::shared_ptr<Cmd>& cmd_ptr
   pika_repl_client_->ScheduleWriteDBTask(cmd_ptr, db_name);
 }
 
+void PikaReplicaManager::FlushWriteDBTasks(const std::string& db_name) {
+  pika_repl_client_->FlushWriteDBTasks(db_name);
+}
+
 void PikaReplicaManager::ReplServerRemoveClientConn(int fd) { pika_repl_server_->RemoveClientConn(fd); }
 
 void PikaReplicaManager::ReplServerUpdateClientConnMap(const std::string& ip_port, int fd) {
   pika_repl_server_->UpdateClientConnMap(ip_port, fd);
 }
 
+void PikaReplicaManager::ReplServerUpdateClientBinlogCompression(const std::string& ip_port,
+                                                                 InnerMessage::BinlogCompression compression) {
+  pika_repl_server_->UpdateClientBinlogCompression(ip_port, compression);
+}
+
 Status PikaReplicaManager::UpdateSyncBinlogStatus(const RmNode& slave, const LogOffset& offset_start,
                                                   const LogOffset& offset_end) {
   std::shared_lock l(dbs_rw_);
@@ -81,9 +81,13 @@ PikaServer::PikaServer()
   pika_migrate_ = std::make_unique<PikaMigrate>();
   pika_migrate_thread_ = std::make_unique<PikaMigrateThread>();
 
-  pika_client_processor_ = std::make_unique<PikaClientProcessor>(g_pika_conf->thread_pool_size(), 100000);
-  pika_slow_cmd_thread_pool_ = std::make_unique<net::ThreadPool>(g_pika_conf->slow_cmd_thread_pool_size(), 100000);
-  pika_admin_cmd_thread_pool_ = std::make_unique<net::ThreadPool>(g_pika_conf->admin_thread_pool_size(), 100000);
+  bool work_stealing = g_pika_conf->thread_pool_work_stealing();
+  pika_client_processor_ =
+      std::make_unique<PikaClientProcessor>(g_pika_conf->thread_pool_size(), 100000, "CliProcessor", work_stealing);
+  pika_slow_cmd_thread_pool_ = std::make_unique<net::ThreadPool>(g_pika_conf->slow_cmd_thread_pool_size(), 100000,
+                                                                 "ThreadPool", work_stealing);
+  pika_admin_cmd_thread_pool_ = std::make_unique<net::ThreadPool>(g_pika_conf->admin_thread_pool_size(), 100000,
+                                                                  "ThreadPool", work_stealing);
   instant_ = std::make_unique<Instant>();
   exit_mutex_.lock();
   int64_t lastsave = GetLastSaveTime(g_pika_conf->bgsave_path());
@@ -341,6 +345,11 @@ storage::StorageOptions PikaServer::storage_options() {
   return storage_options_;
 }
 
+std::shared_ptr<storage::MemoryGovernor> PikaServer::memory_governor() {
+  std::shared_lock rwl(storage_options_rw_);
+  return storage_options_.memory_governor;
+}
+
 void PikaServer::InitDBStruct() {
   std::string db_path = g_pika_conf->db_path();
   std::string log_path = g_pika_conf->log_path();
@@ -479,6 +488,69 @@ void PikaServer::DBSetSmallCompactionDurationThreshold(uint32_t small_compaction
   }
 }
 
+void PikaServer::DBSetMultiKeyFanoutMinBatch(uint32_t multi_key_fanout_min_batch) {
+  std::shared_lock rwl(dbs_rw_);
+  for (const auto& db_item : dbs_) {
+    db_item.second->DBLockShared();
+    db_item.second->storage()->SetMultiKeyFanoutMinBatch(multi_key_fanout_min_batch);
+    db_item.second->DBUnlockShared();
+  }
+}
+
+void PikaServer::DBSetZSetRankIndexMinMembers(uint32_t zset_rank_index_min_members) {
+  std::shared_lock rwl(dbs_rw_);
+  for (const auto& db_item : dbs_) {
+    db_item.second->DBLockShared();
+    db_item.second->storage()->SetZSetRankIndexMinMembers(zset_rank_index_min_members);
+    db_item.second->DBUnlockShared();
+  }
+}
+
+void PikaServer::DBSetListNodeMaxElements(uint32_t list_node_max_elements) {
+  std::shared_lock rwl(dbs_rw_);
+  for (const auto& db_item : dbs_) {
+    db_item.second->DBLockShared();
+    db_item.second->storage()->SetListNodeMaxElements(list_node_max_elements);
+    db_item.second->DBUnlockShared();
+  }
+}
+
+void PikaServer::DBSetInlineCollectionMaxEntries(uint32_t inline_collection_max_entries) {
+  std::shared_lock rwl(dbs_rw_);
+  for (const auto& db_item : dbs_) {
+    db_item.second->DBLockShared();
+    db_item.second->storage()->SetInlineCollectionMaxEntries(inline_collection_max_entries);
+    db_item.second->DBUnlockShared();
+  }
+}
+
+void PikaServer::DBSetCompactionMetaCacheSize(size_t compaction_meta_cache_size) {
+  std::shared_lock rwl(dbs_rw_);
+  for (const auto& db_item : dbs_) {
+    db_item.second->DBLockShared();
+    db_item.second->storage()->SetCompactionMetaCacheSize(compaction_meta_cache_size);
+    db_item.second->DBUnlockShared();
+  }
+}
+
+void PikaServer::DBSetCompactionMetaScan(bool compaction_meta_scan) {
+  std::shared_lock rwl(dbs_rw_);
+  for (const auto& db_item : dbs_) {
+    db_item.second->DBLockShared();
+    db_item.second->storage()->SetCompactionMetaScan(compaction_meta_scan);
+    db_item.second->DBUnlockShared();
+  }
+}
+
+void PikaServer::DBSetRangeDeleteMinEntries(uint64_t range_delete_min_entries) {
+  std::shared_lock rwl(dbs_rw_);
+  for (const auto& db_item : dbs_) {
+    db_item.second->DBLockShared();
+    db_item.second->storage()->SetRangeDeleteMinEntries(range_delete_min_entries);
+    db_item.second->DBUnlockShared();
+  }
+}
+
 bool PikaServer::GetDBBinlogOffset(const std::string& db_name, BinlogOffset* const boffset) {
   std::shared_ptr<SyncMasterDB> db = g_pika_rm->GetSyncMasterDBByName(DBInfo(db_name));
   if (!db) {
@@ -1026,6 +1098,8 @@ size_t PikaServer::NetReplInputBytes() { return g_network_statistic->NetReplInpu
 
 size_t PikaServer::NetReplOutputBytes() { return g_network_statistic->NetReplOutputBytes(); }
 
+size_t PikaServer::NetReplSavedBytes() { return g_network_statistic->NetReplSavedBytes(); }
+
 float PikaServer::InstantaneousInputKbps() {
   return static_cast<float>(g_pika_server->instant_->getInstantaneousMetric(STATS_METRIC_NET_INPUT)) / 1024.0f;
 }
@@ -1122,6 +1196,15 @@ void PikaServer::DoTimingTask() {
   // Print the queue status periodically
   PrintThreadPoolQueueStatus();
   StatDiskUsage();
+  // Lend the unused block cache budget to the busy column families
+  RebalanceMemory();
+}
+
+void PikaServer::RebalanceMemory() {
+  std::shared_ptr<storage::MemoryGovernor> governor = memory_governor();
+  if (governor != nullptr) {
+    governor->Rebalance();
+  }
 }
 
 void PikaServer::StatDiskUsage() {
@@ -1465,11 +1548,24 @@ void PikaServer::InitStorageOptions() {
   storage_options_.table_options.cache_index_and_filter_blocks = g_pika_conf->cache_index_and_filter_blocks();
   storage_options_.block_cache_size = g_pika_conf->block_cache();
   storage_options_.share_block_cache = g_pika_conf->share_block_cache();
+  for (const auto& type_name : g_pika_conf->prefix_bloom_types()) {
+    for (auto type : {storage::DataType::kHashes, storage::DataType::kSets, storage::DataType::kLists,
+                      storage::DataType::kZSets, storage::DataType::kStreams}) {
+      if (type_name == storage::DataTypeToString(type)) {
+        storage_options_.prefix_bloom_types.push_back(type);
+      }
+    }
+  }
 
   storage_options_.table_options.pin_l0_filter_and_index_blocks_in_cache =
       g_pika_conf->pin_l0_filter_and_index_blocks_in_cache();
 
-  if (storage_options_.block_cache_size == 0) {
+  if (g_pika_conf->memory_governor()) {
+    storage_options_.memory_governor = std::make_shared<storage::MemoryGovernor>(
+        g_pika_conf->block_cache() + g_pika_conf->max_write_buffer_size(), g_pika_conf->max_write_buffer_size(),
+        g_pika_conf->memory_governor_cf_weights(), static_cast<int>(g_pika_conf->num_shard_bits()));
+    storage_options_.options.write_buffer_manager = storage_options_.memory_governor->write_buffer_manager();
+  } else if (storage_options_.block_cache_size == 0) {
     storage_options_.table_options.no_block_cache = true;
   } else if (storage_options_.share_block_cache) {
     storage_options_.table_options.block_cache =
@@ -1487,6 +1583,15 @@ void PikaServer::InitStorageOptions() {
   // For Storage small compaction
   storage_options_.statistics_max_size = g_pika_conf->max_cache_statistic_keys();
   storage_options_.small_compaction_threshold = g_pika_conf->small_compaction_threshold();
+  // For multi-key commands across db instances
+  storage_options_.multi_key_fanout_min_batch = g_pika_conf->multi_key_fanout_min_batch();
+  // For zset rank queries
+  storage_options_.zset_rank_index_min_members = g_pika_conf->zset_rank_index_min_members();
+  storage_options_.list_node_max_elements = g_pika_conf->list_node_max_elements();
+  storage_options_.inline_collection_max_entries = g_pika_conf->inline_collection_max_entries();
+  storage_options_.compaction_meta_cache_size = g_pika_conf->compaction_meta_cache_size();
+  storage_options_.compaction_meta_scan = g_pika_conf->compaction_meta_scan();
+  storage_options_.range_delete_min_entries = g_pika_conf->range_delete_min_entries();
 
   // rocksdb blob
   if (g_pika_conf->enable_blob_files()) {
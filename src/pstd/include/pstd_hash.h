@@ -76,6 +76,7 @@ documentation and/or software.
 #define __PSTD_HASH_H__
 #include <cstring>
 #include <iostream>
+#include <cstdint>
 #include <string>
 
 namespace pstd {
@@ -83,6 +84,10 @@ namespace pstd {
 std::string md5(const std::string& str, bool raw = false);
 std::string sha256(const std::string& input, bool raw = false);
 
+// CRC32C (Castagnoli), using the SSE4.2 or ARMv8 crc instructions when the
+// build enables them. Pass the previous result as crc to extend a checksum.
+uint32_t crc32c(uint32_t crc, const char* data, size_t n);
+
 bool isSha256(const std::string& input);
 
 // a small class for calculating MD5 hashes of strings or byte arrays
@@ -77,6 +77,12 @@
 #include <cstring>
 #include <fstream>
 
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
 namespace pstd {
 
 class SHA256 {
@@ -580,4 +586,59 @@ std::string md5(const std::string& str, bool raw) {
   return md5.hexdigest();
 }
 
+//////////////////////////////
+
+#if !defined(__SSE4_2__) && !defined(__ARM_FEATURE_CRC32)
+static uint32_t crc32c_table[256];
+
+static bool InitCrc32cTable() {
+  for (uint32_t i = 0; i < 256; i++) {
+    uint32_t crc = i;
+    for (int j = 0; j < 8; j++) {
+      crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+    }
+    crc32c_table[i] = crc;
+  }
+  return true;
+}
+#endif
+
+uint32_t crc32c(uint32_t crc, const char* data, size_t n) {
+  const auto* p = reinterpret_cast<const uint8_t*>(data);
+  crc = ~crc;
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+  uint64_t crc64 = crc;
+  while (n >= 8) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+#if defined(__SSE4_2__)
+    crc64 = _mm_crc32_u64(crc64, word);
+#else
+    crc64 = __crc32cd(static_cast<uint32_t>(crc64), word);
+#endif
+    p += 8;
+    n -= 8;
+  }
+  crc = static_cast<uint32_t>(crc64);
+  while (n > 0) {
+#if defined(__SSE4_2__)
+    crc = _mm_crc32_u8(crc, *p);
+#else
+    crc = __crc32cb(crc, *p);
+#endif
+    p++;
+    n--;
+  }
+#else
+  static bool table_inited = InitCrc32cTable();
+  (void)table_inited;
+  while (n > 0) {
+    crc = crc32c_table[(crc ^ *p) & 0xFF] ^ (crc >> 8);
+    p++;
+    n--;
+  }
+#endif
+  return ~crc;
+}
+
 }  // namespace pstd
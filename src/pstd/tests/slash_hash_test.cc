@@ -0,0 +1,52 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "pstd/include/pstd_hash.h"
+
+namespace pstd {
+
+class HashTest : public ::testing::Test {};
+
+// Test vectors from RFC 3720, section B.4
+TEST_F(HashTest, Crc32cStandardResults) {
+  std::string buf(32, '\0');
+  ASSERT_EQ(0x8a9136aaU, crc32c(0, buf.data(), buf.size()));
+
+  buf.assign(32, '\xff');
+  ASSERT_EQ(0x62a8ab43U, crc32c(0, buf.data(), buf.size()));
+
+  for (int i = 0; i < 32; i++) {
+    buf[i] = static_cast<char>(i);
+  }
+  ASSERT_EQ(0x46dd794eU, crc32c(0, buf.data(), buf.size()));
+
+  for (int i = 0; i < 32; i++) {
+    buf[i] = static_cast<char>(31 - i);
+  }
+  ASSERT_EQ(0x113fdb5cU, crc32c(0, buf.data(), buf.size()));
+
+  ASSERT_EQ(0xe3069283U, crc32c(0, "123456789", 9));
+  ASSERT_EQ(0U, crc32c(0, "", 0));
+}
+
+TEST_F(HashTest, Crc32cExtend) {
+  std::string data = "hello world, this string is longer than a couple of words";
+  uint32_t whole = crc32c(0, data.data(), data.size());
+  for (size_t split = 0; split <= data.size(); split++) {
+    uint32_t crc = crc32c(0, data.data(), split);
+    ASSERT_EQ(whole, crc32c(crc, data.data() + split, data.size() - split));
+  }
+  ASSERT_NE(crc32c(0, "a", 1), crc32c(0, "foo", 3));
+}
+
+TEST_F(HashTest, Md5) {
+  ASSERT_EQ("d41d8cd98f00b204e9800998ecf8427e", md5(""));
+  ASSERT_EQ("900150983cd24fb0d6963f7d28e17f72", md5("abc"));
+}
+
+}  // namespace pstd
@@ -4,12 +4,15 @@
 // of patent rights can be found in the PATENTS file in the same directory.
 
 #include <stdio.h>
+#include <algorithm>
+#include <deque>
 #include <fstream>
 
 #include "rocksdb/env.h"
 #include "pstd/include/pstd_defer.h"
 #include "include/pika_server.h"
 #include "include/rsync_client.h"
+#include "include/rsync_file_meta.h"
 
 using namespace net;
 using namespace pstd;
@@ -19,9 +22,28 @@ extern PikaServer* g_pika_server;
 
 const int kFlushIntervalUs = 10 * 1000 * 1000;
 const int kBytesPerRequest = 4 << 20;
+const int kMinBytesPerRequest = 1 << 20;
+const int kMaxBytesPerRequest = 8 << 20;
 const int kThrottleCheckCycle = 10;
 
 namespace rsync {
+
+struct InflightChunk {
+  size_t offset;
+  size_t count;
+  uint64_t send_time_us;
+};
+
+static ChecksumType ParseChecksumType(const std::string& type) {
+  if (type == "none") {
+    return kChecksumNone;
+  }
+  if (type == "md5") {
+    return kChecksumMd5;
+  }
+  return kChecksumCrc32c;
+}
+
 RsyncClient::RsyncClient(const std::string& dir, const std::string& db_name)
     : snapshot_uuid_(""), dir_(dir), db_name_(db_name),
       state_(IDLE), max_retries_(10), master_ip_(""), master_port_(0),
@@ -167,9 +189,19 @@ void* RsyncClient::ThreadMain() {
 Status RsyncClient::CopyRemoteFile(const std::string& filename, int index) {
     const std::string filepath = dir_ + "/" + filename;
     std::unique_ptr<RsyncWriter> writer(new RsyncWriter(filepath));
+    auto file_size = remote_file_sizes_.find(filename);
+    if (file_size != remote_file_sizes_.end()) {
+      writer->Preallocate(file_size->second);
+    }
     Status s = Status::OK();
+    // bytes written to the local file, and the offset of the next chunk to request
     size_t offset = 0;
+    size_t send_offset = 0;
+    size_t chunk_size = kBytesPerRequest;
     int retries = 0;
+    ChecksumType checksum_type = ParseChecksumType(g_pika_conf->rsync_checksum_type());
+    std::deque<InflightChunk> inflight;
+    WaitObject* wo = wo_mgr_->UpdateWaitObject(index, filename, kRsyncFile);
 
     DEFER {
       if (writer) {
@@ -181,55 +213,75 @@ Status RsyncClient::CopyRemoteFile(const std::string& filename, int index) {
       }
     };
 
+    // Forgets the chunks in flight and requests the file again from the
+    // first byte not written yet, their late responses get dropped
+    auto reset_window = [&]() {
+      inflight.clear();
+      wo->Reset(filename, kRsyncFile);
+      send_offset = offset;
+    };
+
     while (retries < max_retries_) {
       if (state_.load() != RUNNING) {
         break;
       }
-      size_t copy_file_begin_time = pstd::NowMicros();
-      size_t count = Throttle::GetInstance().ThrottledByThroughput(kBytesPerRequest);
-      if (count == 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / kThrottleCheckCycle));
-        continue;
+      while (inflight.size() < window_size_) {
+        size_t count = Throttle::GetInstance().ThrottledByThroughput(chunk_size);
+        if (count == 0) {
+          break;
+        }
+        RsyncRequest request;
+        request.set_reader_index(index);
+        request.set_type(kRsyncFile);
+        request.set_db_name(db_name_);
+        /*
+         * Since the slot field is written in protobuffer,
+         * slot_id is set to the default value 0 for compatibility
+         * with older versions, but slot_id is not used
+         */
+        request.set_slot_id(0);
+        FileRequest* file_req = request.mutable_file_req();
+        file_req->set_filename(filename);
+        file_req->set_offset(send_offset);
+        file_req->set_count(count);
+        file_req->set_checksum_type(checksum_type);
+        file_req->set_framed(true);
+
+        std::string to_send;
+        request.SerializeToString(&to_send);
+        wo->Expect(send_offset);
+        s = client_thread_->Write(master_ip_, master_port_, to_send);
+        if (!s.ok()) {
+          LOG(WARNING) << "send rsync request failed";
+          break;
+        }
+        inflight.push_back({send_offset, count, pstd::NowMicros()});
+        send_offset += count;
       }
-      RsyncRequest request;
-      request.set_reader_index(index);
-      request.set_type(kRsyncFile);
-      request.set_db_name(db_name_);
-      /*
-       * Since the slot field is written in protobuffer,
-       * slot_id is set to the default value 0 for compatibility
-       * with older versions, but slot_id is not used
-       */
-      request.set_slot_id(0);
-      FileRequest* file_req = request.mutable_file_req();
-      file_req->set_filename(filename);
-      file_req->set_offset(offset);
-      file_req->set_count(count);
-
-      std::string to_send;
-      request.SerializeToString(&to_send);
-      WaitObject* wo = wo_mgr_->UpdateWaitObject(index, filename, kRsyncFile, offset);
-      s = client_thread_->Write(master_ip_, master_port_, to_send);
-      if (!s.ok()) {
-        LOG(WARNING) << "send rsync request failed";
+      if (inflight.empty()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / kThrottleCheckCycle));
         continue;
       }
 
+      InflightChunk chunk = inflight.front();
       std::shared_ptr<RsyncResponse> resp = nullptr;
-      s = wo->Wait(resp);
+      s = wo->Wait(chunk.offset, resp);
       if (s.IsTimeout() || resp == nullptr) {
         LOG(WARNING) << s.ToString();
         retries++;
+        chunk_size = std::max(chunk_size / 2, static_cast<size_t>(kMinBytesPerRequest));
+        reset_window();
         continue;
       }
+      inflight.pop_front();
 
       if (resp->code() != RsyncService::kOk) {
         return Status::IOError("kRsyncFile request failed, master response error code");
       }
 
       size_t ret_count = resp->file_resp().count();
-      size_t elaspe_time_us = pstd::NowMicros() - copy_file_begin_time;
-      Throttle::GetInstance().ReturnUnusedThroughput(count, ret_count, elaspe_time_us);
+      size_t elaspe_time_us = pstd::NowMicros() - chunk.send_time_us;
+      Throttle::GetInstance().ReturnUnusedThroughput(chunk.count, ret_count, elaspe_time_us);
 
       if (resp->snapshot_uuid() != snapshot_uuid_) {
         LOG(WARNING) << "receive newer dump, reset state to STOP, local_snapshot_uuid:"
@@ -239,13 +291,33 @@ Status RsyncClient::CopyRemoteFile(const std::string& filename, int index) {
         return s;
       }
 
-      s = writer->Write((uint64_t)offset, ret_count, resp->file_resp().data().c_str());
+      // masters that do not know framed responses send the chunk in file_resp
+      const std::string& data = resp->has_payload() ? resp->payload() : resp->file_resp().data();
+      if (data.size() != ret_count) {
+        LOG(WARNING) << "rsync chunk size mismatch, filename: " << filename << ", offset: " << chunk.offset;
+        retries++;
+        reset_window();
+        continue;
+      }
+      // masters that do not know the checksum type send no checksum
+      if (!resp->file_resp().checksum().empty()) {
+        std::string checksum;
+        ChunkChecksum(checksum_type, data.data(), ret_count, &checksum);
+        if (checksum != resp->file_resp().checksum()) {
+          LOG(WARNING) << "rsync chunk checksum mismatch, filename: " << filename << ", offset: " << chunk.offset;
+          retries++;
+          reset_window();
+          continue;
+        }
+      }
+
+      s = writer->Write((uint64_t)offset, ret_count, data.data());
       if (!s.ok()) {
         LOG(WARNING) << "rsync client write file error";
         break;
       }
 
-      offset += resp->file_resp().count();
+      offset += ret_count;
       if (resp->file_resp().eof()) {
         s = writer->Fsync();
         if (!s.ok()) {
@@ -256,6 +328,19 @@ Status RsyncClient::CopyRemoteFile(const std::string& filename, int index) {
         mu_.unlock();
         break;
       }
+      if (ret_count != chunk.count) {
+        // older masters stop a chunk at their read ahead block boundary
+        reset_window();
+      }
+
+      // Grow the chunks while they come back well within the timeout, shrink
+      // them when the link or the master falls behind
+      uint64_t timeout_us = g_pika_conf->rsync_timeout_ms() * 1000;
+      if (elaspe_time_us < timeout_us / 8 && ret_count == chunk.count) {
+        chunk_size = std::min(chunk_size * 2, static_cast<size_t>(kMaxBytesPerRequest));
+      } else if (elaspe_time_us > timeout_us / 2) {
+        chunk_size = std::max(chunk_size / 2, static_cast<size_t>(kMinBytesPerRequest));
+      }
       retries = 0;
     }
 
@@ -288,8 +373,9 @@ bool RsyncClient::ComparisonUpdate() {
   std::set<std::string> local_file_set;
   std::set<std::string> remote_file_set;
   std::map<std::string, std::string> local_file_map;
+  std::map<std::string, FileMeta> remote_file_metas;
 
-  Status s = PullRemoteMeta(&remote_snapshot_uuid, &remote_file_set);
+  Status s = PullRemoteMeta(&remote_snapshot_uuid, &remote_file_set, &remote_file_metas);
   if (!s.ok()) {
     LOG(WARNING) << "copy remote meta failed! error:" << s.ToString();
     return false;
@@ -325,6 +411,11 @@ bool RsyncClient::ComparisonUpdate() {
     LOG(WARNING) << "clean up expired files failed";
     return false;
   }
+  ReuseLocalFiles(remote_file_metas);
+  remote_file_sizes_.clear();
+  for (const auto& [filename, file_meta] : remote_file_metas) {
+    remote_file_sizes_[filename] = file_meta.size();
+  }
   s = UpdateLocalMeta(snapshot_uuid_, expired_files, &local_file_map);
   if (!s.ok()) {
     LOG(WARNING) << "update local meta failed";
@@ -337,6 +428,8 @@ bool RsyncClient::ComparisonUpdate() {
             << " snapshot_uuid: " << snapshot_uuid_
             << " file count: " << file_set_.size()
             << " expired file count: " << expired_files.size()
+            << " reused file count: " << reused_file_count_.load()
+            << " reused bytes: " << reused_bytes_.load()
             << " local file count: " << local_file_set.size()
             << " remote file count: " << remote_file_set.size()
             << " remote snapshot_uuid: " << remote_snapshot_uuid
@@ -347,7 +440,8 @@ bool RsyncClient::ComparisonUpdate() {
   return true;
 }
 
-Status RsyncClient::PullRemoteMeta(std::string* snapshot_uuid, std::set<std::string>* file_set) {
+Status RsyncClient::PullRemoteMeta(std::string* snapshot_uuid, std::set<std::string>* file_set,
+                                   std::map<std::string, FileMeta>* file_metas) {
   Status s;
   int retries = 0;
   RsyncRequest request;
@@ -363,13 +457,14 @@ Status RsyncClient::PullRemoteMeta(std::string* snapshot_uuid, std::set<std::str
   std::string to_send;
   request.SerializeToString(&to_send);
   while (retries < max_retries_) {
-    WaitObject* wo = wo_mgr_->UpdateWaitObject(0, "", kRsyncMeta, kInvalidOffset);
+    WaitObject* wo = wo_mgr_->UpdateWaitObject(0, "", kRsyncMeta);
+    wo->Expect(kInvalidOffset);
     s = client_thread_->Write(master_ip_, master_port_, to_send);
     if (!s.ok()) {
       retries++;
     }
     std::shared_ptr<RsyncResponse> resp;
-    s = wo->Wait(resp);
+    s = wo->Wait(kInvalidOffset, resp);
     if (s.IsTimeout()) {
       LOG(WARNING) << "rsync PullRemoteMeta request timeout, "
                    << "retry times: " << retries;
@@ -389,6 +484,10 @@ Status RsyncClient::PullRemoteMeta(std::string* snapshot_uuid, std::set<std::str
     for (std::string item : resp->meta_resp().filenames()) {
       file_set->insert(item);
     }
+    for (const auto& item : resp->meta_resp().files()) {
+      (*file_metas)[item.filename()] = item;
+    }
+    window_size_ = std::clamp<uint32_t>(resp->meta_resp().window_size(), 1, kRsyncWindowSize);
 
     *snapshot_uuid = resp->snapshot_uuid();
     s = Status::OK();
@@ -397,6 +496,53 @@ Status RsyncClient::PullRemoteMeta(std::string* snapshot_uuid, std::set<std::str
   return s;
 }
 
+// SST files are immutable, so a table in the local db with the same name, size
+// and fingerprint as one in the master's dump holds the same bytes. Hard link
+// those into the sync dir and fetch only the rest from the master.
+void RsyncClient::ReuseLocalFiles(const std::map<std::string, FileMeta>& file_metas) {
+  reused_file_count_.store(0);
+  reused_bytes_.store(0);
+  if (file_metas.empty()) {
+    return;
+  }
+
+  std::string local_db_path = g_pika_conf->db_path() + db_name_ + "/";
+  std::string db_path = dir_ + (dir_.back() == '/' ? "" : "/");
+  for (const auto& [filename, file_meta] : file_metas) {
+    if (file_set_.find(filename) == file_set_.end() || !IsReusableFile(filename)) {
+      continue;
+    }
+    std::string local_file = local_db_path + filename;
+    struct stat st;
+    if (stat(local_file.c_str(), &st) != 0 || static_cast<uint64_t>(st.st_size) != file_meta.size()) {
+      continue;
+    }
+    uint64_t size = 0;
+    std::string checksum;
+    Status s = GetFileFingerprint(local_file, &size, &checksum);
+    if (!s.ok() || size != file_meta.size() || checksum != file_meta.checksum()) {
+      continue;
+    }
+
+    std::string target_file = db_path + filename;
+    DeleteFile(target_file);
+    if (link(local_file.c_str(), target_file.c_str()) != 0) {
+      int link_errno = errno;
+      LOG(WARNING) << "link local file failed, file: " << local_file << ", error: " << strerror(link_errno);
+      if (link_errno == EXDEV) {
+        // db-path and db-sync-path live on different devices, nothing can be linked
+        break;
+      }
+      continue;
+    }
+    file_set_.erase(filename);
+    reused_file_count_.fetch_add(1);
+    reused_bytes_.fetch_add(size);
+    std::lock_guard<std::mutex> guard(mu_);
+    meta_table_[filename] = "";
+  }
+}
+
 Status RsyncClient::LoadLocalMeta(std::string* snapshot_uuid, std::map<std::string, std::string>* file_map) {
   std::string meta_file_path = GetLocalMetaFilePath();
   if (!FileExists(meta_file_path)) {
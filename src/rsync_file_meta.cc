@@ -0,0 +1,128 @@
+// Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+#include "pstd/include/pstd_defer.h"
+#include "pstd/include/pstd_hash.h"
+#include "include/rsync_file_meta.h"
+
+namespace rsync {
+
+using pstd::Status;
+
+bool IsReusableFile(const std::string& filename) {
+  const std::string suffix = ".sst";
+  return filename.size() > suffix.size() &&
+         filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+Status GetFileFingerprint(const std::string& filepath, uint64_t* size, std::string* checksum) {
+  int fd = open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return Status::IOError(filepath, strerror(errno));
+  }
+  DEFER {
+    close(fd);
+  };
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return Status::IOError(filepath, strerror(errno));
+  }
+  uint64_t file_size = static_cast<uint64_t>(st.st_size);
+  size_t tail = static_cast<size_t>(std::min<uint64_t>(file_size, kFingerprintTailBytes));
+  std::unique_ptr<char[]> buffer(new char[tail]);
+  size_t done = 0;
+  while (done < tail) {
+    ssize_t n = pread(fd, buffer.get() + done, tail - done, file_size - tail + done);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return Status::IOError(filepath, "read file tail failed");
+    }
+    done += n;
+  }
+
+  pstd::MD5 md5;
+  std::string size_str = std::to_string(file_size);
+  md5.update(size_str.data(), size_str.size());
+  md5.update(buffer.get(), tail);
+  *size = file_size;
+  *checksum = md5.finalize().hexdigest();
+  return Status::OK();
+}
+
+Status FileFingerprintCache::Get(const std::string& filepath, uint64_t* size, std::string* checksum) {
+  struct stat st;
+  if (stat(filepath.c_str(), &st) != 0) {
+    return Status::IOError(filepath, strerror(errno));
+  }
+  std::string key = std::to_string(st.st_dev) + ":" + std::to_string(st.st_ino) + ":" + std::to_string(st.st_size);
+  {
+    std::lock_guard<std::mutex> guard(mu_);
+    auto iter = fingerprints_.find(key);
+    if (iter != fingerprints_.end()) {
+      *size = iter->second.first;
+      *checksum = iter->second.second;
+      return Status::OK();
+    }
+  }
+
+  Status s = GetFileFingerprint(filepath, size, checksum);
+  if (!s.ok()) {
+    return s;
+  }
+  std::lock_guard<std::mutex> guard(mu_);
+  if (fingerprints_.size() >= kMaxCachedFingerprints) {
+    fingerprints_.clear();
+  }
+  fingerprints_[key] = {*size, *checksum};
+  return Status::OK();
+}
+
+void ChunkChecksum(RsyncService::ChecksumType type, const char* data, size_t n, std::string* checksum) {
+  switch (type) {
+    case RsyncService::kChecksumCrc32c:
+      *checksum = std::to_string(pstd::crc32c(0, data, n));
+      break;
+    case RsyncService::kChecksumMd5: {
+      pstd::MD5 md5;
+      md5.update(data, static_cast<pstd::MD5::size_type>(n));
+      *checksum = md5.finalize().hexdigest();
+      break;
+    }
+    default:
+      checksum->clear();
+  }
+}
+
+Status ChunkChecksum(RsyncService::ChecksumType type, int fd, off_t offset, size_t len, std::string* checksum) {
+  if (type == RsyncService::kChecksumNone || len == 0) {
+    ChunkChecksum(type, "", 0, checksum);
+    return Status::OK();
+  }
+  static const off_t page_size = sysconf(_SC_PAGESIZE);
+  off_t map_offset = offset - offset % page_size;
+  size_t map_len = len + (offset - map_offset);
+  void* addr = mmap(nullptr, map_len, PROT_READ, MAP_SHARED, fd, map_offset);
+  if (addr == MAP_FAILED) {
+    return Status::IOError("mmap chunk failed", strerror(errno));
+  }
+  ChunkChecksum(type, static_cast<const char*>(addr) + (offset - map_offset), len, checksum);
+  munmap(addr, map_len);
+  return Status::OK();
+}
+
+}  // namespace rsync
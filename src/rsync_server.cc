@@ -6,20 +6,54 @@
 #include <filesystem>
 
 #include <glog/logging.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <google/protobuf/map.h>
+#include <google/protobuf/wire_format_lite.h>
 
 #include "pstd_hash.h"
 #include "include/pika_server.h"
+#include "include/rsync_file_meta.h"
 #include "include/rsync_server.h"
 #include "pstd/include/pstd_defer.h"
 
 extern PikaServer* g_pika_server;
 namespace rsync {
 
+static FileFingerprintCache fingerprint_cache;
+
 using namespace net;
 using namespace pstd;
 using namespace RsyncService;
 
+// Sends the response with len bytes of fd from offset as its payload field.
+// The payload is the last field, so the protobuf header is serialized first
+// and the chunk follows on the wire without ever being copied into it.
+void RsyncWriteFramedResp(RsyncService::RsyncResponse& response, int fd, off_t offset, size_t len,
+                          std::shared_ptr<net::PbConn> conn) {
+  std::string reply_str;
+  if (!response.SerializeToString(&reply_str)) {
+    LOG(WARNING) << "Process FileRsync request serialization failed";
+    close(fd);
+    conn->NotifyClose();
+    return;
+  }
+  google::protobuf::io::StringOutputStream output(&reply_str);
+  {
+    google::protobuf::io::CodedOutputStream encoder(&output);
+    encoder.WriteTag(google::protobuf::internal::WireFormatLite::MakeTag(
+        RsyncService::RsyncResponse::kPayloadFieldNumber,
+        google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+    encoder.WriteVarint32(static_cast<uint32_t>(len));
+  }
+  if (conn->WriteResp(reply_str, fd, offset, len) != 0) {
+    LOG(WARNING) << "Process FileRsync request write failed";
+    conn->NotifyClose();
+    return;
+  }
+  conn->NotifyWrite();
+}
+
 void RsyncWriteResp(RsyncService::RsyncResponse& response, std::shared_ptr<net::PbConn> conn) {
   std::string reply_str;
   if (!response.SerializeToString(&reply_str) || (conn->WriteResp(reply_str) != 0)) {
@@ -31,7 +65,7 @@ void RsyncWriteResp(RsyncService::RsyncResponse& response, std::shared_ptr<net::
 }
 
 RsyncServer::RsyncServer(const std::set<std::string>& ips, const int port) {
-  work_thread_ = std::make_unique<net::ThreadPool>(2, 100000, "RsyncServerWork");
+  work_thread_ = std::make_unique<net::ThreadPool>(kMaxRsyncParallelNum, 100000, "RsyncServerWork");
   rsync_server_thread_ = std::make_unique<RsyncServerThread>(ips, port, 1 * 1000, this);
 }
 
@@ -150,8 +184,24 @@ void RsyncServerConn::HandleMetaRsyncRequest(void* arg) {
   });
 
   RsyncService::MetaResponse* meta_resp = response.mutable_meta_resp();
+  meta_resp->set_window_size(kRsyncWindowSize);
+  const std::string dump_path = db->bgsave_info().path + "/";
   for (const auto& filename : filenames) {
-        meta_resp->add_filenames(filename);
+    meta_resp->add_filenames(filename);
+    if (!IsReusableFile(filename)) {
+      continue;
+    }
+    uint64_t size = 0;
+    std::string checksum;
+    Status s = fingerprint_cache.Get(dump_path + filename, &size, &checksum);
+    if (!s.ok()) {
+      LOG(WARNING) << "fingerprint rsync snapshot file failed, file: " << filename << ", error: " << s.ToString();
+      continue;
+    }
+    RsyncService::FileMeta* file_meta = meta_resp->add_files();
+    file_meta->set_filename(filename);
+    file_meta->set_size(size);
+    file_meta->set_checksum(checksum);
   }
   RsyncWriteResp(response, conn);
 }
@@ -193,14 +243,44 @@ void RsyncServerConn::HandleFileRsyncRequest(void* arg) {
    LOG(WARNING) << "cannot find db for db_name: " << db_name;
    response.set_code(RsyncService::kErr);
    RsyncWriteResp(response, conn);
+   return;
   }
 
   const std::string filepath = db->bgsave_info().path + "/" + filename;
+  std::shared_ptr<RsyncReader> reader = conn->readers_[req->reader_index()];
+  if (req->file_req().framed()) {
+    int fd = -1;
+    size_t len = 0;
+    bool is_eof = false;
+    std::string checksum;
+    s = reader->ReadRegion(filepath, offset, count, &fd, &len, &is_eof);
+    if (s.ok()) {
+      s = ChunkChecksum(req->file_req().checksum_type(), fd, offset, len, &checksum);
+      if (!s.ok()) {
+        close(fd);
+      }
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "rsync read file region failed, file: " << filepath << ", error: " << s.ToString();
+      response.set_code(RsyncService::kErr);
+      RsyncWriteResp(response, conn);
+      return;
+    }
+    RsyncService::FileResponse* file_resp = response.mutable_file_resp();
+    file_resp->set_data("");
+    file_resp->set_eof(is_eof);
+    file_resp->set_checksum(checksum);
+    file_resp->set_filename(filename);
+    file_resp->set_count(len);
+    file_resp->set_offset(offset);
+    RsyncWriteFramedResp(response, fd, offset, len, conn);
+    return;
+  }
+
   char* buffer = new char[req->file_req().count() + 1];
   size_t bytes_read{0};
   std::string checksum = "";
   bool is_eof = false;
-  std::shared_ptr<RsyncReader> reader = conn->readers_[req->reader_index()];
   s = reader->Read(filepath, offset, count, buffer,
                    &bytes_read, &checksum, &is_eof);
   if (!s.ok()) {
@@ -209,6 +289,7 @@ void RsyncServerConn::HandleFileRsyncRequest(void* arg) {
     delete []buffer;
     return;
   }
+  ChunkChecksum(req->file_req().checksum_type(), buffer, bytes_read, &checksum);
 
   RsyncService::FileResponse* file_resp = response.mutable_file_resp();
   file_resp->set_data(buffer, bytes_read);
@@ -0,0 +1,79 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const int FIELDS = 4;
+const int WRITE_BATCH = 1000;
+// One in DELETE_EVERY hashes is deleted before the compaction
+const int DELETE_EVERY = 10;
+
+struct CompactionMetaMode {
+  std::string name;
+  size_t cache_size;
+  bool scan;
+};
+
+// Returns the cost in ms of a full compaction of hashes hashes
+// of FIELDS fields each, a tenth of them deleted
+static int64_t RunCompaction(const CompactionMetaMode& mode, int64_t hashes) {
+  std::string path = "./db/compaction_meta_bench";
+  pstd::DeleteDirIfExist(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  storage_options.compaction_meta_cache_size = mode.cache_size;
+  storage_options.compaction_meta_scan = mode.scan;
+  Storage db;
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return -1;
+  }
+
+  std::vector<FieldValue> fvs;
+  for (int i = 0; i < FIELDS; ++i) {
+    fvs.emplace_back("FIELD_" + std::to_string(i), "VALUE_" + std::to_string(i));
+  }
+  std::vector<std::string> deleted;
+  for (int64_t i = 0; i < hashes; ++i) {
+    std::string key = "COMPACTION_META_BENCH_" + std::to_string(i);
+    db.HMSet(key, fvs);
+    if (i % DELETE_EVERY == 0) {
+      deleted.push_back(key);
+    }
+    if (deleted.size() == WRITE_BATCH) {
+      db.Del(deleted);
+      deleted.clear();
+    }
+  }
+  db.Del(deleted);
+
+  auto start = steady_clock::now();
+  db.Compact(DataType::kAll, true);
+  return duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
+
+// Full compaction of 1M hashes (or argv[1]), with a point lookup per hash,
+// with the shared meta cache and with the metas read by one iterator
+int main(int argc, char** argv) {
+  int64_t hashes = argc > 1 ? std::stoll(argv[1]) : 1000000;
+  std::vector<CompactionMetaMode> modes = {
+      {"point lookups", 0, false}, {"meta cache", 1000000, false}, {"meta scan", 0, true}, {"meta cache + scan", 1000000, true}};
+  for (const auto& mode : modes) {
+    int64_t cost = RunCompaction(mode, hashes);
+    std::cout << hashes << " hashes, " << mode.name << ", full compaction: " << cost << "ms" << std::endl;
+  }
+  return 0;
+}
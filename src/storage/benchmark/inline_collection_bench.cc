@@ -0,0 +1,79 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const int KEYS = 10000;
+const int QUERIES = 100000;
+const std::vector<int> COLLECTION_SIZES = {4, 16, 64};
+const std::vector<uint32_t> MAX_ENTRIES = {0, 128};
+
+// Returns the average cost in us of a HGET + HSET on a random hash
+// followed by a SISMEMBER + SMEMBERS on a random set
+static int64_t RunQueries(Storage* db, const std::string& prefix, int size) {
+  std::mt19937 rng(size);
+  int32_t ret = 0;
+  std::string value;
+  std::vector<std::string> members;
+  auto start = steady_clock::now();
+  for (int i = 0; i < QUERIES; ++i) {
+    std::string key = prefix + std::to_string(rng() % KEYS);
+    std::string field = "FIELD_" + std::to_string(rng() % size);
+    db->HGet(key + "_HASH", field, &value);
+    db->HSet(key + "_HASH", field, "NEW_VALUE", &ret);
+    db->SIsmember(key + "_SET", field, &ret);
+    db->SMembers(key + "_SET", &members);
+  }
+  return duration_cast<microseconds>(steady_clock::now() - start).count() / QUERIES;
+}
+
+// HGET + HSET + SISMEMBER + SMEMBERS on 10k hashes and sets of 4, 16 and 64
+// entries, with one key per entry and with the entries inline in the meta
+int main(int argc, char** argv) {
+  std::string path = "./db/inline_collection_bench";
+  pstd::DeleteDirIfExist(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  Storage db;
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return -1;
+  }
+
+  int32_t ret = 0;
+  for (int size : COLLECTION_SIZES) {
+    for (uint32_t max_entries : MAX_ENTRIES) {
+      std::string prefix = "INLINE_BENCH_" + std::to_string(size) + "_" + std::to_string(max_entries) + "_";
+      db.SetInlineCollectionMaxEntries(max_entries);
+      for (int i = 0; i < KEYS; ++i) {
+        std::vector<FieldValue> fvs;
+        std::vector<std::string> members;
+        for (int j = 0; j < size; ++j) {
+          fvs.emplace_back("FIELD_" + std::to_string(j), "VALUE_" + std::to_string(j));
+          members.push_back("FIELD_" + std::to_string(j));
+        }
+        db.HMSet(prefix + std::to_string(i) + "_HASH", fvs);
+        db.SAdd(prefix + std::to_string(i) + "_SET", members, &ret);
+      }
+
+      int64_t cost = RunQueries(&db, prefix, size);
+      std::cout << size << " entries, inline-collection-max-entries " << max_entries
+                << ", HGET+HSET+SISMEMBER+SMEMBERS: " << cost << "us/op" << std::endl;
+    }
+  }
+  return 0;
+}
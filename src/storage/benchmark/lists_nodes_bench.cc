@@ -0,0 +1,75 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const int PUSH_BATCH = 1000;
+const int QUERIES = 200;
+const std::vector<int> LIST_SIZES = {10000, 100000};
+const std::vector<uint32_t> NODE_SIZES = {0, 128, 1024};
+
+// Returns the average cost in us of a LSET, LINSERT and LREM
+// around a random position followed by a LRANGE of 100 elements
+static int64_t RunQueries(Storage* db, const std::string& key, int size) {
+  std::mt19937 rng(size);
+  int64_t ret = 0;
+  uint64_t removed = 0;
+  std::vector<std::string> elements;
+  auto start = steady_clock::now();
+  for (int i = 0; i < QUERIES; ++i) {
+    int64_t pos = static_cast<int64_t>(rng() % size);
+    db->LSet(key, pos, "ELEMENT_" + std::to_string(pos));
+    db->LInsert(key, Before, "ELEMENT_" + std::to_string(pos), "INSERTED", &ret);
+    db->LRem(key, 1, "INSERTED", &removed);
+    db->LRange(key, pos, pos + 99, &elements);
+  }
+  return duration_cast<microseconds>(steady_clock::now() - start).count() / QUERIES;
+}
+
+// LSET + LINSERT + LREM + LRANGE in the middle of lists of 10k and 100k
+// elements, with one key per element and with nodes of 128 and 1024 elements
+int main(int argc, char** argv) {
+  std::string path = "./db/lists_nodes_bench";
+  pstd::DeleteDirIfExist(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  Storage db;
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return -1;
+  }
+
+  for (int size : LIST_SIZES) {
+    for (uint32_t node_size : NODE_SIZES) {
+      std::string key = "LISTS_NODES_BENCH_" + std::to_string(size) + "_" + std::to_string(node_size);
+      db.SetListNodeMaxElements(node_size);
+      uint64_t len = 0;
+      for (int i = 0; i < size; i += PUSH_BATCH) {
+        std::vector<std::string> values;
+        for (int j = i; j < i + PUSH_BATCH && j < size; ++j) {
+          values.push_back("ELEMENT_" + std::to_string(j));
+        }
+        db.RPush(key, values, &len);
+      }
+
+      int64_t cost = RunQueries(&db, key, size);
+      std::cout << size << " elements, node size " << node_size
+                << ", LSET+LINSERT+LREM+LRANGE: " << cost << "us/op" << std::endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,82 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const int DB_INSTANCE_NUM = 3;
+const int SLOT_NUM = 1024;
+const int KEY_NUM = 1000000;
+const int VALUE_LENGTH = 64;
+const int ROUNDS = 2000;
+const std::vector<int> BATCH_SIZES = {10, 100, 500};
+
+// Compare Storage::MGet (one rocksdb MultiGet per instance) with
+// the previous key by key loop of point lookups
+int main(int argc, char** argv) {
+  std::string path = "./db/mget_bench";
+  pstd::DeleteDirIfExist(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  Storage db(DB_INSTANCE_NUM, SLOT_NUM, true);
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return -1;
+  }
+
+  std::string value(VALUE_LENGTH, 'v');
+  std::vector<KeyValue> kvs;
+  for (int i = 0; i < KEY_NUM; ++i) {
+    kvs.push_back({"MGET_BENCH_KEY_" + std::to_string(i), value});
+    if (kvs.size() == 1000) {
+      db.MSet(kvs);
+      kvs.clear();
+    }
+  }
+  db.MSet(kvs);
+
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> dist(0, KEY_NUM * 2 - 1);
+  for (int batch_size : BATCH_SIZES) {
+    std::vector<std::vector<std::string>> batches(ROUNDS);
+    for (auto& batch : batches) {
+      for (int i = 0; i < batch_size; ++i) {
+        // half of the lookups miss
+        batch.push_back("MGET_BENCH_KEY_" + std::to_string(dist(gen)));
+      }
+    }
+
+    auto start = steady_clock::now();
+    for (const auto& batch : batches) {
+      for (const auto& key : batch) {
+        std::string get_value;
+        db.Get(key, &get_value);
+      }
+    }
+    auto loop_cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    start = steady_clock::now();
+    for (const auto& batch : batches) {
+      std::vector<ValueStatus> vss;
+      db.MGet(batch, &vss);
+    }
+    auto batch_cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+    std::cout << "MGet " << batch_size << " keys, key by key loop: " << loop_cost / ROUNDS
+              << "us/op, MultiGet: " << batch_cost / ROUNDS << "us/op" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,74 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const int SLOT_NUM = 1024;
+const int BATCH_SIZE = 200;
+const int ROUNDS = 2000;
+const std::vector<int> INSTANCE_NUMS = {1, 3, 8};
+
+static std::vector<std::string> BatchKeys(int round) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < BATCH_SIZE; ++i) {
+    keys.push_back("FANOUT_BENCH_" + std::to_string(round) + "_" + std::to_string(i));
+  }
+  return keys;
+}
+
+// Returns the average cost in us of MSET + MGET + DEL of BATCH_SIZE keys
+static int64_t RunRounds(Storage* db) {
+  std::string value(64, 'v');
+  int64_t total = 0;
+  for (int round = 0; round < ROUNDS; ++round) {
+    std::vector<std::string> keys = BatchKeys(round);
+    std::vector<KeyValue> kvs;
+    for (const auto& key : keys) {
+      kvs.push_back({key, value});
+    }
+    std::vector<ValueStatus> vss;
+    auto start = steady_clock::now();
+    db->MSet(kvs);
+    db->MGet(keys, &vss);
+    db->Del(keys);
+    total += duration_cast<microseconds>(steady_clock::now() - start).count();
+  }
+  return total / ROUNDS;
+}
+
+// MSET/MGET/DEL of 200 keys with 1, 3 and 8 db instances,
+// with the per-instance fan-out disabled and enabled
+int main(int argc, char** argv) {
+  for (int inst_num : INSTANCE_NUMS) {
+    std::string path = "./db/fanout_bench_" + std::to_string(inst_num);
+    pstd::DeleteDirIfExist(path);
+
+    StorageOptions storage_options;
+    storage_options.options.create_if_missing = true;
+    Storage db(inst_num, SLOT_NUM, true);
+    Status s = db.Open(storage_options, path);
+    if (!s.ok()) {
+      printf("Open db failed, error: %s\n", s.ToString().c_str());
+      return -1;
+    }
+
+    db.SetMultiKeyFanoutMinBatch(0);
+    int64_t serial_cost = RunRounds(&db);
+    db.SetMultiKeyFanoutMinBatch(BATCH_SIZE);
+    int64_t fanout_cost = RunRounds(&db);
+    std::cout << inst_num << " instances, MSET+MGET+DEL " << BATCH_SIZE << " keys, serial: " << serial_cost
+              << "us/op, fan-out: " << fanout_cost << "us/op" << std::endl;
+  }
+  return 0;
+}
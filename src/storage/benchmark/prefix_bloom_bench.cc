@@ -0,0 +1,87 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const int FIELDS = 4;
+const int QUERIES = 100000;
+// Small memtables, sst files and block caches, so the data keys spread
+// over many files on several levels and most reads miss the cache
+const size_t WRITE_BUFFER_SIZE = 1 << 20;
+const size_t BLOCK_CACHE_SIZE = 1 << 20;
+
+// Returns the average cost in us of a HGETALL + ZRANGE on a random
+// hash and zset out of keys of each
+static int64_t RunQueries(const std::vector<DataType>& prefix_bloom_types, int64_t keys) {
+  std::string path = "./db/prefix_bloom_bench";
+  pstd::DeleteDirIfExist(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  storage_options.options.write_buffer_size = WRITE_BUFFER_SIZE;
+  storage_options.options.target_file_size_base = WRITE_BUFFER_SIZE;
+  storage_options.options.max_bytes_for_level_base = 4 * WRITE_BUFFER_SIZE;
+  storage_options.block_cache_size = BLOCK_CACHE_SIZE;
+  storage_options.prefix_bloom_types = prefix_bloom_types;
+  Storage db;
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return -1;
+  }
+
+  int32_t ret = 0;
+  std::vector<FieldValue> fvs;
+  std::vector<ScoreMember> score_members;
+  for (int i = 0; i < FIELDS; ++i) {
+    fvs.emplace_back("FIELD_" + std::to_string(i), "VALUE_" + std::to_string(i));
+    score_members.push_back({static_cast<double>(i), "MEMBER_" + std::to_string(i)});
+  }
+  // written in random order so every sst file covers the whole key range
+  std::mt19937 rng(keys);
+  std::vector<int64_t> order(keys);
+  for (int64_t i = 0; i < keys; ++i) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), rng);
+  for (int64_t i : order) {
+    db.HMSet("PREFIX_BLOOM_BENCH_" + std::to_string(i), fvs);
+    db.ZAdd("PREFIX_BLOOM_BENCH_ZSET_" + std::to_string(i), score_members, &ret);
+  }
+
+  std::vector<FieldValue> fvs_out;
+  std::vector<ScoreMember> score_members_out;
+  auto start = steady_clock::now();
+  for (int i = 0; i < QUERIES; ++i) {
+    std::string id = std::to_string(rng() % keys);
+    fvs_out.clear();
+    db.HGetall("PREFIX_BLOOM_BENCH_" + id, &fvs_out);
+    score_members_out.clear();
+    db.ZRange("PREFIX_BLOOM_BENCH_ZSET_" + id, 0, -1, &score_members_out);
+  }
+  return duration_cast<microseconds>(steady_clock::now() - start).count() / QUERIES;
+}
+
+// HGETALL + ZRANGE on 1M hashes and zsets (or argv[1]) spread over small
+// sst files, with the whole key blooms only and with the prefix blooms
+int main(int argc, char** argv) {
+  int64_t keys = argc > 1 ? std::stoll(argv[1]) : 1000000;
+  int64_t cost = RunQueries({}, keys);
+  std::cout << keys << " keys, whole key blooms, HGETALL+ZRANGE: " << cost << "us/op" << std::endl;
+  cost = RunQueries({DataType::kHashes, DataType::kZSets}, keys);
+  std::cout << keys << " keys, prefix blooms, HGETALL+ZRANGE: " << cost << "us/op" << std::endl;
+  return 0;
+}
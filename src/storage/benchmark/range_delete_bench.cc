@@ -0,0 +1,81 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const int WRITE_BATCH = 1000;
+const int QUERIES = 1000;
+const std::vector<uint64_t> MIN_ENTRIES = {0, 100000};
+
+// Deletes a hash of fields fields, re-creates it with one field, then
+// prints the cost of the DEL and the average cost in us of a HGETALL
+// of the new hash and a HSCAN of the hash after it
+static void RunDelete(uint64_t min_entries, int64_t fields) {
+  std::string path = "./db/range_delete_bench";
+  pstd::DeleteDirIfExist(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  storage_options.range_delete_min_entries = min_entries;
+  Storage db;
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return;
+  }
+
+  std::string key = "RANGE_DELETE_BENCH";
+  std::string next_key = "RANGE_DELETE_BENCH_NEXT";
+  std::vector<FieldValue> fvs;
+  for (int64_t i = 0; i < fields; ++i) {
+    fvs.emplace_back("FIELD_" + std::to_string(i), "VALUE_" + std::to_string(i));
+    if (fvs.size() == WRITE_BATCH || i == fields - 1) {
+      db.HMSet(key, fvs);
+      fvs.clear();
+    }
+  }
+  db.HMSet(next_key, {{"FIELD", "VALUE"}});
+  // the fields are in sst files like those of a long lived hash
+  db.Compact(DataType::kAll, true);
+
+  auto start = steady_clock::now();
+  db.Del({key});
+  int64_t del_cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+  db.HMSet(key, {{"FIELD", "VALUE"}});
+
+  int64_t next_cursor = 0;
+  std::vector<FieldValue> fvs_out;
+  start = steady_clock::now();
+  for (int i = 0; i < QUERIES; ++i) {
+    fvs_out.clear();
+    db.HGetall(key, &fvs_out);
+    fvs_out.clear();
+    db.HScan(next_key, 0, "*", 10, &fvs_out, &next_cursor);
+  }
+  int64_t read_cost = duration_cast<microseconds>(steady_clock::now() - start).count() / QUERIES;
+
+  std::cout << fields << " fields, range-delete-min-entries " << min_entries << ", DEL: " << del_cost
+            << "us, HGETALL+HSCAN after DEL: " << read_cost << "us/op" << std::endl;
+}
+
+// DEL of a hash of 1M fields (or argv[1]) with its data keys left to the
+// compaction filter and with them range deleted, then reads of the hashes
+// whose data keys are next to the deleted ones
+int main(int argc, char** argv) {
+  int64_t fields = argc > 1 ? std::stoll(argv[1]) : 1000000;
+  for (uint64_t min_entries : MIN_ENTRIES) {
+    RunDelete(min_entries, fields);
+  }
+  return 0;
+}
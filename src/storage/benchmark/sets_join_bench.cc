@@ -0,0 +1,84 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const size_t ADD_BATCH = 1000;
+const int ROUNDS = 10;
+
+static void AddMembers(Storage* db, const std::string& key, int begin, int end, int step) {
+  int32_t ret = 0;
+  std::vector<std::string> members;
+  for (int i = begin; i < end; i += step) {
+    members.push_back("MEMBER_" + std::to_string(i));
+    if (members.size() == ADD_BATCH) {
+      db->SAdd(key, members, &ret);
+      members.clear();
+    }
+  }
+  if (!members.empty()) {
+    db->SAdd(key, members, &ret);
+  }
+}
+
+// Returns the average cost in us of op
+static int64_t Measure(const std::function<void()>& op) {
+  auto start = steady_clock::now();
+  for (int i = 0; i < ROUNDS; ++i) {
+    op();
+  }
+  return duration_cast<microseconds>(steady_clock::now() - start).count() / ROUNDS;
+}
+
+// SINTER, SDIFF and SUNION over skewed (1m vs 10 members) and
+// even (two sets of 100k members sharing half of them) set sizes
+int main(int argc, char** argv) {
+  std::string path = "./db/sets_join_bench";
+  pstd::DeleteDirIfExist(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  Storage db;
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return -1;
+  }
+
+  AddMembers(&db, "SETS_JOIN_BIG", 0, 1000000, 1);
+  AddMembers(&db, "SETS_JOIN_SMALL", 0, 1000000, 100000);
+  AddMembers(&db, "SETS_JOIN_EVEN1", 0, 200000, 2);
+  AddMembers(&db, "SETS_JOIN_EVEN2", 0, 200000, 4);
+  AddMembers(&db, "SETS_JOIN_EVEN2", 1, 200000, 4);
+
+  std::vector<std::string> members;
+  auto run = [&](const std::string& name, const std::vector<std::string>& keys,
+                 Status (Storage::*op)(const std::vector<std::string>&, std::vector<std::string>*)) {
+    int64_t cost = Measure([&]() { (db.*op)(keys, &members); });
+    std::cout << name;
+    for (const auto& key : keys) {
+      std::cout << " " << key;
+    }
+    std::cout << ": " << cost << "us/op, " << members.size() << " members" << std::endl;
+  };
+
+  run("SINTER", {"SETS_JOIN_BIG", "SETS_JOIN_SMALL"}, &Storage::SInter);
+  run("SINTER", {"SETS_JOIN_SMALL", "SETS_JOIN_BIG"}, &Storage::SInter);
+  run("SDIFF", {"SETS_JOIN_SMALL", "SETS_JOIN_BIG"}, &Storage::SDiff);
+  run("SINTER", {"SETS_JOIN_EVEN1", "SETS_JOIN_EVEN2"}, &Storage::SInter);
+  run("SDIFF", {"SETS_JOIN_EVEN1", "SETS_JOIN_EVEN2"}, &Storage::SDiff);
+  run("SUNION", {"SETS_JOIN_EVEN1", "SETS_JOIN_EVEN2"}, &Storage::SUnion);
+  return 0;
+}
@@ -0,0 +1,66 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const size_t ADD_BATCH = 1000;
+const int CALLS = 1000;
+const std::vector<int> SET_SIZES = {10000, 100000, 1000000, 10000000};
+
+// SRANDMEMBER 1 and SPOP 1 on sets of 10k up to 10m members,
+// the cost of a call should not grow with the set
+int main(int argc, char** argv) {
+  std::string path = "./db/sets_sample_bench";
+  pstd::DeleteDirIfExist(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  Storage db;
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return -1;
+  }
+
+  for (int size : SET_SIZES) {
+    std::string key = "SETS_SAMPLE_BENCH_" + std::to_string(size);
+    int32_t ret = 0;
+    std::vector<std::string> members;
+    for (int i = 0; i < size; ++i) {
+      members.push_back("MEMBER_" + std::to_string(i));
+      if (members.size() == ADD_BATCH) {
+        db.SAdd(key, members, &ret);
+        members.clear();
+      }
+    }
+
+    // the first call indexes the set
+    db.SRandmember(key, 1, &members);
+    auto start = steady_clock::now();
+    for (int i = 0; i < CALLS; ++i) {
+      db.SRandmember(key, 1, &members);
+    }
+    int64_t srandmember_cost = duration_cast<microseconds>(steady_clock::now() - start).count() / CALLS;
+
+    start = steady_clock::now();
+    for (int i = 0; i < CALLS; ++i) {
+      members.clear();
+      db.SPop(key, &members, 1);
+    }
+    int64_t spop_cost = duration_cast<microseconds>(steady_clock::now() - start).count() / CALLS;
+    std::cout << size << " members, SRANDMEMBER: " << srandmember_cost << "us/op, SPOP: " << spop_cost << "us/op"
+              << std::endl;
+  }
+  return 0;
+}
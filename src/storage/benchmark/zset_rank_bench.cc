@@ -0,0 +1,71 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "pstd/include/env.h"
+#include "storage/storage.h"
+
+using namespace storage;
+using namespace std::chrono;
+
+const int ADD_BATCH = 1000;
+const int QUERIES = 2000;
+const std::vector<int> ZSET_SIZES = {10000, 100000, 1000000};
+
+// Returns the average cost in us of a ZRANK of a random member
+// followed by a ZRANGE of 10 members at a random offset
+static int64_t RunQueries(Storage* db, const std::string& key, int size) {
+  std::mt19937 rng(size);
+  int32_t rank = 0;
+  std::vector<ScoreMember> score_members;
+  auto start = steady_clock::now();
+  for (int i = 0; i < QUERIES; ++i) {
+    int32_t offset = static_cast<int32_t>(rng() % size);
+    db->ZRank(key, "MEMBER_" + std::to_string(offset), &rank);
+    db->ZRange(key, offset, offset + 9, &score_members);
+  }
+  return duration_cast<microseconds>(steady_clock::now() - start).count() / QUERIES;
+}
+
+// ZRANK + ZRANGE on zsets of 10k, 100k and 1m members,
+// with the rank index disabled and enabled
+int main(int argc, char** argv) {
+  std::string path = "./db/zset_rank_bench";
+  pstd::DeleteDirIfExist(path);
+
+  StorageOptions storage_options;
+  storage_options.options.create_if_missing = true;
+  Storage db;
+  Status s = db.Open(storage_options, path);
+  if (!s.ok()) {
+    printf("Open db failed, error: %s\n", s.ToString().c_str());
+    return -1;
+  }
+
+  for (int size : ZSET_SIZES) {
+    std::string key = "ZSET_RANK_BENCH_" + std::to_string(size);
+    int32_t ret = 0;
+    for (int i = 0; i < size; i += ADD_BATCH) {
+      std::vector<ScoreMember> score_members;
+      for (int j = i; j < i + ADD_BATCH && j < size; ++j) {
+        score_members.push_back({static_cast<double>(j), "MEMBER_" + std::to_string(j)});
+      }
+      db.ZAdd(key, score_members, &ret);
+    }
+
+    db.SetZSetRankIndexMinMembers(0);
+    int64_t scan_cost = RunQueries(&db, key, size);
+    db.SetZSetRankIndexMinMembers(1);
+    int64_t index_cost = RunQueries(&db, key, size);
+    std::cout << size << " members, ZRANK+ZRANGE, scan: " << scan_cost << "us/op, rank index: " << index_cost
+              << "us/op" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef INCLUDE_STORAGE_MEMORY_GOVERNOR_H_
+#define INCLUDE_STORAGE_MEMORY_GOVERNOR_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/write_buffer_manager.h"
+
+#include "storage/storage_define.h"
+
+namespace storage {
+
+// The column families of an instance, kMetaCF to kStreamsDataCF
+const int kColumnFamilyNum = 7;
+inline const char* const kColumnFamilyNames[kColumnFamilyNum] = {
+    "meta", "hash_data", "set_data", "list_data", "zset_data", "zset_score", "stream_data"};
+
+// A block cache using less than its share keeps this part of its share
+// above its usage, and no less than kGovernorIdleMinShare of its share,
+// the rest is lent to the busy block caches
+const double kGovernorIdleHeadroom = 0.125;
+const double kGovernorIdleMinShare = 0.25;
+
+/*
+ * One memory budget for the memtables and block caches of every column
+ * family of every instance, instead of a block cache per column family
+ * per instance.
+ *
+ * The memtables of all instances are capped by one WriteBufferManager at
+ * memtable_budget, and what they use is taken off the budget left to the
+ * block caches. Each column family has one block cache shared by every
+ * instance, its share of the block cache budget goes by its weight and
+ * Rebalance lends the unused share of the idle block caches to the busy
+ * ones. The memtables of a column family are sized by its weight too.
+ */
+class MemoryGovernor {
+ public:
+  // weights are indexed by ColumnFamilyIndex, a weight of 0 counts as 1
+  MemoryGovernor(size_t budget, size_t memtable_budget, const std::vector<uint32_t>& weights,
+                 int num_shard_bits = -1);
+
+  size_t budget() const { return budget_; }
+  size_t memtable_budget() const { return memtable_budget_; }
+  size_t MemtableUsage() const { return write_buffer_manager_->memory_usage(); }
+  const std::shared_ptr<rocksdb::WriteBufferManager>& write_buffer_manager() const { return write_buffer_manager_; }
+
+  uint32_t Weight(int cf) const { return weights_[cf]; }
+  const std::shared_ptr<rocksdb::Cache>& BlockCache(int cf) const { return block_caches_[cf]; }
+  // The weighted share of cf of the block cache budget at the last Rebalance
+  size_t BlockCacheShare(int cf);
+  // The weighted share of cf of the memtable budget
+  size_t MemtableShare(int cf) const;
+  // The memtable size of cf, write_buffer_size scaled by its weight
+  // against the average weight
+  size_t WriteBufferSize(int cf, size_t write_buffer_size) const;
+
+  // Set the capacities of the block caches from the current memtable
+  // and block cache usage
+  void Rebalance();
+
+  // The block cache capacities for block_budget given the weights and
+  // usages of the block caches, shares gets the weighted shares
+  static std::vector<size_t> Distribute(size_t block_budget, const std::vector<uint32_t>& weights,
+                                        const std::vector<size_t>& usages, std::vector<size_t>* shares);
+
+ private:
+  size_t budget_ = 0;
+  size_t memtable_budget_ = 0;
+  std::vector<uint32_t> weights_;
+  uint64_t total_weight_ = 0;
+  std::shared_ptr<rocksdb::WriteBufferManager> write_buffer_manager_;
+  std::vector<std::shared_ptr<rocksdb::Cache>> block_caches_;
+
+  std::mutex mu_;
+  std::vector<size_t> shares_;
+};
+
+}  //  namespace storage
+#endif  //  INCLUDE_STORAGE_MEMORY_GOVERNOR_H_
@@ -7,6 +7,7 @@
 #define INCLUDE_STORAGE_STORAGE_H_
 
 #include <unistd.h>
+#include <functional>
 #include <list>
 #include <map>
 #include <queue>
@@ -23,6 +24,7 @@
 #include "rocksdb/table.h"
 
 #include "slot_indexer.h"
+#include "storage/memory_governor.h"
 #include "pstd/include/pstd_mutex.h"
 #include "src/base_data_value_format.h"
 
@@ -53,6 +55,7 @@ using Status = rocksdb::Status;
 using Slice = rocksdb::Slice;
 
 class Redis;
+class InstanceExecutor;
 enum class OptionType;
 
 struct StreamAddTrimArgs;
@@ -74,6 +77,34 @@ struct StorageOptions {
   bool enable_db_statistics = false;
   size_t small_compaction_threshold = 5000;
   size_t small_compaction_duration_threshold = 10000;
+  // multi-key commands touching at least this many keys run their
+  // per-instance sub-batches concurrently, 0 disables the fan-out
+  size_t multi_key_fanout_min_batch = 64;
+  // zsets with at least this many members answer ZRANK, ZREVRANK, ZRANGE,
+  // ZREVRANGE and ZREMRANGEBYRANK through an in memory rank index, 0 disables it
+  size_t zset_rank_index_min_members = 0;
+  // new lists pack this many elements into one kListsDataCF entry,
+  // 0 keeps one entry per element
+  uint32_t list_node_max_elements = 0;
+  // new hashes and sets with at most this many entries keep them
+  // in their meta value, 0 keeps one data cf entry per entry
+  uint32_t inline_collection_max_entries = 0;
+  // the data filters of an instance share a cache of this many metas
+  // during compactions, 0 disables it
+  size_t compaction_meta_cache_size = 0;
+  // the data filters read the metas in key order with one iterator per
+  // compaction instead of a point lookup per user key
+  bool compaction_meta_scan = false;
+  // deleting a hash, set, zset or list of at least this many entries also
+  // drops its data keys with a range deletion and compacts them, 0 leaves
+  // them all to the compaction filters
+  uint64_t range_delete_min_entries = 0;
+  // the data column families of these types get a prefix bloom on the
+  // data keys of a version of a user key, in the sst files and memtables
+  std::vector<DataType> prefix_bloom_types;
+  // the block caches and memtable sizes of every column family of every
+  // instance, instead of block_cache_size and share_block_cache
+  std::shared_ptr<MemoryGovernor> memory_governor;
   Status ResetOptions(const OptionType& option_type, const std::unordered_map<std::string, std::string>& options_map);
 };
 
@@ -1083,10 +1114,19 @@ class Storage {
   Status SetMaxCacheStatisticKeys(uint32_t max_cache_statistic_keys);
   Status SetSmallCompactionThreshold(uint32_t small_compaction_threshold);
   Status SetSmallCompactionDurationThreshold(uint32_t small_compaction_duration_threshold);
+  void SetMultiKeyFanoutMinBatch(size_t min_batch);
+  Status SetZSetRankIndexMinMembers(uint32_t zset_rank_index_min_members);
+  Status SetListNodeMaxElements(uint32_t list_node_max_elements);
+  Status SetInlineCollectionMaxEntries(uint32_t inline_collection_max_entries);
+  Status SetCompactionMetaCacheSize(size_t compaction_meta_cache_size);
+  Status SetCompactionMetaScan(bool compaction_meta_scan);
+  Status SetRangeDeleteMinEntries(uint64_t range_delete_min_entries);
 
   std::string GetCurrentTaskType();
   Status GetUsage(const std::string& property, uint64_t* result);
   Status GetUsage(const std::string& property, std::map<int, uint64_t>* type_result);
+  // property summed over the instances, per column family
+  Status GetColumnFamilyUsage(const std::string& property, std::vector<uint64_t>* cf_result);
   uint64_t GetProperty(const std::string& property);
 
   Status GetKeyNum(std::vector<KeyInfo>* key_infos);
@@ -1130,6 +1170,23 @@ class Storage {
   // For scan keys in data base
   std::atomic<bool> scan_keynum_exit_ = {false};
   Status MGetWithTTL(const Slice& key, std::string* value, int64_t* ttl_millsec);
+
+  // For multi-key commands spanning several instances
+  std::unique_ptr<InstanceExecutor> instance_executor_;
+  std::atomic<size_t> multi_key_fanout_min_batch_ = {0};
+
+  // Bucket the positions of keys by the index of the Redis instance that owns them,
+  // returns the indexes of the instances owning at least one key
+  std::vector<size_t> GroupKeysByInstance(const std::vector<std::string>& keys,
+                                          std::vector<std::vector<size_t>>* inst_key_indexes);
+  // Run task(inst_index) for every instance in inst_indexes, concurrently when
+  // batch_size reaches multi_key_fanout_min_batch_, serially on the caller otherwise
+  void RunOnInstances(const std::vector<size_t>& inst_indexes, size_t batch_size,
+                      const std::function<void(size_t)>& task);
+  // The member counts of the sets at keys, 0 for the missing ones
+  Status SetsCards(const std::vector<std::string>& keys, std::vector<int32_t>* cards);
+  // The members of the sets at keys, each sorted
+  Status SetsMembers(const std::vector<std::string>& keys, std::vector<std::vector<std::string>>* key_members);
 };
 
 }  //  namespace storage
@@ -15,6 +15,7 @@
 #include "src/base_data_key_format.h"
 #include "src/base_value_format.h"
 #include "src/base_meta_value_format.h"
+#include "src/compaction_meta_cache.h"
 #include "src/lists_meta_value_format.h"
 #include "src/pika_stream_meta_value.h"
 #include "src/strings_value_format.h"
@@ -109,9 +110,9 @@ class BaseMetaFilterFactory : public rocksdb::CompactionFilterFactory {
 
 class BaseDataFilter : public rocksdb::CompactionFilter {
  public:
-  BaseDataFilter(rocksdb::DB* db, std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr, enum DataType type)
-      : db_(db),
-        cf_handles_ptr_(cf_handles_ptr),
+  BaseDataFilter(rocksdb::DB* db, std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr, enum DataType type,
+                 CompactionMetaCache* meta_cache = nullptr)
+      : meta_reader_(db, cf_handles_ptr, meta_cache),
         type_(type)
         {}
 
@@ -132,66 +133,7 @@ class BaseDataFilter : public rocksdb::CompactionFilter {
     std::string meta_key_enc(key.data(), std::distance(key.data(), ptr));
     meta_key_enc.append(kSuffixReserveLength, kNeedTransformCharacter);
 
-    if (meta_key_enc != cur_key_) {
-      cur_meta_etime_ = 0;
-      cur_meta_version_ = 0;
-      meta_not_found_ = true;
-      cur_key_ = meta_key_enc;
-      std::string meta_value;
-      // destroyed when close the database, Reserve Current key value
-      if (cf_handles_ptr_->empty()) {
-        return false;
-      }
-      Status s = db_->Get(default_read_options_, (*cf_handles_ptr_)[0], cur_key_, &meta_value);
-      if (s.ok()) {
-        /*
-         * The elimination policy for keys of the Data type is that if the key
-         * type obtained from MetaCF is inconsistent with the key type in Data,
-         * it needs to be eliminated
-         */
-        auto type = static_cast<enum DataType>(static_cast<uint8_t>(meta_value[0]));
-        if (type != type_) {
-          return true;
-        } else if (type == DataType::kStreams) {
-          ParsedStreamMetaValue parsed_stream_meta_value(meta_value);
-          meta_not_found_ = false;
-          cur_meta_version_ = parsed_stream_meta_value.version();
-          cur_meta_etime_ = 0; // stream do not support ttl
-        } else if (type == DataType::kHashes || type == DataType::kSets || type == DataType::kZSets) {
-          ParsedBaseMetaValue parsed_base_meta_value(&meta_value);
-          meta_not_found_ = false;
-          cur_meta_version_ = parsed_base_meta_value.Version();
-          cur_meta_etime_ = parsed_base_meta_value.Etime();
-        } else {
-          return true;
-        }
-      } else if (s.IsNotFound()) {
-        meta_not_found_ = true;
-      } else {
-        cur_key_ = "";
-        TRACE("Reserve[Get meta_key faild]");
-        return false;
-      }
-    }
-
-    if (meta_not_found_) {
-      TRACE("Drop[Meta key not exist]");
-      return true;
-    }
-
-    pstd::TimeType unix_time = pstd::NowMillis();
-    if (cur_meta_etime_ != 0 && cur_meta_etime_ < unix_time) {
-      TRACE("Drop[Timeout]");
-      return true;
-    }
-
-    if (cur_meta_version_ > parsed_base_data_key.Version()) {
-      TRACE("Drop[data_key_version < cur_meta_version]");
-      return true;
-    } else {
-      TRACE("Reserve[data_key_version == cur_meta_version]");
-      return false;
-    }
+    return meta_reader_.Drop(meta_key_enc, type_, parsed_base_data_key.Version());
   }
 
   /*
@@ -214,23 +156,18 @@ class BaseDataFilter : public rocksdb::CompactionFilter {
   const char* Name() const override { return "BaseDataFilter"; }
 
  private:
-  rocksdb::DB* db_ = nullptr;
-  std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr_ = nullptr;
-  rocksdb::ReadOptions default_read_options_;
-  mutable std::string cur_key_;
-  mutable bool meta_not_found_ = false;
-  mutable uint64_t cur_meta_version_ = 0;
-  mutable uint64_t cur_meta_etime_ = 0;
+  mutable CompactionMetaReader meta_reader_;
   enum DataType type_ = DataType::kNones;
 };
 
 class BaseDataFilterFactory : public rocksdb::CompactionFilterFactory {
  public:
-  BaseDataFilterFactory(rocksdb::DB** db_ptr, std::vector<rocksdb::ColumnFamilyHandle*>* handles_ptr, enum DataType type)
-      : db_ptr_(db_ptr), cf_handles_ptr_(handles_ptr), type_(type) {}
+  BaseDataFilterFactory(rocksdb::DB** db_ptr, std::vector<rocksdb::ColumnFamilyHandle*>* handles_ptr, enum DataType type,
+                        CompactionMetaCache* meta_cache = nullptr)
+      : db_ptr_(db_ptr), cf_handles_ptr_(handles_ptr), type_(type), meta_cache_(meta_cache) {}
   std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
       const rocksdb::CompactionFilter::Context& context) override {
-    return std::make_unique<BaseDataFilter>(BaseDataFilter(*db_ptr_, cf_handles_ptr_, type_));
+    return std::make_unique<BaseDataFilter>(*db_ptr_, cf_handles_ptr_, type_, meta_cache_);
   }
   const char* Name() const override { return "BaseDataFilterFactory"; }
 
@@ -238,6 +175,7 @@ class BaseDataFilterFactory : public rocksdb::CompactionFilterFactory {
   rocksdb::DB** db_ptr_ = nullptr;
   std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr_ = nullptr;
   enum DataType type_ = DataType::kNones;
+  CompactionMetaCache* meta_cache_ = nullptr;
 };
 
 using HashesMetaFilter = BaseMetaFilter;
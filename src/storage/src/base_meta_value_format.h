@@ -14,9 +14,20 @@
 
 namespace storage {
 
+// The first byte of the reserve of hashes and sets meta tells
+// how the fields or members of the collection are stored
+enum class CollectionEncoding : uint8_t {
+  // one data cf entry per field or member
+  kDataKeys = 0,
+  // serialised into the value of the meta after the count, see inline_entries_format.h
+  kInline = 1,
+};
+
 /*
 *| type | value |  version | reserve | cdate | timestamp |
 *|  1B  |       |    8B   |   16B    |   8B  |     8B    |
+*
+* value is the 4B count, followed by the entries of kInline collections
 */
 // TODO(wangshaoyi): reformat encode, AppendTimestampAndVersion
 class BaseMetaValue : public InternalValue {
@@ -157,9 +168,37 @@ class ParsedBaseMetaValue : public ParsedInternalValue {
     this->SetCount(0);
     this->SetEtime(0);
     this->SetCtime(0);
+    this->SetEncoding(CollectionEncoding::kDataKeys);
+    this->SetInlinePayload(Slice());
     return this->UpdateVersion();
   }
 
+  CollectionEncoding Encoding() { return static_cast<CollectionEncoding>(reserve_[0]); }
+
+  void SetEncoding(CollectionEncoding encoding) {
+    reserve_[0] = static_cast<char>(encoding);
+    if (value_) {
+      char* dst = const_cast<char*>(value_->data()) + value_->size() - kBaseMetaValueSuffixLength + kVersionLength;
+      dst[0] = reserve_[0];
+    }
+  }
+
+  // The serialised entries of a kInline collection
+  Slice InlinePayload() {
+    if (user_value_.size() <= sizeof(int32_t)) {
+      return {};
+    }
+    return {user_value_.data() + sizeof(int32_t), user_value_.size() - sizeof(int32_t)};
+  }
+
+  void SetInlinePayload(const Slice& payload) {
+    if (value_) {
+      size_t old_size = user_value_.size() > sizeof(int32_t) ? user_value_.size() - sizeof(int32_t) : 0;
+      value_->replace(kTypeLength + sizeof(int32_t), old_size, payload.data(), payload.size());
+      user_value_ = Slice(value_->data() + kTypeLength, sizeof(int32_t) + payload.size());
+    }
+  }
+
   bool IsValid() override {
     return !IsStale() && Count() != 0;
   }
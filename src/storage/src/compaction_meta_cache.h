@@ -0,0 +1,274 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_COMPACTION_META_CACHE_H_
+#define SRC_COMPACTION_META_CACHE_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "rocksdb/iterator.h"
+
+#include "pstd/include/env.h"
+#include "src/base_meta_value_format.h"
+#include "src/debug.h"
+#include "src/lists_meta_value_format.h"
+#include "src/lru_cache.h"
+#include "src/pika_stream_meta_value.h"
+
+namespace storage {
+
+// Nexts tried on the meta iterator before seeking it to the next meta key
+const int kCompactionMetaScanMaxNext = 8;
+
+/*
+ * What a data filter needs to know of the meta of a user key, and when it
+ * was read. Versions of a user key only grow and a new meta gets a version
+ * no less than the time it is written, so some decisions made from an old
+ * read still hold:
+ *   - data keys older than the meta version are dropped for good
+ *   - data keys of a meta expired when read are dropped for good
+ *   - data keys older than read_time are dropped for good if there was no
+ *     such meta, or a meta of another type, when it was read
+ * Others need the meta read again, see Decide. A new stream counts its
+ * version up from the last one of the key, starting at 1, so stream data
+ * keys are never dropped for a meta missing in an old read.
+ */
+struct CompactionMeta {
+  bool found = false;
+  DataType type = DataType::kNones;
+  uint64_t version = 0;
+  uint64_t etime = 0;
+  uint64_t read_time = 0;
+
+  static CompactionMeta Parse(const Slice& meta_value, uint64_t read_time) {
+    CompactionMeta meta;
+    meta.read_time = read_time;
+    if (meta_value.empty()) {
+      return meta;
+    }
+    meta.found = true;
+    meta.type = static_cast<enum DataType>(static_cast<uint8_t>(meta_value[0]));
+    if (meta.type == DataType::kLists) {
+      ParsedListsMetaValue parsed_lists_meta_value(meta_value);
+      meta.version = parsed_lists_meta_value.Version();
+      meta.etime = parsed_lists_meta_value.Etime();
+    } else if (meta.type == DataType::kStreams) {
+      ParsedStreamMetaValue parsed_stream_meta_value(meta_value);
+      meta.version = parsed_stream_meta_value.version();
+      // stream do not support ttl
+      meta.etime = 0;
+    } else if (meta.type == DataType::kHashes || meta.type == DataType::kSets || meta.type == DataType::kZSets) {
+      ParsedBaseMetaValue parsed_base_meta_value(meta_value);
+      meta.version = parsed_base_meta_value.Version();
+      meta.etime = parsed_base_meta_value.Etime();
+    }
+    return meta;
+  }
+
+  enum class Decision { kKeep, kDrop, kUnknown };
+
+  // Whether a data key of type and data_version should be dropped. A meta
+  // just read decides every data key, one read before may answer kUnknown
+  Decision Decide(DataType data_type, uint64_t data_version, uint64_t now, bool fresh) const {
+    if (!found || type != data_type) {
+      TRACE("[%s]", found ? "Meta type mismatch" : "Meta key not exist");
+      if (fresh) {
+        return Decision::kDrop;
+      }
+      return (data_type != DataType::kStreams && data_version < read_time) ? Decision::kDrop : Decision::kUnknown;
+    }
+    if (data_version < version) {
+      TRACE("Drop[data_key_version < cur_meta_version]");
+      return Decision::kDrop;
+    }
+    if (data_version > version) {
+      return fresh ? Decision::kKeep : Decision::kUnknown;
+    }
+    if (etime != 0 && etime < read_time) {
+      TRACE("Drop[Timeout]");
+      return Decision::kDrop;
+    }
+    if (etime != 0 && etime < now) {
+      // the ttl may have been changed since
+      return fresh ? Decision::kDrop : Decision::kUnknown;
+    }
+    TRACE("Reserve[data_key_version == cur_meta_version]");
+    return Decision::kKeep;
+  }
+};
+
+/*
+ * The metas read by the data filters of all the column families of a
+ * Redis instance, so the data keys and score keys of a zset, or the data
+ * keys of a user key split over several compactions, look up its meta
+ * once. The entries are dropped when the last data filter using them is
+ * destroyed, so they only live as long as the compactions reading them.
+ */
+class CompactionMetaCache {
+ public:
+  CompactionMetaCache() { cache_.SetCapacity(0); }
+
+  // capacity is the number of metas kept, 0 to disable the cache
+  void SetCapacity(size_t capacity) { cache_.SetCapacity(capacity); }
+  size_t Capacity() { return cache_.Capacity(); }
+  // Read the metas of a compaction in key order with one iterator instead
+  // of a point lookup per user key
+  void SetScanMeta(bool scan_meta) { scan_meta_.store(scan_meta); }
+  bool ScanMeta() const { return scan_meta_.load(); }
+
+  bool Lookup(const std::string& meta_key, CompactionMeta* meta) {
+    return cache_.Capacity() != 0 && cache_.Lookup(meta_key, meta).ok();
+  }
+  void Insert(const std::string& meta_key, const CompactionMeta& meta) {
+    if (cache_.Capacity() != 0) {
+      cache_.Insert(meta_key, meta);
+    }
+  }
+
+  void Ref() { refs_.fetch_add(1); }
+  void Unref() {
+    if (refs_.fetch_sub(1) == 1) {
+      cache_.Clear();
+    }
+  }
+
+ private:
+  LRUCache<std::string, CompactionMeta> cache_;
+  std::atomic_bool scan_meta_{false};
+  std::atomic_int refs_{0};
+};
+
+/*
+ * The meta lookups of one data filter. The meta of the user key being
+ * filtered is kept until the next user key, then the cache, the meta
+ * iterator and a point lookup are tried in turn.
+ */
+class CompactionMetaReader {
+ public:
+  CompactionMetaReader(rocksdb::DB* db, std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr,
+                       CompactionMetaCache* cache)
+      : db_(db), cf_handles_ptr_(cf_handles_ptr), cache_(cache) {
+    if (cache_ != nullptr) {
+      cache_->Ref();
+      scan_meta_ = cache_->ScanMeta();
+    }
+  }
+  ~CompactionMetaReader() {
+    // the iterator goes before the column families it reads
+    iter_.reset();
+    if (cache_ != nullptr) {
+      cache_->Unref();
+    }
+  }
+  CompactionMetaReader(const CompactionMetaReader&) = delete;
+  CompactionMetaReader& operator=(const CompactionMetaReader&) = delete;
+
+  // Whether a data key of type and data_version under the user key of
+  // meta_key should be dropped, the data key is kept if the meta can not
+  // be read
+  bool Drop(const std::string& meta_key, DataType type, uint64_t data_version) {
+    // destroyed when close the database, Reserve Current key value
+    if (cf_handles_ptr_->empty()) {
+      return false;
+    }
+    if (meta_key != cur_key_) {
+      cur_key_.clear();
+      if (cache_ != nullptr && cache_->Lookup(meta_key, &cur_meta_)) {
+        cur_fresh_ = false;
+      } else if (scan_meta_) {
+        if (!ScanMeta(meta_key, &cur_meta_).ok()) {
+          TRACE("Reserve[Scan meta_key faild]");
+          return false;
+        }
+        cur_fresh_ = false;
+        cache_->Insert(meta_key, cur_meta_);
+      } else if (!GetMeta(meta_key).ok()) {
+        TRACE("Reserve[Get meta_key faild]");
+        return false;
+      }
+      cur_key_ = meta_key;
+    }
+
+    uint64_t now = pstd::NowMillis();
+    auto decision = cur_meta_.Decide(type, data_version, now, cur_fresh_);
+    if (decision == CompactionMeta::Decision::kUnknown) {
+      if (!GetMeta(meta_key).ok()) {
+        cur_key_.clear();
+        TRACE("Reserve[Get meta_key faild]");
+        return false;
+      }
+      decision = cur_meta_.Decide(type, data_version, now, cur_fresh_);
+    }
+    return decision == CompactionMeta::Decision::kDrop;
+  }
+
+ private:
+  Status GetMeta(const std::string& meta_key) {
+    std::string meta_value;
+    uint64_t read_time = pstd::NowMillis();
+    Status s = db_->Get(default_read_options_, (*cf_handles_ptr_)[0], meta_key, &meta_value);
+    if (!s.ok() && !s.IsNotFound()) {
+      return s;
+    }
+    cur_meta_ = CompactionMeta::Parse(s.ok() ? Slice(meta_value) : Slice(), read_time);
+    cur_fresh_ = true;
+    if (cache_ != nullptr) {
+      cache_->Insert(meta_key, cur_meta_);
+    }
+    return Status::OK();
+  }
+
+  // The user keys of a compaction come in key order, so the iterator is
+  // moved forward from the last meta key, it sees the metas as they were
+  // when it was created
+  Status ScanMeta(const std::string& meta_key, CompactionMeta* meta) {
+    if (iter_ == nullptr) {
+      iter_time_ = pstd::NowMillis();
+      rocksdb::ReadOptions iterator_options;
+      iterator_options.fill_cache = false;
+      iter_.reset(db_->NewIterator(iterator_options, (*cf_handles_ptr_)[0]));
+      iter_->Seek(meta_key);
+    } else if (meta_key > iter_key_) {
+      for (int i = 0; i < kCompactionMetaScanMaxNext && iter_->Valid() && iter_->key().compare(meta_key) < 0; ++i) {
+        iter_->Next();
+      }
+      if (iter_->Valid() && iter_->key().compare(meta_key) < 0) {
+        iter_->Seek(meta_key);
+      }
+    } else {
+      iter_->Seek(meta_key);
+    }
+    iter_key_ = meta_key;
+    Status s = iter_->status();
+    if (!s.ok()) {
+      iter_.reset();
+      return s;
+    }
+    bool found = iter_->Valid() && iter_->key() == meta_key;
+    *meta = CompactionMeta::Parse(found ? iter_->value() : Slice(), iter_time_);
+    return Status::OK();
+  }
+
+  rocksdb::DB* db_ = nullptr;
+  std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr_ = nullptr;
+  CompactionMetaCache* cache_ = nullptr;
+  bool scan_meta_ = false;
+  rocksdb::ReadOptions default_read_options_;
+
+  std::string cur_key_;
+  CompactionMeta cur_meta_;
+  bool cur_fresh_ = false;
+
+  std::unique_ptr<rocksdb::Iterator> iter_;
+  std::string iter_key_;
+  uint64_t iter_time_ = 0;
+};
+
+}  //  namespace storage
+#endif  //  SRC_COMPACTION_META_CACHE_H_
@@ -123,6 +123,16 @@ class ZSetsScoreKeyComparatorImpl : public rocksdb::Comparator {
 
     ptr_a += kVersionLength;
     ptr_b += kVersionLength;
+    // a key ending at the version, like the prefix of a prefix bloom,
+    // goes before the keys of that version
+    if (ptr_a - a.data() == a_size && ptr_b - b.data() == b_size) {
+      return 0;
+    } else if (ptr_a - a.data() == a_size) {
+      return -1;
+    } else if (ptr_b - b.data() == b_size) {
+      return 1;
+    }
+
     // compare score
     uint64_t a_i = DecodeFixed64(ptr_a);
     uint64_t b_i = DecodeFixed64(ptr_b);
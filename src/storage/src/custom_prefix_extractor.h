@@ -0,0 +1,62 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_CUSTOM_PREFIX_EXTRACTOR_H_
+#define SRC_CUSTOM_PREFIX_EXTRACTOR_H_
+
+#include <memory>
+
+#include "rocksdb/slice_transform.h"
+
+#include "storage/storage_define.h"
+
+namespace storage {
+
+// Share of the memtable size given to its prefix bloom when the
+// column family options do not set memtable_prefix_bloom_size_ratio
+const double kMemtablePrefixBloomSizeRatio = 0.1;
+
+/*
+ * The prefix of the data keys of one version of a user key, for the
+ * prefix blooms of the data column families:
+ * | reserve1 | key | version |
+ * |    8B    |     |    8B   |
+ * Hashes, sets, zsets and streams seek to it to read their data keys,
+ * lists and zset scores seek to keys starting with it, so the sst files
+ * and memtables holding no key of that version are skipped by their
+ * prefix bloom instead of reading their index blocks.
+ * The keys of a prefix are contiguous for ListsDataKeyComparator and
+ * ZSetsScoreKeyComparator too, both order by prefix first.
+ */
+class DataKeyPrefixExtractorImpl : public rocksdb::SliceTransform {
+ public:
+  const char* Name() const override { return "pika.DataKeyPrefixExtractor"; }
+
+  Slice Transform(const Slice& key) const override { return {key.data(), PrefixLength(key)}; }
+
+  bool InDomain(const Slice& key) const override { return PrefixLength(key) != 0; }
+
+ private:
+  // 0 if key does not hold a whole prefix
+  static size_t PrefixLength(const Slice& key) {
+    if (key.size() < kPrefixReserveLength + kEncodedKeyDelimSize + kVersionLength) {
+      return 0;
+    }
+    const char* ptr = key.data() + kPrefixReserveLength;
+    const char* version_ptr = SeekUserkeyDelim(ptr, static_cast<int>(key.size()) - kPrefixReserveLength);
+    if (version_ptr == ptr) {
+      return 0;
+    }
+    size_t prefix_length = std::distance(key.data(), version_ptr) + kVersionLength;
+    return prefix_length <= key.size() ? prefix_length : 0;
+  }
+};
+
+inline std::shared_ptr<const rocksdb::SliceTransform> NewDataKeyPrefixExtractor() {
+  return std::make_shared<DataKeyPrefixExtractorImpl>();
+}
+
+}  //  namespace storage
+#endif  //  SRC_CUSTOM_PREFIX_EXTRACTOR_H_
@@ -0,0 +1,149 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_INLINE_ENTRIES_FORMAT_H_
+#define SRC_INLINE_ENTRIES_FORMAT_H_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+
+#include "src/coding.h"
+#include "storage/storage.h"
+
+namespace storage {
+
+using Slice = rocksdb::Slice;
+
+// Largest inline-collection-max-entries allowed
+const uint32_t kInlineCollectionMaxEntries = 512;
+// Fields, values and members longer than this move the
+// collection to data keys, like hash-max-listpack-value
+const size_t kInlineEntryMaxLength = 64;
+
+/*
+ * The fields and values of a hash, or the members of a set, kept in its
+ * meta value after the count (CollectionEncoding::kInline). The entries
+ * are sorted by field like the data keys they stand in for, so scans
+ * and cursors behave the same on both encodings:
+ * | field len | field | value len | value | field len | field | ...
+ * |    4B     |       |    4B     |       |    4B     |       |
+ * The members of a set have no value len and value.
+ */
+class InlineEntries {
+ public:
+  explicit InlineEntries(bool with_values) : with_values_(with_values) {}
+
+  bool Decode(const Slice& payload) {
+    entries_.clear();
+    const char* ptr = payload.data();
+    const char* end = payload.data() + payload.size();
+    while (ptr < end) {
+      FieldValue entry;
+      if (!DecodeString(&ptr, end, &entry.field) || (with_values_ && !DecodeString(&ptr, end, &entry.value))) {
+        entries_.clear();
+        return false;
+      }
+      entries_.push_back(std::move(entry));
+    }
+    return true;
+  }
+
+  std::string Encode() const {
+    std::string payload;
+    for (const auto& entry : entries_) {
+      EncodeString(entry.field, &payload);
+      if (with_values_) {
+        EncodeString(entry.value, &payload);
+      }
+    }
+    return payload;
+  }
+
+  size_t size() const { return entries_.size(); }
+  const std::vector<FieldValue>& entries() const { return entries_; }
+  const FieldValue& operator[](size_t idx) const { return entries_[idx]; }
+
+  // The position of the first entry not less than field
+  size_t LowerBound(const Slice& field) const {
+    auto iter = std::lower_bound(entries_.begin(), entries_.end(), field,
+                                 [](const FieldValue& entry, const Slice& target) {
+                                   return Slice(entry.field).compare(target) < 0;
+                                 });
+    return iter - entries_.begin();
+  }
+
+  // nullptr if there is no such field
+  const std::string* Get(const Slice& field) const {
+    size_t idx = LowerBound(field);
+    if (idx < entries_.size() && Slice(entries_[idx].field) == field) {
+      return &entries_[idx].value;
+    }
+    return nullptr;
+  }
+
+  // Returns true if the field is new
+  bool Put(const Slice& field, const Slice& value) {
+    size_t idx = LowerBound(field);
+    if (idx < entries_.size() && Slice(entries_[idx].field) == field) {
+      entries_[idx].value.assign(value.data(), value.size());
+      return false;
+    }
+    entries_.insert(entries_.begin() + static_cast<int64_t>(idx), FieldValue(field.ToString(), value.ToString()));
+    return true;
+  }
+
+  // Returns true if the field was there
+  bool Delete(const Slice& field) {
+    size_t idx = LowerBound(field);
+    if (idx < entries_.size() && Slice(entries_[idx].field) == field) {
+      entries_.erase(entries_.begin() + static_cast<int64_t>(idx));
+      return true;
+    }
+    return false;
+  }
+
+  void Erase(size_t idx) { entries_.erase(entries_.begin() + static_cast<int64_t>(idx)); }
+
+  // Whether the entries can stay inline with at most max_entries of them
+  bool Fits(size_t max_entries) const {
+    if (entries_.size() > max_entries) {
+      return false;
+    }
+    return std::all_of(entries_.begin(), entries_.end(), [](const FieldValue& entry) {
+      return entry.field.size() <= kInlineEntryMaxLength && entry.value.size() <= kInlineEntryMaxLength;
+    });
+  }
+
+ private:
+  static void EncodeString(const std::string& str, std::string* dst) {
+    char buf[sizeof(uint32_t)];
+    EncodeFixed32(buf, static_cast<uint32_t>(str.size()));
+    dst->append(buf, sizeof(buf));
+    dst->append(str);
+  }
+
+  static bool DecodeString(const char** ptr, const char* end, std::string* str) {
+    if (end - *ptr < static_cast<int64_t>(sizeof(uint32_t))) {
+      return false;
+    }
+    uint32_t len = DecodeFixed32(*ptr);
+    *ptr += sizeof(uint32_t);
+    if (end - *ptr < static_cast<int64_t>(len)) {
+      return false;
+    }
+    str->assign(*ptr, len);
+    *ptr += len;
+    return true;
+  }
+
+  bool with_values_ = true;
+  std::vector<FieldValue> entries_;
+};
+
+}  //  namespace storage
+#endif  //  SRC_INLINE_ENTRIES_FORMAT_H_
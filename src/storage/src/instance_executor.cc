@@ -0,0 +1,90 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "src/instance_executor.h"
+
+namespace storage {
+
+InstanceExecutor::InstanceExecutor(size_t inst_num) {
+  workers_.reserve(inst_num);
+  for (size_t i = 0; i < inst_num; ++i) {
+    workers_.emplace_back(std::make_unique<Worker>());
+  }
+  for (auto& worker : workers_) {
+    worker->thread = std::thread(&InstanceExecutor::WorkerMain, this, worker.get());
+  }
+}
+
+InstanceExecutor::~InstanceExecutor() {
+  should_exit_ = true;
+  for (auto& worker : workers_) {
+    std::lock_guard lock(worker->mu);
+    worker->cv.notify_one();
+  }
+  for (auto& worker : workers_) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+void InstanceExecutor::Run(const std::vector<size_t>& inst_indexes, const std::function<void(size_t)>& task) {
+  Batch batch(inst_indexes.size());
+  batch.task = &task;
+
+  std::vector<JobSptr> jobs;
+  jobs.reserve(inst_indexes.size());
+  for (size_t inst_index : inst_indexes) {
+    jobs.emplace_back(std::make_shared<Job>(&batch, inst_index));
+  }
+  // the first sub-batch always runs on the calling thread,
+  // hand the others to the workers of their instances
+  for (size_t i = 1; i < jobs.size(); ++i) {
+    Worker* worker = workers_[jobs[i]->inst_index % workers_.size()].get();
+    std::lock_guard lock(worker->mu);
+    worker->queue.push_back(jobs[i]);
+    worker->cv.notify_one();
+  }
+  for (const auto& job : jobs) {
+    RunJob(job);
+  }
+
+  std::unique_lock lock(batch.mu);
+  batch.cv.wait(lock, [&batch] { return batch.pending == 0; });
+}
+
+void InstanceExecutor::RunJob(const JobSptr& job) {
+  if (job->claimed.exchange(true)) {
+    return;
+  }
+  Batch* batch = job->batch;
+  (*batch->task)(job->inst_index);
+  std::lock_guard lock(batch->mu);
+  if (--batch->pending == 0) {
+    batch->cv.notify_one();
+  }
+}
+
+void InstanceExecutor::WorkerMain(Worker* worker) {
+  while (true) {
+    JobSptr job;
+    {
+      std::unique_lock lock(worker->mu);
+      worker->cv.wait(lock, [this, worker] { return !worker->queue.empty() || should_exit_; });
+      if (should_exit_) {
+        return;
+      }
+      job = std::move(worker->queue.front());
+      worker->queue.pop_front();
+    }
+    // the caller may already have run it, the batch is gone then
+    if (job->claimed.load()) {
+      continue;
+    }
+    RunJob(job);
+  }
+}
+
+}  //  namespace storage
@@ -0,0 +1,71 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_INSTANCE_EXECUTOR_H_
+#define SRC_INSTANCE_EXECUTOR_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "pstd/include/noncopyable.h"
+#include "pstd/include/pstd_mutex.h"
+
+namespace storage {
+
+/*
+ * Fans the per-instance sub-batches of a multi-key command out to one
+ * worker thread per rocksdb instance and waits for all of them.
+ *
+ * The calling thread never idles while its sub-batches sit in a busy
+ * worker's queue: after dispatching, it claims and runs every task that
+ * no worker has picked up yet, so under saturation the command degrades
+ * to the serial loop instead of queueing behind other commands.
+ */
+class InstanceExecutor : public pstd::noncopyable {
+ public:
+  explicit InstanceExecutor(size_t inst_num);
+  ~InstanceExecutor();
+
+  // Run task(inst_index) once for every index in inst_indexes,
+  // returns after all of them finished
+  void Run(const std::vector<size_t>& inst_indexes, const std::function<void(size_t)>& task);
+
+ private:
+  struct Batch {
+    explicit Batch(size_t n) : pending(n) {}
+    const std::function<void(size_t)>* task = nullptr;
+    pstd::Mutex mu;
+    pstd::CondVar cv;
+    size_t pending;
+  };
+
+  struct Job {
+    Job(Batch* b, size_t index) : batch(b), inst_index(index) {}
+    Batch* batch;
+    size_t inst_index;
+    std::atomic<bool> claimed{false};
+  };
+  using JobSptr = std::shared_ptr<Job>;
+
+  struct Worker {
+    pstd::Mutex mu;
+    pstd::CondVar cv;
+    std::deque<JobSptr> queue;
+    std::thread thread;
+  };
+
+  void WorkerMain(Worker* worker);
+  static void RunJob(const JobSptr& job);
+
+  std::atomic<bool> should_exit_{false};
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}  //  namespace storage
+#endif  //  SRC_INSTANCE_EXECUTOR_H_
@@ -12,6 +12,7 @@
 
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/db.h"
+#include "src/compaction_meta_cache.h"
 #include "src/debug.h"
 #include "src/lists_data_key_format.h"
 #include "src/lists_meta_value_format.h"
@@ -26,9 +27,9 @@ namespace storage {
 
 class ListsDataFilter : public rocksdb::CompactionFilter {
  public:
-  ListsDataFilter(rocksdb::DB* db, std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr, enum DataType type)
-      : db_(db),
-        cf_handles_ptr_(cf_handles_ptr),
+  ListsDataFilter(rocksdb::DB* db, std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr, enum DataType type,
+                  CompactionMetaCache* meta_cache = nullptr)
+      : meta_reader_(db, cf_handles_ptr, meta_cache),
         type_(type)
         {}
 
@@ -49,58 +50,7 @@ class ListsDataFilter : public rocksdb::CompactionFilter {
     std::string meta_key_enc(key.data(), std::distance(key.data(), ptr));
     meta_key_enc.append(kSuffixReserveLength, kNeedTransformCharacter);
 
-    if (meta_key_enc != cur_key_) {
-      cur_key_ = meta_key_enc;
-      cur_meta_etime_ = 0;
-      cur_meta_version_ = 0;
-      meta_not_found_ = true;
-      std::string meta_value;
-      // destroyed when close the database, Reserve Current key value
-      if (cf_handles_ptr_->empty()) {
-        return false;
-      }
-      rocksdb::Status s = db_->Get(default_read_options_, (*cf_handles_ptr_)[0], cur_key_, &meta_value);
-      if (s.ok()) {
-        /*
-         * The elimination policy for keys of the Data type is that if the key
-         * type obtained from MetaCF is inconsistent with the key type in Data,
-         * it needs to be eliminated
-         */
-        auto type = static_cast<enum DataType>(static_cast<uint8_t>(meta_value[0]));
-        if (type != type_) {
-          return true;
-        }
-        ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
-        meta_not_found_ = false;
-        cur_meta_version_ = parsed_lists_meta_value.Version();
-        cur_meta_etime_ = parsed_lists_meta_value.Etime();
-      } else if (s.IsNotFound()) {
-        meta_not_found_ = true;
-      } else {
-        cur_key_ = "";
-        TRACE("Reserve[Get meta_key faild]");
-        return false;
-      }
-    }
-
-    if (meta_not_found_) {
-      TRACE("Drop[Meta key not exist]");
-      return true;
-    }
-
-    pstd::TimeType unix_time = pstd::NowMillis();
-    if (cur_meta_etime_ != 0 && cur_meta_etime_ < static_cast<uint64_t>(unix_time)) {
-      TRACE("Drop[Timeout]");
-      return true;
-    }
-
-    if (cur_meta_version_ > parsed_lists_data_key.Version()) {
-      TRACE("Drop[list_data_key_version < cur_meta_version]");
-      return true;
-    } else {
-      TRACE("Reserve[list_data_key_version == cur_meta_version]");
-      return false;
-    }
+    return meta_reader_.Drop(meta_key_enc, type_, parsed_lists_data_key.Version());
   }
 
   /*
@@ -122,24 +72,19 @@ class ListsDataFilter : public rocksdb::CompactionFilter {
   const char* Name() const override { return "ListsDataFilter"; }
 
  private:
-  rocksdb::DB* db_ = nullptr;
-  std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr_ = nullptr;
-  rocksdb::ReadOptions default_read_options_;
-  mutable std::string cur_key_;
-  mutable bool meta_not_found_ = false;
-  mutable uint64_t cur_meta_version_ = 0;
-  mutable uint64_t cur_meta_etime_ = 0;
+  mutable CompactionMetaReader meta_reader_;
   enum DataType type_ = DataType::kNones;
 };
 
 class ListsDataFilterFactory : public rocksdb::CompactionFilterFactory {
  public:
-  ListsDataFilterFactory(rocksdb::DB** db_ptr, std::vector<rocksdb::ColumnFamilyHandle*>* handles_ptr, enum DataType type)
-      : db_ptr_(db_ptr), cf_handles_ptr_(handles_ptr), type_(type) {}
+  ListsDataFilterFactory(rocksdb::DB** db_ptr, std::vector<rocksdb::ColumnFamilyHandle*>* handles_ptr, enum DataType type,
+                         CompactionMetaCache* meta_cache = nullptr)
+      : db_ptr_(db_ptr), cf_handles_ptr_(handles_ptr), type_(type), meta_cache_(meta_cache) {}
 
   std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
       const rocksdb::CompactionFilter::Context& context) override {
-    return std::unique_ptr<rocksdb::CompactionFilter>(new ListsDataFilter(*db_ptr_, cf_handles_ptr_, type_));
+    return std::unique_ptr<rocksdb::CompactionFilter>(new ListsDataFilter(*db_ptr_, cf_handles_ptr_, type_, meta_cache_));
   }
   const char* Name() const override { return "ListsDataFilterFactory"; }
 
@@ -147,6 +92,7 @@ class ListsDataFilterFactory : public rocksdb::CompactionFilterFactory {
   rocksdb::DB** db_ptr_ = nullptr;
   std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr_ = nullptr;
   enum DataType type_ = DataType::kNones;
+  CompactionMetaCache* meta_cache_ = nullptr;
 };
 
 }  //  namespace storage
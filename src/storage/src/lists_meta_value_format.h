@@ -16,6 +16,17 @@ namespace storage {
 const uint64_t InitalLeftIndex = 9223372036854775807;
 const uint64_t InitalRightIndex = 9223372036854775808U;
 
+// The first byte of the reserve of lists meta tells how the elements
+// of the list are stored
+enum class ListsEncoding : uint8_t {
+  // one kListsDataCF entry per element at its index
+  kElements = 0,
+  // kListsDataCF entries packing many elements each, see lists_nodes.h
+  kNodes = 1,
+};
+const size_t kListsHeadNodeCountOffset = 8;
+const size_t kListsTailNodeCountOffset = 12;
+
 /*
 *| type | list_size | version | left index | right index | reserve |  cdate | timestamp |
 *|  1B  |     8B    |    8B   |     8B     |      8B     |   16B   |    8B  |     8B    |
@@ -197,6 +208,8 @@ class ParsedListsMetaValue : public ParsedInternalValue {
     this->SetCount(0);
     this->set_left_index(InitalLeftIndex);
     this->set_right_index(InitalRightIndex);
+    this->SetEncoding(ListsEncoding::kElements);
+    this->SetNodeCounts(0, 0);
     this->SetEtime(0);
     this->SetCtime(0);
     return this->UpdateVersion();
@@ -271,7 +284,34 @@ class ParsedListsMetaValue : public ParsedInternalValue {
     }
   }
 
+  ListsEncoding Encoding() { return static_cast<ListsEncoding>(static_cast<uint8_t>(reserve_[0])); }
+
+  void SetEncoding(ListsEncoding encoding) {
+    reserve_[0] = static_cast<char>(encoding);
+    SetReserveToValue();
+  }
+
+  // For lists of ListsEncoding::kNodes, the left and right index are the
+  // ids of the head and tail node and the reserve keeps their element counts
+  uint32_t HeadNodeCount() { return DecodeFixed32(reserve_ + kListsHeadNodeCountOffset); }
+
+  uint32_t TailNodeCount() { return DecodeFixed32(reserve_ + kListsTailNodeCountOffset); }
+
+  void SetNodeCounts(uint32_t head_count, uint32_t tail_count) {
+    EncodeFixed32(reserve_ + kListsHeadNodeCountOffset, head_count);
+    EncodeFixed32(reserve_ + kListsTailNodeCountOffset, tail_count);
+    SetReserveToValue();
+  }
+
 private:
+  void SetReserveToValue() {
+    if (value_) {
+      char* dst = const_cast<char*>(value_->data()) + value_->size() - kListsMetaValueSuffixLength + kVersionLength +
+                  2 * kListValueIndexLength;
+      memcpy(dst, reserve_, sizeof(reserve_));
+    }
+  }
+
   const size_t kListsMetaValueSuffixLength = kVersionLength + 2 * kListValueIndexLength + kSuffixReserveLength + 2 * kTimestampLength;
 
  private:
@@ -0,0 +1,631 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "src/lists_nodes.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "src/base_data_value_format.h"
+#include "src/coding.h"
+#include "src/lists_data_key_format.h"
+
+namespace storage {
+
+static const size_t kNodeIndexEntryLength = sizeof(uint64_t) + sizeof(uint32_t);
+
+static void AppendFixed32(std::string* dst, uint32_t value) {
+  char buf[sizeof(uint32_t)];
+  EncodeFixed32(buf, value);
+  dst->append(buf, sizeof(buf));
+}
+
+static void AppendFixed64(std::string* dst, uint64_t value) {
+  char buf[sizeof(uint64_t)];
+  EncodeFixed64(buf, value);
+  dst->append(buf, sizeof(buf));
+}
+
+ListsNodes::ListsNodes(rocksdb::DB* db, rocksdb::ColumnFamilyHandle* handle, const rocksdb::ReadOptions& read_options,
+                       const Slice& key, ParsedListsMetaValue* meta, uint32_t node_max_elements)
+    : db_(db),
+      handle_(handle),
+      read_options_(read_options),
+      key_(key.ToString()),
+      meta_(meta),
+      version_(meta->Version()),
+      node_max_elements_(std::max<uint32_t>(node_max_elements, 1)),
+      count_(meta->Count()) {
+  if (count_ == 0) {
+    // a new list, there is nothing to read
+    index_loaded_ = true;
+    return;
+  }
+  Node head;
+  head.id = meta->LeftIndex();
+  head.count = meta->HeadNodeCount();
+  nodes_.push_back(std::move(head));
+  if (meta->RightIndex() != meta->LeftIndex()) {
+    Node tail;
+    tail.id = meta->RightIndex();
+    tail.count = meta->TailNodeCount();
+    nodes_.push_back(std::move(tail));
+  }
+}
+
+std::string ListsNodes::NodeKey(uint64_t id) const {
+  ListsDataKey lists_data_key(key_, version_, id);
+  return lists_data_key.Encode().ToString();
+}
+
+Status ListsNodes::LoadIndex() {
+  if (index_loaded_) {
+    return Status::OK();
+  }
+  std::string value;
+  Status s = db_->Get(read_options_, handle_, NodeKey(kListsNodeIndexId), &value);
+  if (s.IsNotFound()) {
+    return Status::Corruption("list node index not found, key: " + key_);
+  } else if (!s.ok()) {
+    return s;
+  }
+  ParsedBaseDataValue parsed_value(&value);
+  Slice index = parsed_value.UserValue();
+  if (index.size() < sizeof(uint64_t) || (index.size() - sizeof(uint64_t)) % kNodeIndexEntryLength != 0) {
+    return Status::Corruption("invalid list node index, key: " + key_);
+  }
+
+  std::deque<Node> nodes;
+  const char* ptr = index.data();
+  next_id_ = DecodeFixed64(ptr);
+  ptr += sizeof(uint64_t);
+  for (size_t i = 0; i < (index.size() - sizeof(uint64_t)) / kNodeIndexEntryLength; ++i) {
+    Node node;
+    node.id = DecodeFixed64(ptr);
+    node.count = DecodeFixed32(ptr + sizeof(uint64_t));
+    ptr += kNodeIndexEntryLength;
+    nodes.push_back(std::move(node));
+  }
+  if (nodes.empty() || nodes.front().id != nodes_.front().id || nodes.back().id != nodes_.back().id) {
+    return Status::Corruption("list node index does not match meta, key: " + key_);
+  }
+
+  // the edge nodes we have are the up to date ones
+  nodes.front() = std::move(nodes_.front());
+  if (nodes.size() > 1) {
+    nodes.back() = std::move(nodes_.back());
+  }
+  uint64_t count = 0;
+  for (const auto& node : nodes) {
+    count += node.count;
+  }
+  if (count != count_) {
+    return Status::Corruption("list node index count mismatch, key: " + key_);
+  }
+  nodes_.swap(nodes);
+  index_loaded_ = true;
+  return Status::OK();
+}
+
+Status ListsNodes::LoadNode(Node* node) {
+  if (node->loaded) {
+    return Status::OK();
+  }
+  std::string value;
+  Status s = db_->Get(read_options_, handle_, NodeKey(node->id), &value);
+  if (s.IsNotFound()) {
+    return Status::Corruption("list node not found, key: " + key_);
+  } else if (!s.ok()) {
+    return s;
+  }
+  ParsedBaseDataValue parsed_value(&value);
+  Slice data = parsed_value.UserValue();
+  node->elements.clear();
+  node->elements.reserve(node->count);
+  const char* ptr = data.data();
+  size_t left = data.size();
+  while (left > 0) {
+    if (left < sizeof(uint32_t)) {
+      return Status::Corruption("invalid list node, key: " + key_);
+    }
+    uint32_t len = DecodeFixed32(ptr);
+    ptr += sizeof(uint32_t);
+    left -= sizeof(uint32_t);
+    if (len > left) {
+      return Status::Corruption("invalid list node, key: " + key_);
+    }
+    node->elements.emplace_back(ptr, len);
+    ptr += len;
+    left -= len;
+  }
+  if (node->elements.size() != node->count) {
+    return Status::Corruption("list node count mismatch, key: " + key_);
+  }
+  node->loaded = true;
+  return Status::OK();
+}
+
+void ListsNodes::Release(Node* node) {
+  if (!node->dirty) {
+    std::vector<std::string>().swap(node->elements);
+    node->loaded = false;
+  }
+}
+
+Status ListsNodes::Locate(uint64_t pos, size_t* node, uint64_t* node_start) {
+  if (pos < nodes_.front().count) {
+    *node = 0;
+    *node_start = 0;
+    return Status::OK();
+  }
+  if (pos >= count_ - nodes_.back().count) {
+    *node = nodes_.size() - 1;
+    *node_start = count_ - nodes_.back().count;
+    return Status::OK();
+  }
+  Status s = LoadIndex();
+  if (!s.ok()) {
+    return s;
+  }
+  uint64_t start = 0;
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    if (pos < start + nodes_[i].count) {
+      *node = i;
+      *node_start = start;
+      return Status::OK();
+    }
+    start += nodes_[i].count;
+  }
+  return Status::Corruption("list position out of range, key: " + key_);
+}
+
+Status ListsNodes::NewNode(size_t at) {
+  Node node;
+  node.id = next_id_++;
+  node.loaded = true;
+  node.dirty = true;
+  nodes_.insert(nodes_.begin() + static_cast<int64_t>(at), std::move(node));
+  index_dirty_ = true;
+  return Status::OK();
+}
+
+Status ListsNodes::EraseNode(size_t node) {
+  if (!index_loaded_ && nodes_.size() > 1) {
+    // the neighbour of the erased edge node becomes the new edge
+    bool back = node != 0;
+    Status s = LoadIndex();
+    if (!s.ok()) {
+      return s;
+    }
+    node = back ? nodes_.size() - 1 : 0;
+  }
+  deleted_ids_.push_back(nodes_[node].id);
+  count_ -= nodes_[node].count;
+  nodes_.erase(nodes_.begin() + static_cast<int64_t>(node));
+  index_dirty_ = true;
+  if (nodes_.empty()) {
+    // the ids deleted above may be used again, the deletes go
+    // into the batch ahead of the puts
+    index_loaded_ = true;
+    next_id_ = kListsNodeIndexId + 1;
+  }
+  return Status::OK();
+}
+
+void ListsNodes::Changed(size_t node) {
+  nodes_[node].dirty = true;
+  // the counts of the edge nodes are kept in meta
+  if (node != 0 && node + 1 != nodes_.size()) {
+    index_dirty_ = true;
+  }
+}
+
+Status ListsNodes::SplitIfOversized(size_t node) {
+  if (nodes_[node].count <= node_max_elements_) {
+    return Status::OK();
+  }
+  Status s = LoadIndex();
+  if (!s.ok()) {
+    return s;
+  }
+  Node next;
+  next.id = next_id_++;
+  next.loaded = true;
+  next.dirty = true;
+  auto& elements = nodes_[node].elements;
+  size_t half = elements.size() / 2;
+  next.elements.assign(std::make_move_iterator(elements.begin() + static_cast<int64_t>(half)),
+                       std::make_move_iterator(elements.end()));
+  elements.resize(half);
+  next.count = next.elements.size();
+  nodes_[node].count = half;
+  nodes_[node].dirty = true;
+  nodes_.insert(nodes_.begin() + static_cast<int64_t>(node) + 1, std::move(next));
+  index_dirty_ = true;
+  return Status::OK();
+}
+
+Status ListsNodes::MergeSmallNodes() {
+  Status s;
+  for (size_t i = 0; i + 1 < nodes_.size();) {
+    Node& node = nodes_[i];
+    Node& next = nodes_[i + 1];
+    if ((node.dirty || next.dirty) && node.count + next.count <= node_max_elements_ / 2) {
+      s = LoadNode(&node);
+      if (s.ok()) {
+        s = LoadNode(&next);
+      }
+      if (!s.ok()) {
+        return s;
+      }
+      node.elements.insert(node.elements.end(), std::make_move_iterator(next.elements.begin()),
+                           std::make_move_iterator(next.elements.end()));
+      node.count += next.count;
+      next.count = 0;
+      Changed(i);
+      s = EraseNode(i + 1);
+      if (!s.ok()) {
+        return s;
+      }
+      continue;
+    }
+    ++i;
+  }
+  return Status::OK();
+}
+
+Status ListsNodes::Get(uint64_t pos, std::string* element) {
+  size_t node = 0;
+  uint64_t node_start = 0;
+  Status s = Locate(pos, &node, &node_start);
+  if (s.ok()) {
+    s = LoadNode(&nodes_[node]);
+  }
+  if (s.ok()) {
+    *element = nodes_[node].elements[pos - node_start];
+  }
+  return s;
+}
+
+Status ListsNodes::Set(uint64_t pos, const Slice& value) {
+  size_t node = 0;
+  uint64_t node_start = 0;
+  Status s = Locate(pos, &node, &node_start);
+  if (s.ok()) {
+    s = LoadNode(&nodes_[node]);
+  }
+  if (s.ok()) {
+    nodes_[node].elements[pos - node_start] = value.ToString();
+    Changed(node);
+  }
+  return s;
+}
+
+Status ListsNodes::Range(uint64_t start, uint64_t stop, std::vector<std::string>* elements) {
+  Status s;
+  if (!index_loaded_ && stop >= nodes_.front().count && start < count_ - nodes_.back().count) {
+    s = LoadIndex();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  size_t node = 0;
+  uint64_t node_start = 0;
+  s = Locate(start, &node, &node_start);
+  if (!s.ok()) {
+    return s;
+  }
+  uint64_t pos = start;
+  for (; pos <= stop && node < nodes_.size(); ++node) {
+    Node& current = nodes_[node];
+    s = LoadNode(&current);
+    if (!s.ok()) {
+      return s;
+    }
+    for (uint64_t offset = pos - node_start; offset < current.count && pos <= stop; ++offset, ++pos) {
+      elements->push_back(current.elements[offset]);
+    }
+    node_start += current.count;
+    Release(&current);
+  }
+  return Status::OK();
+}
+
+Status ListsNodes::Find(const Slice& value, uint64_t* pos) {
+  Status s = LoadIndex();
+  if (!s.ok()) {
+    return s;
+  }
+  uint64_t node_start = 0;
+  for (auto& node : nodes_) {
+    s = LoadNode(&node);
+    if (!s.ok()) {
+      return s;
+    }
+    for (size_t i = 0; i < node.elements.size(); ++i) {
+      if (value.compare(node.elements[i]) == 0) {
+        *pos = node_start + i;
+        return Status::OK();
+      }
+    }
+    node_start += node.count;
+    Release(&node);
+  }
+  return Status::NotFound();
+}
+
+Status ListsNodes::Insert(uint64_t pos, const Slice& value) {
+  Status s = LoadIndex();
+  if (!s.ok()) {
+    return s;
+  }
+  if (nodes_.empty()) {
+    NewNode(0);
+  }
+  size_t node = nodes_.size() - 1;
+  uint64_t node_start = count_ - nodes_.back().count;
+  if (pos < count_) {
+    s = Locate(pos, &node, &node_start);
+  }
+  if (s.ok()) {
+    s = LoadNode(&nodes_[node]);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  auto& elements = nodes_[node].elements;
+  elements.insert(elements.begin() + static_cast<int64_t>(pos - node_start), value.ToString());
+  nodes_[node].count++;
+  count_++;
+  Changed(node);
+  return SplitIfOversized(node);
+}
+
+Status ListsNodes::PushFront(const std::vector<std::string>& values) {
+  Status s;
+  for (const auto& value : values) {
+    if (nodes_.empty() || nodes_.front().count >= node_max_elements_) {
+      s = LoadIndex();
+      if (!s.ok()) {
+        return s;
+      }
+      NewNode(0);
+    }
+    Node& front = nodes_.front();
+    s = LoadNode(&front);
+    if (!s.ok()) {
+      return s;
+    }
+    front.elements.insert(front.elements.begin(), value);
+    front.count++;
+    count_++;
+    Changed(0);
+  }
+  return Status::OK();
+}
+
+Status ListsNodes::PushBack(const std::vector<std::string>& values) {
+  Status s;
+  for (const auto& value : values) {
+    if (nodes_.empty() || nodes_.back().count >= node_max_elements_) {
+      s = LoadIndex();
+      if (!s.ok()) {
+        return s;
+      }
+      NewNode(nodes_.size());
+    }
+    Node& back = nodes_.back();
+    s = LoadNode(&back);
+    if (!s.ok()) {
+      return s;
+    }
+    back.elements.push_back(value);
+    back.count++;
+    count_++;
+    Changed(nodes_.size() - 1);
+  }
+  return Status::OK();
+}
+
+Status ListsNodes::PopFront(uint64_t count, std::vector<std::string>* elements) {
+  Status s;
+  while (count > 0 && count_ > 0) {
+    Node& front = nodes_.front();
+    s = LoadNode(&front);
+    if (!s.ok()) {
+      return s;
+    }
+    uint64_t num = std::min(count, front.count);
+    auto end = front.elements.begin() + static_cast<int64_t>(num);
+    elements->insert(elements->end(), std::make_move_iterator(front.elements.begin()), std::make_move_iterator(end));
+    front.elements.erase(front.elements.begin(), end);
+    front.count -= num;
+    count_ -= num;
+    count -= num;
+    if (front.count == 0) {
+      s = EraseNode(0);
+      if (!s.ok()) {
+        return s;
+      }
+    } else {
+      Changed(0);
+    }
+  }
+  return Status::OK();
+}
+
+Status ListsNodes::PopBack(uint64_t count, std::vector<std::string>* elements) {
+  Status s;
+  while (count > 0 && count_ > 0) {
+    Node& back = nodes_.back();
+    s = LoadNode(&back);
+    if (!s.ok()) {
+      return s;
+    }
+    uint64_t num = std::min(count, back.count);
+    for (uint64_t i = 0; i < num; ++i) {
+      elements->push_back(std::move(back.elements[back.elements.size() - 1 - i]));
+    }
+    back.elements.resize(back.elements.size() - num);
+    back.count -= num;
+    count_ -= num;
+    count -= num;
+    if (back.count == 0) {
+      s = EraseNode(nodes_.size() - 1);
+      if (!s.ok()) {
+        return s;
+      }
+    } else {
+      Changed(nodes_.size() - 1);
+    }
+  }
+  return Status::OK();
+}
+
+Status ListsNodes::DropFront(uint64_t count) {
+  Status s;
+  while (count > 0 && count_ > 0) {
+    Node& front = nodes_.front();
+    if (front.count <= count) {
+      count -= front.count;
+      s = EraseNode(0);
+    } else {
+      s = LoadNode(&front);
+      if (s.ok()) {
+        front.elements.erase(front.elements.begin(), front.elements.begin() + static_cast<int64_t>(count));
+        front.count -= count;
+        count_ -= count;
+        count = 0;
+        Changed(0);
+      }
+    }
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
+Status ListsNodes::DropBack(uint64_t count) {
+  Status s;
+  while (count > 0 && count_ > 0) {
+    Node& back = nodes_.back();
+    if (back.count <= count) {
+      count -= back.count;
+      s = EraseNode(nodes_.size() - 1);
+    } else {
+      s = LoadNode(&back);
+      if (s.ok()) {
+        back.elements.resize(back.elements.size() - count);
+        back.count -= count;
+        count_ -= count;
+        count = 0;
+        Changed(nodes_.size() - 1);
+      }
+    }
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  return Status::OK();
+}
+
+Status ListsNodes::Remove(int64_t count, const Slice& value, uint64_t* removed) {
+  *removed = 0;
+  Status s = LoadIndex();
+  if (!s.ok()) {
+    return s;
+  }
+  bool reverse = count < 0;
+  uint64_t rest = reverse ? -count : count;
+  for (size_t n = 0; n < nodes_.size() && (count == 0 || rest != 0); ++n) {
+    size_t i = reverse ? nodes_.size() - 1 - n : n;
+    Node& node = nodes_[i];
+    s = LoadNode(&node);
+    if (!s.ok()) {
+      return s;
+    }
+    std::vector<std::string> kept;
+    kept.reserve(node.elements.size());
+    for (size_t k = 0; k < node.elements.size(); ++k) {
+      std::string& element = node.elements[reverse ? node.elements.size() - 1 - k : k];
+      if ((count == 0 || rest != 0) && value.compare(element) == 0) {
+        if (count != 0) {
+          rest--;
+        }
+      } else {
+        kept.push_back(std::move(element));
+      }
+    }
+    if (reverse) {
+      std::reverse(kept.begin(), kept.end());
+    }
+    uint64_t num = node.elements.size() - kept.size();
+    if (num == 0) {
+      Release(&node);
+      continue;
+    }
+    node.elements.swap(kept);
+    node.count -= num;
+    count_ -= num;
+    *removed += num;
+    Changed(i);
+  }
+
+  for (size_t i = nodes_.size(); i > 0; --i) {
+    if (nodes_[i - 1].count == 0) {
+      s = EraseNode(i - 1);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  return MergeSmallNodes();
+}
+
+void ListsNodes::Flush(rocksdb::WriteBatch* batch) {
+  for (uint64_t id : deleted_ids_) {
+    batch->Delete(handle_, NodeKey(id));
+  }
+  if (count_ == 0) {
+    batch->Delete(handle_, NodeKey(kListsNodeIndexId));
+    meta_->SetCount(0);
+    meta_->SetNodeCounts(0, 0);
+    return;
+  }
+
+  for (auto& node : nodes_) {
+    if (!node.dirty) {
+      continue;
+    }
+    std::string data;
+    for (const auto& element : node.elements) {
+      AppendFixed32(&data, static_cast<uint32_t>(element.size()));
+      data.append(element);
+    }
+    BaseDataValue node_value(data);
+    batch->Put(handle_, NodeKey(node.id), node_value.Encode());
+    node.dirty = false;
+  }
+  if (index_dirty_) {
+    std::string index;
+    index.reserve(sizeof(uint64_t) + nodes_.size() * kNodeIndexEntryLength);
+    AppendFixed64(&index, next_id_);
+    for (const auto& node : nodes_) {
+      AppendFixed64(&index, node.id);
+      AppendFixed32(&index, static_cast<uint32_t>(node.count));
+    }
+    BaseDataValue index_value(index);
+    batch->Put(handle_, NodeKey(kListsNodeIndexId), index_value.Encode());
+    index_dirty_ = false;
+  }
+
+  meta_->SetCount(count_);
+  meta_->set_left_index(nodes_.front().id);
+  meta_->set_right_index(nodes_.back().id);
+  meta_->SetNodeCounts(static_cast<uint32_t>(nodes_.front().count), static_cast<uint32_t>(nodes_.back().count));
+}
+
+}  //  namespace storage
@@ -0,0 +1,139 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_LISTS_NODES_H_
+#define SRC_LISTS_NODES_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "rocksdb/db.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "rocksdb/write_batch.h"
+
+#include "src/lists_meta_value_format.h"
+
+namespace storage {
+
+using Slice = rocksdb::Slice;
+using Status = rocksdb::Status;
+
+// Node size used by lists of ListsEncoding::kNodes when
+// list-node-max-elements is 0, and the largest one allowed
+const uint32_t kListsNodeDefaultElements = 128;
+const uint32_t kListsNodeMaxElements = 8192;
+// The node index of a list is kept at this id, nodes start at 1
+const uint64_t kListsNodeIndexId = 0;
+
+/*
+ * Elements of a list of ListsEncoding::kNodes, quicklist style.
+ *
+ * The elements are packed in order into nodes of at most node_max_elements
+ * elements, node n of the list is kept in kListsDataCF at
+ * ListsDataKey(key, version, n):
+ * | element len | element | element len | element | ...
+ * |     4B      |         |     4B      |         |
+ *
+ * The node index at ListsDataKey(key, version, kListsNodeIndexId) lists
+ * the nodes in list order:
+ * | next node id | node id | count | node id | count | ...
+ * |      8B      |    8B   |   4B  |    8B   |   4B  |
+ *
+ * The meta keeps the ids and element counts of the head and tail node,
+ * the counts of both in the node index may be stale. Pushing to and popping
+ * from a list only reads and writes its edge node, the node index is read
+ * when an interior node is needed and written when nodes are added, removed
+ * or an interior node changes its count. Inserting into, removing from or
+ * setting an element in the middle rewrites one or two nodes and the index.
+ *
+ * The values are BaseDataValue encoded like the elements of the
+ * ListsEncoding::kElements lists, so ListsDataFilter drops the nodes and
+ * node index of stale versions the same way.
+ *
+ * The caller holds the record lock of key for writes and calls Flush
+ * to put the changes into the batch of the write.
+ */
+class ListsNodes {
+ public:
+  // meta must be a kNodes list, an empty one for a new list
+  ListsNodes(rocksdb::DB* db, rocksdb::ColumnFamilyHandle* handle, const rocksdb::ReadOptions& read_options,
+             const Slice& key, ParsedListsMetaValue* meta, uint32_t node_max_elements);
+
+  uint64_t Count() const { return count_; }
+  // The number of node keys deleted so far
+  uint64_t deleted_nodes() const { return deleted_ids_.size(); }
+
+  // pos, start and stop are the 0 based positions in the list,
+  // they should be less than Count()
+  Status Get(uint64_t pos, std::string* element);
+  Status Set(uint64_t pos, const Slice& value);
+  Status Range(uint64_t start, uint64_t stop, std::vector<std::string>* elements);
+  // The position of the first element equal to value
+  Status Find(const Slice& value, uint64_t* pos);
+  // Insert value before pos, pos may be Count() to append it
+  Status Insert(uint64_t pos, const Slice& value);
+
+  // Every value is pushed in turn, like LPUSH and RPUSH
+  Status PushFront(const std::vector<std::string>& values);
+  Status PushBack(const std::vector<std::string>& values);
+  Status PopFront(uint64_t count, std::vector<std::string>* elements);
+  Status PopBack(uint64_t count, std::vector<std::string>* elements);
+  // Same as the pops without reading the dropped nodes
+  Status DropFront(uint64_t count);
+  Status DropBack(uint64_t count);
+  // LREM, from the head if count >= 0, from the tail otherwise
+  Status Remove(int64_t count, const Slice& value, uint64_t* removed);
+
+  // Put the changed nodes and node index into batch, and the
+  // counts and edge nodes into meta, the caller puts meta
+  void Flush(rocksdb::WriteBatch* batch);
+
+ private:
+  struct Node {
+    uint64_t id = 0;
+    uint64_t count = 0;
+    bool loaded = false;
+    bool dirty = false;
+    std::vector<std::string> elements;
+  };
+
+  // Until the node index is read, nodes_ only holds the head
+  // node and the tail node if there are more than one nodes
+  Status LoadIndex();
+  Status LoadNode(Node* node);
+  // Drop the elements of a node only read, so reading a long
+  // list does not keep all of it in memory
+  void Release(Node* node);
+  // The node holding pos and the position of its first element
+  Status Locate(uint64_t pos, size_t* node, uint64_t* node_start);
+  Status NewNode(size_t at);
+  Status EraseNode(size_t node);
+  // Called after the elements of a node changed
+  void Changed(size_t node);
+  Status SplitIfOversized(size_t node);
+  // Merge small nodes with their next node
+  Status MergeSmallNodes();
+  std::string NodeKey(uint64_t id) const;
+
+  rocksdb::DB* db_;
+  rocksdb::ColumnFamilyHandle* handle_;
+  const rocksdb::ReadOptions& read_options_;
+  std::string key_;
+  ParsedListsMetaValue* meta_;
+  uint64_t version_;
+  uint32_t node_max_elements_;
+
+  uint64_t count_ = 0;
+  bool index_loaded_ = false;
+  bool index_dirty_ = false;
+  uint64_t next_id_ = kListsNodeIndexId + 1;
+  std::deque<Node> nodes_;
+  std::vector<uint64_t> deleted_ids_;
+};
+
+}  //  namespace storage
+#endif  //  SRC_LISTS_NODES_H_
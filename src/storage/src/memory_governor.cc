@@ -0,0 +1,105 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "storage/memory_governor.h"
+
+#include <algorithm>
+
+namespace storage {
+
+// part * weight / total_weight without overflowing
+static size_t WeightedShare(size_t part, uint64_t weight, uint64_t total_weight) {
+  return static_cast<size_t>(static_cast<long double>(part) * weight / total_weight);
+}
+
+MemoryGovernor::MemoryGovernor(size_t budget, size_t memtable_budget, const std::vector<uint32_t>& weights,
+                               int num_shard_bits)
+    : budget_(budget), memtable_budget_(std::min(memtable_budget, budget)), weights_(kColumnFamilyNum, 1) {
+  for (int cf = 0; cf < kColumnFamilyNum && cf < static_cast<int>(weights.size()); ++cf) {
+    weights_[cf] = std::max<uint32_t>(weights[cf], 1);
+  }
+  for (auto weight : weights_) {
+    total_weight_ += weight;
+  }
+  write_buffer_manager_ = std::make_shared<rocksdb::WriteBufferManager>(memtable_budget_);
+
+  // the memtables are empty, the block caches start with all the budget
+  std::vector<size_t> usages(kColumnFamilyNum, 0);
+  std::vector<size_t> capacities = Distribute(budget_, weights_, usages, &shares_);
+  for (int cf = 0; cf < kColumnFamilyNum; ++cf) {
+    block_caches_.push_back(rocksdb::NewLRUCache(capacities[cf], num_shard_bits));
+  }
+}
+
+size_t MemoryGovernor::BlockCacheShare(int cf) {
+  std::lock_guard l(mu_);
+  return shares_[cf];
+}
+
+size_t MemoryGovernor::MemtableShare(int cf) const {
+  return WeightedShare(memtable_budget_, weights_[cf], total_weight_);
+}
+
+size_t MemoryGovernor::WriteBufferSize(int cf, size_t write_buffer_size) const {
+  return std::max<size_t>(WeightedShare(write_buffer_size, weights_[cf] * kColumnFamilyNum, total_weight_), 1 << 20);
+}
+
+void MemoryGovernor::Rebalance() {
+  size_t memtable_usage = std::min(MemtableUsage(), budget_);
+  std::vector<size_t> usages;
+  for (const auto& cache : block_caches_) {
+    usages.push_back(cache->GetUsage());
+  }
+  std::vector<size_t> shares;
+  std::vector<size_t> capacities = Distribute(budget_ - memtable_usage, weights_, usages, &shares);
+  for (int cf = 0; cf < kColumnFamilyNum; ++cf) {
+    if (block_caches_[cf]->GetCapacity() != capacities[cf]) {
+      block_caches_[cf]->SetCapacity(capacities[cf]);
+    }
+  }
+  std::lock_guard l(mu_);
+  shares_ = std::move(shares);
+}
+
+std::vector<size_t> MemoryGovernor::Distribute(size_t block_budget, const std::vector<uint32_t>& weights,
+                                               const std::vector<size_t>& usages, std::vector<size_t>* shares) {
+  uint64_t total_weight = 0;
+  for (auto weight : weights) {
+    total_weight += weight;
+  }
+  shares->clear();
+  if (total_weight == 0) {
+    shares->resize(weights.size(), 0);
+    return *shares;
+  }
+  for (auto weight : weights) {
+    shares->push_back(WeightedShare(block_budget, weight, total_weight));
+  }
+
+  std::vector<size_t> capacities = *shares;
+  size_t lent = 0;
+  uint64_t busy_weight = 0;
+  for (size_t i = 0; i < weights.size(); ++i) {
+    size_t share = (*shares)[i];
+    auto keep = static_cast<size_t>(std::max(usages[i] + share * kGovernorIdleHeadroom, share * kGovernorIdleMinShare));
+    if (keep < share) {
+      capacities[i] = keep;
+      lent += share - keep;
+    } else {
+      busy_weight += weights[i];
+    }
+  }
+  if (busy_weight == 0) {
+    return *shares;
+  }
+  for (size_t i = 0; i < weights.size(); ++i) {
+    if (capacities[i] == (*shares)[i]) {
+      capacities[i] += WeightedShare(lent, weights[i], busy_weight);
+    }
+  }
+  return capacities;
+}
+
+}  //  namespace storage
@@ -3,13 +3,21 @@
 //  LICENSE file in the root directory of this source tree. An additional grant
 //  of patent rights can be found in the PATENTS file in the same directory.
 
+#include <algorithm>
+#include <limits>
 #include <sstream>
 
 #include "rocksdb/env.h"
 
 #include "src/redis.h"
+#include "src/base_data_key_format.h"
+#include "src/base_data_value_format.h"
+#include "src/base_key_format.h"
+#include "src/lists_data_key_format.h"
+#include "src/zsets_data_key_format.h"
 #include "src/lists_filter.h"
 #include "src/base_filter.h"
+#include "src/custom_prefix_extractor.h"
 #include "src/zsets_filter.h"
 
 namespace storage {
@@ -30,14 +38,24 @@ Redis::Redis(Storage* const s, int32_t index)
     : storage_(s), index_(index),
       lock_mgr_(std::make_shared<LockMgr>(1000, 0, std::make_shared<MutexFactoryImpl>())),
       small_compaction_threshold_(5000),
-      small_compaction_duration_threshold_(10000) {
+      small_compaction_duration_threshold_(10000),
+      zset_rank_index_min_members_(0),
+      list_node_max_elements_(0),
+      range_delete_min_entries_(0),
+      inline_collection_max_entries_(0) {
   statistics_store_ = std::make_unique<LRUCache<std::string, KeyStatistics>>();
   scan_cursors_store_ = std::make_unique<LRUCache<std::string, std::string>>();
   spop_counts_store_ = std::make_unique<LRUCache<std::string, size_t>>();
+  zset_rank_index_store_ = std::make_unique<LRUCache<std::string, std::shared_ptr<ZSetRankIndex>>>();
+  sets_sample_index_store_ = std::make_unique<LRUCache<std::string, std::shared_ptr<ZSetRankIndex>>>();
+  compaction_meta_cache_ = std::make_unique<CompactionMetaCache>();
   default_compact_range_options_.exclusive_manual_compaction = false;
   default_compact_range_options_.change_level = true;
   spop_counts_store_->SetCapacity(1000);
   scan_cursors_store_->SetCapacity(5000);
+  // charged by the number of blocks of the index
+  zset_rank_index_store_->SetCapacity(kZSetRankIndexMaxBlocks);
+  sets_sample_index_store_->SetCapacity(kZSetRankIndexMaxBlocks);
   //env_ = rocksdb::Env::Instance();
   handles_.clear();
 }
@@ -57,15 +75,51 @@ Redis::~Redis() {
   }
 }
 
+// Seeks to the data keys of a version of a user key check the prefix
+// blooms of the sst files and memtable before reading their blocks
+static void SetDataKeyPrefixBloom(const StorageOptions& storage_options, DataType type,
+                                  rocksdb::ColumnFamilyOptions* cf_ops) {
+  const auto& types = storage_options.prefix_bloom_types;
+  if (std::find(types.begin(), types.end(), type) == types.end()) {
+    return;
+  }
+  cf_ops->prefix_extractor = NewDataKeyPrefixExtractor();
+  if (cf_ops->memtable_prefix_bloom_size_ratio == 0) {
+    cf_ops->memtable_prefix_bloom_size_ratio = kMemtablePrefixBloomSizeRatio;
+  }
+}
+
+// The block cache and memtable size of a column family under the memory governor
+static void SetMemoryGovernor(const StorageOptions& storage_options, ColumnFamilyIndex cf,
+                              rocksdb::ColumnFamilyOptions* cf_ops, rocksdb::BlockBasedTableOptions* table_ops) {
+  const auto& governor = storage_options.memory_governor;
+  if (governor == nullptr) {
+    return;
+  }
+  table_ops->block_cache = governor->BlockCache(cf);
+  table_ops->no_block_cache = false;
+  cf_ops->write_buffer_size = governor->WriteBufferSize(cf, cf_ops->write_buffer_size);
+}
+
 Status Redis::Open(const StorageOptions& storage_options, const std::string& db_path) {
   statistics_store_->SetCapacity(storage_options.statistics_max_size);
   small_compaction_threshold_ = storage_options.small_compaction_threshold;
+  zset_rank_index_min_members_ = storage_options.zset_rank_index_min_members;
+  list_node_max_elements_ = std::min(storage_options.list_node_max_elements, kListsNodeMaxElements);
+  inline_collection_max_entries_ =
+      std::min(storage_options.inline_collection_max_entries, kInlineCollectionMaxEntries);
+  compaction_meta_cache_->SetCapacity(storage_options.compaction_meta_cache_size);
+  compaction_meta_cache_->SetScanMeta(storage_options.compaction_meta_scan);
+  range_delete_min_entries_ = storage_options.range_delete_min_entries;
 
   rocksdb::BlockBasedTableOptions table_ops(storage_options.table_options);
   table_ops.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, true));
 
   rocksdb::DBOptions db_ops(storage_options.options);
   db_ops.create_missing_column_families = true;
+  if (storage_options.memory_governor != nullptr) {
+    db_ops.write_buffer_manager = storage_options.memory_governor->write_buffer_manager();
+  }
   if (storage_options.enable_db_statistics) {
     db_statistics_ = rocksdb::CreateDBStatistics();
     db_statistics_->set_stats_level(static_cast<rocksdb::StatsLevel>(storage_options.db_statistics_level));
@@ -86,43 +140,57 @@ Status Redis::Open(const StorageOptions& storage_options, const std::string& db_
   if (!storage_options.share_block_cache && storage_options.block_cache_size > 0) {
     meta_table_ops.block_cache = rocksdb::NewLRUCache(storage_options.block_cache_size);
   }
+  SetMemoryGovernor(storage_options, kMetaCF, &meta_cf_ops, &meta_table_ops);
   meta_cf_ops.table_factory.reset(rocksdb::NewBlockBasedTableFactory(meta_table_ops));
 
   // hash column-family options
   rocksdb::ColumnFamilyOptions hash_data_cf_ops(storage_options.options);
-  hash_data_cf_ops.compaction_filter_factory = std::make_shared<HashesDataFilterFactory>(&db_, &handles_, DataType::kHashes);
+  hash_data_cf_ops.compaction_filter_factory =
+      std::make_shared<HashesDataFilterFactory>(&db_, &handles_, DataType::kHashes, compaction_meta_cache_.get());
+  SetDataKeyPrefixBloom(storage_options, DataType::kHashes, &hash_data_cf_ops);
   rocksdb::BlockBasedTableOptions hash_data_cf_table_ops(table_ops);
   if (!storage_options.share_block_cache && storage_options.block_cache_size > 0) {
     hash_data_cf_table_ops.block_cache = rocksdb::NewLRUCache(storage_options.block_cache_size);
   }
+  SetMemoryGovernor(storage_options, kHashesDataCF, &hash_data_cf_ops, &hash_data_cf_table_ops);
   hash_data_cf_ops.table_factory.reset(rocksdb::NewBlockBasedTableFactory(hash_data_cf_table_ops));
 
   // list column-family options
   rocksdb::ColumnFamilyOptions list_data_cf_ops(storage_options.options);
-  list_data_cf_ops.compaction_filter_factory = std::make_shared<ListsDataFilterFactory>(&db_, &handles_, DataType::kLists);
+  list_data_cf_ops.compaction_filter_factory =
+      std::make_shared<ListsDataFilterFactory>(&db_, &handles_, DataType::kLists, compaction_meta_cache_.get());
   list_data_cf_ops.comparator = ListsDataKeyComparator();
+  SetDataKeyPrefixBloom(storage_options, DataType::kLists, &list_data_cf_ops);
 
   rocksdb::BlockBasedTableOptions list_data_cf_table_ops(table_ops);
   if (!storage_options.share_block_cache && storage_options.block_cache_size > 0) {
     list_data_cf_table_ops.block_cache = rocksdb::NewLRUCache(storage_options.block_cache_size);
   }
+  SetMemoryGovernor(storage_options, kListsDataCF, &list_data_cf_ops, &list_data_cf_table_ops);
   list_data_cf_ops.table_factory.reset(rocksdb::NewBlockBasedTableFactory(list_data_cf_table_ops));
 
   // set column-family options
   rocksdb::ColumnFamilyOptions set_data_cf_ops(storage_options.options);
-  set_data_cf_ops.compaction_filter_factory = std::make_shared<SetsMemberFilterFactory>(&db_, &handles_, DataType::kSets);
+  set_data_cf_ops.compaction_filter_factory =
+      std::make_shared<SetsMemberFilterFactory>(&db_, &handles_, DataType::kSets, compaction_meta_cache_.get());
+  SetDataKeyPrefixBloom(storage_options, DataType::kSets, &set_data_cf_ops);
   rocksdb::BlockBasedTableOptions set_data_cf_table_ops(table_ops);
   if (!storage_options.share_block_cache && storage_options.block_cache_size > 0) {
     set_data_cf_table_ops.block_cache = rocksdb::NewLRUCache(storage_options.block_cache_size);
   }
+  SetMemoryGovernor(storage_options, kSetsDataCF, &set_data_cf_ops, &set_data_cf_table_ops);
   set_data_cf_ops.table_factory.reset(rocksdb::NewBlockBasedTableFactory(set_data_cf_table_ops));
 
   // zset column-family options
   rocksdb::ColumnFamilyOptions zset_data_cf_ops(storage_options.options);
   rocksdb::ColumnFamilyOptions zset_score_cf_ops(storage_options.options);
-  zset_data_cf_ops.compaction_filter_factory = std::make_shared<ZSetsDataFilterFactory>(&db_, &handles_, DataType::kZSets);
-  zset_score_cf_ops.compaction_filter_factory = std::make_shared<ZSetsScoreFilterFactory>(&db_, &handles_, DataType::kZSets);
+  zset_data_cf_ops.compaction_filter_factory =
+      std::make_shared<ZSetsDataFilterFactory>(&db_, &handles_, DataType::kZSets, compaction_meta_cache_.get());
+  zset_score_cf_ops.compaction_filter_factory =
+      std::make_shared<ZSetsScoreFilterFactory>(&db_, &handles_, DataType::kZSets, compaction_meta_cache_.get());
   zset_score_cf_ops.comparator = ZSetsScoreKeyComparator();
+  SetDataKeyPrefixBloom(storage_options, DataType::kZSets, &zset_data_cf_ops);
+  SetDataKeyPrefixBloom(storage_options, DataType::kZSets, &zset_score_cf_ops);
 
   rocksdb::BlockBasedTableOptions zset_meta_cf_table_ops(table_ops);
   rocksdb::BlockBasedTableOptions zset_data_cf_table_ops(table_ops);
@@ -130,16 +198,21 @@ Status Redis::Open(const StorageOptions& storage_options, const std::string& db_
   if (!storage_options.share_block_cache && storage_options.block_cache_size > 0) {
     zset_data_cf_table_ops.block_cache = rocksdb::NewLRUCache(storage_options.block_cache_size);
   }
+  SetMemoryGovernor(storage_options, kZsetsDataCF, &zset_data_cf_ops, &zset_data_cf_table_ops);
   zset_data_cf_ops.table_factory.reset(rocksdb::NewBlockBasedTableFactory(zset_data_cf_table_ops));
+  SetMemoryGovernor(storage_options, kZsetsScoreCF, &zset_score_cf_ops, &zset_score_cf_table_ops);
   zset_score_cf_ops.table_factory.reset(rocksdb::NewBlockBasedTableFactory(zset_score_cf_table_ops));
 
   // stream column-family options
   rocksdb::ColumnFamilyOptions stream_data_cf_ops(storage_options.options);
-  stream_data_cf_ops.compaction_filter_factory = std::make_shared<BaseDataFilterFactory>(&db_, &handles_, DataType::kStreams);
+  stream_data_cf_ops.compaction_filter_factory =
+      std::make_shared<BaseDataFilterFactory>(&db_, &handles_, DataType::kStreams, compaction_meta_cache_.get());
+  SetDataKeyPrefixBloom(storage_options, DataType::kStreams, &stream_data_cf_ops);
   rocksdb::BlockBasedTableOptions stream_data_cf_table_ops(table_ops);
   if (!storage_options.share_block_cache && storage_options.block_cache_size > 0) {
     stream_data_cf_table_ops.block_cache = rocksdb::NewLRUCache(storage_options.block_cache_size);
   }
+  SetMemoryGovernor(storage_options, kStreamsDataCF, &stream_data_cf_ops, &stream_data_cf_table_ops);
   stream_data_cf_ops.table_factory.reset(rocksdb::NewBlockBasedTableFactory(stream_data_cf_table_ops));
 
   std::vector<rocksdb::ColumnFamilyDescriptor> column_families;
@@ -213,6 +286,144 @@ Status Redis::SetSmallCompactionDurationThreshold(uint64_t small_compaction_dura
   return Status::OK();
 }
 
+Status Redis::SetZSetRankIndexMinMembers(uint64_t zset_rank_index_min_members) {
+  zset_rank_index_min_members_ = zset_rank_index_min_members;
+  if (zset_rank_index_min_members == 0) {
+    zset_rank_index_store_->Clear();
+  }
+  return Status::OK();
+}
+
+Status Redis::SetListNodeMaxElements(uint32_t list_node_max_elements) {
+  list_node_max_elements_ = std::min(list_node_max_elements, kListsNodeMaxElements);
+  return Status::OK();
+}
+
+Status Redis::SetInlineCollectionMaxEntries(uint32_t inline_collection_max_entries) {
+  inline_collection_max_entries_ = std::min(inline_collection_max_entries, kInlineCollectionMaxEntries);
+  return Status::OK();
+}
+
+Status Redis::SetCompactionMetaCacheSize(size_t compaction_meta_cache_size) {
+  compaction_meta_cache_->SetCapacity(compaction_meta_cache_size);
+  return Status::OK();
+}
+
+Status Redis::SetCompactionMetaScan(bool compaction_meta_scan) {
+  compaction_meta_cache_->SetScanMeta(compaction_meta_scan);
+  return Status::OK();
+}
+
+Status Redis::SetRangeDeleteMinEntries(uint64_t range_delete_min_entries) {
+  range_delete_min_entries_ = range_delete_min_entries;
+  return Status::OK();
+}
+
+// The smallest key greater than every key starting with prefix
+static std::string PrefixSuccessor(const Slice& prefix) {
+  std::string successor = prefix.ToString();
+  while (!successor.empty() && static_cast<uint8_t>(successor.back()) == 0xff) {
+    successor.pop_back();
+  }
+  if (!successor.empty()) {
+    successor.back() = static_cast<char>(static_cast<uint8_t>(successor.back()) + 1);
+  }
+  return successor;
+}
+
+bool Redis::DeleteDataKeysRange(DataType type, const Slice& key, uint64_t version, uint64_t count,
+                                rocksdb::WriteBatch* batch) {
+  uint64_t min_entries = range_delete_min_entries_;
+  if (min_entries == 0 || count < min_entries) {
+    return false;
+  }
+  if (type == DataType::kLists) {
+    // kListsDataCF orders the keys of a list by version then index
+    ListsDataKey begin(key, version, 0);
+    ListsDataKey end(key, version + 1, 0);
+    batch->DeleteRange(handles_[kListsDataCF], begin.Encode(), end.Encode());
+    return true;
+  }
+  // the data keys of a version share the prefix of its seek key
+  BaseDataKey data_prefix(key, version, Slice());
+  Slice begin = data_prefix.EncodeSeekKey();
+  std::string end = PrefixSuccessor(begin);
+  if (type == DataType::kHashes) {
+    batch->DeleteRange(handles_[kHashesDataCF], begin, end);
+  } else if (type == DataType::kSets) {
+    batch->DeleteRange(handles_[kSetsDataCF], begin, end);
+  } else if (type == DataType::kZSets) {
+    batch->DeleteRange(handles_[kZsetsDataCF], begin, end);
+    // kZsetsScoreCF orders the keys of a zset by version then score
+    ZSetsScoreKey score_begin(key, version, -std::numeric_limits<double>::infinity(), Slice());
+    ZSetsScoreKey score_end(key, version + 1, -std::numeric_limits<double>::infinity(), Slice());
+    batch->DeleteRange(handles_[kZsetsScoreCF], score_begin.Encode(), score_end.Encode());
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool Redis::UseInlineEntries(ParsedBaseMetaValue* meta) {
+  if (meta->IsStale() || meta->Count() == 0) {
+    bool use_inline = inline_collection_max_entries_ != 0;
+    if (use_inline || meta->Encoding() == CollectionEncoding::kInline) {
+      meta->InitialMetaValue();
+    }
+    if (use_inline) {
+      meta->SetEncoding(CollectionEncoding::kInline);
+    }
+  }
+  return meta->Encoding() == CollectionEncoding::kInline;
+}
+
+Status Redis::DecodeInlineEntries(ParsedBaseMetaValue* meta, InlineEntries* entries) {
+  if (!entries->Decode(meta->InlinePayload())) {
+    return Status::Corruption("invalid inline entries");
+  }
+  return Status::OK();
+}
+
+Status Redis::PutInlineEntries(DataType type, const Slice& key, std::string* meta_value, const InlineEntries& entries,
+                               rocksdb::WriteBatch* batch) {
+  ParsedBaseMetaValue parsed_meta_value(meta_value);
+  if (!parsed_meta_value.check_set_count(entries.size())) {
+    return Status::InvalidArgument(type == DataType::kHashes ? "hash size overflow" : "set size overflow");
+  }
+  parsed_meta_value.SetCount(static_cast<int32_t>(entries.size()));
+  if (entries.Fits(inline_collection_max_entries_)) {
+    parsed_meta_value.SetInlinePayload(entries.Encode());
+  } else {
+    // the entries take the version of the collection, which never had
+    // data keys while it was inline
+    uint64_t version = parsed_meta_value.Version();
+    for (const auto& entry : entries.entries()) {
+      if (type == DataType::kHashes) {
+        HashesDataKey hashes_data_key(key, version, entry.field);
+        BaseDataValue internal_value(entry.value);
+        batch->Put(handles_[kHashesDataCF], hashes_data_key.Encode(), internal_value.Encode());
+      } else {
+        SetsMemberKey sets_member_key(key, version, entry.field);
+        BaseDataValue internal_value(Slice{});
+        batch->Put(handles_[kSetsDataCF], sets_member_key.Encode(), internal_value.Encode());
+      }
+    }
+    parsed_meta_value.SetEncoding(CollectionEncoding::kDataKeys);
+    parsed_meta_value.SetInlinePayload(Slice());
+  }
+  BaseMetaKey base_meta_key(key);
+  batch->Put(handles_[kMetaCF], base_meta_key.Encode(), *meta_value);
+  return Status::OK();
+}
+
+std::string Redis::NewBaseMetaValue(DataType type) {
+  char buf[4];
+  EncodeFixed32(buf, 0);
+  BaseMetaValue base_meta_value(type, Slice(buf, sizeof(buf)));
+  base_meta_value.UpdateVersion();
+  return base_meta_value.Encode().ToString();
+}
+
 Status Redis::UpdateSpecificKeyStatistics(const DataType& dtype, const std::string& key, uint64_t count) {
   if ((statistics_store_->Capacity() != 0U) && (count != 0U) && (small_compaction_threshold_ != 0U)) {
     KeyStatistics data;
@@ -491,6 +702,15 @@ Status Redis::GetProperty(const std::string& property, uint64_t* out) {
   return Status::OK();
 }
 
+Status Redis::GetColumnFamilyProperty(const std::string& property, std::vector<uint64_t>* out) {
+  std::string value;
+  for (size_t idx = 0; idx < handles_.size() && idx < out->size(); ++idx) {
+    db_->GetProperty(handles_[idx], property, &value);
+    (*out)[idx] += std::strtoull(value.c_str(), nullptr, 10);
+  }
+  return Status::OK();
+}
+
 Status Redis::ScanKeyNum(std::vector<KeyInfo>* key_infos) {
   key_infos->resize(DataTypeNum);
   rocksdb::Status s;
@@ -14,12 +14,16 @@
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 
+#include "src/compaction_meta_cache.h"
 #include "src/debug.h"
 #include "src/lock_mgr.h"
 #include "src/lru_cache.h"
 #include "src/mutex_impl.h"
 #include "src/type_iterator.h"
 #include "src/custom_comparator.h"
+#include "src/inline_entries_format.h"
+#include "src/lists_nodes.h"
+#include "src/zsets_rank_index.h"
 #include "storage/storage.h"
 #include "storage/storage_define.h"
 #include "pstd/include/env.h"
@@ -107,6 +111,8 @@ class Redis {
   virtual Status CompactRange(const rocksdb::Slice* begin, const rocksdb::Slice* end);
 
   virtual Status GetProperty(const std::string& property, uint64_t* out);
+  // Add property of each column family to out, indexed by ColumnFamilyIndex
+  Status GetColumnFamilyProperty(const std::string& property, std::vector<uint64_t>* out);
 
   Status ScanKeyNum(std::vector<KeyInfo>* key_info);
   Status ScanStringsKeyNum(KeyInfo* key_info);
@@ -158,6 +164,11 @@ class Redis {
   Status MGet(const Slice& key, std::string* value);
   Status GetWithTTL(const Slice& key, std::string* value, int64_t* ttl_millsec);
   Status MGetWithTTL(const Slice& key, std::string* value, int64_t* ttl_millsec);
+  // Batched variants, look up keys[indexes[i]] with one rocksdb::DB::MultiGet
+  // and fill (*vss)[indexes[i]], the caller must resize vss beforehand
+  Status MGet(const std::vector<std::string>& keys, const std::vector<size_t>& indexes, std::vector<ValueStatus>* vss);
+  Status MGetWithTTL(const std::vector<std::string>& keys, const std::vector<size_t>& indexes,
+                     std::vector<ValueStatus>* vss);
   Status GetBit(const Slice& key, int64_t offset, int32_t* ret);
   Status Getrange(const Slice& key, int64_t start_offset, int64_t end_offset, std::string* ret);
   Status GetrangeWithValue(const Slice& key, int64_t start_offset, int64_t end_offset,
@@ -221,6 +232,12 @@ class Redis {
   Status SetMaxCacheStatisticKeys(size_t max_cache_statistic_keys);
   Status SetSmallCompactionThreshold(uint64_t small_compaction_threshold);
   Status SetSmallCompactionDurationThreshold(uint64_t small_compaction_duration_threshold);
+  Status SetZSetRankIndexMinMembers(uint64_t zset_rank_index_min_members);
+  Status SetListNodeMaxElements(uint32_t list_node_max_elements);
+  Status SetInlineCollectionMaxEntries(uint32_t inline_collection_max_entries);
+  Status SetCompactionMetaCacheSize(size_t compaction_meta_cache_size);
+  Status SetCompactionMetaScan(bool compaction_meta_scan);
+  Status SetRangeDeleteMinEntries(uint64_t range_delete_min_entries);
 
 
   std::vector<rocksdb::ColumnFamilyHandle*> GetStringCFHandles() { return {handles_[kMetaCF]}; }
@@ -262,6 +279,8 @@ class Redis {
   Status SRem(const Slice& key, const std::vector<std::string>& members, int32_t* ret);
   Status SUnion(const std::vector<std::string>& keys, std::vector<std::string>* members);
   Status SUnionstore(const Slice& destination, const std::vector<std::string>& keys, std::vector<std::string>& value_to_dest, int32_t* ret);
+  // Whether walking all the members of the sets beats point lookups of probes members
+  static bool UseSetsMergeJoin(int64_t probes, int64_t members);
   Status SScan(const Slice& key, int64_t cursor, const std::string& pattern, int64_t count,
                std::vector<std::string>* members, int64_t* next_cursor);
   Status AddAndGetSpopCount(const std::string& key, uint64_t* count);
@@ -433,6 +452,9 @@ class Redis {
   }
 
 private:
+  Status StringsMultiGet(const std::vector<std::string>& keys, const std::vector<size_t>& indexes,
+                         std::vector<ValueStatus>* vss, bool with_ttl);
+
   Status GenerateStreamID(const StreamMetaValue& stream_meta, StreamAddTrimArgs& args);
 
   Status StreamScanRange(const Slice& key, const uint64_t version, const Slice& id_start, const std::string& id_end,
@@ -496,6 +518,110 @@ private:
   Status UpdateSpecificKeyStatistics(const DataType& dtype, const std::string& key, uint64_t count);
   Status UpdateSpecificKeyDuration(const DataType& dtype, const std::string& key, uint64_t duration);
   Status AddCompactKeyTaskIfNeeded(const DataType& dtype, const std::string& key, uint64_t count, uint64_t duration);
+
+  // For zset rank index, 0 disables it
+  std::atomic_uint64_t zset_rank_index_min_members_;
+  std::unique_ptr<LRUCache<std::string, std::shared_ptr<ZSetRankIndex>>> zset_rank_index_store_;
+
+  bool UseZSetRankIndex(int32_t count) const;
+  // The functions below need to hold the record lock of key.
+  // Returns the index of key at version if there is one
+  std::shared_ptr<ZSetRankIndex> LookupZSetRankIndex(const Slice& key, uint64_t version);
+  // Same as LookupZSetRankIndex but builds the index if there is none,
+  // returns nullptr if the score keys don't add up to count
+  std::shared_ptr<ZSetRankIndex> GetZSetRankIndex(const Slice& key, uint64_t version, int32_t count);
+  // Apply the score keys a write added to and removed from key
+  void UpdateZSetRankIndex(const Slice& key, const std::shared_ptr<ZSetRankIndex>& rank_index, const Status& s,
+                           const std::vector<std::string>& added, const std::vector<std::string>& removed);
+  // Position iter at the score key of key at rank
+  void SeekZSetRank(rocksdb::Iterator* iter, const Slice& key, uint64_t version,
+                    const std::shared_ptr<ZSetRankIndex>& rank_index, int64_t rank);
+  Status ZRankByIndex(const Slice& key, const Slice& member, bool reverse, int32_t* rank);
+  Status ZRangeByIndex(const Slice& key, int32_t start, int32_t stop, bool reverse,
+                       std::vector<ScoreMember>* score_members);
+
+  // For SINTER, SDIFF and SUNION
+  struct SetsInput {
+    std::string key;
+    uint64_t version = 0;
+    int32_t count = 0;
+    // The members of an inline set
+    std::shared_ptr<InlineEntries> entries;
+  };
+  Status GetSetsInput(const std::string& key, ParsedSetsMetaValue* meta, SetsInput* input);
+  Status SetsHasMember(const rocksdb::ReadOptions& read_options, const SetsInput& set, const Slice& member);
+  static const int64_t kSetsProbeCost = 16;
+
+  // Members in every set, sets are reordered smallest first
+  Status SetsInterMembers(const rocksdb::ReadOptions& read_options, std::vector<SetsInput>* sets,
+                          std::vector<std::string>* members);
+  // Members of first that are in none of others
+  Status SetsDiffMembers(const rocksdb::ReadOptions& read_options, const SetsInput& first,
+                         std::vector<SetsInput>* others, std::vector<std::string>* members);
+  // Members in any set, in order
+  Status SetsUnionMembers(const rocksdb::ReadOptions& read_options, const std::vector<SetsInput>& sets,
+                          std::vector<std::string>* members);
+
+  // For SPOP and SRANDMEMBER, the same order statistics as the zset rank
+  // index over the member keys of a set, every set write keeps it up to
+  // date and it is rebuilt once the set size drifted by kSetsSampleIndexMaxDrift
+  std::unique_ptr<LRUCache<std::string, std::shared_ptr<ZSetRankIndex>>> sets_sample_index_store_;
+  static const int32_t kSetsSampleIndexMinMembers = 4 * kZSetRankIndexBlockSize;
+  static const int32_t kSetsSampleIndexMaxDrift = 8;
+
+  // Whether sampling count members beats a walk over a set of size members
+  static bool UseSetsSampleIndex(int32_t size, int64_t count);
+  // The functions below need to hold the record lock of key.
+  std::shared_ptr<ZSetRankIndex> GetSetsSampleIndex(const Slice& key, uint64_t version, int32_t count);
+  // The sample index of key if there is one for version
+  std::shared_ptr<ZSetRankIndex> LookupSetsSampleIndex(const Slice& key, uint64_t version);
+  // Apply the member keys a write added and removed to the sample index,
+  // or drop it if the write failed or left a block to walk too long
+  void UpdateSetsSampleIndex(const Slice& key, const std::shared_ptr<ZSetRankIndex>& sample_index, const Status& s,
+                             const std::vector<std::string>& added, const std::vector<std::string>& removed);
+  // Pick count random member keys, distinct ones if unique, may return
+  // fewer if the index is off too far
+  Status SampleSetsMemberKeys(const Slice& key, uint64_t version, const std::shared_ptr<ZSetRankIndex>& sample_index,
+                              int64_t count, bool unique, std::vector<std::string>* member_keys);
+
+  // For lists, new lists are node encoded with this many elements
+  // per node, 0 keeps one key per element
+  std::atomic_uint32_t list_node_max_elements_;
+
+  uint32_t ListNodeMaxElements() const;
+  // Push values to a node encoded list, meta_value may be
+  // one of an empty list, the caller puts meta_value and writes
+  Status ListsNodesPush(const Slice& key, std::string* meta_value, const std::vector<std::string>& values,
+                        bool front, rocksdb::WriteBatch* batch, uint64_t* len);
+  // A meta value of a new empty list in the encoding new lists use
+  std::string NewListsMetaValue();
+
+  // The metas read by the data filters of every column family
+  std::unique_ptr<CompactionMetaCache> compaction_meta_cache_;
+
+  // Deleting a collection of at least this many entries drops its
+  // data keys with a range deletion too, 0 disables it
+  std::atomic_uint64_t range_delete_min_entries_;
+
+  // Add a range deletion of the data keys of version of a collection
+  // of count entries to batch, returns false if it is too small
+  bool DeleteDataKeysRange(DataType type, const Slice& key, uint64_t version, uint64_t count,
+                           rocksdb::WriteBatch* batch);
+
+  // For hashes and sets, new ones with at most this many entries keep
+  // them in their meta value, 0 stores every entry in a data key
+  std::atomic_uint32_t inline_collection_max_entries_;
+
+  // Reset a stale or empty hash or set to the encoding a new one gets,
+  // returns whether the collection keeps its entries inline
+  bool UseInlineEntries(ParsedBaseMetaValue* meta);
+  static Status DecodeInlineEntries(ParsedBaseMetaValue* meta, InlineEntries* entries);
+  // Put meta_value of an inline hash or set holding entries into batch,
+  // the entries move to data keys once they don't fit inline any more
+  Status PutInlineEntries(DataType type, const Slice& key, std::string* meta_value, const InlineEntries& entries,
+                          rocksdb::WriteBatch* batch);
+  // A meta value of a new empty hash or set
+  std::string NewBaseMetaValue(DataType type);
 };
 
 }  //  namespace storage
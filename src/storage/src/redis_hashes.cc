@@ -98,6 +98,22 @@ Status Redis::HDel(const Slice& key, const std::vector<std::string>& fields, int
     if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
       *ret = 0;
       return Status::OK();
+    } else if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+      InlineEntries entries(true);
+      s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      for (const auto& field : filtered_fields) {
+        if (entries.Delete(field)) {
+          del_cnt++;
+        }
+      }
+      *ret = del_cnt;
+      s = PutInlineEntries(DataType::kHashes, key, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
     } else {
       std::string data_value;
       version = parsed_hashes_meta_value.Version();
@@ -163,6 +179,17 @@ Status Redis::HGet(const Slice& key, const Slice& field, std::string* value) {
       return Status::NotFound("Stale");
     } else if (parsed_hashes_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+      InlineEntries entries(true);
+      s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      const std::string* entry_value = entries.Get(field);
+      if (entry_value == nullptr) {
+        return Status::NotFound();
+      }
+      *value = *entry_value;
     } else {
       version = parsed_hashes_meta_value.Version();
       HashesDataKey data_key(key, version, field);
@@ -204,6 +231,15 @@ Status Redis::HGetall(const Slice& key, std::vector<FieldValue>* fvs) {
     } else if (parsed_hashes_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(true);
+        s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        fvs->insert(fvs->end(), entries.entries().begin(), entries.entries().end());
+        return s;
+      }
       version = parsed_hashes_meta_value.Version();
       HashesDataKey hashes_data_key(key, version, "");
       Slice prefix = hashes_data_key.EncodeSeekKey();
@@ -256,6 +292,15 @@ Status Redis::HGetallWithTTL(const Slice& key, std::vector<FieldValue>* fvs, int
         *ttl_millsec = *ttl_millsec - curtime >= 0 ? *ttl_millsec - curtime : -2;
       }
 
+      if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(true);
+        s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        fvs->insert(fvs->end(), entries.entries().begin(), entries.entries().end());
+        return s;
+      }
       version = parsed_hashes_meta_value.Version();
       HashesDataKey hashes_data_key(key, version, "");
       Slice prefix = hashes_data_key.EncodeSeekKey();
@@ -297,9 +342,34 @@ Status Redis::HIncrby(const Slice& key, const Slice& field, int64_t value, int64
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.IsNotFound() && inline_collection_max_entries_ != 0) {
+    meta_value = NewBaseMetaValue(DataType::kHashes);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedHashesMetaValue parsed_hashes_meta_value(&meta_value);
-    if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
+    if (UseInlineEntries(&parsed_hashes_meta_value)) {
+      InlineEntries entries(true);
+      s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      int64_t ival = 0;
+      const std::string* old_entry = entries.Get(field);
+      if (old_entry != nullptr && StrToInt64(old_entry->data(), old_entry->size(), &ival) == 0) {
+        return Status::Corruption("hash value is not an integer");
+      }
+      if ((value >= 0 && LLONG_MAX - value < ival) || (value < 0 && LLONG_MIN - value > ival)) {
+        return Status::InvalidArgument("Overflow");
+      }
+      *ret = ival + value;
+      Int64ToStr(value_buf, 32, *ret);
+      entries.Put(field, value_buf);
+      s = PutInlineEntries(DataType::kHashes, key, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+    } else if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
       version = parsed_hashes_meta_value.UpdateVersion();
       parsed_hashes_meta_value.SetCount(1);
       parsed_hashes_meta_value.SetEtime(0);
@@ -390,9 +460,32 @@ Status Redis::HIncrbyfloat(const Slice& key, const Slice& field, const Slice& by
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.IsNotFound() && inline_collection_max_entries_ != 0) {
+    meta_value = NewBaseMetaValue(DataType::kHashes);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedHashesMetaValue parsed_hashes_meta_value(&meta_value);
-    if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
+    if (UseInlineEntries(&parsed_hashes_meta_value)) {
+      InlineEntries entries(true);
+      s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      long double old_value = 0;
+      const std::string* old_entry = entries.Get(field);
+      if (old_entry != nullptr && StrToLongDouble(old_entry->data(), old_entry->size(), &old_value) == -1) {
+        return Status::Corruption("value is not a vaild float");
+      }
+      if (LongDoubleToStr(old_value + long_double_by, new_value) == -1) {
+        return Status::InvalidArgument("Overflow");
+      }
+      entries.Put(field, *new_value);
+      s = PutInlineEntries(DataType::kHashes, key, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+    } else if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
       version = parsed_hashes_meta_value.UpdateVersion();
       parsed_hashes_meta_value.SetCount(1);
       parsed_hashes_meta_value.SetEtime(0);
@@ -481,6 +574,17 @@ Status Redis::HKeys(const Slice& key, std::vector<std::string>* fields) {
     } else if (parsed_hashes_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(true);
+        s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        for (const auto& entry : entries.entries()) {
+          fields->push_back(entry.field);
+        }
+        return s;
+      }
       version = parsed_hashes_meta_value.Version();
       HashesDataKey hashes_data_key(key, version, "");
       Slice prefix = hashes_data_key.EncodeSeekKey();
@@ -563,6 +667,20 @@ Status Redis::HMGet(const Slice& key, const std::vector<std::string>& fields, st
         vss->push_back({std::string(), Status::NotFound()});
       }
       return Status::NotFound(is_stale ? "Stale" : "");
+    } else if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+      InlineEntries entries(true);
+      s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      for (const auto& field : fields) {
+        const std::string* entry_value = entries.Get(field);
+        if (entry_value != nullptr) {
+          vss->push_back({*entry_value, Status::OK()});
+        } else {
+          vss->push_back({std::string(), Status::NotFound()});
+        }
+      }
     } else {
       version = parsed_hashes_meta_value.Version();
       for (const auto& field : fields) {
@@ -620,9 +738,26 @@ Status Redis::HMSet(const Slice& key, const std::vector<FieldValue>& fvs) {
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.IsNotFound() && inline_collection_max_entries_ != 0) {
+    meta_value = NewBaseMetaValue(DataType::kHashes);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedHashesMetaValue parsed_hashes_meta_value(&meta_value);
-    if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
+    if (UseInlineEntries(&parsed_hashes_meta_value)) {
+      InlineEntries entries(true);
+      s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      for (const auto& fv : filtered_fvs) {
+        entries.Put(fv.field, fv.value);
+      }
+      s = PutInlineEntries(DataType::kHashes, key, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+    } else if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
       version = parsed_hashes_meta_value.InitialMetaValue();
       if (!parsed_hashes_meta_value.check_set_count(static_cast<int32_t>(filtered_fvs.size()))) {
         return Status::InvalidArgument("hash size overflow");
@@ -695,9 +830,29 @@ Status Redis::HSet(const Slice& key, const Slice& field, const Slice& value, int
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.IsNotFound() && inline_collection_max_entries_ != 0) {
+    meta_value = NewBaseMetaValue(DataType::kHashes);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedHashesMetaValue parsed_hashes_meta_value(&meta_value);
-    if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
+    if (UseInlineEntries(&parsed_hashes_meta_value)) {
+      InlineEntries entries(true);
+      s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      const std::string* old_entry = entries.Get(field);
+      if (old_entry != nullptr && *old_entry == value) {
+        *res = 0;
+        return Status::OK();
+      }
+      *res = entries.Put(field, value) ? 1 : 0;
+      s = PutInlineEntries(DataType::kHashes, key, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+    } else if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
       version = parsed_hashes_meta_value.InitialMetaValue();
       parsed_hashes_meta_value.SetCount(1);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
@@ -770,9 +925,29 @@ Status Redis::HSetnx(const Slice& key, const Slice& field, const Slice& value, i
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.IsNotFound() && inline_collection_max_entries_ != 0) {
+    meta_value = NewBaseMetaValue(DataType::kHashes);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedHashesMetaValue parsed_hashes_meta_value(&meta_value);
-    if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
+    if (UseInlineEntries(&parsed_hashes_meta_value)) {
+      InlineEntries entries(true);
+      s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      if (entries.Get(field) != nullptr) {
+        *ret = 0;
+        return Status::OK();
+      }
+      entries.Put(field, value);
+      *ret = 1;
+      s = PutInlineEntries(DataType::kHashes, key, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+    } else if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
       version = parsed_hashes_meta_value.InitialMetaValue();
       parsed_hashes_meta_value.SetCount(1);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
@@ -840,6 +1015,17 @@ Status Redis::HVals(const Slice& key, std::vector<std::string>* values) {
     } else if (parsed_hashes_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(true);
+        s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        for (const auto& entry : entries.entries()) {
+          values->push_back(entry.value);
+        }
+        return s;
+      }
       version = parsed_hashes_meta_value.Version();
       HashesDataKey hashes_data_key(key, version, "");
       Slice prefix = hashes_data_key.EncodeSeekKey();
@@ -916,6 +1102,30 @@ Status Redis::HScan(const Slice& key, int64_t cursor, const std::string& pattern
         sub_field = pattern.substr(0, pattern.size() - 1);
       }
 
+      if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(true);
+        s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        size_t idx = entries.LowerBound(start_point);
+        for (; idx < entries.size() && rest > 0 && Slice(entries[idx].field).starts_with(sub_field); ++idx) {
+          const FieldValue& entry = entries[idx];
+          if (StringMatch(pattern.data(), pattern.size(), entry.field.data(), entry.field.size(), 0) != 0) {
+            field_values->push_back(entry);
+          }
+          rest--;
+        }
+        if (idx < entries.size() &&
+            (entries[idx].field.compare(sub_field) < 0 || Slice(entries[idx].field).starts_with(sub_field))) {
+          *next_cursor = cursor + step_length;
+          StoreScanNextPoint(DataType::kHashes, key, pattern, *next_cursor, entries[idx].field);
+        } else {
+          *next_cursor = 0;
+        }
+        return Status::OK();
+      }
+
       HashesDataKey hashes_data_prefix(key, version, sub_field);
       HashesDataKey hashes_start_data_key(key, version, start_point);
       std::string prefix = hashes_data_prefix.EncodeSeekKey().ToString();
@@ -979,6 +1189,23 @@ Status Redis::HScanx(const Slice& key, const std::string& start_field, const std
       *next_field = "";
       return Status::NotFound();
     } else {
+      if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(true);
+        s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        size_t idx = entries.LowerBound(start_field);
+        for (; idx < entries.size() && rest > 0; ++idx) {
+          const FieldValue& entry = entries[idx];
+          if (StringMatch(pattern.data(), pattern.size(), entry.field.data(), entry.field.size(), 0) != 0) {
+            field_values->push_back(entry);
+          }
+          rest--;
+        }
+        *next_field = idx < entries.size() ? entries[idx].field : "";
+        return Status::OK();
+      }
       uint64_t version = parsed_hashes_meta_value.Version();
       HashesDataKey hashes_data_prefix(key, version, Slice());
       HashesDataKey hashes_start_data_key(key, version, start_field);
@@ -1048,6 +1275,28 @@ Status Redis::PKHScanRange(const Slice& key, const Slice& field_start, const std
     if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(true);
+        s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        size_t idx = start_no_limit ? 0 : entries.LowerBound(field_start);
+        for (; idx < entries.size() && remain > 0; ++idx) {
+          const FieldValue& entry = entries[idx];
+          if (!end_no_limit && entry.field.compare(field_end) > 0) {
+            break;
+          }
+          if (StringMatch(pattern.data(), pattern.size(), entry.field.data(), entry.field.size(), 0) != 0) {
+            field_values->push_back(entry);
+          }
+          remain--;
+        }
+        if (idx < entries.size() && (end_no_limit || entries[idx].field.compare(field_end) <= 0)) {
+          *next_field = entries[idx].field;
+        }
+        return Status::OK();
+      }
       uint64_t version = parsed_hashes_meta_value.Version();
       HashesDataKey hashes_data_prefix(key, version, Slice());
       HashesDataKey hashes_start_data_key(key, version, field_start);
@@ -1119,6 +1368,36 @@ Status Redis::PKHRScanRange(const Slice& key, const Slice& field_start, const st
     if (parsed_hashes_meta_value.IsStale() || parsed_hashes_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      if (parsed_hashes_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(true);
+        s = DecodeInlineEntries(&parsed_hashes_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        // one past the last entry not greater than field_start
+        auto end = static_cast<int64_t>(entries.size());
+        if (!start_no_limit) {
+          end = static_cast<int64_t>(entries.LowerBound(field_start));
+          if (end < static_cast<int64_t>(entries.size()) && Slice(entries[end].field) == field_start) {
+            end++;
+          }
+        }
+        int64_t idx = end - 1;
+        for (; idx >= 0 && remain > 0; --idx) {
+          const FieldValue& entry = entries[idx];
+          if (!end_no_limit && entry.field.compare(field_end) < 0) {
+            break;
+          }
+          if (StringMatch(pattern.data(), pattern.size(), entry.field.data(), entry.field.size(), 0) != 0) {
+            field_values->push_back(entry);
+          }
+          remain--;
+        }
+        if (idx >= 0 && (end_no_limit || entries[idx].field.compare(field_end) >= 0)) {
+          *next_field = entries[idx].field;
+        }
+        return Status::OK();
+      }
       uint64_t version = parsed_hashes_meta_value.Version();
       uint64_t start_key_version = start_no_limit ? version + 1 : version;
       std::string start_key_field = start_no_limit ? "" : field_start.ToString();
@@ -1126,6 +1405,8 @@ Status Redis::PKHRScanRange(const Slice& key, const Slice& field_start, const st
       HashesDataKey hashes_start_data_key(key, start_key_version, start_key_field);
       std::string prefix = hashes_data_prefix.EncodeSeekKey().ToString();
       KeyStatisticsDurationGuard guard(this, DataType::kHashes, key.ToString());
+      // the key of version + 1 is out of the prefix of the data keys
+      read_options.total_order_seek = start_no_limit;
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kHashesDataCF]);
       for (iter->SeekForPrev(hashes_start_data_key.Encode().ToString());
            iter->Valid() && remain > 0 && iter->key().starts_with(prefix); iter->Prev()) {
@@ -1224,9 +1505,17 @@ Status Redis::HashesDel(const Slice& key, std::string&& prefetch_meta) {
       return Status::NotFound();
     } else {
       uint32_t statistic = parsed_hashes_meta_value.Count();
+      rocksdb::WriteBatch batch;
+      bool range_deleted =
+          parsed_hashes_meta_value.Encoding() != CollectionEncoding::kInline &&
+          DeleteDataKeysRange(DataType::kHashes, key, parsed_hashes_meta_value.Version(), statistic, &batch);
       parsed_hashes_meta_value.InitialMetaValue();
-      s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      s = db_->Write(default_write_options_, &batch);
       UpdateSpecificKeyStatistics(DataType::kHashes, key.ToString(), statistic);
+      if (s.ok() && range_deleted) {
+        storage_->AddBGTask({DataType::kHashes, kCompactRange, {key.ToString()}});
+      }
     }
   }
   return s;
@@ -3,6 +3,7 @@
 //  LICENSE file in the root directory of this source tree. An additional grant
 //  of patent rights can be found in the PATENTS file in the same directory.
 
+#include <algorithm>
 #include <memory>
 
 #include <fmt/core.h>
@@ -11,6 +12,7 @@
 #include "pstd/include/pika_codis_slot.h"
 #include "src/base_data_value_format.h"
 #include "src/lists_filter.h"
+#include "src/lists_nodes.h"
 #include "src/redis.h"
 #include "src/scope_record_lock.h"
 #include "src/scope_snapshot.h"
@@ -18,6 +20,45 @@
 #include "src/debug.h"
 
 namespace storage {
+// Turns start and stop of LRANGE and LTRIM into positions in a list of count
+// elements, returns false if the range is empty
+static bool ListsRangePositions(int64_t count, int64_t start, int64_t stop, uint64_t* start_pos, uint64_t* stop_pos) {
+  start = std::max<int64_t>(start >= 0 ? start : count + start, 0);
+  stop = std::min<int64_t>(stop >= 0 ? stop : count + stop, count - 1);
+  if (start > stop) {
+    return false;
+  }
+  *start_pos = start;
+  *stop_pos = stop;
+  return true;
+}
+
+uint32_t Redis::ListNodeMaxElements() const {
+  uint32_t list_node_max_elements = list_node_max_elements_;
+  return list_node_max_elements != 0 ? list_node_max_elements : kListsNodeDefaultElements;
+}
+
+std::string Redis::NewListsMetaValue() {
+  char str[8];
+  EncodeFixed64(str, 0);
+  ListsMetaValue lists_meta_value(Slice(str, sizeof(uint64_t)));
+  lists_meta_value.UpdateVersion();
+  return lists_meta_value.Encode().ToString();
+}
+
+Status Redis::ListsNodesPush(const Slice& key, std::string* meta_value, const std::vector<std::string>& values,
+                             bool front, rocksdb::WriteBatch* batch, uint64_t* len) {
+  ParsedListsMetaValue parsed_lists_meta_value(meta_value);
+  ListsNodes nodes(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                   ListNodeMaxElements());
+  Status s = front ? nodes.PushFront(values) : nodes.PushBack(values);
+  if (s.ok()) {
+    nodes.Flush(batch);
+    *len = nodes.Count();
+  }
+  return s;
+}
+
 Status Redis::ScanListsKeyNum(KeyInfo* key_info) {
   uint64_t keys = 0;
   uint64_t expires = 0;
@@ -84,6 +125,14 @@ Status Redis::LIndex(const Slice& key, int64_t index, std::string* element) {
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      auto count = static_cast<int64_t>(parsed_lists_meta_value.Count());
+      if (index >= count || index < -count) {
+        return Status::NotFound();
+      }
+      ListsNodes nodes(db_, handles_[kListsDataCF], read_options, key, &parsed_lists_meta_value,
+                       ListNodeMaxElements());
+      return nodes.Get(index >= 0 ? index : count + index, element);
     } else {
       uint64_t target_index =
           index >= 0 ? parsed_lists_meta_value.LeftIndex() + index + 1 : parsed_lists_meta_value.RightIndex() + index;
@@ -127,6 +176,25 @@ Status Redis::LInsert(const Slice& key, const BeforeOrAfter& before_or_after, co
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      ListsNodes nodes(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                       ListNodeMaxElements());
+      uint64_t pivot_pos = 0;
+      s = nodes.Find(pivot, &pivot_pos);
+      if (s.IsNotFound()) {
+        *ret = -1;
+        return s;
+      }
+      if (s.ok()) {
+        s = nodes.Insert(before_or_after == Before ? pivot_pos : pivot_pos + 1, value);
+      }
+      if (!s.ok()) {
+        return s;
+      }
+      nodes.Flush(&batch);
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      *ret = static_cast<int64_t>(nodes.Count());
+      return db_->Write(default_write_options_, &batch);
     } else {
       bool find_pivot = false;
       uint64_t pivot_index = 0;
@@ -278,6 +346,16 @@ Status Redis::LPop(const Slice& key, int64_t count, std::vector<std::string>* el
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      ListsNodes nodes(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                       ListNodeMaxElements());
+      s = nodes.PopFront(count > 0 ? count : 0, elements);
+      if (!s.ok()) {
+        return s;
+      }
+      nodes.Flush(&batch);
+      statistic += nodes.deleted_nodes();
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
     } else {
       auto size = static_cast<int64_t>(parsed_lists_meta_value.Count());
       uint64_t version = parsed_lists_meta_value.Version();
@@ -330,13 +408,28 @@ Status Redis::LPush(const Slice& key, const std::vector<std::string>& values, ui
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.IsNotFound() && list_node_max_elements_ != 0) {
+    meta_value = NewListsMetaValue();
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale() || parsed_lists_meta_value.Count() == 0) {
       version = parsed_lists_meta_value.InitialMetaValue();
+      if (list_node_max_elements_ != 0) {
+        parsed_lists_meta_value.SetEncoding(ListsEncoding::kNodes);
+      }
     } else {
       version = parsed_lists_meta_value.Version();
     }
+    if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      s = ListsNodesPush(key, &meta_value, values, true, &batch, ret);
+      if (!s.ok()) {
+        return s;
+      }
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      return db_->Write(default_write_options_, &batch);
+    }
     for (const auto& value : values) {
       index = parsed_lists_meta_value.LeftIndex();
       parsed_lists_meta_value.ModifyLeftIndex(1);
@@ -392,6 +485,13 @@ Status Redis::LPushx(const Slice& key, const std::vector<std::string>& values, u
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      s = ListsNodesPush(key, &meta_value, values, true, &batch, len);
+      if (!s.ok()) {
+        return s;
+      }
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      return db_->Write(default_write_options_, &batch);
     } else {
       uint64_t version = parsed_lists_meta_value.Version();
       for (const auto& value : values) {
@@ -436,6 +536,15 @@ Status Redis::LRange(const Slice& key, int64_t start, int64_t stop, std::vector<
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      uint64_t start_pos = 0;
+      uint64_t stop_pos = 0;
+      if (!ListsRangePositions(parsed_lists_meta_value.Count(), start, stop, &start_pos, &stop_pos)) {
+        return Status::OK();
+      }
+      ListsNodes nodes(db_, handles_[kListsDataCF], read_options, key, &parsed_lists_meta_value,
+                       ListNodeMaxElements());
+      return nodes.Range(start_pos, stop_pos, ret);
     } else {
       uint64_t version = parsed_lists_meta_value.Version();
       uint64_t origin_left_index = parsed_lists_meta_value.LeftIndex() + 1;
@@ -506,6 +615,17 @@ Status Redis::LRangeWithTTL(const Slice& key, int64_t start, int64_t stop, std::
         *ttl_millsec = *ttl_millsec - curtime >= 0 ? *ttl_millsec - curtime : -2;
       }
 
+      if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+        uint64_t start_pos = 0;
+        uint64_t stop_pos = 0;
+        if (!ListsRangePositions(parsed_lists_meta_value.Count(), start, stop, &start_pos, &stop_pos)) {
+          return Status::OK();
+        }
+        ListsNodes nodes(db_, handles_[kListsDataCF], read_options, key, &parsed_lists_meta_value,
+                         ListNodeMaxElements());
+        return nodes.Range(start_pos, stop_pos, ret);
+      }
+
       uint64_t version = parsed_lists_meta_value.Version();
       uint64_t origin_left_index = parsed_lists_meta_value.LeftIndex() + 1;
       uint64_t origin_right_index = parsed_lists_meta_value.RightIndex() - 1;
@@ -565,6 +685,19 @@ Status Redis::LRem(const Slice& key, int64_t count, const Slice& value, uint64_t
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      ListsNodes nodes(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                       ListNodeMaxElements());
+      s = nodes.Remove(count, value, ret);
+      if (!s.ok()) {
+        return s;
+      }
+      if (*ret == 0) {
+        return Status::NotFound();
+      }
+      nodes.Flush(&batch);
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      return db_->Write(default_write_options_, &batch);
     } else {
       uint64_t current_index;
       std::vector<uint64_t> target_index;
@@ -697,6 +830,24 @@ Status Redis::LSet(const Slice& key, int64_t index, const Slice& value) {
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      auto count = static_cast<int64_t>(parsed_lists_meta_value.Count());
+      if (index >= count || index < -count) {
+        return Status::Corruption("index out of range");
+      }
+      ListsNodes nodes(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                       ListNodeMaxElements());
+      s = nodes.Set(index >= 0 ? index : count + index, value);
+      if (!s.ok()) {
+        return s;
+      }
+      rocksdb::WriteBatch batch;
+      nodes.Flush(&batch);
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      s = db_->Write(default_write_options_, &batch);
+      statistic++;
+      UpdateSpecificKeyStatistics(DataType::kLists, key.ToString(), statistic);
+      return s;
     } else {
       uint64_t version = parsed_lists_meta_value.Version();
       uint64_t target_index =
@@ -742,6 +893,26 @@ Status Redis::LTrim(const Slice& key, int64_t start, int64_t stop) {
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      uint64_t start_pos = 0;
+      uint64_t stop_pos = 0;
+      if (!ListsRangePositions(parsed_lists_meta_value.Count(), start, stop, &start_pos, &stop_pos)) {
+        parsed_lists_meta_value.InitialMetaValue();
+        batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      } else {
+        ListsNodes nodes(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                         ListNodeMaxElements());
+        s = nodes.DropBack(parsed_lists_meta_value.Count() - 1 - stop_pos);
+        if (s.ok()) {
+          s = nodes.DropFront(start_pos);
+        }
+        if (!s.ok()) {
+          return s;
+        }
+        nodes.Flush(&batch);
+        statistic += nodes.deleted_nodes();
+        batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      }
     } else {
       uint64_t origin_left_index = parsed_lists_meta_value.LeftIndex() + 1;
       uint64_t origin_right_index = parsed_lists_meta_value.RightIndex() - 1;
@@ -814,6 +985,16 @@ Status Redis::RPop(const Slice& key, int64_t count, std::vector<std::string>* el
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      ListsNodes nodes(db_, handles_[kListsDataCF], default_read_options_, key, &parsed_lists_meta_value,
+                       ListNodeMaxElements());
+      s = nodes.PopBack(count > 0 ? count : 0, elements);
+      if (!s.ok()) {
+        return s;
+      }
+      nodes.Flush(&batch);
+      statistic += nodes.deleted_nodes();
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
     } else {
       auto size = static_cast<int64_t>(parsed_lists_meta_value.Count());
       uint64_t version = parsed_lists_meta_value.Version();
@@ -871,6 +1052,28 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
         return Status::NotFound("Stale");
       } else if (parsed_lists_meta_value.Count() == 0) {
         return Status::NotFound();
+      } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+        ListsNodes nodes(db_, handles_[kListsDataCF], default_read_options_, source, &parsed_lists_meta_value,
+                         ListNodeMaxElements());
+        std::vector<std::string> elements;
+        s = nodes.PopBack(1, &elements);
+        if (!s.ok()) {
+          return s;
+        }
+        *element = elements.front();
+        if (nodes.Count() == 0) {
+          return Status::OK();
+        }
+        s = nodes.PushFront(elements);
+        if (!s.ok()) {
+          return s;
+        }
+        nodes.Flush(&batch);
+        statistic++;
+        batch.Put(handles_[kMetaCF], base_source.Encode(), meta_value);
+        s = db_->Write(default_write_options_, &batch);
+        UpdateSpecificKeyStatistics(DataType::kLists, source.ToString(), statistic);
+        return s;
       } else {
         std::string target;
         uint64_t version = parsed_lists_meta_value.Version();
@@ -926,6 +1129,19 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      ListsNodes nodes(db_, handles_[kListsDataCF], default_read_options_, source, &parsed_lists_meta_value,
+                       ListNodeMaxElements());
+      std::vector<std::string> elements;
+      s = nodes.PopBack(1, &elements);
+      if (!s.ok()) {
+        return s;
+      }
+      nodes.Flush(&batch);
+      statistic++;
+      batch.Put(handles_[kMetaCF], base_source.Encode(), source_meta_value);
+      BaseDataValue i_val(elements.front());
+      target = i_val.Encode().ToString();
     } else {
       version = parsed_lists_meta_value.Version();
       uint64_t last_node_index = parsed_lists_meta_value.RightIndex() - 1;
@@ -958,18 +1174,36 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
         DataTypeStrings[static_cast<int>(GetMetaValueType(destination_meta_value))]);
     }
   }
+  if (s.IsNotFound() && list_node_max_elements_ != 0) {
+    destination_meta_value = NewListsMetaValue();
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&destination_meta_value);
     if (parsed_lists_meta_value.IsStale() || parsed_lists_meta_value.Count() == 0) {
       version = parsed_lists_meta_value.InitialMetaValue();
+      if (list_node_max_elements_ != 0) {
+        parsed_lists_meta_value.SetEncoding(ListsEncoding::kNodes);
+      }
     } else {
       version = parsed_lists_meta_value.Version();
     }
-    uint64_t target_index = parsed_lists_meta_value.LeftIndex();
-    ListsDataKey lists_data_key(destination, version, target_index);
-    batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), target);
-    parsed_lists_meta_value.ModifyCount(1);
-    parsed_lists_meta_value.ModifyLeftIndex(1);
+    if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      std::string value = target;
+      ParsedBaseDataValue parsed_value(&value);
+      parsed_value.StripSuffix();
+      uint64_t len = 0;
+      s = ListsNodesPush(destination, &destination_meta_value, {value}, true, &batch, &len);
+      if (!s.ok()) {
+        return s;
+      }
+    } else {
+      uint64_t target_index = parsed_lists_meta_value.LeftIndex();
+      ListsDataKey lists_data_key(destination, version, target_index);
+      batch.Put(handles_[kListsDataCF], lists_data_key.Encode(), target);
+      parsed_lists_meta_value.ModifyCount(1);
+      parsed_lists_meta_value.ModifyLeftIndex(1);
+    }
     batch.Put(handles_[kMetaCF], base_destination.Encode(), destination_meta_value);
   } else if (s.IsNotFound()) {
     char str[8];
@@ -998,6 +1232,7 @@ Status Redis::RPoplpush(const Slice& source, const Slice& destination, std::stri
 Status Redis::RPush(const Slice& key, const std::vector<std::string>& values, uint64_t* ret) {
   *ret = 0;
   rocksdb::WriteBatch batch;
+  ScopeRecordLock l(lock_mgr_, key);
 
   uint64_t index = 0;
   uint64_t version = 0;
@@ -1015,13 +1250,28 @@ Status Redis::RPush(const Slice& key, const std::vector<std::string>& values, ui
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.IsNotFound() && list_node_max_elements_ != 0) {
+    meta_value = NewListsMetaValue();
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedListsMetaValue parsed_lists_meta_value(&meta_value);
     if (parsed_lists_meta_value.IsStale() || parsed_lists_meta_value.Count() == 0) {
       version = parsed_lists_meta_value.InitialMetaValue();
+      if (list_node_max_elements_ != 0) {
+        parsed_lists_meta_value.SetEncoding(ListsEncoding::kNodes);
+      }
     } else {
       version = parsed_lists_meta_value.Version();
     }
+    if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      s = ListsNodesPush(key, &meta_value, values, false, &batch, ret);
+      if (!s.ok()) {
+        return s;
+      }
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      return db_->Write(default_write_options_, &batch);
+    }
     for (const auto& value : values) {
       index = parsed_lists_meta_value.RightIndex();
       parsed_lists_meta_value.ModifyRightIndex(1);
@@ -1077,6 +1327,13 @@ Status Redis::RPushx(const Slice& key, const std::vector<std::string>& values, u
       return Status::NotFound("Stale");
     } else if (parsed_lists_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_lists_meta_value.Encoding() == ListsEncoding::kNodes) {
+      s = ListsNodesPush(key, &meta_value, values, false, &batch, len);
+      if (!s.ok()) {
+        return s;
+      }
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      return db_->Write(default_write_options_, &batch);
     } else {
       uint64_t version = parsed_lists_meta_value.Version();
       for (const auto& value : values) {
@@ -1164,9 +1421,16 @@ Status Redis::ListsDel(const Slice& key, std::string&& prefetch_meta) {
       return Status::NotFound();
     } else {
       uint64_t statistic = parsed_lists_meta_value.Count();
+      rocksdb::WriteBatch batch;
+      bool range_deleted =
+          DeleteDataKeysRange(DataType::kLists, key, parsed_lists_meta_value.Version(), statistic, &batch);
       parsed_lists_meta_value.InitialMetaValue();
-      s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      s = db_->Write(default_write_options_, &batch);
       UpdateSpecificKeyStatistics(DataType::kLists, key.ToString(), statistic);
+      if (s.ok() && range_deleted) {
+        storage_->AddBGTask({DataType::kLists, kCompactRange, {key.ToString()}});
+      }
     }
   }
   return s;
@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <numeric>
+#include <queue>
 #include <random>
 
 #include <glog/logging.h>
@@ -17,6 +19,7 @@
 #include "src/scope_snapshot.h"
 #include "src/scope_record_lock.h"
 #include "src/base_data_value_format.h"
+#include "src/inline_entries_format.h"
 #include "pstd/include/env.h"
 #include "pstd/include/pika_codis_slot.h"
 #include "storage/util.h"
@@ -75,6 +78,8 @@ rocksdb::Status Redis::SAdd(const Slice& key, const std::vector<std::string>& me
   ScopeRecordLock l(lock_mgr_, key);
   uint64_t version = 0;
   std::string meta_value;
+  std::shared_ptr<ZSetRankIndex> sample_index;
+  std::vector<std::string> added_member_keys;
 
   BaseMetaKey base_meta_key(key);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
@@ -88,9 +93,33 @@ rocksdb::Status Redis::SAdd(const Slice& key, const std::vector<std::string>& me
           DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.IsNotFound() && inline_collection_max_entries_ != 0) {
+    meta_value = NewBaseMetaValue(DataType::kSets);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
-    if (parsed_sets_meta_value.IsStale() || parsed_sets_meta_value.Count() == 0) {
+    if (UseInlineEntries(&parsed_sets_meta_value)) {
+      InlineEntries entries(false);
+      s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      int32_t cnt = 0;
+      for (const auto& member : filtered_members) {
+        if (entries.Put(member, Slice())) {
+          cnt++;
+        }
+      }
+      *ret = cnt;
+      if (cnt == 0) {
+        return rocksdb::Status::OK();
+      }
+      s = PutInlineEntries(DataType::kSets, key, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+    } else if (parsed_sets_meta_value.IsStale() || parsed_sets_meta_value.Count() == 0) {
       version = parsed_sets_meta_value.InitialMetaValue();
       if (!parsed_sets_meta_value.check_set_count(static_cast<int32_t>(filtered_members.size()))) {
         return Status::InvalidArgument("set size overflow");
@@ -107,6 +136,7 @@ rocksdb::Status Redis::SAdd(const Slice& key, const std::vector<std::string>& me
       int32_t cnt = 0;
       std::string member_value;
       version = parsed_sets_meta_value.Version();
+      sample_index = LookupSetsSampleIndex(key, version);
       for (const auto& member : filtered_members) {
         SetsMemberKey sets_member_key(key, version, member);
         s = db_->Get(default_read_options_, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
@@ -115,6 +145,9 @@ rocksdb::Status Redis::SAdd(const Slice& key, const std::vector<std::string>& me
           cnt++;
           BaseDataValue iter_value(Slice{});
           batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
+          if (sample_index) {
+            added_member_keys.push_back(sets_member_key.Encode().ToString());
+          }
         } else {
           return s;
         }
@@ -145,7 +178,9 @@ rocksdb::Status Redis::SAdd(const Slice& key, const std::vector<std::string>& me
   } else {
     return s;
   }
-  return db_->Write(default_write_options_, &batch);
+  s = db_->Write(default_write_options_, &batch);
+  UpdateSetsSampleIndex(key, sample_index, s, added_member_keys, {});
+  return s;
 }
 
 rocksdb::Status Redis::SCard(const Slice& key, int32_t* ret, std::string&& meta) {
@@ -181,6 +216,273 @@ rocksdb::Status Redis::SCard(const Slice& key, int32_t* ret, std::string&& meta)
   return s;
 }
 
+// Walks the members of one set in order, members are stored sorted
+// under the key and version prefix, or inline in entries
+class SetsMemberCursor {
+ public:
+  SetsMemberCursor(rocksdb::DB* db, const rocksdb::ReadOptions& read_options, rocksdb::ColumnFamilyHandle* handle,
+                   const std::string& key, uint64_t version, const InlineEntries* entries)
+      : key_(key), version_(version), entries_(entries) {
+    if (entries_ == nullptr) {
+      iter_.reset(db->NewIterator(read_options, handle));
+      SetsMemberKey sets_member_key(key_, version_, Slice());
+      prefix_ = sets_member_key.EncodeSeekKey().ToString();
+      iter_->Seek(prefix_);
+    }
+  }
+
+  bool Valid() const {
+    if (entries_ != nullptr) {
+      return pos_ < entries_->size();
+    }
+    return iter_->Valid() && iter_->key().starts_with(prefix_);
+  }
+  Slice member() const {
+    if (entries_ != nullptr) {
+      return (*entries_)[pos_].field;
+    }
+    Slice key = iter_->key();
+    return {key.data() + prefix_.size(), key.size() - prefix_.size() - kSuffixReserveLength};
+  }
+  void Next() {
+    if (entries_ != nullptr) {
+      pos_++;
+    } else {
+      iter_->Next();
+    }
+  }
+  // Move to the first member not less than target, steps a few
+  // times before seeking as the next match is often close by
+  void SeekTo(const Slice& target) {
+    if (entries_ != nullptr) {
+      pos_ = std::max(pos_, entries_->LowerBound(target));
+      return;
+    }
+    for (int i = 0; i < kSetsCursorMaxSkip && Valid(); ++i) {
+      if (member().compare(target) >= 0) {
+        return;
+      }
+      Next();
+    }
+    if (Valid() && member().compare(target) < 0) {
+      SetsMemberKey sets_member_key(key_, version_, target);
+      iter_->Seek(sets_member_key.EncodeSeekKey());
+    }
+  }
+  rocksdb::Status status() const { return entries_ != nullptr ? rocksdb::Status::OK() : iter_->status(); }
+
+ private:
+  static const int kSetsCursorMaxSkip = 8;
+
+  std::string key_;
+  uint64_t version_ = 0;
+  std::string prefix_;
+  std::unique_ptr<rocksdb::Iterator> iter_;
+  const InlineEntries* entries_ = nullptr;
+  size_t pos_ = 0;
+};
+
+Status Redis::GetSetsInput(const std::string& key, ParsedSetsMetaValue* meta, SetsInput* input) {
+  input->key = key;
+  input->version = meta->Version();
+  input->count = meta->Count();
+  if (meta->Encoding() == CollectionEncoding::kInline) {
+    input->entries = std::make_shared<InlineEntries>(false);
+    return DecodeInlineEntries(meta, input->entries.get());
+  }
+  return Status::OK();
+}
+
+Status Redis::SetsHasMember(const rocksdb::ReadOptions& read_options, const SetsInput& set, const Slice& member) {
+  if (set.entries) {
+    return set.entries->Get(member) != nullptr ? Status::OK() : Status::NotFound();
+  }
+  std::string member_value;
+  SetsMemberKey sets_member_key(set.key, set.version, member);
+  return db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
+}
+
+bool Redis::UseSetsMergeJoin(int64_t probes, int64_t members) {
+  // a point lookup costs about as much as stepping over
+  // kSetsProbeCost members of an iterator
+  return probes * kSetsProbeCost >= members;
+}
+
+rocksdb::Status Redis::SetsInterMembers(const rocksdb::ReadOptions& read_options, std::vector<SetsInput>* sets,
+                                        std::vector<std::string>* members) {
+  // iterate the smallest set and check the others from the next smallest on
+  std::sort(sets->begin(), sets->end(),
+            [](const SetsInput& a, const SetsInput& b) { return a.count < b.count; });
+  int64_t total = 0;
+  for (const auto& set : *sets) {
+    total += set.count;
+  }
+  KeyStatisticsDurationGuard guard(this, DataType::kSets, sets->front().key);
+
+  rocksdb::Status s;
+  if (!UseSetsMergeJoin(static_cast<int64_t>(sets->front().count) * static_cast<int64_t>(sets->size() - 1), total)) {
+    SetsMemberCursor cursor(db_, read_options, handles_[kSetsDataCF], sets->front().key, sets->front().version,
+                            sets->front().entries.get());
+    for (; cursor.Valid(); cursor.Next()) {
+      Slice member = cursor.member();
+      bool reliable = true;
+      for (size_t idx = 1; idx < sets->size(); ++idx) {
+        s = SetsHasMember(read_options, (*sets)[idx], member);
+        if (s.IsNotFound()) {
+          reliable = false;
+          break;
+        } else if (!s.ok()) {
+          return s;
+        }
+      }
+      if (reliable) {
+        members->push_back(member.ToString());
+      }
+    }
+    return cursor.status();
+  }
+
+  // leapfrog over all the sets, each cursor seeks to the
+  // largest member seen until they all stop on the same one
+  std::vector<std::unique_ptr<SetsMemberCursor>> cursors;
+  for (const auto& set : *sets) {
+    cursors.push_back(std::make_unique<SetsMemberCursor>(db_, read_options, handles_[kSetsDataCF], set.key,
+                                                         set.version, set.entries.get()));
+  }
+  bool done = false;
+  std::string target;
+  while (!done && cursors[0]->Valid()) {
+    target = cursors[0]->member().ToString();
+    bool reliable = true;
+    for (size_t idx = 1; idx < cursors.size(); ++idx) {
+      cursors[idx]->SeekTo(target);
+      if (!cursors[idx]->Valid()) {
+        reliable = false;
+        done = true;
+        break;
+      }
+      if (cursors[idx]->member() != target) {
+        reliable = false;
+        cursors[0]->SeekTo(cursors[idx]->member());
+        break;
+      }
+    }
+    if (reliable) {
+      members->push_back(target);
+      cursors[0]->Next();
+    }
+  }
+  for (const auto& cursor : cursors) {
+    if (!cursor->status().ok()) {
+      return cursor->status();
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status Redis::SetsDiffMembers(const rocksdb::ReadOptions& read_options, const SetsInput& first,
+                                       std::vector<SetsInput>* others, std::vector<std::string>* members) {
+  // check the largest sets first, they are the likeliest to hold a member
+  std::sort(others->begin(), others->end(),
+            [](const SetsInput& a, const SetsInput& b) { return a.count > b.count; });
+  int64_t total = first.count;
+  for (const auto& set : *others) {
+    total += set.count;
+  }
+  KeyStatisticsDurationGuard guard(this, DataType::kSets, first.key);
+
+  rocksdb::Status s;
+  SetsMemberCursor cursor(db_, read_options, handles_[kSetsDataCF], first.key, first.version, first.entries.get());
+  if (!UseSetsMergeJoin(static_cast<int64_t>(first.count) * static_cast<int64_t>(others->size()), total)) {
+    for (; cursor.Valid(); cursor.Next()) {
+      Slice member = cursor.member();
+      bool found = false;
+      for (const auto& set : *others) {
+        s = SetsHasMember(read_options, set, member);
+        if (s.ok()) {
+          found = true;
+          break;
+        } else if (!s.IsNotFound()) {
+          return s;
+        }
+      }
+      if (!found) {
+        members->push_back(member.ToString());
+      }
+    }
+    return cursor.status();
+  }
+
+  // walk the other sets along with the first one
+  std::vector<std::unique_ptr<SetsMemberCursor>> cursors;
+  for (const auto& set : *others) {
+    cursors.push_back(std::make_unique<SetsMemberCursor>(db_, read_options, handles_[kSetsDataCF], set.key,
+                                                         set.version, set.entries.get()));
+  }
+  for (; cursor.Valid(); cursor.Next()) {
+    Slice member = cursor.member();
+    bool found = false;
+    for (const auto& other : cursors) {
+      other->SeekTo(member);
+      if (other->Valid() && other->member() == member) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      members->push_back(member.ToString());
+    }
+  }
+  if (!cursor.status().ok()) {
+    return cursor.status();
+  }
+  for (const auto& other : cursors) {
+    if (!other->status().ok()) {
+      return other->status();
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
+rocksdb::Status Redis::SetsUnionMembers(const rocksdb::ReadOptions& read_options, const std::vector<SetsInput>& sets,
+                                        std::vector<std::string>* members) {
+  // merge the sorted sets, a member shared by several sets comes
+  // up from all of them in a row and is only kept once
+  std::vector<std::unique_ptr<KeyStatisticsDurationGuard>> guards;
+  std::vector<std::unique_ptr<SetsMemberCursor>> cursors;
+  for (const auto& set : sets) {
+    guards.push_back(std::make_unique<KeyStatisticsDurationGuard>(this, DataType::kSets, set.key));
+    cursors.push_back(std::make_unique<SetsMemberCursor>(db_, read_options, handles_[kSetsDataCF], set.key,
+                                                         set.version, set.entries.get()));
+  }
+  auto greater = [&cursors](size_t a, size_t b) { return cursors[a]->member().compare(cursors[b]->member()) > 0; };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(greater);
+  for (size_t idx = 0; idx < cursors.size(); ++idx) {
+    if (cursors[idx]->Valid()) {
+      heap.push(idx);
+    }
+  }
+  size_t start = members->size();
+  while (!heap.empty()) {
+    size_t idx = heap.top();
+    heap.pop();
+    Slice member = cursors[idx]->member();
+    if (members->size() == start || member != members->back()) {
+      members->push_back(member.ToString());
+    }
+    cursors[idx]->Next();
+    if (cursors[idx]->Valid()) {
+      heap.push(idx);
+    }
+  }
+  for (const auto& cursor : cursors) {
+    if (!cursor->status().ok()) {
+      return cursor->status();
+    }
+  }
+  return rocksdb::Status::OK();
+}
+
 rocksdb::Status Redis::SDiff(const std::vector<std::string>& keys, std::vector<std::string>* members) {
   if (keys.empty()) {
     return rocksdb::Status::Corruption("SDiff invalid parameter, no keys");
@@ -190,10 +492,9 @@ rocksdb::Status Redis::SDiff(const std::vector<std::string>& keys, std::vector<s
   const rocksdb::Snapshot* snapshot;
 
   std::string meta_value;
-  uint64_t version = 0;
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
-  std::vector<KeyVersion> vaild_sets;
+  std::vector<SetsInput> vaild_sets;
   rocksdb::Status s;
 
   for (uint32_t idx = 1; idx < keys.size(); ++idx) {
@@ -212,7 +513,12 @@ rocksdb::Status Redis::SDiff(const std::vector<std::string>& keys, std::vector<s
     if (s.ok()) {
       ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
       if (!parsed_sets_meta_value.IsStale() && parsed_sets_meta_value.Count() != 0) {
-        vaild_sets.push_back({keys[idx], parsed_sets_meta_value.Version()});
+        SetsInput input;
+        s = GetSetsInput(keys[idx], &parsed_sets_meta_value, &input);
+        if (!s.ok()) {
+          return s;
+        }
+        vaild_sets.push_back(std::move(input));
       }
     } else if (!s.IsNotFound()) {
       return s;
@@ -234,35 +540,12 @@ rocksdb::Status Redis::SDiff(const std::vector<std::string>& keys, std::vector<s
   if (s.ok()) {
     ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
     if (!parsed_sets_meta_value.IsStale() && parsed_sets_meta_value.Count() != 0) {
-      bool found;
-      Slice prefix;
-      std::string member_value;
-      version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(keys[0], version, Slice());
-      prefix = sets_member_key.EncodeSeekKey();
-      KeyStatisticsDurationGuard guard(this, DataType::kSets, keys[0]);
-      auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
-      for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
-        ParsedSetsMemberKey parsed_sets_member_key(iter->key());
-        Slice member = parsed_sets_member_key.member();
-
-        found = false;
-        for (const auto& key_version : vaild_sets) {
-          SetsMemberKey sets_member_key(key_version.key, key_version.version, member);
-          s = db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
-          if (s.ok()) {
-            found = true;
-            break;
-          } else if (!s.IsNotFound()) {
-            delete iter;
-            return s;
-          }
-        }
-        if (!found) {
-          members->push_back(member.ToString());
-        }
+      SetsInput first;
+      s = GetSetsInput(keys[0], &parsed_sets_meta_value, &first);
+      if (!s.ok()) {
+        return s;
       }
-      delete iter;
+      return SetsDiffMembers(read_options, first, &vaild_sets, members);
     }
   } else if (!s.IsNotFound()) {
     return s;
@@ -284,7 +567,7 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
   ScopeRecordLock l(lock_mgr_, destination);
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
-  std::vector<KeyVersion> vaild_sets;
+  std::vector<SetsInput> vaild_sets;
   rocksdb::Status s;
 
   for (uint32_t idx = 1; idx < keys.size(); ++idx) {
@@ -303,7 +586,12 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
     if (s.ok()) {
       ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
       if (!parsed_sets_meta_value.IsStale() && parsed_sets_meta_value.Count() != 0) {
-        vaild_sets.push_back({keys[idx], parsed_sets_meta_value.Version()});
+        SetsInput input;
+        s = GetSetsInput(keys[idx], &parsed_sets_meta_value, &input);
+        if (!s.ok()) {
+          return s;
+        }
+        vaild_sets.push_back(std::move(input));
       }
     } else if (!s.IsNotFound()) {
       return s;
@@ -326,34 +614,15 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
   if (s.ok()) {
     ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
     if (!parsed_sets_meta_value.IsStale() && parsed_sets_meta_value.Count() != 0) {
-      bool found;
-      std::string member_value;
-      version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(keys[0], version, Slice());
-      Slice prefix = sets_member_key.EncodeSeekKey();
-      KeyStatisticsDurationGuard guard(this, DataType::kSets, keys[0]);
-      auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
-      for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
-        ParsedSetsMemberKey parsed_sets_member_key(iter->key());
-        Slice member = parsed_sets_member_key.member();
-
-        found = false;
-        for (const auto& key_version : vaild_sets) {
-          SetsMemberKey sets_member_key(key_version.key, key_version.version, member);
-          s = db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
-          if (s.ok()) {
-            found = true;
-            break;
-          } else if (!s.IsNotFound()) {
-            delete iter;
-            return s;
-          }
-        }
-        if (!found) {
-          members.push_back(member.ToString());
-        }
+      SetsInput first;
+      s = GetSetsInput(keys[0], &parsed_sets_meta_value, &first);
+      if (!s.ok()) {
+        return s;
+      }
+      s = SetsDiffMembers(read_options, first, &vaild_sets, &members);
+      if (!s.ok()) {
+        return s;
       }
-      delete iter;
     }
   } else if (!s.IsNotFound()) {
     return s;
@@ -372,15 +641,32 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  bool use_inline = inline_collection_max_entries_ != 0 && members.size() <= inline_collection_max_entries_;
+  if (s.IsNotFound() && use_inline) {
+    meta_value = NewBaseMetaValue(DataType::kSets);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
     statistic = parsed_sets_meta_value.Count();
     version = parsed_sets_meta_value.InitialMetaValue();
-    if (!parsed_sets_meta_value.check_set_count(static_cast<int32_t>(members.size()))) {
-      return Status::InvalidArgument("set size overflow");
+    if (use_inline) {
+      parsed_sets_meta_value.SetEncoding(CollectionEncoding::kInline);
+      InlineEntries entries(false);
+      for (const auto& member : members) {
+        entries.Put(member, Slice());
+      }
+      s = PutInlineEntries(DataType::kSets, destination, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+    } else {
+      if (!parsed_sets_meta_value.check_set_count(static_cast<int32_t>(members.size()))) {
+        return Status::InvalidArgument("set size overflow");
+      }
+      parsed_sets_meta_value.SetCount(static_cast<int32_t>(members.size()));
+      batch.Put(handles_[kMetaCF], base_destination.Encode(), meta_value);
     }
-    parsed_sets_meta_value.SetCount(static_cast<int32_t>(members.size()));
-    batch.Put(handles_[kMetaCF], base_destination.Encode(), meta_value);
   } else if (s.IsNotFound()) {
     char str[4];
     EncodeFixed32(str, members.size());
@@ -390,10 +676,12 @@ rocksdb::Status Redis::SDiffstore(const Slice& destination, const std::vector<st
   } else {
     return s;
   }
-  for (const auto& member : members) {
-    SetsMemberKey sets_member_key(destination, version, member);
-    BaseDataValue iter_value(Slice{});
-    batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
+  if (!use_inline) {
+    for (const auto& member : members) {
+      SetsMemberKey sets_member_key(destination, version, member);
+      BaseDataValue iter_value(Slice{});
+      batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
+    }
   }
   *ret = static_cast<int32_t>(members.size());
   s = db_->Write(default_write_options_, &batch);
@@ -411,10 +699,9 @@ rocksdb::Status Redis::SInter(const std::vector<std::string>& keys, std::vector<
   const rocksdb::Snapshot* snapshot;
 
   std::string meta_value;
-  uint64_t version = 0;
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
-  std::vector<KeyVersion> vaild_sets;
+  std::vector<SetsInput> vaild_sets;
   rocksdb::Status s;
 
   for (uint32_t idx = 1; idx < keys.size(); ++idx) {
@@ -435,7 +722,12 @@ rocksdb::Status Redis::SInter(const std::vector<std::string>& keys, std::vector<
       if (parsed_sets_meta_value.IsStale() || parsed_sets_meta_value.Count() == 0) {
         return rocksdb::Status::OK();
       } else {
-        vaild_sets.push_back({keys[idx], parsed_sets_meta_value.Version()});
+        SetsInput input;
+        s = GetSetsInput(keys[idx], &parsed_sets_meta_value, &input);
+        if (!s.ok()) {
+          return s;
+        }
+        vaild_sets.push_back(std::move(input));
       }
     } else if (s.IsNotFound()) {
       return rocksdb::Status::OK();
@@ -461,36 +753,13 @@ rocksdb::Status Redis::SInter(const std::vector<std::string>& keys, std::vector<
     if (parsed_sets_meta_value.IsStale() || parsed_sets_meta_value.Count() == 0) {
       return rocksdb::Status::OK();
     } else {
-      bool reliable;
-      std::string member_value;
-      version = parsed_sets_meta_value.Version();
-      SetsMemberKey sets_member_key(keys[0], version, Slice());
-      KeyStatisticsDurationGuard guard(this, DataType::kSets, keys[0]);
-      Slice prefix = sets_member_key.EncodeSeekKey();
-      auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
-      for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
-        ParsedSetsMemberKey parsed_sets_member_key(iter->key());
-        Slice member = parsed_sets_member_key.member();
-
-        reliable = true;
-        for (const auto& key_version : vaild_sets) {
-          SetsMemberKey sets_member_key(key_version.key, key_version.version, member);
-          s = db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
-          if (s.ok()) {
-            continue;
-          } else if (s.IsNotFound()) {
-            reliable = false;
-            break;
-          } else {
-            delete iter;
-            return s;
-          }
-        }
-        if (reliable) {
-          members->push_back(member.ToString());
-        }
+      SetsInput input;
+      s = GetSetsInput(keys[0], &parsed_sets_meta_value, &input);
+      if (!s.ok()) {
+        return s;
       }
-      delete iter;
+      vaild_sets.push_back(std::move(input));
+      return SetsInterMembers(read_options, &vaild_sets, members);
     }
   } else if (s.IsNotFound()) {
     return rocksdb::Status::OK();
@@ -515,7 +784,7 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
   ScopeRecordLock l(lock_mgr_, destination);
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
-  std::vector<KeyVersion> vaild_sets;
+  std::vector<SetsInput> vaild_sets;
   rocksdb::Status s;
 
   for (uint32_t idx = 1; idx < keys.size(); ++idx) {
@@ -537,7 +806,12 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
         have_invalid_sets = true;
         break;
       } else {
-        vaild_sets.push_back({keys[idx], parsed_sets_meta_value.Version()});
+        SetsInput input;
+        s = GetSetsInput(keys[idx], &parsed_sets_meta_value, &input);
+        if (!s.ok()) {
+          return s;
+        }
+        vaild_sets.push_back(std::move(input));
       }
     } else if (s.IsNotFound()) {
       have_invalid_sets = true;
@@ -566,36 +840,16 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
       if (parsed_sets_meta_value.IsStale() || parsed_sets_meta_value.Count() == 0) {
         have_invalid_sets = true;
       } else {
-        bool reliable;
-        std::string member_value;
-        version = parsed_sets_meta_value.Version();
-        SetsMemberKey sets_member_key(keys[0], version, Slice());
-        Slice prefix = sets_member_key.EncodeSeekKey();
-        KeyStatisticsDurationGuard guard(this, DataType::kSets, keys[0]);
-        auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
-        for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
-          ParsedSetsMemberKey parsed_sets_member_key(iter->key());
-          Slice member = parsed_sets_member_key.member();
-
-          reliable = true;
-          for (const auto& key_version : vaild_sets) {
-            SetsMemberKey sets_member_key(key_version.key, key_version.version, member);
-            s = db_->Get(read_options, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
-            if (s.ok()) {
-              continue;
-            } else if (s.IsNotFound()) {
-              reliable = false;
-              break;
-            } else {
-              delete iter;
-              return s;
-            }
-          }
-          if (reliable) {
-            members.push_back(member.ToString());
-          }
+        SetsInput input;
+        s = GetSetsInput(keys[0], &parsed_sets_meta_value, &input);
+        if (!s.ok()) {
+          return s;
+        }
+        vaild_sets.push_back(std::move(input));
+        s = SetsInterMembers(read_options, &vaild_sets, &members);
+        if (!s.ok()) {
+          return s;
         }
-        delete iter;
       }
     } else if (s.IsNotFound()) {
     } else {
@@ -616,15 +870,32 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  bool use_inline = inline_collection_max_entries_ != 0 && members.size() <= inline_collection_max_entries_;
+  if (s.IsNotFound() && use_inline) {
+    meta_value = NewBaseMetaValue(DataType::kSets);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
     statistic = parsed_sets_meta_value.Count();
     version = parsed_sets_meta_value.InitialMetaValue();
-    if (!parsed_sets_meta_value.check_set_count(static_cast<int32_t>(members.size()))) {
-      return Status::InvalidArgument("set size overflow");
+    if (use_inline) {
+      parsed_sets_meta_value.SetEncoding(CollectionEncoding::kInline);
+      InlineEntries entries(false);
+      for (const auto& member : members) {
+        entries.Put(member, Slice());
+      }
+      s = PutInlineEntries(DataType::kSets, destination, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+    } else {
+      if (!parsed_sets_meta_value.check_set_count(static_cast<int32_t>(members.size()))) {
+        return Status::InvalidArgument("set size overflow");
+      }
+      parsed_sets_meta_value.SetCount(static_cast<int32_t>(members.size()));
+      batch.Put(handles_[kMetaCF], base_destination.Encode(), meta_value);
     }
-    parsed_sets_meta_value.SetCount(static_cast<int32_t>(members.size()));
-    batch.Put(handles_[kMetaCF], base_destination.Encode(), meta_value);
   } else if (s.IsNotFound()) {
     char str[4];
     EncodeFixed32(str, members.size());
@@ -634,10 +905,12 @@ rocksdb::Status Redis::SInterstore(const Slice& destination, const std::vector<s
   } else {
     return s;
   }
-  for (const auto& member : members) {
-    SetsMemberKey sets_member_key(destination, version, member);
-    BaseDataValue iter_value(Slice{});
-    batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
+  if (!use_inline) {
+    for (const auto& member : members) {
+      SetsMemberKey sets_member_key(destination, version, member);
+      BaseDataValue iter_value(Slice{});
+      batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
+    }
   }
   *ret = static_cast<int32_t>(members.size());
   s = db_->Write(default_write_options_, &batch);
@@ -674,6 +947,16 @@ rocksdb::Status Redis::SIsmember(const Slice& key, const Slice& member, int32_t*
       return rocksdb::Status::NotFound("Stale");
     } else if (parsed_sets_meta_value.Count() == 0) {
       return rocksdb::Status::NotFound();
+    } else if (parsed_sets_meta_value.Encoding() == CollectionEncoding::kInline) {
+      InlineEntries entries(false);
+      s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      if (entries.Get(member) == nullptr) {
+        return rocksdb::Status::NotFound();
+      }
+      *ret = 1;
     } else {
       std::string member_value;
       version = parsed_sets_meta_value.Version();
@@ -725,6 +1008,17 @@ rocksdb::Status Redis::SMembers(const Slice& key, std::vector<std::string>* memb
     } else if (parsed_sets_meta_value.Count() == 0) {
       return rocksdb::Status::NotFound();
     } else {
+      if (parsed_sets_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(false);
+        s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        for (const auto& entry : entries.entries()) {
+          members->push_back(entry.field);
+        }
+        return s;
+      }
       version = parsed_sets_meta_value.Version();
       SetsMemberKey sets_member_key(key, version, Slice());
       Slice prefix = sets_member_key.EncodeSeekKey();
@@ -778,6 +1072,17 @@ Status Redis::SMembersWithTTL(const Slice& key,
         *ttl_millsec = *ttl_millsec - curtime >= 0 ? *ttl_millsec - curtime : -2;
       }
 
+      if (parsed_sets_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(false);
+        s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        for (const auto& entry : entries.entries()) {
+          members->push_back(entry.field);
+        }
+        return s;
+      }
       version = parsed_sets_meta_value.Version();
       SetsMemberKey sets_member_key(key, version, Slice());
       Slice prefix = sets_member_key.EncodeSeekKey();
@@ -803,6 +1108,10 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
   uint64_t version = 0;
   uint32_t statistic = 0;
   std::string meta_value;
+  std::shared_ptr<ZSetRankIndex> source_sample_index;
+  std::shared_ptr<ZSetRankIndex> destination_sample_index;
+  std::string source_member_key;
+  std::string destination_member_key;
   std::vector<std::string> keys{source.ToString(), destination.ToString()};
   MultiScopeRecordLock ml(lock_mgr_, keys);
 
@@ -829,6 +1138,21 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
       return rocksdb::Status::NotFound("Stale");
     } else if (parsed_sets_meta_value.Count() == 0) {
       return rocksdb::Status::NotFound();
+    } else if (parsed_sets_meta_value.Encoding() == CollectionEncoding::kInline) {
+      InlineEntries entries(false);
+      s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      if (!entries.Delete(member)) {
+        *ret = 0;
+        return rocksdb::Status::NotFound();
+      }
+      *ret = 1;
+      s = PutInlineEntries(DataType::kSets, source, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
     } else {
       std::string member_value;
       version = parsed_sets_meta_value.Version();
@@ -843,6 +1167,8 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
         batch.Put(handles_[kMetaCF], base_source.Encode(), meta_value);
         batch.Delete(handles_[kSetsDataCF], sets_member_key.Encode());
         statistic++;
+        source_sample_index = LookupSetsSampleIndex(source, version);
+        source_member_key = sets_member_key.Encode().ToString();
       } else if (s.IsNotFound()) {
         *ret = 0;
         return rocksdb::Status::NotFound();
@@ -869,9 +1195,25 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  if (s.IsNotFound() && inline_collection_max_entries_ != 0) {
+    meta_value = NewBaseMetaValue(DataType::kSets);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
-    if (parsed_sets_meta_value.IsStale() || parsed_sets_meta_value.Count() == 0) {
+    if (UseInlineEntries(&parsed_sets_meta_value)) {
+      InlineEntries entries(false);
+      s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      if (entries.Put(member, Slice())) {
+        s = PutInlineEntries(DataType::kSets, destination, &meta_value, entries, &batch);
+        if (!s.ok()) {
+          return s;
+        }
+      }
+    } else if (parsed_sets_meta_value.IsStale() || parsed_sets_meta_value.Count() == 0) {
       version = parsed_sets_meta_value.InitialMetaValue();
       parsed_sets_meta_value.SetCount(1);
       batch.Put(handles_[kMetaCF], base_destination.Encode(), meta_value);
@@ -891,6 +1233,8 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
         BaseDataValue iter_value(Slice{});
         batch.Put(handles_[kMetaCF], base_destination.Encode(), meta_value);
         batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), iter_value.Encode());
+        destination_sample_index = LookupSetsSampleIndex(destination, version);
+        destination_member_key = sets_member_key.Encode().ToString();
       } else if (!s.ok()) {
         return s;
       }
@@ -908,6 +1252,12 @@ rocksdb::Status Redis::SMove(const Slice& source, const Slice& destination, cons
     return s;
   }
   s = db_->Write(default_write_options_, &batch);
+  if (source_sample_index) {
+    UpdateSetsSampleIndex(source, source_sample_index, s, {}, {source_member_key});
+  }
+  if (destination_sample_index) {
+    UpdateSetsSampleIndex(destination, destination_sample_index, s, {destination_member_key}, {});
+  }
   UpdateSpecificKeyStatistics(DataType::kSets, source.ToString(), 1);
   return s;
 }
@@ -918,6 +1268,8 @@ rocksdb::Status Redis::SPop(const Slice& key, std::vector<std::string>* members,
   std::string meta_value;
   rocksdb::WriteBatch batch;
   ScopeRecordLock l(lock_mgr_, key);
+  std::shared_ptr<ZSetRankIndex> sample_index;
+  std::vector<std::string> popped_keys;
 
   BaseMetaKey base_meta_key(key);
   Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
@@ -937,6 +1289,22 @@ rocksdb::Status Redis::SPop(const Slice& key, std::vector<std::string>* members,
       return Status::NotFound("Stale");
     } else if (parsed_sets_meta_value.Count() == 0) {
       return Status::NotFound();
+    } else if (parsed_sets_meta_value.Encoding() == CollectionEncoding::kInline) {
+      InlineEntries entries(false);
+      s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      engine.seed(time(nullptr));
+      for (int64_t cur_round = 0; cur_round < cnt && entries.size() != 0; cur_round++) {
+        size_t target_index = engine() % entries.size();
+        members->push_back(entries[target_index].field);
+        entries.Erase(target_index);
+      }
+      s = PutInlineEntries(DataType::kSets, key, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
     } else {
       int32_t length = parsed_sets_meta_value.Count();
       if (length < cnt) {
@@ -959,41 +1327,66 @@ rocksdb::Status Redis::SPop(const Slice& key, std::vector<std::string>* members,
         //batch.Put(handles_[kMetaCF], key, meta_value);
         batch.Delete(handles_[kMetaCF], base_meta_key.Encode());
         delete iter;
+        sets_sample_index_store_->Remove(key.ToString());
 
       } else {
-        engine.seed(time(nullptr));
-        int32_t cur_index = 0;
-        int32_t size = parsed_sets_meta_value.Count();
-        int32_t target_index = -1;
         uint64_t version = parsed_sets_meta_value.Version();
-        std::unordered_set<int32_t> sets_index;
-        int32_t modnum = size;
-
-        for (int64_t cur_round = 0;
-            cur_round < cnt;
-            cur_round++) {
-          do {
-            target_index = static_cast<int32_t>( engine() % modnum);
-          } while (sets_index.find(target_index) != sets_index.end());
-          sets_index.insert(target_index);
+        if (UseSetsSampleIndex(length, cnt)) {
+          sample_index = GetSetsSampleIndex(key, version, length);
         }
-
-        SetsMemberKey sets_member_key(key, version, Slice());
-        int64_t del_count = 0;
-        KeyStatisticsDurationGuard guard(this, DataType::kSets, key.ToString());
-        auto iter = db_->NewIterator(default_read_options_, handles_[kSetsDataCF]);
-        for (iter->Seek(sets_member_key.EncodeSeekKey());
-            iter->Valid() && cur_index < size;
-            iter->Next(), cur_index++) {
-          if (del_count == cnt) {
-            break;
+        if (sample_index) {
+          s = SampleSetsMemberKeys(key, version, sample_index, cnt, true, &popped_keys);
+          if (!s.ok()) {
+            return s;
           }
-          if (sets_index.find(cur_index) != sets_index.end()) {
-            del_count++;
-            batch.Delete(handles_[kSetsDataCF], iter->key());
-            ParsedSetsMemberKey parsed_sets_member_key(iter->key());
+          if (static_cast<int64_t>(popped_keys.size()) < cnt) {
+            // the index is too far off, walk the set instead
+            popped_keys.clear();
+            sample_index = nullptr;
+          }
+        }
+        if (sample_index) {
+          for (const auto& member_key : popped_keys) {
+            batch.Delete(handles_[kSetsDataCF], member_key);
+            ParsedSetsMemberKey parsed_sets_member_key(member_key);
             members->push_back(parsed_sets_member_key.member().ToString());
           }
+        } else {
+          sets_sample_index_store_->Remove(key.ToString());
+          engine.seed(time(nullptr));
+          int32_t cur_index = 0;
+          int32_t size = parsed_sets_meta_value.Count();
+          int32_t target_index = -1;
+          std::unordered_set<int32_t> sets_index;
+          int32_t modnum = size;
+
+          for (int64_t cur_round = 0;
+              cur_round < cnt;
+              cur_round++) {
+            do {
+              target_index = static_cast<int32_t>( engine() % modnum);
+            } while (sets_index.find(target_index) != sets_index.end());
+            sets_index.insert(target_index);
+          }
+
+          SetsMemberKey sets_member_key(key, version, Slice());
+          int64_t del_count = 0;
+          KeyStatisticsDurationGuard guard(this, DataType::kSets, key.ToString());
+          auto iter = db_->NewIterator(default_read_options_, handles_[kSetsDataCF]);
+          for (iter->Seek(sets_member_key.EncodeSeekKey());
+              iter->Valid() && cur_index < size;
+              iter->Next(), cur_index++) {
+            if (del_count == cnt) {
+              break;
+            }
+            if (sets_index.find(cur_index) != sets_index.end()) {
+              del_count++;
+              batch.Delete(handles_[kSetsDataCF], iter->key());
+              ParsedSetsMemberKey parsed_sets_member_key(iter->key());
+              members->push_back(parsed_sets_member_key.member().ToString());
+            }
+          }
+          delete iter;
         }
 
         if (!parsed_sets_meta_value.CheckModifyCount(static_cast<int32_t>(-cnt))) {
@@ -1001,13 +1394,14 @@ rocksdb::Status Redis::SPop(const Slice& key, std::vector<std::string>* members,
         }
         parsed_sets_meta_value.ModifyCount(static_cast<int32_t>(-cnt));
         batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
-        delete iter;
       }
     }
   } else {
     return s;
   }
-  return db_->Write(default_write_options_, &batch);
+  s = db_->Write(default_write_options_, &batch);
+  UpdateSetsSampleIndex(key, sample_index, s, {}, popped_keys);
+  return s;
 }
 
 rocksdb::Status Redis::ResetSpopCount(const std::string& key) { return spop_counts_store_->Remove(key); }
@@ -1054,9 +1448,50 @@ rocksdb::Status Redis::SRandmember(const Slice& key, int32_t count, std::vector<
       return rocksdb::Status::NotFound("Stale");
     } else if (parsed_sets_meta_value.Count() == 0) {
       return rocksdb::Status::NotFound();
+    } else if (parsed_sets_meta_value.Encoding() == CollectionEncoding::kInline) {
+      InlineEntries entries(false);
+      s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      engine.seed(last_seed);
+      if (count > 0) {
+        std::vector<size_t> positions(entries.size());
+        std::iota(positions.begin(), positions.end(), 0);
+        std::shuffle(positions.begin(), positions.end(), engine);
+        positions.resize(std::min(positions.size(), static_cast<size_t>(count)));
+        for (size_t pos : positions) {
+          members->push_back(entries[pos].field);
+        }
+      } else {
+        for (int32_t idx = 0; idx < -count; ++idx) {
+          members->push_back(entries[engine() % entries.size()].field);
+        }
+      }
     } else {
       int32_t size = parsed_sets_meta_value.Count();
       uint64_t version = parsed_sets_meta_value.Version();
+      std::shared_ptr<ZSetRankIndex> sample_index;
+      if (UseSetsSampleIndex(size, std::abs(static_cast<int64_t>(count)))) {
+        sample_index = GetSetsSampleIndex(key, version, size);
+      }
+      if (sample_index) {
+        std::vector<std::string> member_keys;
+        int64_t sample_count = std::abs(static_cast<int64_t>(count));
+        s = SampleSetsMemberKeys(key, version, sample_index, sample_count, count > 0, &member_keys);
+        if (!s.ok()) {
+          return s;
+        }
+        if (static_cast<int64_t>(member_keys.size()) == sample_count) {
+          for (const auto& member_key : member_keys) {
+            ParsedSetsMemberKey parsed_sets_member_key(member_key);
+            members->push_back(parsed_sets_member_key.member().ToString());
+          }
+          return s;
+        }
+        // the index is too far off, walk the set instead
+        sets_sample_index_store_->Remove(key.ToString());
+      }
       if (count > 0) {
         count = count <= size ? count : size;
         while (targets.size() < static_cast<size_t>(count)) {
@@ -1101,6 +1536,116 @@ rocksdb::Status Redis::SRandmember(const Slice& key, int32_t count, std::vector<
   return s;
 }
 
+bool Redis::UseSetsSampleIndex(int32_t size, int64_t count) {
+  // a sample seeks and steps over at most a block of member keys
+  return size >= kSetsSampleIndexMinMembers && count * kZSetRankIndexBlockSize < size;
+}
+
+std::shared_ptr<ZSetRankIndex> Redis::GetSetsSampleIndex(const Slice& key, uint64_t version, int32_t count) {
+  std::shared_ptr<ZSetRankIndex> sample_index;
+  if (sets_sample_index_store_->Lookup(key.ToString(), &sample_index).ok() && sample_index->version() == version &&
+      std::abs(sample_index->count() - count) * kSetsSampleIndexMaxDrift <= count) {
+    return sample_index;
+  }
+
+  sample_index = std::make_shared<ZSetRankIndex>(version, handles_[kSetsDataCF]->GetComparator());
+  SetsMemberKey sets_member_key(key, version, Slice());
+  Slice prefix = sets_member_key.EncodeSeekKey();
+  rocksdb::ReadOptions read_options;
+  read_options.fill_cache = false;
+  KeyStatisticsDurationGuard guard(this, DataType::kSets, key.ToString());
+  rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
+  for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
+    sample_index->Append(iter->key());
+  }
+  rocksdb::Status s = iter->status();
+  delete iter;
+  sample_index->FinishBuild();
+  if (!s.ok() || sample_index->count() == 0) {
+    sets_sample_index_store_->Remove(key.ToString());
+    return nullptr;
+  }
+  sets_sample_index_store_->Insert(key.ToString(), sample_index, sample_index->block_num() + 1);
+  return sample_index;
+}
+
+std::shared_ptr<ZSetRankIndex> Redis::LookupSetsSampleIndex(const Slice& key, uint64_t version) {
+  std::shared_ptr<ZSetRankIndex> sample_index;
+  if (!sets_sample_index_store_->Lookup(key.ToString(), &sample_index).ok()) {
+    return nullptr;
+  }
+  if (sample_index->version() != version) {
+    // the set was deleted or recreated since
+    sets_sample_index_store_->Remove(key.ToString());
+    return nullptr;
+  }
+  return sample_index;
+}
+
+void Redis::UpdateSetsSampleIndex(const Slice& key, const std::shared_ptr<ZSetRankIndex>& sample_index,
+                                  const Status& s, const std::vector<std::string>& added,
+                                  const std::vector<std::string>& removed) {
+  if (!sample_index) {
+    return;
+  }
+  if (!s.ok() || added.size() + removed.size() > kZSetRankIndexMaxUpdate) {
+    sets_sample_index_store_->Remove(key.ToString());
+    return;
+  }
+  for (const auto& member_key : removed) {
+    sample_index->Erase(member_key);
+  }
+  for (const auto& member_key : added) {
+    sample_index->Insert(member_key);
+  }
+  // a sample steps through its block one key at a time, rebuild the
+  // index rather than walk a block grown past twice the block size
+  size_t block = 0;
+  std::string block_start;
+  int64_t block_count = 0;
+  if (sample_index->OversizedBlock(&block, &block_start, &block_count)) {
+    sets_sample_index_store_->Remove(key.ToString());
+  }
+}
+
+Status Redis::SampleSetsMemberKeys(const Slice& key, uint64_t version,
+                                   const std::shared_ptr<ZSetRankIndex>& sample_index, int64_t count, bool unique,
+                                   std::vector<std::string>* member_keys) {
+  std::mt19937_64 engine(pstd::NowMicros());
+  std::unordered_set<std::string> picked;
+  SetsMemberKey sets_member_key(key, version, Slice());
+  Slice prefix = sets_member_key.EncodeSeekKey();
+  std::unique_ptr<rocksdb::Iterator> iter(db_->NewIterator(default_read_options_, handles_[kSetsDataCF]));
+
+  // a rank past the members left by other writes misses, give up
+  // after a few of them rather than spin on a stale index
+  int64_t misses = 0;
+  std::string block_start;
+  while (static_cast<int64_t>(member_keys->size()) < count && misses <= count / 4 + 4) {
+    int64_t rank = static_cast<int64_t>(engine() % static_cast<uint64_t>(sample_index->count()));
+    int64_t block_rank = 0;
+    sample_index->LocateRank(rank, &block_rank, &block_start);
+    iter->Seek(block_start.empty() ? prefix : Slice(block_start));
+    for (int64_t step = rank - block_rank; step > 0 && iter->Valid(); --step) {
+      iter->Next();
+    }
+    if (!iter->Valid() || !iter->key().starts_with(prefix)) {
+      if (!iter->status().ok()) {
+        return iter->status();
+      }
+      misses++;
+      continue;
+    }
+    std::string member_key = iter->key().ToString();
+    if (unique && !picked.insert(member_key).second) {
+      misses++;
+      continue;
+    }
+    member_keys->push_back(std::move(member_key));
+  }
+  return Status::OK();
+}
+
 rocksdb::Status Redis::SRem(const Slice& key, const std::vector<std::string>& members, int32_t* ret) {
   *ret = 0;
   rocksdb::WriteBatch batch;
@@ -1109,6 +1654,8 @@ rocksdb::Status Redis::SRem(const Slice& key, const std::vector<std::string>& me
   uint64_t version = 0;
   uint32_t statistic = 0;
   std::string meta_value;
+  std::shared_ptr<ZSetRankIndex> sample_index;
+  std::vector<std::string> removed_member_keys;
 
   BaseMetaKey base_meta_key(key);
   rocksdb::Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
@@ -1128,10 +1675,29 @@ rocksdb::Status Redis::SRem(const Slice& key, const std::vector<std::string>& me
       return rocksdb::Status::NotFound("stale");
     } else if (parsed_sets_meta_value.Count() == 0) {
       return rocksdb::Status::NotFound();
+    } else if (parsed_sets_meta_value.Encoding() == CollectionEncoding::kInline) {
+      InlineEntries entries(false);
+      s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+      if (!s.ok()) {
+        return s;
+      }
+      int32_t cnt = 0;
+      for (const auto& member : members) {
+        if (entries.Delete(member)) {
+          cnt++;
+        }
+      }
+      *ret = cnt;
+      s = PutInlineEntries(DataType::kSets, key, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
     } else {
       int32_t cnt = 0;
       std::string member_value;
       version = parsed_sets_meta_value.Version();
+      sample_index = LookupSetsSampleIndex(key, version);
+      std::unordered_set<std::string> removed;
       for (const auto& member : members) {
         SetsMemberKey sets_member_key(key, version, member);
         s = db_->Get(default_read_options_, handles_[kSetsDataCF], sets_member_key.Encode(), &member_value);
@@ -1139,6 +1705,9 @@ rocksdb::Status Redis::SRem(const Slice& key, const std::vector<std::string>& me
           cnt++;
           statistic++;
           batch.Delete(handles_[kSetsDataCF], sets_member_key.Encode());
+          if (sample_index && removed.insert(member).second) {
+            removed_member_keys.push_back(sets_member_key.Encode().ToString());
+          }
         } else if (s.IsNotFound()) {
         } else {
           return s;
@@ -1158,6 +1727,7 @@ rocksdb::Status Redis::SRem(const Slice& key, const std::vector<std::string>& me
     return s;
   }
   s = db_->Write(default_write_options_, &batch);
+  UpdateSetsSampleIndex(key, sample_index, s, {}, removed_member_keys);
   UpdateSpecificKeyStatistics(DataType::kSets, key.ToString(), statistic);
   return s;
 }
@@ -1173,7 +1743,7 @@ rocksdb::Status Redis::SUnion(const std::vector<std::string>& keys, std::vector<
   std::string meta_value;
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
-  std::vector<KeyVersion> vaild_sets;
+  std::vector<SetsInput> vaild_sets;
   rocksdb::Status s;
 
   for (const auto & key : keys) {
@@ -1192,31 +1762,19 @@ rocksdb::Status Redis::SUnion(const std::vector<std::string>& keys, std::vector<
     if (s.ok()) {
       ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
       if (!parsed_sets_meta_value.IsStale() && parsed_sets_meta_value.Count() != 0) {
-        vaild_sets.push_back({key, parsed_sets_meta_value.Version()});
+        SetsInput input;
+        s = GetSetsInput(key, &parsed_sets_meta_value, &input);
+        if (!s.ok()) {
+          return s;
+        }
+        vaild_sets.push_back(std::move(input));
       }
     } else if (!s.IsNotFound()) {
       return s;
     }
   }
 
-  Slice prefix;
-  std::map<std::string, bool> result_flag;
-  for (const auto& key_version : vaild_sets) {
-    SetsMemberKey sets_member_key(key_version.key, key_version.version, Slice());
-    prefix = sets_member_key.EncodeSeekKey();
-    KeyStatisticsDurationGuard guard(this, DataType::kSets, key_version.key);
-    auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
-    for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
-      ParsedSetsMemberKey parsed_sets_member_key(iter->key());
-      std::string member = parsed_sets_member_key.member().ToString();
-      if (result_flag.find(member) == result_flag.end()) {
-        members->push_back(member);
-        result_flag[member] = true;
-      }
-    }
-    delete iter;
-  }
-  return rocksdb::Status::OK();
+  return SetsUnionMembers(read_options, vaild_sets, members);
 }
 
 rocksdb::Status Redis::SUnionstore(const Slice& destination, const std::vector<std::string>& keys, std::vector<std::string>& value_to_dest, int32_t* ret) {
@@ -1233,7 +1791,7 @@ rocksdb::Status Redis::SUnionstore(const Slice& destination, const std::vector<s
   ScopeRecordLock l(lock_mgr_, destination);
   ScopeSnapshot ss(db_, &snapshot);
   read_options.snapshot = snapshot;
-  std::vector<KeyVersion> vaild_sets;
+  std::vector<SetsInput> vaild_sets;
   rocksdb::Status s;
 
   for (const auto & key : keys) {
@@ -1252,30 +1810,22 @@ rocksdb::Status Redis::SUnionstore(const Slice& destination, const std::vector<s
     if (s.ok()) {
       ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
       if (!parsed_sets_meta_value.IsStale() && parsed_sets_meta_value.Count() != 0) {
-        vaild_sets.push_back({key, parsed_sets_meta_value.Version()});
+        SetsInput input;
+        s = GetSetsInput(key, &parsed_sets_meta_value, &input);
+        if (!s.ok()) {
+          return s;
+        }
+        vaild_sets.push_back(std::move(input));
       }
     } else if (!s.IsNotFound()) {
       return s;
     }
   }
 
-  Slice prefix;
   std::vector<std::string> members;
-  std::map<std::string, bool> result_flag;
-  for (const auto& key_version : vaild_sets) {
-    SetsMemberKey sets_member_key(key_version.key, key_version.version, Slice());
-    prefix = sets_member_key.EncodeSeekKey();
-    KeyStatisticsDurationGuard guard(this, DataType::kSets, key_version.key);
-    auto iter = db_->NewIterator(read_options, handles_[kSetsDataCF]);
-    for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
-      ParsedSetsMemberKey parsed_sets_member_key(iter->key());
-      std::string member = parsed_sets_member_key.member().ToString();
-      if (result_flag.find(member) == result_flag.end()) {
-        members.push_back(member);
-        result_flag[member] = true;
-      }
-    }
-    delete iter;
+  s = SetsUnionMembers(read_options, vaild_sets, &members);
+  if (!s.ok()) {
+    return s;
   }
 
   uint32_t statistic = 0;
@@ -1291,15 +1841,32 @@ rocksdb::Status Redis::SUnionstore(const Slice& destination, const std::vector<s
         DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
     }
   }
+  bool use_inline = inline_collection_max_entries_ != 0 && members.size() <= inline_collection_max_entries_;
+  if (s.IsNotFound() && use_inline) {
+    meta_value = NewBaseMetaValue(DataType::kSets);
+    s = Status::OK();
+  }
   if (s.ok()) {
     ParsedSetsMetaValue parsed_sets_meta_value(&meta_value);
     statistic = parsed_sets_meta_value.Count();
     version = parsed_sets_meta_value.InitialMetaValue();
-    if (!parsed_sets_meta_value.check_set_count(static_cast<int32_t>(members.size()))) {
-      return Status::InvalidArgument("set size overflow");
+    if (use_inline) {
+      parsed_sets_meta_value.SetEncoding(CollectionEncoding::kInline);
+      InlineEntries entries(false);
+      for (const auto& member : members) {
+        entries.Put(member, Slice());
+      }
+      s = PutInlineEntries(DataType::kSets, destination, &meta_value, entries, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+    } else {
+      if (!parsed_sets_meta_value.check_set_count(static_cast<int32_t>(members.size()))) {
+        return Status::InvalidArgument("set size overflow");
+      }
+      parsed_sets_meta_value.SetCount(static_cast<int32_t>(members.size()));
+      batch.Put(handles_[kMetaCF], base_destination.Encode(), meta_value);
     }
-    parsed_sets_meta_value.SetCount(static_cast<int32_t>(members.size()));
-    batch.Put(handles_[kMetaCF], destination, meta_value);
   } else if (s.IsNotFound()) {
     char str[4];
     EncodeFixed32(str, members.size());
@@ -1309,10 +1876,12 @@ rocksdb::Status Redis::SUnionstore(const Slice& destination, const std::vector<s
   } else {
     return s;
   }
-  for (const auto& member : members) {
-    SetsMemberKey sets_member_key(destination, version, member);
-    BaseDataValue i_val(Slice{});
-    batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), i_val.Encode());
+  if (!use_inline) {
+    for (const auto& member : members) {
+      SetsMemberKey sets_member_key(destination, version, member);
+      BaseDataValue i_val(Slice{});
+      batch.Put(handles_[kSetsDataCF], sets_member_key.Encode(), i_val.Encode());
+    }
   }
   *ret = static_cast<int32_t>(members.size());
   s = db_->Write(default_write_options_, &batch);
@@ -1371,6 +1940,30 @@ rocksdb::Status Redis::SScan(const Slice& key, int64_t cursor, const std::string
         sub_member = pattern.substr(0, pattern.size() - 1);
       }
 
+      if (parsed_sets_meta_value.Encoding() == CollectionEncoding::kInline) {
+        InlineEntries entries(false);
+        s = DecodeInlineEntries(&parsed_sets_meta_value, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        size_t idx = entries.LowerBound(start_point);
+        for (; idx < entries.size() && rest > 0 && Slice(entries[idx].field).starts_with(sub_member); ++idx) {
+          const std::string& member = entries[idx].field;
+          if (StringMatch(pattern.data(), pattern.size(), member.data(), member.size(), 0) != 0) {
+            members->push_back(member);
+          }
+          rest--;
+        }
+        if (idx < entries.size() &&
+            (entries[idx].field.compare(sub_member) < 0 || Slice(entries[idx].field).starts_with(sub_member))) {
+          *next_cursor = cursor + step_length;
+          StoreScanNextPoint(DataType::kSets, key, pattern, *next_cursor, entries[idx].field);
+        } else {
+          *next_cursor = 0;
+        }
+        return rocksdb::Status::OK();
+      }
+
       SetsMemberKey sets_member_prefix(key, version, sub_member);
       SetsMemberKey sets_member_key(key, version, start_point);
       std::string prefix = sets_member_prefix.EncodeSeekKey().ToString();
@@ -1472,9 +2065,17 @@ rocksdb::Status Redis::SetsDel(const Slice& key, std::string&& prefetch_meta) {
       return rocksdb::Status::NotFound();
     } else {
       uint32_t statistic = parsed_sets_meta_value.Count();
+      rocksdb::WriteBatch batch;
+      bool range_deleted =
+          parsed_sets_meta_value.Encoding() != CollectionEncoding::kInline &&
+          DeleteDataKeysRange(DataType::kSets, key, parsed_sets_meta_value.Version(), statistic, &batch);
       parsed_sets_meta_value.InitialMetaValue();
-      s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      s = db_->Write(default_write_options_, &batch);
       UpdateSpecificKeyStatistics(DataType::kSets, key.ToString(), statistic);
+      if (s.ok() && range_deleted) {
+        storage_->AddBGTask({DataType::kSets, kCompactRange, {key.ToString()}});
+      }
     }
   }
   return s;
@@ -714,7 +714,10 @@ Status Redis::StreamReScanRange(const Slice& key, const uint64_t version, const
   StreamDataKey streams_data_prefix(key, version, Slice());
   StreamDataKey streams_start_data_key(key, start_key_version, start_key_id);
   std::string prefix = streams_data_prefix.EncodeSeekKey().ToString();
-  rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kStreamsDataCF]);
+  // the key of version + 1 is out of the prefix of the data keys
+  rocksdb::ReadOptions iterator_options(read_options);
+  iterator_options.total_order_seek = start_no_limit;
+  rocksdb::Iterator* iter = db_->NewIterator(iterator_options, handles_[kStreamsDataCF]);
   for (iter->SeekForPrev(streams_start_data_key.Encode().ToString());
        iter->Valid() && remain > 0 && iter->key().starts_with(prefix); iter->Prev()) {
     ParsedStreamDataKey parsed_streams_data_key(iter->key());
@@ -8,6 +8,7 @@
 #include <climits>
 #include <limits>
 #include <memory>
+#include <numeric>
 
 #include <fmt/core.h>
 #include <glog/logging.h>
@@ -84,6 +85,7 @@ Status Redis::Append(const Slice& key, const Slice& value, int32_t* ret, int64_t
     ParsedStringsValue parsed_strings_value(&old_value);
     if (parsed_strings_value.IsStale()) {
       *ret = static_cast<int32_t>(value.size());
+      out_new_value = value.ToString();
       StringsValue strings_value(value);
       return db_->Put(default_write_options_, base_key.Encode(), strings_value.Encode());
     } else {
@@ -99,6 +101,7 @@ Status Redis::Append(const Slice& key, const Slice& value, int32_t* ret, int64_t
     }
   } else if (s.IsNotFound()) {
     *ret = static_cast<int32_t>(value.size());
+    out_new_value = value.ToString();
     StringsValue strings_value(value);
     *expired_timestamp_millsec = 0;
     return db_->Put(default_write_options_, base_key.Encode(), strings_value.Encode());
@@ -444,6 +447,81 @@ Status Redis::MGetWithTTL(const Slice& key, std::string* value, int64_t* ttl_mil
   return s;
 }
 
+Status Redis::MGet(const std::vector<std::string>& keys, const std::vector<size_t>& indexes,
+                   std::vector<ValueStatus>* vss) {
+  return StringsMultiGet(keys, indexes, vss, false);
+}
+
+Status Redis::MGetWithTTL(const std::vector<std::string>& keys, const std::vector<size_t>& indexes,
+                          std::vector<ValueStatus>* vss) {
+  return StringsMultiGet(keys, indexes, vss, true);
+}
+
+Status Redis::StringsMultiGet(const std::vector<std::string>& keys, const std::vector<size_t>& indexes,
+                              std::vector<ValueStatus>* vss, bool with_ttl) {
+  size_t num_keys = indexes.size();
+  if (num_keys == 0) {
+    return Status::OK();
+  }
+
+  std::vector<std::string> encoded_keys;
+  encoded_keys.reserve(num_keys);
+  for (size_t index : indexes) {
+    BaseKey base_key(keys[index]);
+    encoded_keys.emplace_back(base_key.Encode().ToString());
+  }
+
+  // MultiGet with sorted_input skips its own sort, the keys must be
+  // ordered by the comparator of the meta column family
+  const rocksdb::Comparator* comparator = handles_[kMetaCF]->GetComparator();
+  std::vector<size_t> order(num_keys);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return comparator->Compare(encoded_keys[lhs], encoded_keys[rhs]) < 0;
+  });
+  std::vector<Slice> sorted_keys;
+  sorted_keys.reserve(num_keys);
+  for (size_t pos : order) {
+    sorted_keys.emplace_back(encoded_keys[pos]);
+  }
+
+  std::vector<rocksdb::PinnableSlice> values(num_keys);
+  std::vector<Status> statuses(num_keys);
+  db_->MultiGet(default_read_options_, handles_[kMetaCF], num_keys, sorted_keys.data(), values.data(),
+                statuses.data(), true);
+
+  for (size_t i = 0; i < num_keys; ++i) {
+    ValueStatus& vs = (*vss)[indexes[order[i]]];
+    vs.value.clear();
+    vs.status = Status::NotFound();
+    vs.ttl_millsec = with_ttl ? -2 : 0;
+
+    const Status& s = statuses[i];
+    if (s.IsNotFound()) {
+      continue;
+    } else if (!s.ok()) {
+      return s;
+    }
+    // Keys holding other types are reported as nil, the same as MGet(key)
+    if (values[i].empty() || static_cast<DataType>(static_cast<uint8_t>(values[i][0])) != DataType::kStrings) {
+      continue;
+    }
+    // Parse the pinned value in place, only the user value gets copied out
+    ParsedStringsValue parsed_strings_value(values[i]);
+    if (parsed_strings_value.IsStale()) {
+      continue;
+    }
+    Slice user_value = parsed_strings_value.UserValue();
+    vs.value.assign(user_value.data(), user_value.size());
+    vs.status = Status::OK();
+    if (with_ttl) {
+      int64_t expiry_time = parsed_strings_value.Etime();
+      vs.ttl_millsec = (expiry_time == 0) ? -1 : CalculateTTL(expiry_time);
+    }
+  }
+  return Status::OK();
+}
+
 Status Redis::GetBit(const Slice& key, int64_t offset, int32_t* ret) {
   std::string meta_value;
 
@@ -622,6 +700,7 @@ Status Redis::GetSet(const Slice& key, const Slice& value, std::string* old_valu
 Status Redis::Incrby(const Slice& key, int64_t value, int64_t* ret, int64_t* expired_timestamp_millsec) {
   std::string old_value;
   std::string new_value;
+  *expired_timestamp_millsec = 0;
   ScopeRecordLock l(lock_mgr_, key);
   BaseKey base_key(key);
   Status s = db_->Get(default_read_options_, base_key.Encode(), &old_value);
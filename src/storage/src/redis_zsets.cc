@@ -94,6 +94,8 @@ Status Redis::ZPopMax(const Slice& key, const int64_t count, std::vector<ScoreMe
       uint64_t version = parsed_zsets_meta_value.Version();
       ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::max(), Slice());
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
+      std::shared_ptr<ZSetRankIndex> rank_index = LookupZSetRankIndex(key, version);
+      std::vector<std::string> removed_score_keys;
       rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
       int32_t del_cnt = 0;
       for (iter->SeekForPrev(zsets_score_key.Encode()); iter->Valid() && del_cnt < num; iter->Prev()) {
@@ -105,6 +107,9 @@ Status Redis::ZPopMax(const Slice& key, const int64_t count, std::vector<ScoreMe
         ++del_cnt;
         batch.Delete(handles_[kZsetsDataCF], zsets_member_key.Encode());
         batch.Delete(handles_[kZsetsScoreCF], iter->key());
+        if (rank_index) {
+          removed_score_keys.push_back(iter->key().ToString());
+        }
       }
       delete iter;
       if (!parsed_zsets_meta_value.CheckModifyCount(-del_cnt)) {
@@ -113,6 +118,9 @@ Status Redis::ZPopMax(const Slice& key, const int64_t count, std::vector<ScoreMe
       parsed_zsets_meta_value.ModifyCount(-del_cnt);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
       s = db_->Write(default_write_options_, &batch);
+      if (rank_index) {
+        UpdateZSetRankIndex(key, rank_index, s, {}, removed_score_keys);
+      }
       UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
       return s;
     }
@@ -152,6 +160,8 @@ Status Redis::ZPopMin(const Slice& key, const int64_t count, std::vector<ScoreMe
       uint64_t version = parsed_zsets_meta_value.Version();
       ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
+      std::shared_ptr<ZSetRankIndex> rank_index = LookupZSetRankIndex(key, version);
+      std::vector<std::string> removed_score_keys;
       rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
       int32_t del_cnt = 0;
       for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && del_cnt < num; iter->Next()) {
@@ -163,6 +173,9 @@ Status Redis::ZPopMin(const Slice& key, const int64_t count, std::vector<ScoreMe
         ++del_cnt;
         batch.Delete(handles_[kZsetsDataCF], zsets_member_key.Encode());
         batch.Delete(handles_[kZsetsScoreCF], iter->key());
+        if (rank_index) {
+          removed_score_keys.push_back(iter->key().ToString());
+        }
       }
       delete iter;
       if (!parsed_zsets_meta_value.CheckModifyCount(-del_cnt)) {
@@ -171,6 +184,9 @@ Status Redis::ZPopMin(const Slice& key, const int64_t count, std::vector<ScoreMe
       parsed_zsets_meta_value.ModifyCount(-del_cnt);
       batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
       s = db_->Write(default_write_options_, &batch);
+      if (rank_index) {
+        UpdateZSetRankIndex(key, rank_index, s, {}, removed_score_keys);
+      }
       UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
       return s;
     }
@@ -195,6 +211,9 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
   uint64_t version = 0;
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetRankIndex> rank_index;
+  std::vector<std::string> added_score_keys;
+  std::vector<std::string> removed_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
   BaseMetaKey base_meta_key(key);
@@ -218,6 +237,7 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
     } else {
       vaild = true;
       version = parsed_zsets_meta_value.Version();
+      rank_index = LookupZSetRankIndex(key, version);
     }
 
     int32_t cnt = 0;
@@ -239,6 +259,9 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
           } else {
             ZSetsScoreKey zsets_score_key(key, version, old_score, sm.member);
             batch.Delete(handles_[kZsetsScoreCF], zsets_score_key.Encode());
+            if (rank_index) {
+              removed_score_keys.push_back(zsets_score_key.Encode().ToString());
+            }
             // delete old zsets_score_key and overwirte zsets_member_key
             // but in different column_families so we accumulative 1
             statistic++;
@@ -256,6 +279,9 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
       ZSetsScoreKey zsets_score_key(key, version, sm.score, sm.member);
       BaseDataValue zsets_score_i_val(Slice{});
       batch.Put(handles_[kZsetsScoreCF], zsets_score_key.Encode(), zsets_score_i_val.Encode());
+      if (rank_index) {
+        added_score_keys.push_back(zsets_score_key.Encode().ToString());
+      }
       if (not_found) {
         cnt++;
       }
@@ -288,6 +314,9 @@ Status Redis::ZAdd(const Slice& key, const std::vector<ScoreMember>& score_membe
     return s;
   }
   s = db_->Write(default_write_options_, &batch);
+  if (rank_index) {
+    UpdateZSetRankIndex(key, rank_index, s, added_score_keys, removed_score_keys);
+  }
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -405,6 +434,9 @@ Status Redis::ZIncrby(const Slice& key, const Slice& member, double increment, d
   uint64_t version = 0;
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetRankIndex> rank_index;
+  std::vector<std::string> added_score_keys;
+  std::vector<std::string> removed_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
   BaseMetaKey base_meta_key(key);
@@ -425,6 +457,7 @@ Status Redis::ZIncrby(const Slice& key, const Slice& member, double increment, d
       version = parsed_zsets_meta_value.InitialMetaValue();
     } else {
       version = parsed_zsets_meta_value.Version();
+      rank_index = LookupZSetRankIndex(key, version);
     }
     std::string data_value;
     ZSetsMemberKey zsets_member_key(key, version, member);
@@ -438,6 +471,9 @@ Status Redis::ZIncrby(const Slice& key, const Slice& member, double increment, d
       score = old_score + increment;
       ZSetsScoreKey zsets_score_key(key, version, old_score, member);
       batch.Delete(handles_[kZsetsScoreCF], zsets_score_key.Encode());
+      if (rank_index) {
+        removed_score_keys.push_back(zsets_score_key.Encode().ToString());
+      }
       // delete old zsets_score_key and overwirte zsets_member_key
       // but in different column_families so we accumulative 1
       statistic++;
@@ -472,6 +508,10 @@ Status Redis::ZIncrby(const Slice& key, const Slice& member, double increment, d
   batch.Put(handles_[kZsetsScoreCF], zsets_score_key.Encode(), zsets_score_i_val.Encode());
   *ret = score;
   s = db_->Write(default_write_options_, &batch);
+  if (rank_index) {
+    added_score_keys.push_back(zsets_score_key.Encode().ToString());
+    UpdateZSetRankIndex(key, rank_index, s, added_score_keys, removed_score_keys);
+  }
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -514,6 +554,14 @@ Status Redis::ZRange(const Slice& key, int32_t start, int32_t stop, std::vector<
       if (start_index > stop_index || start_index >= count || stop_index < 0) {
         return s;
       }
+      // skipping less than a block costs no more than locating it
+      if (UseZSetRankIndex(count) && start_index >= kZSetRankIndexBlockSize) {
+        s = ZRangeByIndex(key, start, stop, false, score_members);
+        if (!s.IsNotSupported()) {
+          return s;
+        }
+        s = Status::OK();
+      }
       int32_t cur_index = 0;
       ScoreMember score_member;
       ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
@@ -710,6 +758,12 @@ Status Redis::ZRank(const Slice& key, const Slice& member, int32_t* rank) {
     } else if (parsed_zsets_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      if (UseZSetRankIndex(parsed_zsets_meta_value.Count())) {
+        s = ZRankByIndex(key, member, false, rank);
+        if (!s.IsNotSupported()) {
+          return s;
+        }
+      }
       bool found = false;
       uint64_t version = parsed_zsets_meta_value.Version();
       int32_t index = 0;
@@ -751,6 +805,8 @@ Status Redis::ZRem(const Slice& key, const std::vector<std::string>& members, in
 
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetRankIndex> rank_index;
+  std::vector<std::string> removed_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
   BaseMetaKey base_meta_key(key);
@@ -775,6 +831,7 @@ Status Redis::ZRem(const Slice& key, const std::vector<std::string>& members, in
       int32_t del_cnt = 0;
       std::string data_value;
       uint64_t version = parsed_zsets_meta_value.Version();
+      rank_index = LookupZSetRankIndex(key, version);
       for (const auto& member : filtered_members) {
         ZSetsMemberKey zsets_member_key(key, version, member);
         s = db_->Get(default_read_options_, handles_[kZsetsDataCF], zsets_member_key.Encode(), &data_value);
@@ -790,6 +847,9 @@ Status Redis::ZRem(const Slice& key, const std::vector<std::string>& members, in
 
           ZSetsScoreKey zsets_score_key(key, version, score, member);
           batch.Delete(handles_[kZsetsScoreCF], zsets_score_key.Encode());
+          if (rank_index) {
+            removed_score_keys.push_back(zsets_score_key.Encode().ToString());
+          }
         } else if (!s.IsNotFound()) {
           return s;
         }
@@ -805,6 +865,9 @@ Status Redis::ZRem(const Slice& key, const std::vector<std::string>& members, in
     return s;
   }
   s = db_->Write(default_write_options_, &batch);
+  if (rank_index) {
+    UpdateZSetRankIndex(key, rank_index, s, {}, removed_score_keys);
+  }
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -814,6 +877,8 @@ Status Redis::ZRemrangebyrank(const Slice& key, int32_t start, int32_t stop, int
   uint32_t statistic = 0;
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetRankIndex> rank_index;
+  std::vector<std::string> removed_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
   BaseMetaKey base_meta_key(key);
@@ -849,13 +914,24 @@ Status Redis::ZRemrangebyrank(const Slice& key, int32_t start, int32_t stop, int
       }
       ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
+      rank_index = UseZSetRankIndex(count) ? GetZSetRankIndex(key, version, count)
+                                           : LookupZSetRankIndex(key, version);
       rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
-      for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
+      if (rank_index) {
+        SeekZSetRank(iter, key, version, rank_index, start_index);
+        cur_index = start_index;
+      } else {
+        iter->Seek(zsets_score_key.Encode());
+      }
+      for (; iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
         if (cur_index >= start_index) {
           ParsedZSetsScoreKey parsed_zsets_score_key(iter->key());
           ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member());
           batch.Delete(handles_[kZsetsDataCF], zsets_member_key.Encode());
           batch.Delete(handles_[kZsetsScoreCF], iter->key());
+          if (rank_index) {
+            removed_score_keys.push_back(iter->key().ToString());
+          }
           del_cnt++;
           statistic++;
         }
@@ -872,6 +948,9 @@ Status Redis::ZRemrangebyrank(const Slice& key, int32_t start, int32_t stop, int
     return s;
   }
   s = db_->Write(default_write_options_, &batch);
+  if (rank_index) {
+    UpdateZSetRankIndex(key, rank_index, s, {}, removed_score_keys);
+  }
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -882,6 +961,8 @@ Status Redis::ZRemrangebyscore(const Slice& key, double min, double max, bool le
   uint32_t statistic = 0;
   std::string meta_value;
   rocksdb::WriteBatch batch;
+  std::shared_ptr<ZSetRankIndex> rank_index;
+  std::vector<std::string> removed_score_keys;
   ScopeRecordLock l(lock_mgr_, key);
 
   BaseMetaKey base_meta_key(key);
@@ -910,6 +991,7 @@ Status Redis::ZRemrangebyscore(const Slice& key, double min, double max, bool le
       uint64_t version = parsed_zsets_meta_value.Version();
       ZSetsScoreKey zsets_score_key(key, version, min, Slice());
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
+      rank_index = LookupZSetRankIndex(key, version);
       rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
       for (iter->Seek(zsets_score_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
         bool left_pass = false;
@@ -933,6 +1015,9 @@ Status Redis::ZRemrangebyscore(const Slice& key, double min, double max, bool le
           ZSetsMemberKey zsets_member_key(key, version, parsed_zsets_score_key.member());
           batch.Delete(handles_[kZsetsDataCF], zsets_member_key.Encode());
           batch.Delete(handles_[kZsetsScoreCF], iter->key());
+          if (rank_index) {
+            removed_score_keys.push_back(iter->key().ToString());
+          }
           del_cnt++;
           statistic++;
         }
@@ -952,6 +1037,9 @@ Status Redis::ZRemrangebyscore(const Slice& key, double min, double max, bool le
     return s;
   }
   s = db_->Write(default_write_options_, &batch);
+  if (rank_index) {
+    UpdateZSetRankIndex(key, rank_index, s, {}, removed_score_keys);
+  }
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -994,6 +1082,13 @@ Status Redis::ZRevrange(const Slice& key, int32_t start, int32_t stop, std::vect
       if (start_index > stop_index || start_index >= count || stop_index < 0) {
         return s;
       }
+      if (UseZSetRankIndex(count) && count - 1 - stop_index >= kZSetRankIndexBlockSize) {
+        s = ZRangeByIndex(key, start, stop, true, score_members);
+        if (!s.IsNotSupported()) {
+          return s;
+        }
+        s = Status::OK();
+      }
       int32_t cur_index = count - 1;
       ScoreMember score_member;
       ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::max(), Slice());
@@ -1120,6 +1215,12 @@ Status Redis::ZRevrank(const Slice& key, const Slice& member, int32_t* rank) {
     } else if (parsed_zsets_meta_value.Count() == 0) {
       return Status::NotFound();
     } else {
+      if (UseZSetRankIndex(parsed_zsets_meta_value.Count())) {
+        s = ZRankByIndex(key, member, true, rank);
+        if (!s.IsNotSupported()) {
+          return s;
+        }
+      }
       bool found = false;
       int32_t rev_index = 0;
       int32_t left = parsed_zsets_meta_value.Count();
@@ -1600,6 +1701,8 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
 
   int32_t del_cnt = 0;
   std::string meta_value;
+  std::shared_ptr<ZSetRankIndex> rank_index;
+  std::vector<std::string> removed_score_keys;
 
   BaseMetaKey base_meta_key(key);
   Status s = db_->Get(read_options, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
@@ -1623,6 +1726,7 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
       int32_t stop_index = parsed_zsets_meta_value.Count() - 1;
       ZSetsMemberKey zsets_member_key(key, version, Slice());
       KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
+      rank_index = LookupZSetRankIndex(key, version);
       rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsDataCF]);
       for (iter->Seek(zsets_member_key.Encode()); iter->Valid() && cur_index <= stop_index; iter->Next(), ++cur_index) {
         bool left_pass = false;
@@ -1644,6 +1748,9 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
           double score = *reinterpret_cast<const double*>(ptr_tmp);
           ZSetsScoreKey zsets_score_key(key, version, score, member);
           batch.Delete(handles_[kZsetsScoreCF], zsets_score_key.Encode());
+          if (rank_index) {
+            removed_score_keys.push_back(zsets_score_key.Encode().ToString());
+          }
           del_cnt++;
           statistic++;
         }
@@ -1665,6 +1772,9 @@ Status Redis::ZRemrangebylex(const Slice& key, const Slice& min, const Slice& ma
     return s;
   }
   s = db_->Write(default_write_options_, &batch);
+  if (rank_index) {
+    UpdateZSetRankIndex(key, rank_index, s, {}, removed_score_keys);
+  }
   UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
   return s;
 }
@@ -1737,9 +1847,16 @@ Status Redis::ZsetsDel(const Slice& key, std::string&& prefetch_meta) {
       return Status::NotFound();
     } else {
       uint32_t statistic = parsed_zsets_meta_value.Count();
+      rocksdb::WriteBatch batch;
+      bool range_deleted =
+          DeleteDataKeysRange(DataType::kZSets, key, parsed_zsets_meta_value.Version(), statistic, &batch);
       parsed_zsets_meta_value.InitialMetaValue();
-      s = db_->Put(default_write_options_, handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      batch.Put(handles_[kMetaCF], base_meta_key.Encode(), meta_value);
+      s = db_->Write(default_write_options_, &batch);
       UpdateSpecificKeyStatistics(DataType::kZSets, key.ToString(), statistic);
+      if (s.ok() && range_deleted) {
+        storage_->AddBGTask({DataType::kZSets, kCompactRange, {key.ToString()}});
+      }
     }
   }
   return s;
@@ -2010,4 +2127,253 @@ void Redis::ScanZsets() {
   delete score_iter;
 }
 
+bool Redis::UseZSetRankIndex(int32_t count) const {
+  uint64_t min_members = zset_rank_index_min_members_.load();
+  return min_members != 0 && static_cast<uint64_t>(count) >= min_members;
+}
+
+std::shared_ptr<ZSetRankIndex> Redis::LookupZSetRankIndex(const Slice& key, uint64_t version) {
+  if (zset_rank_index_min_members_.load() == 0) {
+    return nullptr;
+  }
+  std::shared_ptr<ZSetRankIndex> rank_index;
+  if (!zset_rank_index_store_->Lookup(key.ToString(), &rank_index).ok()) {
+    return nullptr;
+  }
+  if (rank_index->version() != version) {
+    // the zset was deleted or recreated since
+    zset_rank_index_store_->Remove(key.ToString());
+    return nullptr;
+  }
+  return rank_index;
+}
+
+std::shared_ptr<ZSetRankIndex> Redis::GetZSetRankIndex(const Slice& key, uint64_t version, int32_t count) {
+  std::shared_ptr<ZSetRankIndex> rank_index = LookupZSetRankIndex(key, version);
+  if (rank_index && rank_index->count() == count) {
+    return rank_index;
+  }
+
+  // Existing zsets are indexed by their first rank query, with one scan
+  rank_index = std::make_shared<ZSetRankIndex>(version, handles_[kZsetsScoreCF]->GetComparator());
+  ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
+  Slice seek_key = zsets_score_key.Encode();
+  Slice prefix(seek_key.data(), seek_key.size() - kScoreLength - kSuffixReserveLength);
+  rocksdb::ReadOptions read_options;
+  read_options.fill_cache = false;
+  rocksdb::Iterator* iter = db_->NewIterator(read_options, handles_[kZsetsScoreCF]);
+  int32_t cur_index = 0;
+  for (iter->Seek(seek_key); iter->Valid() && cur_index < count && iter->key().starts_with(prefix);
+       iter->Next(), ++cur_index) {
+    rank_index->Append(iter->key());
+  }
+  delete iter;
+  rank_index->FinishBuild();
+  if (rank_index->count() != count) {
+    LOG(WARNING) << "zset " << key.ToString() << " has " << rank_index->count() << " score keys, expect " << count
+                 << ", skip the rank index";
+    zset_rank_index_store_->Remove(key.ToString());
+    return nullptr;
+  }
+  zset_rank_index_store_->Insert(key.ToString(), rank_index, rank_index->block_num() + 1);
+  if (zset_rank_index_min_members_.load() == 0) {
+    // disabled meanwhile, writes stop keeping the index up to date
+    zset_rank_index_store_->Remove(key.ToString());
+  }
+  return rank_index;
+}
+
+void Redis::UpdateZSetRankIndex(const Slice& key, const std::shared_ptr<ZSetRankIndex>& rank_index, const Status& s,
+                                const std::vector<std::string>& added, const std::vector<std::string>& removed) {
+  if (!s.ok() || added.size() + removed.size() > kZSetRankIndexMaxUpdate) {
+    zset_rank_index_store_->Remove(key.ToString());
+    return;
+  }
+  for (const auto& score_key : removed) {
+    rank_index->Erase(score_key);
+  }
+  for (const auto& score_key : added) {
+    rank_index->Insert(score_key);
+  }
+
+  size_t block = 0;
+  std::string block_start;
+  int64_t block_count = 0;
+  while (rank_index->OversizedBlock(&block, &block_start, &block_count)) {
+    std::vector<std::string> starts;
+    int64_t offset = 0;
+    rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
+    if (block_start.empty()) {
+      ZSetsScoreKey zsets_score_key(key, rank_index->version(), std::numeric_limits<double>::lowest(), Slice());
+      iter->Seek(zsets_score_key.Encode());
+    } else {
+      iter->Seek(block_start);
+    }
+    for (; iter->Valid() && offset < block_count; iter->Next(), ++offset) {
+      if (offset != 0 && offset % kZSetRankIndexBlockSize == 0) {
+        starts.push_back(iter->key().ToString());
+      }
+    }
+    delete iter;
+    if (offset != block_count) {
+      zset_rank_index_store_->Remove(key.ToString());
+      return;
+    }
+    rank_index->SplitBlock(block, starts);
+  }
+}
+
+void Redis::SeekZSetRank(rocksdb::Iterator* iter, const Slice& key, uint64_t version,
+                         const std::shared_ptr<ZSetRankIndex>& rank_index, int64_t rank) {
+  int64_t cur_rank = 0;
+  std::string block_start;
+  rank_index->LocateRank(rank, &cur_rank, &block_start);
+  if (block_start.empty()) {
+    ZSetsScoreKey zsets_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
+    iter->Seek(zsets_score_key.Encode());
+  } else {
+    iter->Seek(block_start);
+  }
+  for (; iter->Valid() && cur_rank < rank; iter->Next()) {
+    ++cur_rank;
+  }
+}
+
+Status Redis::ZRankByIndex(const Slice& key, const Slice& member, bool reverse, int32_t* rank) {
+  *rank = -1;
+  std::string meta_value;
+  // the index follows the writes of the zset, read both under its lock
+  ScopeRecordLock l(lock_mgr_, key);
+
+  BaseMetaKey base_meta_key(key);
+  Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
+  if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
+    if (ExpectedStale(meta_value)) {
+      s = Status::NotFound();
+    } else {
+      return Status::InvalidArgument(
+        "WRONGTYPE, key: " + key.ToString() + ", expected type: " +
+        DataTypeStrings[static_cast<int>(DataType::kZSets)] + ", got type: " +
+        DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
+    }
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  ParsedZSetsMetaValue parsed_zsets_meta_value(&meta_value);
+  if (parsed_zsets_meta_value.IsStale()) {
+    return Status::NotFound("Stale");
+  } else if (parsed_zsets_meta_value.Count() == 0) {
+    return Status::NotFound();
+  }
+
+  int32_t count = parsed_zsets_meta_value.Count();
+  uint64_t version = parsed_zsets_meta_value.Version();
+  std::string data_value;
+  ZSetsMemberKey zsets_member_key(key, version, member);
+  s = db_->Get(default_read_options_, handles_[kZsetsDataCF], zsets_member_key.Encode(), &data_value);
+  if (!s.ok()) {
+    return s;
+  }
+  ParsedBaseDataValue parsed_value(&data_value);
+  parsed_value.StripSuffix();
+  uint64_t tmp = DecodeFixed64(data_value.data());
+  const void* ptr_tmp = reinterpret_cast<const void*>(&tmp);
+  double score = *reinterpret_cast<const double*>(ptr_tmp);
+
+  KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
+  std::shared_ptr<ZSetRankIndex> rank_index = GetZSetRankIndex(key, version, count);
+  if (!rank_index) {
+    return Status::NotSupported("no rank index");
+  }
+  ZSetsScoreKey zsets_score_key(key, version, score, member);
+  Slice target = zsets_score_key.Encode();
+  int64_t index = 0;
+  std::string block_start;
+  rank_index->Locate(target, &index, &block_start);
+
+  const rocksdb::Comparator* comparator = handles_[kZsetsScoreCF]->GetComparator();
+  rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
+  if (block_start.empty()) {
+    ZSetsScoreKey first_score_key(key, version, std::numeric_limits<double>::lowest(), Slice());
+    iter->Seek(first_score_key.Encode());
+  } else {
+    iter->Seek(block_start);
+  }
+  for (; iter->Valid() && comparator->Compare(iter->key(), target) < 0; iter->Next()) {
+    ++index;
+  }
+  delete iter;
+  *rank = static_cast<int32_t>(reverse ? count - 1 - index : index);
+  return Status::OK();
+}
+
+Status Redis::ZRangeByIndex(const Slice& key, int32_t start, int32_t stop, bool reverse,
+                            std::vector<ScoreMember>* score_members) {
+  score_members->clear();
+  std::string meta_value;
+  // the index follows the writes of the zset, read both under its lock
+  ScopeRecordLock l(lock_mgr_, key);
+
+  BaseMetaKey base_meta_key(key);
+  Status s = db_->Get(default_read_options_, handles_[kMetaCF], base_meta_key.Encode(), &meta_value);
+  if (s.ok() && !ExpectedMetaValue(DataType::kZSets, meta_value)) {
+    if (ExpectedStale(meta_value)) {
+      s = Status::NotFound();
+    } else {
+      return Status::InvalidArgument(
+        "WRONGTYPE, key: " + key.ToString() + ", expected type: " +
+        DataTypeStrings[static_cast<int>(DataType::kZSets)] + ", got type: " +
+        DataTypeStrings[static_cast<int>(GetMetaValueType(meta_value))]);
+    }
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  ParsedZSetsMetaValue parsed_zsets_meta_value(&meta_value);
+  if (parsed_zsets_meta_value.IsStale()) {
+    return Status::NotFound("Stale");
+  } else if (parsed_zsets_meta_value.Count() == 0) {
+    return Status::NotFound();
+  }
+
+  int32_t count = parsed_zsets_meta_value.Count();
+  uint64_t version = parsed_zsets_meta_value.Version();
+  int32_t start_index = 0;
+  int32_t stop_index = 0;
+  if (reverse) {
+    start_index = stop >= 0 ? count - stop - 1 : -stop - 1;
+    stop_index = start >= 0 ? count - start - 1 : -start - 1;
+  } else {
+    start_index = start >= 0 ? start : count + start;
+    stop_index = stop >= 0 ? stop : count + stop;
+  }
+  start_index = start_index <= 0 ? 0 : start_index;
+  stop_index = stop_index >= count ? count - 1 : stop_index;
+  if (start_index > stop_index || start_index >= count || stop_index < 0) {
+    return s;
+  }
+
+  KeyStatisticsDurationGuard guard(this, DataType::kZSets, key.ToString());
+  std::shared_ptr<ZSetRankIndex> rank_index = GetZSetRankIndex(key, version, count);
+  if (!rank_index) {
+    return Status::NotSupported("no rank index");
+  }
+  int32_t cur_index = start_index;
+  ScoreMember score_member;
+  rocksdb::Iterator* iter = db_->NewIterator(default_read_options_, handles_[kZsetsScoreCF]);
+  for (SeekZSetRank(iter, key, version, rank_index, start_index); iter->Valid() && cur_index <= stop_index;
+       iter->Next(), ++cur_index) {
+    ParsedZSetsScoreKey parsed_zsets_score_key(iter->key());
+    score_member.score = parsed_zsets_score_key.score();
+    score_member.member = parsed_zsets_score_key.member().ToString();
+    score_members->push_back(score_member);
+  }
+  delete iter;
+  if (reverse) {
+    std::reverse(score_members->begin(), score_members->end());
+  }
+  return s;
+}
+
 }  // namespace storage
@@ -5,6 +5,7 @@
 
 #include <utility>
 #include <algorithm>
+#include <numeric>
 
 #include <glog/logging.h>
 
@@ -17,10 +18,14 @@
 #include "src/redis_hyperloglog.h"
 #include "src/type_iterator.h"
 #include "src/redis.h"
+#include "src/instance_executor.h"
 #include "include/pika_conf.h"
 #include "pstd/include/pika_codis_slot.h"
 
 namespace storage {
+// Full scans always go through the fan-out when it is enabled
+constexpr size_t kFanoutFullScanBatch = std::numeric_limits<size_t>::max();
+
 extern std::string BitOpOperate(BitOpType op, const std::vector<std::string>& src_values, int64_t max_len);
 class Redis;
 Status StorageOptions::ResetOptions(const OptionType& option_type,
@@ -75,6 +80,7 @@ Storage::~Storage() {
     if ((ret = pthread_join(bg_tasks_thread_id_, nullptr)) != 0) {
       LOG(ERROR) << "pthread_join failed with bgtask thread error " << ret;
     }
+    instance_executor_.reset();
     for (auto& inst : insts_) {
       inst.reset();
     }
@@ -109,6 +115,11 @@ Status Storage::Open(const StorageOptions& storage_options, const std::string& d
     }
   }
 
+  multi_key_fanout_min_batch_ = storage_options.multi_key_fanout_min_batch;
+  if (inst_count > 1) {
+    instance_executor_ = std::make_unique<InstanceExecutor>(inst_count);
+  }
+
   is_opened_.store(true);
   return Status::OK();
 }
@@ -182,31 +193,112 @@ Status Storage::GetBit(const Slice& key, int64_t offset, int32_t* ret) {
 }
 
 Status Storage::MSet(const std::vector<KeyValue>& kvs) {
-  Status s;
+  std::vector<std::vector<KeyValue>> inst_kvs(insts_.size());
+  std::vector<size_t> inst_indexes;
   for (const auto& kv : kvs) {
-    auto& inst = GetDBInstance(kv.key);
-    s = inst->Set(Slice(kv.key), Slice(kv.value));
-    if (!s.ok()) {
-      return s;
+    auto inst_index = slot_indexer_->GetInstanceID(GetSlotID(slot_num_, kv.key));
+    if (inst_kvs[inst_index].empty()) {
+      inst_indexes.push_back(inst_index);
     }
+    inst_kvs[inst_index].push_back(kv);
   }
-  return s;
+
+  std::vector<Status> inst_status(insts_.size());
+  RunOnInstances(inst_indexes, kvs.size(), [&](size_t index) {
+    inst_status[index] = insts_[index]->MSet(inst_kvs[index]);
+  });
+  for (size_t index : inst_indexes) {
+    if (!inst_status[index].ok()) {
+      return inst_status[index];
+    }
+  }
+  return Status::OK();
+}
+
+std::vector<size_t> Storage::GroupKeysByInstance(const std::vector<std::string>& keys,
+                                                 std::vector<std::vector<size_t>>* inst_key_indexes) {
+  std::vector<size_t> inst_indexes;
+  inst_key_indexes->assign(insts_.size(), {});
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto inst_index = slot_indexer_->GetInstanceID(GetSlotID(slot_num_, keys[i]));
+    if ((*inst_key_indexes)[inst_index].empty()) {
+      inst_indexes.push_back(inst_index);
+    }
+    (*inst_key_indexes)[inst_index].push_back(i);
+  }
+  return inst_indexes;
+}
+
+void Storage::RunOnInstances(const std::vector<size_t>& inst_indexes, size_t batch_size,
+                             const std::function<void(size_t)>& task) {
+  size_t min_batch = multi_key_fanout_min_batch_.load(std::memory_order_relaxed);
+  if (!instance_executor_ || inst_indexes.size() < 2 || min_batch == 0 || batch_size < min_batch) {
+    for (size_t index : inst_indexes) {
+      task(index);
+    }
+    return;
+  }
+  instance_executor_->Run(inst_indexes, task);
+}
+
+Status Storage::SetsCards(const std::vector<std::string>& keys, std::vector<int32_t>* cards) {
+  cards->assign(keys.size(), 0);
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(keys, &inst_key_indexes);
+  std::vector<Status> inst_status(insts_.size());
+  RunOnInstances(inst_indexes, keys.size(), [&](size_t index) {
+    for (size_t key_index : inst_key_indexes[index]) {
+      Status ss = insts_[index]->SCard(keys[key_index], &(*cards)[key_index]);
+      if (!ss.ok() && !ss.IsNotFound()) {
+        inst_status[index] = ss;
+        return;
+      }
+    }
+  });
+  for (size_t index : inst_indexes) {
+    if (!inst_status[index].ok()) {
+      return inst_status[index];
+    }
+  }
+  return Status::OK();
+}
+
+Status Storage::SetsMembers(const std::vector<std::string>& keys, std::vector<std::vector<std::string>>* key_members) {
+  key_members->assign(keys.size(), {});
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(keys, &inst_key_indexes);
+  std::vector<Status> inst_status(insts_.size());
+  RunOnInstances(inst_indexes, keys.size(), [&](size_t index) {
+    for (size_t key_index : inst_key_indexes[index]) {
+      Status ss = insts_[index]->SMembers(keys[key_index], &(*key_members)[key_index]);
+      if (!ss.ok() && !ss.IsNotFound()) {
+        inst_status[index] = ss;
+        return;
+      }
+    }
+  });
+  for (size_t index : inst_indexes) {
+    if (!inst_status[index].ok()) {
+      return inst_status[index];
+    }
+  }
+  return Status::OK();
 }
 
 Status Storage::MGet(const std::vector<std::string>& keys, std::vector<ValueStatus>* vss) {
   vss->clear();
-  Status s;
-  for(const auto& key : keys) {
-    auto& inst = GetDBInstance(key);
-    std::string value;
-    s = inst->MGet(key, &value);
-    if (s.ok()) {
-      vss->push_back({value, Status::OK()});
-    } else if (s.IsNotFound()) {
-      vss->push_back({std::string(), Status::NotFound()});
-    } else {
+  vss->resize(keys.size());
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(keys, &inst_key_indexes);
+
+  std::vector<Status> inst_status(insts_.size());
+  RunOnInstances(inst_indexes, keys.size(), [&](size_t index) {
+    inst_status[index] = insts_[index]->MGet(keys, inst_key_indexes[index], vss);
+  });
+  for (size_t index : inst_indexes) {
+    if (!inst_status[index].ok()) {
       vss->clear();
-      return s;
+      return inst_status[index];
     }
   }
   return Status::OK();
@@ -214,19 +306,18 @@ Status Storage::MGet(const std::vector<std::string>& keys, std::vector<ValueStat
 
 Status Storage::MGetWithTTL(const std::vector<std::string>& keys, std::vector<ValueStatus>* vss) {
   vss->clear();
-  Status s;
-  for(const auto& key : keys) {
-    auto& inst = GetDBInstance(key);
-    std::string value;
-    int64_t ttl_millsec;
-    s = inst->MGetWithTTL(key, &value, &ttl_millsec);
-    if (s.ok()) {
-      vss->push_back({value, Status::OK(), ttl_millsec});
-    } else if (s.IsNotFound()) {
-      vss->push_back({std::string(), Status::NotFound(), ttl_millsec});
-    } else {
+  vss->resize(keys.size());
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(keys, &inst_key_indexes);
+
+  std::vector<Status> inst_status(insts_.size());
+  RunOnInstances(inst_indexes, keys.size(), [&](size_t index) {
+    inst_status[index] = insts_[index]->MGetWithTTL(keys, inst_key_indexes[index], vss);
+  });
+  for (size_t index : inst_indexes) {
+    if (!inst_status[index].ok()) {
       vss->clear();
-      return s;
+      return inst_status[index];
     }
   }
   return Status::OK();
@@ -508,6 +599,36 @@ Status Storage::SDiff(const std::vector<std::string>& keys, std::vector<std::str
     return s;
   }
 
+  std::vector<int32_t> cards;
+  s = SetsCards(keys, &cards);
+  if (!s.ok()) {
+    return s;
+  }
+  int64_t others_total = 0;
+  for (size_t i = 1; i < cards.size(); ++i) {
+    others_total += cards[i];
+  }
+  if (cards[0] == 0) {
+    return Status::OK();
+  }
+  // walk the other sets too when keys[0] is not much smaller than them
+  if (Redis::UseSetsMergeJoin(static_cast<int64_t>(cards[0]) * static_cast<int64_t>(keys.size() - 1),
+                              cards[0] + others_total)) {
+    std::vector<std::vector<std::string>> key_members;
+    s = SetsMembers(keys, &key_members);
+    if (!s.ok()) {
+      return s;
+    }
+    *members = std::move(key_members[0]);
+    for (size_t i = 1; i < key_members.size() && !members->empty(); ++i) {
+      std::vector<std::string> diff;
+      std::set_difference(members->begin(), members->end(), key_members[i].begin(), key_members[i].end(),
+                          std::back_inserter(diff));
+      members->swap(diff);
+    }
+    return Status::OK();
+  }
+
   auto& inst = GetDBInstance(keys[0]);
   std::vector<std::string> keys0_members;
   s = inst->SMembers(Slice(keys[0]), &keys0_members);
@@ -515,19 +636,41 @@ Status Storage::SDiff(const std::vector<std::string>& keys, std::vector<std::str
     return s;
   }
 
-  for (const auto& member : keys0_members) {
-    int32_t exist = 0;
-    for (int idx = 1; idx < keys.size(); idx++) {
-      Slice pkey = Slice(keys[idx]);
-      auto& inst = GetDBInstance(pkey);
-      s = inst->SIsmember(pkey, Slice(member), &exist);
-      if (!s.ok() && !s.IsNotFound()) {
-        return s;
+  // every instance marks the members of keys[0] found in one of its sets
+  std::vector<std::string> other_keys(keys.begin() + 1, keys.end());
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(other_keys, &inst_key_indexes);
+  std::vector<std::vector<char>> inst_found(insts_.size());
+  std::vector<Status> inst_status(insts_.size());
+  RunOnInstances(inst_indexes, keys0_members.size() * other_keys.size(), [&](size_t index) {
+    std::vector<char>& found = inst_found[index];
+    found.assign(keys0_members.size(), 0);
+    for (size_t i = 0; i < keys0_members.size(); ++i) {
+      for (size_t key_index : inst_key_indexes[index]) {
+        int32_t exist = 0;
+        Status ss = insts_[index]->SIsmember(other_keys[key_index], keys0_members[i], &exist);
+        if (!ss.ok() && !ss.IsNotFound()) {
+          inst_status[index] = ss;
+          return;
+        }
+        if (exist) {
+          found[i] = 1;
+          break;
+        }
       }
-      if (exist) break;
     }
+  });
+  for (size_t index : inst_indexes) {
+    if (!inst_status[index].ok()) {
+      return inst_status[index];
+    }
+  }
+
+  for (size_t i = 0; i < keys0_members.size(); ++i) {
+    bool exist = std::any_of(inst_indexes.begin(), inst_indexes.end(),
+                             [&](size_t index) { return inst_found[index][i] != 0; });
     if (!exist) {
-      members->push_back(member);
+      members->push_back(keys0_members[i]);
     }
   }
   return Status::OK();
@@ -569,9 +712,41 @@ Status Storage::SInter(const std::vector<std::string>& keys, std::vector<std::st
     return s;
   }
 
-  std::vector<std::string> key0_members;
-  auto& inst = GetDBInstance(keys[0]);
-  s = inst->SMembers(keys[0], &key0_members);
+  std::vector<int32_t> cards;
+  s = SetsCards(keys, &cards);
+  if (!s.ok()) {
+    return s;
+  }
+  // check the members of the smallest set against the others,
+  // or walk all of them when the smallest is not much smaller
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&cards](size_t a, size_t b) { return cards[a] < cards[b]; });
+  int64_t total = std::accumulate(cards.begin(), cards.end(), static_cast<int64_t>(0));
+  if (cards[order[0]] == 0) {
+    return Status::OK();
+  }
+  if (Redis::UseSetsMergeJoin(static_cast<int64_t>(cards[order[0]]) * static_cast<int64_t>(keys.size() - 1),
+                              total)) {
+    std::vector<std::vector<std::string>> key_members;
+    s = SetsMembers(keys, &key_members);
+    if (!s.ok()) {
+      return s;
+    }
+    *members = std::move(key_members[order[0]]);
+    for (size_t i = 1; i < order.size() && !members->empty(); ++i) {
+      const std::vector<std::string>& other = key_members[order[i]];
+      std::vector<std::string> inter;
+      std::set_intersection(members->begin(), members->end(), other.begin(), other.end(),
+                            std::back_inserter(inter));
+      members->swap(inter);
+    }
+    return Status::OK();
+  }
+
+  std::vector<std::string> smallest_members;
+  auto& inst = GetDBInstance(keys[order[0]]);
+  s = inst->SMembers(keys[order[0]], &smallest_members);
   if (s.IsNotFound()) {
     return Status::OK();
   }
@@ -579,22 +754,44 @@ Status Storage::SInter(const std::vector<std::string>& keys, std::vector<std::st
     return s;
   }
 
-  for (const auto member : key0_members) {
-    int32_t exist = 1;
-    for (int idx = 1; idx < keys.size(); idx++) {
-      Slice pkey(keys[idx]);
-      auto& inst = GetDBInstance(keys[idx]);
-      s = inst->SIsmember(keys[idx], member, &exist);
-      if (s.ok() && exist > 0) {
-        continue;
-      } else if (!s.IsNotFound()) {
-        return s;
-      } else {
+  // every instance marks the members of the smallest set missing from one of its sets
+  std::vector<std::string> other_keys;
+  for (size_t i = 1; i < order.size(); ++i) {
+    other_keys.push_back(keys[order[i]]);
+  }
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(other_keys, &inst_key_indexes);
+  std::vector<std::vector<char>> inst_missing(insts_.size());
+  std::vector<Status> inst_status(insts_.size());
+  RunOnInstances(inst_indexes, smallest_members.size() * other_keys.size(), [&](size_t index) {
+    std::vector<char>& missing = inst_missing[index];
+    missing.assign(smallest_members.size(), 0);
+    for (size_t i = 0; i < smallest_members.size(); ++i) {
+      for (size_t key_index : inst_key_indexes[index]) {
+        int32_t exist = 0;
+        Status ss = insts_[index]->SIsmember(other_keys[key_index], smallest_members[i], &exist);
+        if (ss.ok() && exist > 0) {
+          continue;
+        } else if (!ss.IsNotFound()) {
+          inst_status[index] = ss;
+          return;
+        }
+        missing[i] = 1;
         break;
       }
     }
-    if (exist > 0) {
-      members->push_back(member);
+  });
+  for (size_t index : inst_indexes) {
+    if (!inst_status[index].ok()) {
+      return inst_status[index];
+    }
+  }
+
+  for (size_t i = 0; i < smallest_members.size(); ++i) {
+    bool missing = std::any_of(inst_indexes.begin(), inst_indexes.end(),
+                               [&](size_t index) { return inst_missing[index][i] != 0; });
+    if (!missing) {
+      members->push_back(smallest_members[i]);
     }
   }
   return Status::OK();
@@ -693,25 +890,18 @@ Status Storage::SUnion(const std::vector<std::string>& keys, std::vector<std::st
     return inst->SUnion(keys, members);
   }
 
-  using Iter = std::vector<std::string>::iterator;
-  using Uset = std::unordered_set<std::string>;
-  Uset member_set;
-  for (const auto& key : keys) {
-    std::vector<std::string> vec;
-    auto& inst = GetDBInstance(key);
-    s = inst->SMembers(key, &vec);
-    if (s.IsNotFound()) {
-      continue;
-    }
-    if (!s.ok()) {
-      return s;
-    }
-    std::copy(std::move_iterator<Iter>(vec.begin()),
-              std::move_iterator<Iter>(vec.end()),
-              std::insert_iterator<Uset>(member_set, member_set.begin()));
+  std::vector<std::vector<std::string>> key_members;
+  s = SetsMembers(keys, &key_members);
+  if (!s.ok()) {
+    return s;
+  }
+  // the members of every set come sorted, merge them in order
+  for (const auto& set_members : key_members) {
+    std::vector<std::string> merged;
+    std::set_union(members->begin(), members->end(), set_members.begin(), set_members.end(),
+                   std::back_inserter(merged));
+    members->swap(merged);
   }
-
-  std::copy(member_set.begin(), member_set.end(), std::back_inserter(*members));
   return Status::OK();
 }
 
@@ -982,15 +1172,28 @@ Status Storage::ZUnionstore(const Slice& destination, const std::vector<std::str
     return s;
   }
 
-  for (int idx = 0; idx < keys.size(); idx++) {
-    Slice key = Slice(keys[idx]);
-    auto& inst = GetDBInstance(key);
-    std::map<std::string, double> member_to_score;
-    double weight = idx >= weights.size() ? 1 : weights[idx];
-    s = inst->ZGetAll(key, weight, &member_to_score);
-    if (!s.ok() && !s.IsNotFound()) {
-      return s;
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(keys, &inst_key_indexes);
+  std::vector<std::map<std::string, double>> key_member_to_score(keys.size());
+  std::vector<Status> inst_status(insts_.size());
+  RunOnInstances(inst_indexes, keys.size(), [&](size_t index) {
+    for (size_t key_index : inst_key_indexes[index]) {
+      double weight = key_index >= weights.size() ? 1 : weights[key_index];
+      Status ss = insts_[index]->ZGetAll(keys[key_index], weight, &key_member_to_score[key_index]);
+      if (!ss.ok() && !ss.IsNotFound()) {
+        inst_status[index] = ss;
+        return;
+      }
     }
+  });
+  for (size_t index : inst_indexes) {
+    if (!inst_status[index].ok()) {
+      return inst_status[index];
+    }
+  }
+
+  // aggregate in the order of keys, as the serial version did
+  for (const auto& member_to_score : key_member_to_score) {
     for (const auto& key_score : member_to_score) {
       const std::string& member = key_score.first;
       double score = key_score.second;
@@ -1193,29 +1396,41 @@ int32_t Storage::Expire(const Slice& key, int64_t ttl_millsec) {
 
 
 int64_t Storage::Del(const std::vector<std::string>& keys) {
-  Status s;
-  int64_t count = 0;
-  for (const auto& key : keys) {
-    auto& inst = GetDBInstance(key);
-    s = inst->Del(key);
-    if (s.ok()) {
-      count++;
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(keys, &inst_key_indexes);
+  std::vector<int64_t> inst_count(insts_.size(), 0);
+  RunOnInstances(inst_indexes, keys.size(), [&](size_t index) {
+    for (size_t key_index : inst_key_indexes[index]) {
+      Status s = insts_[index]->Del(keys[key_index]);
+      if (s.ok()) {
+        inst_count[index]++;
+      }
     }
-  }
-  return count;
+  });
+  return std::accumulate(inst_count.begin(), inst_count.end(), int64_t{0});
 }
 
 int64_t Storage::Exists(const std::vector<std::string>& keys) {
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(keys, &inst_key_indexes);
+  std::vector<int64_t> inst_count(insts_.size(), 0);
+  RunOnInstances(inst_indexes, keys.size(), [&](size_t index) {
+    for (size_t key_index : inst_key_indexes[index]) {
+      Status s = insts_[index]->Exists(keys[key_index]);
+      if (s.ok()) {
+        inst_count[index]++;
+      } else if (!s.IsNotFound()) {
+        inst_count[index] = -1;
+        return;
+      }
+    }
+  });
   int64_t count = 0;
-  Status s;
-  for (const auto& key : keys) {
-    auto& inst = GetDBInstance(key);
-    s = inst->Exists(key);
-    if (s.ok()) {
-      count++;
-    } else if (!s.IsNotFound()) {
+  for (size_t index : inst_indexes) {
+    if (inst_count[index] < 0) {
       return -1;
     }
+    count += inst_count[index];
   }
   return count;
 }
@@ -1515,25 +1730,34 @@ Status Storage::GetType(const std::string& key, enum DataType& type) {
 
 Status Storage::Keys(const DataType& data_type, const std::string& pattern, std::vector<std::string>* keys) {
   keys->clear();
-  std::vector<DataType> types;
-  types.push_back(data_type);
-
-  for (const auto& type : types) {
-    std::vector<IterSptr> inst_iters;
-    for (const auto& inst : insts_) {
-      IterSptr inst_iter;
-      inst_iter.reset(inst->CreateIterator(type, pattern, nullptr /*lower_bound*/, nullptr /*upper_bound*/));
-      inst_iters.push_back(inst_iter);
+  std::vector<size_t> inst_indexes(insts_.size());
+  std::iota(inst_indexes.begin(), inst_indexes.end(), 0);
+
+  // every instance yields its keys in order, merge the sorted runs afterwards
+  std::vector<std::vector<std::string>> inst_keys(insts_.size());
+  RunOnInstances(inst_indexes, kFanoutFullScanBatch, [&](size_t index) {
+    std::unique_ptr<TypeIterator> inst_iter(
+        insts_[index]->CreateIterator(data_type, pattern, nullptr /*lower_bound*/, nullptr /*upper_bound*/));
+    if (!inst_iter) {
+      return;
     }
-
-    MergingIterator miter(inst_iters);
-    miter.SeekToFirst();
-    while (miter.Valid()) {
-      keys->push_back(miter.Key());
-      miter.Next();
+    inst_iter->SeekToFirst();
+    while (inst_iter->Valid()) {
+      inst_keys[index].push_back(inst_iter->Key());
+      inst_iter->Next();
     }
-  }
+  });
 
+  std::vector<size_t> run_ends;
+  for (auto& run : inst_keys) {
+    std::move(run.begin(), run.end(), std::back_inserter(*keys));
+    run_ends.push_back(keys->size());
+  }
+  size_t merged_end = run_ends.empty() ? 0 : run_ends[0];
+  for (size_t i = 1; i < run_ends.size(); ++i) {
+    std::inplace_merge(keys->begin(), keys->begin() + merged_end, keys->begin() + run_ends[i]);
+    merged_end = run_ends[i];
+  }
   return Status::OK();
 }
 
@@ -1607,31 +1831,27 @@ Status Storage::PfCount(const std::vector<std::string>& keys, int64_t* result) {
     return Status::InvalidArgument("Invalid the number of key");
   }
 
-  std::string value;
-  std::string first_registers;
-  auto& inst = GetDBInstance(keys[0]);
-  Status s = inst->HyperloglogGet(keys[0], &value);
-  if (s.ok()) {
-    first_registers = std::string(value.data(), value.size());
-  } else if (s.IsNotFound()) {
-    first_registers = "";
-  } else {
-    return s;
+  std::vector<std::vector<size_t>> inst_key_indexes;
+  std::vector<size_t> inst_indexes = GroupKeysByInstance(keys, &inst_key_indexes);
+  std::vector<std::string> key_registers(keys.size());
+  std::vector<Status> key_status(keys.size());
+  RunOnInstances(inst_indexes, keys.size(), [&](size_t index) {
+    for (size_t key_index : inst_key_indexes[index]) {
+      key_status[key_index] = insts_[index]->HyperloglogGet(keys[key_index], &key_registers[key_index]);
+    }
+  });
+
+  if (!key_status[0].ok() && !key_status[0].IsNotFound()) {
+    return key_status[0];
   }
-  HyperLogLog first_log(kPrecision, first_registers);
+  HyperLogLog first_log(kPrecision, key_status[0].ok() ? key_registers[0] : "");
   for (size_t i = 1; i < keys.size(); ++i) {
-    std::string value;
-    std::string registers;
-    auto& inst = GetDBInstance(keys[i]);
-    s = inst->HyperloglogGet(keys[i], &value);
-    if (s.ok()) {
-      registers = value;
-    } else if (s.IsNotFound()) {
+    if (key_status[i].IsNotFound()) {
       continue;
-    } else {
-      return s;
+    } else if (!key_status[i].ok()) {
+      return key_status[i];
     }
-    HyperLogLog log(kPrecision, registers);
+    HyperLogLog log(kPrecision, key_registers[i]);
     first_log.Merge(log);
   }
   *result = static_cast<int32_t>(first_log.Estimate());
@@ -1813,6 +2033,52 @@ Status Storage::SetSmallCompactionDurationThreshold(uint32_t small_compaction_du
   return Status::OK();
 }
 
+void Storage::SetMultiKeyFanoutMinBatch(size_t min_batch) {
+  multi_key_fanout_min_batch_ = min_batch;
+}
+
+Status Storage::SetZSetRankIndexMinMembers(uint32_t zset_rank_index_min_members) {
+  for (const auto& inst : insts_) {
+    inst->SetZSetRankIndexMinMembers(zset_rank_index_min_members);
+  }
+  return Status::OK();
+}
+
+Status Storage::SetListNodeMaxElements(uint32_t list_node_max_elements) {
+  for (const auto& inst : insts_) {
+    inst->SetListNodeMaxElements(list_node_max_elements);
+  }
+  return Status::OK();
+}
+
+Status Storage::SetInlineCollectionMaxEntries(uint32_t inline_collection_max_entries) {
+  for (const auto& inst : insts_) {
+    inst->SetInlineCollectionMaxEntries(inline_collection_max_entries);
+  }
+  return Status::OK();
+}
+
+Status Storage::SetCompactionMetaCacheSize(size_t compaction_meta_cache_size) {
+  for (const auto& inst : insts_) {
+    inst->SetCompactionMetaCacheSize(compaction_meta_cache_size);
+  }
+  return Status::OK();
+}
+
+Status Storage::SetCompactionMetaScan(bool compaction_meta_scan) {
+  for (const auto& inst : insts_) {
+    inst->SetCompactionMetaScan(compaction_meta_scan);
+  }
+  return Status::OK();
+}
+
+Status Storage::SetRangeDeleteMinEntries(uint64_t range_delete_min_entries) {
+  for (const auto& inst : insts_) {
+    inst->SetRangeDeleteMinEntries(range_delete_min_entries);
+  }
+  return Status::OK();
+}
+
 std::string Storage::GetCurrentTaskType() {
   int type = current_task_type_;
   switch (type) {
@@ -1843,6 +2109,14 @@ Status Storage::GetUsage(const std::string& property, std::map<int, uint64_t>* c
   return Status::OK();
 }
 
+Status Storage::GetColumnFamilyUsage(const std::string& property, std::vector<uint64_t>* const cf_result) {
+  cf_result->assign(kColumnFamilyNum, 0);
+  for (const auto& inst : insts_) {
+    inst->GetColumnFamilyProperty(property, cf_result);
+  }
+  return Status::OK();
+}
+
 uint64_t Storage::GetProperty(const std::string& property) {
   uint64_t out = 0;
   uint64_t result = 0;
@@ -1855,25 +2129,29 @@ uint64_t Storage::GetProperty(const std::string& property) {
 }
 
 Status Storage::GetKeyNum(std::vector<KeyInfo>* key_infos) {
-  KeyInfo key_info;
   key_infos->resize(DataTypeNum);
-  for (const auto& db : insts_) {
-    std::vector<KeyInfo> db_key_infos;
+  std::vector<size_t> inst_indexes(insts_.size());
+  std::iota(inst_indexes.begin(), inst_indexes.end(), 0);
+  std::vector<std::vector<KeyInfo>> inst_key_infos(insts_.size());
+  std::vector<Status> inst_status(insts_.size());
+  RunOnInstances(inst_indexes, kFanoutFullScanBatch, [&](size_t index) {
     // check the scanner was stopped or not, before scanning the next db
     if (scan_keynum_exit_) {
-      break;
-    }
-    auto s = db->ScanKeyNum(&db_key_infos);
-    if (!s.ok()) {
-      return s;
+      return;
     }
-    std::transform(db_key_infos.begin(), db_key_infos.end(),
-        key_infos->begin(), key_infos->begin(), std::plus<>{});
-  }
+    inst_status[index] = insts_[index]->ScanKeyNum(&inst_key_infos[index]);
+  });
   if (scan_keynum_exit_) {
     scan_keynum_exit_ = false;
     return Status::Corruption("exit");
   }
+  for (size_t index : inst_indexes) {
+    if (!inst_status[index].ok()) {
+      return inst_status[index];
+    }
+    std::transform(inst_key_infos[index].begin(), inst_key_infos[index].end(),
+        key_infos->begin(), key_infos->begin(), std::plus<>{});
+  }
   return Status::OK();
 }
 
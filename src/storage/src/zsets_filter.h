@@ -20,8 +20,9 @@ namespace storage {
 
 class ZSetsScoreFilter : public rocksdb::CompactionFilter {
  public:
-  ZSetsScoreFilter(rocksdb::DB* db, std::vector<rocksdb::ColumnFamilyHandle*>* handles_ptr, enum DataType type)
-      : db_(db), cf_handles_ptr_(handles_ptr), type_(type) {}
+  ZSetsScoreFilter(rocksdb::DB* db, std::vector<rocksdb::ColumnFamilyHandle*>* handles_ptr, enum DataType type,
+                   CompactionMetaCache* meta_cache = nullptr)
+      : meta_reader_(db, handles_ptr, meta_cache), type_(type) {}
 
   bool Filter(int level, const rocksdb::Slice& key, const rocksdb::Slice& value, std::string* new_value,
               bool* value_changed) const override {
@@ -41,57 +42,7 @@ class ZSetsScoreFilter : public rocksdb::CompactionFilter {
     std::string meta_key_enc(key.data(), std::distance(key.data(), ptr));
     meta_key_enc.append(kSuffixReserveLength, kNeedTransformCharacter);
 
-    if (meta_key_enc != cur_key_) {
-      cur_key_ = meta_key_enc;
-      cur_meta_etime_ = 0;
-      cur_meta_version_ = 0;
-      meta_not_found_ = true;
-      std::string meta_value;
-      // destroyed when close the database, Reserve Current key value
-      if (cf_handles_ptr_->empty()) {
-        return false;
-      }
-      Status s = db_->Get(default_read_options_, (*cf_handles_ptr_)[0], cur_key_, &meta_value);
-      if (s.ok()) {
-        /*
-         * The elimination policy for keys of the Data type is that if the key
-         * type obtained from MetaCF is inconsistent with the key type in Data,
-         * it needs to be eliminated
-         */
-        auto type = static_cast<enum DataType>(static_cast<uint8_t>(meta_value[0]));
-        if (type != type_) {
-          return true;
-        }
-        ParsedZSetsMetaValue parsed_zsets_meta_value(&meta_value);
-        meta_not_found_ = false;
-        cur_meta_version_ = parsed_zsets_meta_value.Version();
-        cur_meta_etime_ = parsed_zsets_meta_value.Etime();
-      } else if (s.IsNotFound()) {
-        meta_not_found_ = true;
-      } else {
-        cur_key_ = "";
-        TRACE("Reserve[Get meta_key faild]");
-        return false;
-      }
-    }
-
-    if (meta_not_found_) {
-      TRACE("Drop[Meta key not exist]");
-      return true;
-    }
-
-    pstd::TimeType unix_time = pstd::NowMillis();
-    if (cur_meta_etime_ != 0 && cur_meta_etime_ < static_cast<uint64_t>(unix_time)) {
-      TRACE("Drop[Timeout]");
-      return true;
-    }
-    if (cur_meta_version_ > parsed_zsets_score_key.Version()) {
-      TRACE("Drop[score_key_version < cur_meta_version]");
-      return true;
-    } else {
-      TRACE("Reserve[score_key_version == cur_meta_version]");
-      return false;
-    }
+    return meta_reader_.Drop(meta_key_enc, type_, parsed_zsets_score_key.Version());
   }
 
   /*
@@ -114,24 +65,19 @@ class ZSetsScoreFilter : public rocksdb::CompactionFilter {
   const char* Name() const override { return "ZSetsScoreFilter"; }
 
  private:
-  rocksdb::DB* db_ = nullptr;
-  std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr_ = nullptr;
-  rocksdb::ReadOptions default_read_options_;
-  mutable std::string cur_key_;
-  mutable bool meta_not_found_ = false;
-  mutable uint64_t cur_meta_version_ = 0;
-  mutable uint64_t cur_meta_etime_ = 0;
+  mutable CompactionMetaReader meta_reader_;
   enum DataType type_ = DataType::kNones;
 };
 
 class ZSetsScoreFilterFactory : public rocksdb::CompactionFilterFactory {
  public:
-  ZSetsScoreFilterFactory(rocksdb::DB** db_ptr, std::vector<rocksdb::ColumnFamilyHandle*>* handles_ptr, enum DataType type)
-      : db_ptr_(db_ptr), cf_handles_ptr_(handles_ptr), type_(type) {}
+  ZSetsScoreFilterFactory(rocksdb::DB** db_ptr, std::vector<rocksdb::ColumnFamilyHandle*>* handles_ptr, enum DataType type,
+                          CompactionMetaCache* meta_cache = nullptr)
+      : db_ptr_(db_ptr), cf_handles_ptr_(handles_ptr), type_(type), meta_cache_(meta_cache) {}
 
   std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
       const rocksdb::CompactionFilter::Context& context) override {
-    return std::make_unique<ZSetsScoreFilter>(*db_ptr_, cf_handles_ptr_, type_);
+    return std::make_unique<ZSetsScoreFilter>(*db_ptr_, cf_handles_ptr_, type_, meta_cache_);
   }
 
   const char* Name() const override { return "ZSetsScoreFilterFactory"; }
@@ -140,6 +86,7 @@ class ZSetsScoreFilterFactory : public rocksdb::CompactionFilterFactory {
   rocksdb::DB** db_ptr_ = nullptr;
   std::vector<rocksdb::ColumnFamilyHandle*>* cf_handles_ptr_ = nullptr;
   enum DataType type_ = DataType::kNones;
+  CompactionMetaCache* meta_cache_ = nullptr;
 };
 
 }  //  namespace storage
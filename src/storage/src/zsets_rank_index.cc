@@ -0,0 +1,156 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "src/zsets_rank_index.h"
+
+#include <algorithm>
+
+namespace storage {
+
+void ZSetRankIndex::Append(const Slice& score_key) {
+  if (counts_.empty()) {
+    starts_.emplace_back();
+    counts_.push_back(0);
+  } else if (counts_.back() == kZSetRankIndexBlockSize) {
+    starts_.emplace_back(score_key.data(), score_key.size());
+    counts_.push_back(0);
+  }
+  counts_.back()++;
+  count_++;
+}
+
+void ZSetRankIndex::FinishBuild() {
+  if (counts_.empty()) {
+    starts_.emplace_back();
+    counts_.push_back(0);
+  }
+  RebuildTree();
+}
+
+size_t ZSetRankIndex::Locate(const Slice& score_key, int64_t* block_rank, std::string* block_start) const {
+  // the last block starting at or before score_key
+  auto iter = std::upper_bound(starts_.begin() + 1, starts_.end(), score_key,
+                               [this](const Slice& key, const std::string& start) {
+                                 return comparator_->Compare(key, start) < 0;
+                               });
+  size_t block = std::distance(starts_.begin(), iter) - 1;
+  *block_rank = PrefixCount(block);
+  *block_start = starts_[block];
+  return block;
+}
+
+size_t ZSetRankIndex::LocateRank(int64_t rank, int64_t* block_rank, std::string* block_start) const {
+  // descend the fenwick tree to the last block whose prefix count is <= rank
+  size_t pos = 0;
+  int64_t prefix = 0;
+  size_t step = 1;
+  while ((step << 1) <= tree_.size()) {
+    step <<= 1;
+  }
+  for (; step > 0; step >>= 1) {
+    if (pos + step <= tree_.size() && prefix + tree_[pos + step - 1] <= rank) {
+      pos += step;
+      prefix += tree_[pos - 1];
+    }
+  }
+  size_t block = std::min(pos, counts_.size() - 1);
+  *block_rank = PrefixCount(block);
+  *block_start = starts_[block];
+  return block;
+}
+
+void ZSetRankIndex::Insert(const Slice& score_key) {
+  int64_t block_rank = 0;
+  std::string block_start;
+  size_t block = Locate(score_key, &block_rank, &block_start);
+  counts_[block]++;
+  count_++;
+  for (size_t i = block + 1; i <= tree_.size(); i += i & (~i + 1)) {
+    tree_[i - 1]++;
+  }
+  if (counts_[block] > 2 * kZSetRankIndexBlockSize) {
+    maybe_oversized_ = true;
+  }
+}
+
+void ZSetRankIndex::Erase(const Slice& score_key) {
+  int64_t block_rank = 0;
+  std::string block_start;
+  size_t block = Locate(score_key, &block_rank, &block_start);
+  counts_[block]--;
+  count_--;
+  for (size_t i = block + 1; i <= tree_.size(); i += i & (~i + 1)) {
+    tree_[i - 1]--;
+  }
+  if (counts_[block] < kZSetRankIndexBlockSize / 4) {
+    Merge(block);
+  }
+}
+
+bool ZSetRankIndex::OversizedBlock(size_t* block, std::string* block_start, int64_t* block_count) {
+  if (!maybe_oversized_) {
+    return false;
+  }
+  for (size_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] > 2 * kZSetRankIndexBlockSize) {
+      *block = i;
+      *block_start = starts_[i];
+      *block_count = counts_[i];
+      return true;
+    }
+  }
+  maybe_oversized_ = false;
+  return false;
+}
+
+void ZSetRankIndex::SplitBlock(size_t block, const std::vector<std::string>& starts) {
+  if (starts.empty()) {
+    return;
+  }
+  // starts[i] is the key at offset (i + 1) * kZSetRankIndexBlockSize
+  // of the block, every part but the last one is full
+  std::vector<int64_t> counts(starts.size(), kZSetRankIndexBlockSize);
+  counts.back() = counts_[block] - kZSetRankIndexBlockSize * static_cast<int64_t>(starts.size());
+  counts_[block] = kZSetRankIndexBlockSize;
+  starts_.insert(starts_.begin() + static_cast<int64_t>(block) + 1, starts.begin(), starts.end());
+  counts_.insert(counts_.begin() + static_cast<int64_t>(block) + 1, counts.begin(), counts.end());
+  RebuildTree();
+}
+
+int64_t ZSetRankIndex::PrefixCount(size_t block) const {
+  int64_t prefix = 0;
+  for (size_t i = block; i > 0; i -= i & (~i + 1)) {
+    prefix += tree_[i - 1];
+  }
+  return prefix;
+}
+
+void ZSetRankIndex::RebuildTree() {
+  tree_ = counts_;
+  for (size_t i = 1; i <= tree_.size(); ++i) {
+    size_t parent = i + (i & (~i + 1));
+    if (parent <= tree_.size()) {
+      tree_[parent - 1] += tree_[i - 1];
+    }
+  }
+}
+
+void ZSetRankIndex::Merge(size_t block) {
+  // fold the block into a neighbour as long as that doesn't make it large
+  size_t absorbed = 0;
+  if (block + 1 < counts_.size() && counts_[block] + counts_[block + 1] <= kZSetRankIndexBlockSize) {
+    absorbed = block + 1;
+  } else if (block > 0 && counts_[block - 1] + counts_[block] <= kZSetRankIndexBlockSize) {
+    absorbed = block;
+  } else {
+    return;
+  }
+  counts_[absorbed - 1] += counts_[absorbed];
+  counts_.erase(counts_.begin() + static_cast<int64_t>(absorbed));
+  starts_.erase(starts_.begin() + static_cast<int64_t>(absorbed));
+  RebuildTree();
+}
+
+}  //  namespace storage
@@ -0,0 +1,88 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef SRC_ZSETS_RANK_INDEX_H_
+#define SRC_ZSETS_RANK_INDEX_H_
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/comparator.h"
+#include "rocksdb/slice.h"
+
+namespace storage {
+
+using Slice = rocksdb::Slice;
+
+// A block of the index holds about this many score keys
+const int64_t kZSetRankIndexBlockSize = 512;
+// The most blocks indexed per db instance, the least recently used
+// indexes are dropped beyond it
+const size_t kZSetRankIndexMaxBlocks = 256 * 1024;
+// A write adding or removing more score keys than this drops the index
+// of the zset instead of updating it, the next rank query rebuilds it
+const size_t kZSetRankIndexMaxUpdate = 4 * kZSetRankIndexBlockSize;
+
+/*
+ * Order statistics over the score keys of one zset version.
+ *
+ * The score keys are cut into consecutive blocks, the index keeps the
+ * encoded score key each block starts at and the number of keys in it,
+ * with a fenwick tree over the counts. The rank of a score key is the
+ * number of keys in the blocks before its block plus a scan of at most
+ * one block in kZsetsScoreCF, the same holds for finding the key at a
+ * rank, so both are O(log n + kZSetRankIndexBlockSize).
+ *
+ * Nothing is persisted, the index is built from kZsetsScoreCF with one
+ * scan and kept up to date by the writes of the zset. The caller holds
+ * the record lock of the zset for every access.
+ */
+class ZSetRankIndex {
+ public:
+  ZSetRankIndex(uint64_t version, const rocksdb::Comparator* comparator)
+      : version_(version), comparator_(comparator) {}
+
+  uint64_t version() const { return version_; }
+  int64_t count() const { return count_; }
+  size_t block_num() const { return counts_.size(); }
+
+  // Build the index, score keys must be appended in order
+  void Append(const Slice& score_key);
+  void FinishBuild();
+
+  // Returns the block score_key falls in, the rank of the first
+  // key of the block and the key the block starts at, which is
+  // empty for the first block
+  size_t Locate(const Slice& score_key, int64_t* block_rank, std::string* block_start) const;
+  // Same as Locate for the key at rank, rank should be less than count()
+  size_t LocateRank(int64_t rank, int64_t* block_rank, std::string* block_start) const;
+
+  void Insert(const Slice& score_key);
+  void Erase(const Slice& score_key);
+
+  // Returns true if a block grew past twice the block size, it is
+  // split with the keys at every kZSetRankIndexBlockSize offset
+  bool OversizedBlock(size_t* block, std::string* block_start, int64_t* block_count);
+  void SplitBlock(size_t block, const std::vector<std::string>& starts);
+
+ private:
+  int64_t PrefixCount(size_t block) const;
+  void RebuildTree();
+  void Merge(size_t block);
+
+  uint64_t version_;
+  const rocksdb::Comparator* comparator_;
+  int64_t count_ = 0;
+  // starts_[0] is always empty, the first block has no lower bound
+  std::vector<std::string> starts_;
+  std::vector<int64_t> counts_;
+  // fenwick tree over counts_
+  std::vector<int64_t> tree_;
+  // set by Insert when a block grew past twice the block size
+  bool maybe_oversized_ = false;
+};
+
+}  //  namespace storage
+#endif  //  SRC_ZSETS_RANK_INDEX_H_
@@ -2431,6 +2431,107 @@ TEST_F(HashesTest, PKHRScanRangeTest) {
   ASSERT_EQ(next_field, "i");
 }
 
+// Hashes written with inline-collection-max-entries > 0 keep their
+// fields in the meta value until they outgrow it
+TEST_F(HashesTest, InlineEncodingTest) {  // NOLINT
+  int32_t ret = 0;
+  int64_t ival = 0;
+  int64_t next_cursor = 0;
+  std::string value;
+  std::vector<FieldValue> fvs_out;
+  std::vector<ValueStatus> vss;
+
+  // a hash from before the switch keeps one key per field
+  s = db.HSet("INLINE_OLD_KEY", "a", "1", &ret);
+  ASSERT_TRUE(s.ok());
+  db.SetInlineCollectionMaxEntries(4);
+  s = db.HSet("INLINE_OLD_KEY", "b", "2", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(field_value_match(&db, "INLINE_OLD_KEY", {{"a", "1"}, {"b", "2"}}));
+
+  s = db.HMSet("INLINE_KEY", {{"c", "3"}, {"a", "1"}, {"b", "2"}});
+  ASSERT_TRUE(s.ok());
+  s = db.HSet("INLINE_KEY", "a", "10", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 0);
+  s = db.HIncrby("INLINE_KEY", "b", 5, &ival);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ival, 7);
+  s = db.HGet("INLINE_KEY", "a", &value);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(value, "10");
+  s = db.HGet("INLINE_KEY", "d", &value);
+  ASSERT_TRUE(s.IsNotFound());
+  s = db.HMGet("INLINE_KEY", {"a", "d", "c"}, &vss);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(vss.size(), 3);
+  ASSERT_TRUE(vss[0].status.ok());
+  ASSERT_EQ(vss[0].value, "10");
+  ASSERT_TRUE(vss[1].status.IsNotFound());
+  ASSERT_EQ(vss[2].value, "3");
+  ASSERT_TRUE(size_match(&db, "INLINE_KEY", 3));
+  ASSERT_TRUE(field_value_match(&db, "INLINE_KEY", {{"a", "10"}, {"b", "7"}, {"c", "3"}}));
+
+  s = db.HScan("INLINE_KEY", 0, "*", 2, &fvs_out, &next_cursor);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(field_value_match(fvs_out, {{"a", "10"}, {"b", "7"}}));
+  ASSERT_NE(next_cursor, 0);
+  fvs_out.clear();
+  s = db.HScan("INLINE_KEY", next_cursor, "*", 2, &fvs_out, &next_cursor);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(field_value_match(fvs_out, {{"c", "3"}}));
+  ASSERT_EQ(next_cursor, 0);
+
+  s = db.HDel("INLINE_KEY", {"c", "d"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  ASSERT_TRUE(size_match(&db, "INLINE_KEY", 2));
+
+  // a long value moves the hash to data keys
+  std::string long_value(100, 'v');
+  s = db.HSet("INLINE_KEY", "e", long_value, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  ASSERT_TRUE(field_value_match(&db, "INLINE_KEY", {{"a", "10"}, {"b", "7"}, {"e", long_value}}));
+
+  // so do too many fields
+  s = db.HMSet("INLINE_MANY_KEY", {{"a", "1"}, {"b", "2"}, {"c", "3"}, {"d", "4"}});
+  ASSERT_TRUE(s.ok());
+  s = db.HSet("INLINE_MANY_KEY", "e", "5", &ret);
+  ASSERT_TRUE(s.ok());
+  s = db.HDel("INLINE_MANY_KEY", {"a"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  ASSERT_TRUE(field_value_match(&db, "INLINE_MANY_KEY", {{"b", "2"}, {"c", "3"}, {"d", "4"}, {"e", "5"}}));
+
+  // an expired inline hash is gone, and a new one starts empty
+  ASSERT_TRUE(make_expired(&db, "INLINE_KEY"));
+  s = db.HSet("INLINE_OTHER_KEY", "x", "1", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(make_expired(&db, "INLINE_OTHER_KEY"));
+  s = db.HGet("INLINE_OTHER_KEY", "x", &value);
+  ASSERT_TRUE(s.IsNotFound());
+  s = db.HSet("INLINE_OTHER_KEY", "y", "2", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  ASSERT_TRUE(field_value_match(&db, "INLINE_OTHER_KEY", {{"y", "2"}}));
+
+  // deleting every field leaves no hash
+  s = db.HDel("INLINE_OTHER_KEY", {"y"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(size_match(&db, "INLINE_OTHER_KEY", 0));
+  s = db.HGetall("INLINE_OTHER_KEY", &fvs_out);
+  ASSERT_TRUE(s.IsNotFound());
+
+  // inline hashes are read the same after switching it off
+  s = db.HMSet("INLINE_KEEP_KEY", {{"a", "1"}, {"b", "2"}});
+  ASSERT_TRUE(s.ok());
+  db.SetInlineCollectionMaxEntries(0);
+  s = db.HSet("INLINE_KEEP_KEY", "c", "3", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(field_value_match(&db, "INLINE_KEEP_KEY", {{"a", "1"}, {"b", "2"}, {"c", "3"}}));
+}
+
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
     pstd::CreatePath("./log");
@@ -182,6 +182,40 @@ TEST_F(HyperLogLogTest, MultipleKeysTest) {
   ASSERT_LT(ratio_nums, static_cast<double>(result / 100) * 5);
 }
 
+TEST_F(HyperLogLogTest, PfCountFanoutTest) {
+  // PFCOUNT with enough keys to fan out across the db instances
+  bool update;
+  std::vector<std::string> keys;
+  for (int32_t i = 0; i < 80; i++) {
+    keys.push_back("FANOUT_HLL" + std::to_string(i));
+    std::vector<std::string> values;
+    for (int32_t j = 0; j < 100; j++) {
+      values.push_back("FOO" + std::to_string(i) + "_" + std::to_string(j));
+    }
+    // every key also counts the same BAR values
+    for (int32_t j = 0; j < 20; j++) {
+      values.push_back("BAR" + std::to_string(j));
+    }
+    s = db.PfAdd(keys.back(), values, &update);
+    ASSERT_TRUE(s.ok());
+    ASSERT_TRUE(update);
+  }
+  keys.push_back("FANOUT_HLL_NOT_EXIST");
+
+  int64_t result;
+  s = db.PfCount(keys, &result);
+  ASSERT_TRUE(s.ok());
+  int32_t ratio_nums = abs(8020 - result);
+  ASSERT_LT(ratio_nums, static_cast<double>(result / 100) * 5);
+
+  // fan-out disabled, the serial path merges the same registers
+  db.SetMultiKeyFanoutMinBatch(0);
+  int64_t serial_result;
+  s = db.PfCount(keys, &serial_result);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(serial_result, result);
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -5,6 +5,7 @@
 
 #include <gtest/gtest.h>
 #include <iostream>
+#include <limits>
 #include <thread>
 
 #include "glog/logging.h"
@@ -5167,6 +5168,36 @@ TEST_F(KeysTest, ExistsTest) {
   ASSERT_EQ(ret, 1);
 }
 
+// Del and Exists with enough keys to fan out across the db instances
+TEST_F(KeysTest, MultiKeyFanoutTest) {
+  int32_t ret;
+  std::vector<std::string> keys;
+  for (int i = 0; i < 200; ++i) {
+    keys.push_back("FANOUT_KEY" + std::to_string(i));
+  }
+  std::vector<storage::KeyValue> kvs;
+  for (int i = 0; i < 200; i += 2) {
+    kvs.push_back({keys[i], "VALUE"});
+  }
+  s = db.MSet(kvs);
+  ASSERT_TRUE(s.ok());
+  s = db.SAdd("FANOUT_SET_KEY", {"MEMBER"}, &ret);
+  ASSERT_TRUE(s.ok());
+  keys.push_back("FANOUT_SET_KEY");
+
+  ASSERT_EQ(db.Exists(keys), 101);
+  ASSERT_EQ(db.Del(keys), 101);
+  ASSERT_EQ(db.Exists(keys), 0);
+
+  // fan-out disabled, the serial path gives the same answers
+  db.SetMultiKeyFanoutMinBatch(0);
+  s = db.MSet(kvs);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(db.Exists(keys), 100);
+  ASSERT_EQ(db.Del(keys), 100);
+  ASSERT_EQ(db.Exists(keys), 0);
+}
+
 // Expireat
 TEST_F(KeysTest, ExpireatTest) {
   // If the key does not exist
@@ -5249,6 +5280,171 @@ TEST_F(KeysTest, TTLTest) {
   ttl_ret = db.TTL("TTL_KEY");
 }
 
+// Range deletion of the data keys of big collections
+TEST_F(KeysTest, RangeDeleteTest) {
+  int32_t ret;
+  uint64_t len;
+  db.SetRangeDeleteMinEntries(100);
+
+  std::vector<std::string> keys = {"RANGE_DELETE_HASH", "RANGE_DELETE_SET", "RANGE_DELETE_ZSET", "RANGE_DELETE_LIST"};
+  std::vector<storage::FieldValue> fvs;
+  std::vector<std::string> members;
+  std::vector<storage::ScoreMember> score_members = {{-std::numeric_limits<double>::infinity(), "MEMBER_INF"}};
+  for (int i = 0; i < 200; ++i) {
+    fvs.push_back({"FIELD_" + std::to_string(i), "VALUE_" + std::to_string(i)});
+    members.push_back("MEMBER_" + std::to_string(i));
+    score_members.push_back({static_cast<double>(i - 100), "MEMBER_" + std::to_string(i)});
+  }
+  // the same key names with a suffix are small and not range deleted,
+  // their data keys sort right after the big ones
+  for (const auto& suffix : {"", "_"}) {
+    s = db.HMSet(keys[0] + suffix, fvs);
+    ASSERT_TRUE(s.ok());
+    s = db.SAdd(keys[1] + suffix, members, &ret);
+    ASSERT_TRUE(s.ok());
+    s = db.ZAdd(keys[2] + suffix, score_members, &ret);
+    ASSERT_TRUE(s.ok());
+    s = db.RPush(keys[3] + suffix, members, &len);
+    ASSERT_TRUE(s.ok());
+    if (*suffix == '\0') {
+      fvs.resize(10);
+      members.resize(10);
+      score_members.resize(10);
+    }
+  }
+
+  ASSERT_EQ(db.Del(keys), 4);
+  ASSERT_EQ(db.Exists(keys), 0);
+
+  // the new versions of the keys do not see the old entries
+  s = db.HMSet(keys[0], {{"FIELD_0", "NEW_VALUE"}});
+  ASSERT_TRUE(s.ok());
+  s = db.SAdd(keys[1], {"MEMBER_0"}, &ret);
+  ASSERT_TRUE(s.ok());
+  s = db.ZAdd(keys[2], {{1, "MEMBER_0"}}, &ret);
+  ASSERT_TRUE(s.ok());
+  s = db.RPush(keys[3], {"MEMBER_0"}, &len);
+  ASSERT_TRUE(s.ok());
+  for (int round = 0; round < 2; ++round) {
+    std::vector<storage::FieldValue> fvs_out;
+    std::vector<std::string> members_out;
+    std::vector<storage::ScoreMember> score_members_out;
+    s = db.HGetall(keys[0], &fvs_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(fvs_out.size(), 1);
+    ASSERT_EQ(fvs_out[0].value, "NEW_VALUE");
+    s = db.SMembers(keys[1], &members_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(members_out.size(), 1);
+    s = db.ZRangebyscore(keys[2], -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+                         true, true, &score_members_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(score_members_out.size(), 1);
+    ASSERT_EQ(score_members_out[0].member, "MEMBER_0");
+    members_out.clear();
+    s = db.LRange(keys[3], 0, -1, &members_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(members_out.size(), 1);
+
+    // the small keys next to them keep their entries
+    fvs_out.clear();
+    s = db.HGetall(keys[0] + "_", &fvs_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(fvs_out.size(), 10);
+    s = db.SCard(keys[1] + "_", &ret);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(ret, 10);
+    score_members_out.clear();
+    s = db.ZRangebyscore(keys[2] + "_", -std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::infinity(), true, true, &score_members_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(score_members_out.size(), 10);
+    ASSERT_EQ(score_members_out[0].member, "MEMBER_INF");
+    s = db.LLen(keys[3] + "_", &len);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(len, 10);
+
+    // and the same after the range deletions are compacted
+    db.Compact(DataType::kAll, true);
+  }
+}
+
+// Prefix blooms on the data column families
+static bool prefix_bloom_match(storage::Storage* const db, const std::vector<std::string>& keys) {
+  for (const auto& key : keys) {
+    std::vector<storage::FieldValue> fvs_out;
+    std::vector<storage::FieldValue> rfvs_out;
+    std::vector<std::string> members_out;
+    std::vector<std::string> elements_out;
+    std::vector<storage::ScoreMember> score_members_out;
+    std::string next_field;
+    if (!db->HGetall(key + "_HASH", &fvs_out).ok() || fvs_out.size() != 3) {
+      return false;
+    }
+    // seeks from the key of the next version
+    if (!db->PKHRScanRange(key + "_HASH", "", "", "*", 10, &rfvs_out, &next_field).ok() || rfvs_out.size() != 3 ||
+        rfvs_out[0].field != "c") {
+      return false;
+    }
+    if (!db->SMembers(key + "_SET", &members_out).ok() || members_out.size() != 3) {
+      return false;
+    }
+    if (!db->ZRevrange(key + "_ZSET", 0, -1, &score_members_out).ok() || score_members_out.size() != 3 ||
+        score_members_out[0].member != "c") {
+      return false;
+    }
+    if (!db->LRange(key + "_LIST", 0, -1, &elements_out).ok() || elements_out.size() != 3) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST_F(KeysTest, PrefixBloomTest) {
+  int32_t ret;
+  uint64_t len;
+  std::string path = "./db/prefix_bloom";
+  pstd::DeleteDirIfExist(path);
+  mkdir(path.c_str(), 0755);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 10; ++i) {
+    keys.push_back("PREFIX_BLOOM_" + std::to_string(i));
+  }
+
+  {
+    storage::StorageOptions bloom_options;
+    bloom_options.options.create_if_missing = true;
+    bloom_options.prefix_bloom_types = {DataType::kHashes, DataType::kSets, DataType::kLists, DataType::kZSets};
+    storage::Storage bloom_db;
+    s = bloom_db.Open(bloom_options, path);
+    ASSERT_TRUE(s.ok());
+    for (const auto& key : keys) {
+      s = bloom_db.HMSet(key + "_HASH", {{"a", "1"}, {"b", "2"}, {"c", "3"}});
+      ASSERT_TRUE(s.ok());
+      s = bloom_db.SAdd(key + "_SET", {"a", "b", "c"}, &ret);
+      ASSERT_TRUE(s.ok());
+      s = bloom_db.ZAdd(key + "_ZSET", {{1, "a"}, {2, "b"}, {3, "c"}}, &ret);
+      ASSERT_TRUE(s.ok());
+      s = bloom_db.RPush(key + "_LIST", {"a", "b", "c"}, &len);
+      ASSERT_TRUE(s.ok());
+    }
+    // from the memtables, then from the sst files
+    ASSERT_TRUE(prefix_bloom_match(&bloom_db, keys));
+    bloom_db.Compact(DataType::kAll, true);
+    ASSERT_TRUE(prefix_bloom_match(&bloom_db, keys));
+  }
+
+  // the sst files read without the prefix extractor
+  {
+    storage::StorageOptions no_bloom_options;
+    storage::Storage no_bloom_db;
+    s = no_bloom_db.Open(no_bloom_options, path);
+    ASSERT_TRUE(s.ok());
+    ASSERT_TRUE(prefix_bloom_match(&no_bloom_db, keys));
+  }
+  storage::DeleteFiles(path.c_str());
+}
+
 
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
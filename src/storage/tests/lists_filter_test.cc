@@ -7,8 +7,10 @@
 #include <iostream>
 #include <thread>
 
+#include "src/base_filter.h"
 #include "src/base_key_format.h"
 #include "src/lists_filter.h"
+#include "src/pika_stream_meta_value.h"
 #include "src/redis.h"
 #include "src/zsets_filter.h"
 #include "storage/storage.h"
@@ -245,6 +247,133 @@ TEST_F(ListsFilterTest, DataFilterTest) {
   ASSERT_TRUE(s.ok());
 }
 
+// Data filters sharing a meta cache, and reading the metas with an iterator
+TEST_F(ListsFilterTest, MetaCacheTest) {
+  char str[8];
+  bool filter_result;
+  bool value_changed;
+  std::string new_value;
+  CompactionMetaCache meta_cache;
+  meta_cache.SetCapacity(100);
+  EncodeFixed64(str, 1);
+
+  std::string user_key = "META_CACHE_KEY";
+  BaseMetaKey bmk(user_key);
+  ListsMetaValue lists_meta_value(Slice(str, sizeof(uint64_t)));
+  uint64_t old_version = lists_meta_value.UpdateVersion();
+  s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), lists_meta_value.Encode());
+  ASSERT_TRUE(s.ok());
+  auto filter1 = std::make_unique<ListsDataFilter>(meta_db, &handles, DataType::kLists, &meta_cache);
+  ListsDataKey old_data_key(user_key, old_version, 1);
+  filter_result = filter1->Filter(0, old_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, false);
+
+  // the cached meta is read again for data keys newer than it
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  uint64_t new_version = lists_meta_value.UpdateVersion();
+  s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), lists_meta_value.Encode());
+  ASSERT_TRUE(s.ok());
+  auto filter2 = std::make_unique<ListsDataFilter>(meta_db, &handles, DataType::kLists, &meta_cache);
+  ListsDataKey new_data_key(user_key, new_version, 1);
+  filter_result = filter2->Filter(0, new_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, false);
+  auto filter3 = std::make_unique<ListsDataFilter>(meta_db, &handles, DataType::kLists, &meta_cache);
+  filter_result = filter3->Filter(0, old_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, true);
+
+  // a key created after its meta was found missing
+  std::string created_key = "META_CACHE_CREATED_KEY";
+  BaseMetaKey created_bmk(created_key);
+  ListsDataKey missing_data_key(created_key, old_version, 1);
+  filter_result = filter3->Filter(0, missing_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, true);
+  ListsMetaValue created_meta_value(Slice(str, sizeof(uint64_t)));
+  uint64_t created_version = created_meta_value.UpdateVersion();
+  s = meta_db->Put(rocksdb::WriteOptions(), handles[0], created_bmk.Encode(), created_meta_value.Encode());
+  ASSERT_TRUE(s.ok());
+  auto filter4 = std::make_unique<ListsDataFilter>(meta_db, &handles, DataType::kLists, &meta_cache);
+  ListsDataKey created_data_key(created_key, created_version, 1);
+  filter_result = filter4->Filter(0, created_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, false);
+
+  // the entries go with the last filter
+  CompactionMeta meta;
+  ASSERT_TRUE(meta_cache.Lookup(bmk.Encode().ToString(), &meta));
+  filter1.reset();
+  filter2.reset();
+  filter3.reset();
+  filter4.reset();
+  ASSERT_FALSE(meta_cache.Lookup(bmk.Encode().ToString(), &meta));
+
+  // metas read in key order by one iterator
+  meta_cache.SetScanMeta(true);
+  auto scan_filter = std::make_unique<ListsDataFilter>(meta_db, &handles, DataType::kLists, &meta_cache);
+  ListsDataKey absent_data_key("META_CACHE_ABSENT_KEY", old_version, 1);
+  filter_result = scan_filter->Filter(0, absent_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, true);
+  filter_result = scan_filter->Filter(0, created_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, false);
+  filter_result = scan_filter->Filter(0, old_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, true);
+  filter_result = scan_filter->Filter(0, new_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, false);
+
+  s = meta_db->Delete(rocksdb::WriteOptions(), handles[0], bmk.Encode());
+  ASSERT_TRUE(s.ok());
+  s = meta_db->Delete(rocksdb::WriteOptions(), handles[0], created_bmk.Encode());
+  ASSERT_TRUE(s.ok());
+}
+
+// A stream created after its meta was found missing, stream versions start
+// at 1 instead of the time they are written
+TEST_F(ListsFilterTest, StreamMetaCacheTest) {
+  bool filter_result;
+  bool value_changed;
+  std::string new_value;
+  CompactionMetaCache meta_cache;
+  meta_cache.SetCapacity(100);
+
+  std::string user_key = "META_CACHE_STREAM_KEY";
+  BaseMetaKey bmk(user_key);
+  BaseDataKey data_key(user_key, 1, "1-0");
+  auto filter1 = std::make_unique<BaseDataFilter>(meta_db, &handles, DataType::kStreams, &meta_cache);
+  filter_result = filter1->Filter(0, data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, true);
+  CompactionMeta meta;
+  ASSERT_TRUE(meta_cache.Lookup(bmk.Encode().ToString(), &meta));
+  ASSERT_FALSE(meta.found);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  StreamMetaValue stream_meta_value;
+  stream_meta_value.InitMetaValue();
+  s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), stream_meta_value.value());
+  ASSERT_TRUE(s.ok());
+  auto filter2 = std::make_unique<BaseDataFilter>(meta_db, &handles, DataType::kStreams, &meta_cache);
+  filter_result = filter2->Filter(0, data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, false);
+  ASSERT_TRUE(meta_cache.Lookup(bmk.Encode().ToString(), &meta));
+  ASSERT_TRUE(meta.found);
+  ASSERT_EQ(meta.version, 1);
+  filter1.reset();
+  filter2.reset();
+
+  // the same through a meta iterator created before the stream
+  s = meta_db->Delete(rocksdb::WriteOptions(), handles[0], bmk.Encode());
+  ASSERT_TRUE(s.ok());
+  meta_cache.SetScanMeta(true);
+  auto scan_filter = std::make_unique<BaseDataFilter>(meta_db, &handles, DataType::kStreams, &meta_cache);
+  BaseDataKey absent_data_key("META_CACHE_STREAM_ABSENT_KEY", 1, "1-0");
+  filter_result = scan_filter->Filter(0, absent_data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, true);
+  s = meta_db->Put(rocksdb::WriteOptions(), handles[0], bmk.Encode(), stream_meta_value.value());
+  ASSERT_TRUE(s.ok());
+  filter_result = scan_filter->Filter(0, data_key.Encode(), "FILTER_TEST_VALUE", &new_value, &value_changed);
+  ASSERT_EQ(filter_result, false);
+
+  s = meta_db->Delete(rocksdb::WriteOptions(), handles[0], bmk.Encode());
+  ASSERT_TRUE(s.ok());
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -4,6 +4,8 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <deque>
 #include <iostream>
 #include <thread>
 
@@ -2705,6 +2707,164 @@ TEST_F(ListsTest, RPushxTest) {  // NOLINT
   ASSERT_TRUE(s.ok());
 }
 
+// Lists written with list-node-max-elements > 0 pack their elements
+// into nodes, every command should behave the same on them
+TEST_F(ListsTest, NodesEncodingTest) {  // NOLINT
+  uint64_t num;
+  int64_t ret;
+  std::string element;
+  std::vector<std::string> elements;
+
+  // a list from before the switch keeps one key per element
+  s = db.RPush("NODES_OLD_KEY", {"a", "b", "c"}, &num);
+  ASSERT_TRUE(s.ok());
+  db.SetListNodeMaxElements(4);
+  s = db.LInsert("NODES_OLD_KEY", storage::Before, "b", "x", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 4);
+  ASSERT_TRUE(elements_match(&db, "NODES_OLD_KEY", {"a", "x", "b", "c"}));
+
+  std::deque<std::string> model;
+  std::deque<std::string> other;
+  auto check = [&]() {
+    std::vector<std::string> expect(model.begin(), model.end());
+    if (!elements_match(&db, "NODES_KEY", expect) || !len_match(&db, "NODES_KEY", model.size())) {
+      return false;
+    }
+    std::vector<std::string> other_expect(other.begin(), other.end());
+    return elements_match(&db, "NODES_OTHER_KEY", other_expect);
+  };
+
+  srand(10);
+  int counter = 0;
+  for (int i = 0; i < 2000; ++i) {
+    auto size = static_cast<int64_t>(model.size());
+    int op = rand() % 10;
+    if (op == 0 || op == 1) {
+      std::vector<std::string> values;
+      for (int n = rand() % 6 + 1; n > 0; --n) {
+        values.push_back("v" + std::to_string(counter++ % 20));
+      }
+      if (op == 0) {
+        s = db.LPush("NODES_KEY", values, &num);
+        model.insert(model.begin(), values.rbegin(), values.rend());
+      } else {
+        s = db.RPush("NODES_KEY", values, &num);
+        model.insert(model.end(), values.begin(), values.end());
+      }
+      ASSERT_TRUE(s.ok());
+      ASSERT_EQ(num, model.size());
+    } else if (op == 2 && size != 0) {
+      std::string pivot = model[rand() % size];
+      bool before = rand() % 2 == 0;
+      s = db.LInsert("NODES_KEY", before ? storage::Before : storage::After, pivot, "i", &ret);
+      ASSERT_TRUE(s.ok());
+      auto iter = std::find(model.begin(), model.end(), pivot);
+      model.insert(before ? iter : iter + 1, "i");
+      ASSERT_EQ(ret, static_cast<int64_t>(model.size()));
+    } else if (op == 3 && size != 0) {
+      int64_t count = rand() % 5 - 2;
+      std::string value = model[rand() % size];
+      uint64_t removed = 0;
+      s = db.LRem("NODES_KEY", count, value, &removed);
+      ASSERT_TRUE(s.ok());
+      uint64_t expect_removed = 0;
+      if (count >= 0) {
+        for (auto iter = model.begin(); iter != model.end();) {
+          if (*iter == value && (count == 0 || expect_removed < static_cast<uint64_t>(count))) {
+            iter = model.erase(iter);
+            expect_removed++;
+          } else {
+            ++iter;
+          }
+        }
+      } else {
+        for (auto idx = static_cast<int64_t>(model.size()) - 1;
+             idx >= 0 && expect_removed < static_cast<uint64_t>(-count); --idx) {
+          if (model[idx] == value) {
+            model.erase(model.begin() + idx);
+            expect_removed++;
+          }
+        }
+      }
+      ASSERT_EQ(removed, expect_removed);
+    } else if (op == 4 && size != 0) {
+      int64_t index = rand() % (2 * size) - size;
+      s = db.LSet("NODES_KEY", index, "s" + std::to_string(counter++ % 20));
+      ASSERT_TRUE(s.ok());
+      model[index >= 0 ? index : size + index] = "s" + std::to_string((counter - 1) % 20);
+      s = db.LIndex("NODES_KEY", index, &element);
+      ASSERT_TRUE(s.ok());
+      ASSERT_EQ(element, model[index >= 0 ? index : size + index]);
+    } else if (op == 5 && size != 0) {
+      int64_t start = rand() % 4;
+      int64_t stop = -1 - rand() % 4;
+      s = db.LTrim("NODES_KEY", start, stop);
+      ASSERT_TRUE(s.ok());
+      if (start > size + stop) {
+        model.clear();
+      } else {
+        model.erase(model.begin() + (size + stop + 1), model.end());
+        model.erase(model.begin(), model.begin() + start);
+      }
+    } else if (op == 6 && size != 0) {
+      int64_t count = rand() % 5 + 1;
+      bool left = rand() % 2 == 0;
+      elements.clear();
+      s = left ? db.LPop("NODES_KEY", count, &elements) : db.RPop("NODES_KEY", count, &elements);
+      ASSERT_TRUE(s.ok());
+      ASSERT_EQ(static_cast<int64_t>(elements.size()), std::min(count, size));
+      for (const auto& e : elements) {
+        ASSERT_EQ(e, left ? model.front() : model.back());
+        left ? model.pop_front() : model.pop_back();
+      }
+    } else if (op == 7 && size != 0) {
+      bool self = rand() % 2 == 0;
+      s = db.RPoplpush("NODES_KEY", self ? "NODES_KEY" : "NODES_OTHER_KEY", &element);
+      ASSERT_TRUE(s.ok());
+      ASSERT_EQ(element, model.back());
+      model.pop_back();
+      self ? model.push_front(element) : other.push_front(element);
+    } else if (op == 8 && size != 0) {
+      int64_t start = rand() % (2 * size) - size;
+      int64_t stop = rand() % (2 * size) - size;
+      s = db.LRange("NODES_KEY", start, stop, &elements);
+      ASSERT_TRUE(s.ok());
+      int64_t start_pos = std::max<int64_t>(start >= 0 ? start : size + start, 0);
+      int64_t stop_pos = std::min<int64_t>(stop >= 0 ? stop : size + stop, size - 1);
+      std::vector<std::string> expect;
+      for (int64_t idx = start_pos; idx <= stop_pos; ++idx) {
+        expect.push_back(model[idx]);
+      }
+      ASSERT_TRUE(elements_match(elements, expect));
+      elements.clear();
+    } else if (op == 9 && !other.empty()) {
+      s = db.RPoplpush("NODES_OTHER_KEY", "NODES_KEY", &element);
+      ASSERT_TRUE(s.ok());
+      ASSERT_EQ(element, other.back());
+      other.pop_back();
+      model.push_front(element);
+    }
+    ASSERT_TRUE(check());
+  }
+
+  // the node encoded list outlives switching the encoding back
+  db.SetListNodeMaxElements(0);
+  s = db.RPush("NODES_KEY", {"tail"}, &num);
+  ASSERT_TRUE(s.ok());
+  model.push_back("tail");
+  ASSERT_TRUE(check());
+
+  // expired node encoded lists read as empty and start over
+  ASSERT_TRUE(make_expired(&db, "NODES_KEY"));
+  ASSERT_TRUE(len_match(&db, "NODES_KEY", 0));
+  s = db.LPush("NODES_KEY", {"new"}, &num);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(num, 1);
+  model = {"new"};
+  ASSERT_TRUE(check());
+}
+
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
     pstd::CreatePath("./log");
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <unordered_map>
 
+#include "pstd/include/env.h"
 #include "storage/storage.h"
 
 using namespace storage;
@@ -54,6 +55,47 @@ TEST_F(StorageOptionsTest, ResetOptionsTest) {
   ASSERT_EQ(storage_options.options.max_background_compactions, 32);
 }
 
+// MemoryGovernor
+TEST_F(StorageOptionsTest, MemoryGovernorTest) {
+  std::vector<uint32_t> weights = {4, 4, 2, 2, 2, 1, 1};
+  std::vector<size_t> shares;
+  // nothing busy, every block cache keeps its share
+  std::vector<size_t> capacities = MemoryGovernor::Distribute(1600, weights, {0, 0, 0, 0, 0, 0, 0}, &shares);
+  ASSERT_EQ(shares, std::vector<size_t>({400, 400, 200, 200, 200, 100, 100}));
+  ASSERT_EQ(capacities, shares);
+
+  // the idle block caches lend the share above their usage and
+  // headroom to the busy ones by weight
+  capacities = MemoryGovernor::Distribute(1600, weights, {0, 400, 0, 0, 200, 100, 0}, &shares);
+  ASSERT_EQ(shares, std::vector<size_t>({400, 400, 200, 200, 200, 100, 100}));
+  ASSERT_EQ(capacities, std::vector<size_t>({100, 785, 50, 50, 392, 196, 25}));
+
+  MemoryGovernor governor(16 << 20, 4 << 20, weights);
+  ASSERT_EQ(governor.BlockCache(kHashesDataCF)->GetCapacity(), 4 << 20);
+  ASSERT_EQ(governor.MemtableShare(kHashesDataCF), 1 << 20);
+  // write_buffer_size scaled by the weight against the average weight
+  ASSERT_EQ(governor.WriteBufferSize(kHashesDataCF, 16 << 20), 28 << 20);
+  ASSERT_EQ(governor.WriteBufferSize(kStreamsDataCF, 16 << 20), 7 << 20);
+
+  // every instance uses the block caches and write buffer manager
+  std::string path = "./db/memory_governor";
+  pstd::DeleteDirIfExist(path);
+  storage_options.options.create_if_missing = true;
+  storage_options.memory_governor = std::make_shared<MemoryGovernor>(16 << 20, 4 << 20, weights);
+  Storage db;
+  s = db.Open(storage_options, path);
+  ASSERT_TRUE(s.ok());
+  s = db.HMSet("MEMORY_GOVERNOR_KEY", {{"FIELD", "VALUE"}});
+  ASSERT_TRUE(s.ok());
+  ASSERT_GT(storage_options.memory_governor->MemtableUsage(), 0);
+  storage_options.memory_governor->Rebalance();
+  size_t total_capacity = 0;
+  for (int cf = 0; cf < kColumnFamilyNum; ++cf) {
+    total_capacity += storage_options.memory_governor->BlockCache(cf)->GetCapacity();
+  }
+  ASSERT_LE(total_capacity, (16 << 20) - storage_options.memory_governor->MemtableUsage());
+}
+
 int main(int argc, char** argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
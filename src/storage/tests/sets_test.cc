@@ -4,7 +4,9 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
+#include <set>
 #include <thread>
 
 #include "glog/logging.h"
@@ -2240,6 +2242,413 @@ TEST_F(SetsTest, SScanTest) {  // NOLINT
   ASSERT_TRUE(members_match(member_out, {}));
 }
 
+// SPop and SRandmember on a big set seek to random members
+// instead of walking the set up to them
+TEST_F(SetsTest, SPopSampleTest) {  // NOLINT
+  int32_t ret = 0;
+  std::vector<std::string> all_members;
+  for (int32_t i = 0; i < 10000; ++i) {
+    all_members.push_back("MEMBER_" + std::to_string(i));
+  }
+  s = db.SAdd("GP1_SPOP_SAMPLE_KEY", all_members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 10000);
+
+  std::vector<std::string> members_out;
+  s = db.SRandmember("GP1_SPOP_SAMPLE_KEY", 5, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out.size(), 5);
+  ASSERT_TRUE(members_contains(members_out, all_members));
+  ASSERT_EQ(std::set<std::string>(members_out.begin(), members_out.end()).size(), 5);
+
+  members_out.clear();
+  s = db.SRandmember("GP1_SPOP_SAMPLE_KEY", -8, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out.size(), 8);
+  ASSERT_TRUE(members_contains(members_out, all_members));
+
+  // pop from the set while other writes change it
+  std::set<std::string> popped;
+  std::set<std::string> left(all_members.begin(), all_members.end());
+  for (int32_t i = 0; i < 3000; ++i) {
+    members_out.clear();
+    s = db.SPop("GP1_SPOP_SAMPLE_KEY", &members_out, 2);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(members_out.size(), 2);
+    for (const auto& member : members_out) {
+      ASSERT_TRUE(popped.insert(member).second);
+      ASSERT_EQ(left.erase(member), 1);
+    }
+    if (i % 100 == 0) {
+      std::string member = "NEW_MEMBER_" + std::to_string(i);
+      s = db.SAdd("GP1_SPOP_SAMPLE_KEY", {member}, &ret);
+      ASSERT_TRUE(s.ok());
+      left.insert(member);
+      std::string removed = *left.begin();
+      s = db.SRem("GP1_SPOP_SAMPLE_KEY", {removed}, &ret);
+      ASSERT_TRUE(s.ok());
+      ASSERT_EQ(ret, 1);
+      left.erase(removed);
+    }
+  }
+  s = db.SCard("GP1_SPOP_SAMPLE_KEY", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, static_cast<int32_t>(left.size()));
+  ASSERT_TRUE(members_match(&db, "GP1_SPOP_SAMPLE_KEY", std::vector<std::string>(left.begin(), left.end())));
+}
+
+// SAdd, SRem and SMove keep the sample index of a big set up to date,
+// members added after it was built are sampled as often as the others
+TEST_F(SetsTest, SetsSampleIndexWriteTest) {  // NOLINT
+  int32_t ret = 0;
+  std::vector<std::string> all_members;
+  for (int32_t i = 0; i < 10000; ++i) {
+    all_members.push_back("MEMBER_" + std::to_string(i));
+  }
+  s = db.SAdd("GP1_SAMPLE_INDEX_WRITE_KEY", all_members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 10000);
+  std::vector<std::string> members_out;
+  s = db.SRandmember("GP1_SAMPLE_INDEX_WRITE_KEY", 5, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out.size(), 5);
+
+  // the new members sort after all the others, into the last block
+  std::vector<std::string> new_members;
+  for (int32_t i = 0; i < 300; ++i) {
+    new_members.push_back("NEW_MEMBER_" + std::to_string(i));
+  }
+  s = db.SAdd("GP1_SAMPLE_INDEX_WRITE_KEY", new_members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 300);
+  std::set<std::string> left(all_members.begin(), all_members.end());
+  left.insert(new_members.begin(), new_members.end());
+  int32_t new_sampled = 0;
+  for (int32_t i = 0; i < 2000; ++i) {
+    members_out.clear();
+    s = db.SRandmember("GP1_SAMPLE_INDEX_WRITE_KEY", -1, &members_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(members_out.size(), 1);
+    ASSERT_EQ(left.count(members_out[0]), 1);
+    if (members_out[0].compare(0, 4, "NEW_") == 0) {
+      new_sampled++;
+    }
+  }
+  // about 58 of them are expected
+  ASSERT_GT(new_sampled, 15);
+
+  // remove most of the members a few blocks at a time
+  for (int32_t i = 0; i < 8000; i += 500) {
+    std::vector<std::string> removed(all_members.begin() + i, all_members.begin() + i + 500);
+    s = db.SRem("GP1_SAMPLE_INDEX_WRITE_KEY", removed, &ret);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(ret, 500);
+    for (const auto& member : removed) {
+      left.erase(member);
+    }
+  }
+  for (int32_t i = 0; i < 200; ++i) {
+    s = db.SMove("GP1_SAMPLE_INDEX_WRITE_KEY", "GP1_SAMPLE_INDEX_WRITE_DST_KEY", all_members[8000 + i], &ret);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(ret, 1);
+    left.erase(all_members[8000 + i]);
+  }
+  for (int32_t i = 0; i < 200; ++i) {
+    members_out.clear();
+    s = db.SRandmember("GP1_SAMPLE_INDEX_WRITE_KEY", 2, &members_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(members_out.size(), 2);
+    ASSERT_NE(members_out[0], members_out[1]);
+    ASSERT_EQ(left.count(members_out[0]), 1);
+    ASSERT_EQ(left.count(members_out[1]), 1);
+  }
+  for (int32_t i = 0; i < 100; ++i) {
+    members_out.clear();
+    s = db.SPop("GP1_SAMPLE_INDEX_WRITE_KEY", &members_out, 3);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(members_out.size(), 3);
+    for (const auto& member : members_out) {
+      ASSERT_EQ(left.erase(member), 1);
+    }
+  }
+  s = db.SCard("GP1_SAMPLE_INDEX_WRITE_KEY", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, static_cast<int32_t>(left.size()));
+  ASSERT_TRUE(
+      members_match(&db, "GP1_SAMPLE_INDEX_WRITE_KEY", std::vector<std::string>(left.begin(), left.end())));
+  s = db.SCard("GP1_SAMPLE_INDEX_WRITE_DST_KEY", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 200);
+}
+
+// SInter, SDiff and SUnion look up the members of a set that is much
+// smaller than the others and walk all the sets together otherwise
+TEST_F(SetsTest, SetsMergeJoinTest) {  // NOLINT
+  int32_t ret = 0;
+  auto make_members = [](int32_t begin, int32_t end, int32_t step) {
+    std::vector<std::string> members;
+    for (int32_t i = begin; i < end; i += step) {
+      members.push_back("MEMBER_" + std::to_string(i));
+    }
+    return members;
+  };
+  auto sorted = [](std::vector<std::string> members) {
+    std::sort(members.begin(), members.end());
+    return members;
+  };
+
+  // ***************** Group 1 Test *****************
+  // big = {0, 1, ..., 4999}, small = {0, 1000, ..., 9000}
+  // the small set is looked up in the big one whichever comes first
+  std::vector<std::string> big_members = make_members(0, 5000, 1);
+  std::vector<std::string> small_members = make_members(0, 10000, 1000);
+  s = db.SAdd("GP1_MERGE_JOIN_BIG", big_members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 5000);
+  s = db.SAdd("GP1_MERGE_JOIN_SMALL", small_members, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 10);
+
+  std::vector<std::string> members_out;
+  s = db.SInter({"GP1_MERGE_JOIN_BIG", "GP1_MERGE_JOIN_SMALL"}, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out, sorted(make_members(0, 5000, 1000)));
+
+  members_out.clear();
+  s = db.SInter({"GP1_MERGE_JOIN_SMALL", "GP1_MERGE_JOIN_BIG"}, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out, sorted(make_members(0, 5000, 1000)));
+
+  members_out.clear();
+  s = db.SDiff({"GP1_MERGE_JOIN_SMALL", "GP1_MERGE_JOIN_BIG"}, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out, sorted(make_members(5000, 10000, 1000)));
+
+  // ***************** Group 2 Test *****************
+  // key1 = multiples of 2, key2 = multiples of 3, key3 = multiples of 5
+  // in [0, 3000), the sets are walked together
+  s = db.SAdd("GP2_MERGE_JOIN_KEY1", make_members(0, 3000, 2), &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1500);
+  s = db.SAdd("GP2_MERGE_JOIN_KEY2", make_members(0, 3000, 3), &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1000);
+  s = db.SAdd("GP2_MERGE_JOIN_KEY3", make_members(0, 3000, 5), &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 600);
+  std::vector<std::string> gp2_keys{"GP2_MERGE_JOIN_KEY1", "GP2_MERGE_JOIN_KEY2", "GP2_MERGE_JOIN_KEY3"};
+
+  members_out.clear();
+  s = db.SInter(gp2_keys, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out, sorted(make_members(0, 3000, 30)));
+
+  std::vector<std::string> expect_diff;
+  std::vector<std::string> expect_union;
+  for (int32_t i = 0; i < 3000; ++i) {
+    if (i % 2 == 0 && i % 3 != 0 && i % 5 != 0) {
+      expect_diff.push_back("MEMBER_" + std::to_string(i));
+    }
+    if (i % 2 == 0 || i % 3 == 0 || i % 5 == 0) {
+      expect_union.push_back("MEMBER_" + std::to_string(i));
+    }
+  }
+  members_out.clear();
+  s = db.SDiff(gp2_keys, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out, sorted(expect_diff));
+
+  members_out.clear();
+  s = db.SUnion(gp2_keys, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out, sorted(expect_union));
+
+  std::vector<std::string> value_to_dest;
+  s = db.SInterstore("GP2_MERGE_JOIN_DEST", gp2_keys, value_to_dest, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 100);
+  ASSERT_TRUE(members_match(&db, "GP2_MERGE_JOIN_DEST", make_members(0, 3000, 30)));
+
+  s = db.SDiffstore("GP2_MERGE_JOIN_DEST", gp2_keys, value_to_dest, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, static_cast<int32_t>(expect_diff.size()));
+  ASSERT_TRUE(members_match(&db, "GP2_MERGE_JOIN_DEST", expect_diff));
+
+  s = db.SUnionstore("GP2_MERGE_JOIN_DEST", gp2_keys, value_to_dest, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, static_cast<int32_t>(expect_union.size()));
+  ASSERT_TRUE(members_match(&db, "GP2_MERGE_JOIN_DEST", expect_union));
+
+  // ***************** Group 3 Test *****************
+  // the members left in an older version of a key are not seen
+  s = db.SAdd("GP3_MERGE_JOIN_KEY1", make_members(0, 2000, 1), &ret);
+  ASSERT_TRUE(s.ok());
+  s = db.SAdd("GP3_MERGE_JOIN_KEY2", make_members(0, 2000, 1), &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(make_expired(&db, "GP3_MERGE_JOIN_KEY2"));
+  s = db.SAdd("GP3_MERGE_JOIN_KEY2", make_members(1000, 3000, 1), &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 2000);
+
+  members_out.clear();
+  s = db.SInter({"GP3_MERGE_JOIN_KEY1", "GP3_MERGE_JOIN_KEY2"}, &members_out);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members_out, sorted(make_members(1000, 2000, 1)));
+}
+
+// Sets written with inline-collection-max-entries > 0 keep their
+// members in the meta value until they outgrow it
+TEST_F(SetsTest, InlineEncodingTest) {  // NOLINT
+  int32_t ret = 0;
+  int64_t next_cursor = 0;
+  std::vector<std::string> members;
+  std::vector<std::string> value_to_dest;
+  db.SetInlineCollectionMaxEntries(4);
+
+  s = db.SAdd("INLINE_KEY", {"c", "a", "b", "a"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 3);
+  ASSERT_TRUE(size_match(&db, "INLINE_KEY", 3));
+  ASSERT_TRUE(members_match(&db, "INLINE_KEY", {"a", "b", "c"}));
+  s = db.SIsmember("INLINE_KEY", "b", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  s = db.SIsmember("INLINE_KEY", "d", &ret);
+  ASSERT_EQ(ret, 0);
+
+  s = db.SScan("INLINE_KEY", 0, "*", 2, &members, &next_cursor);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(members_match(members, {"a", "b"}));
+  ASSERT_NE(next_cursor, 0);
+  s = db.SScan("INLINE_KEY", next_cursor, "*", 2, &members, &next_cursor);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(members_match(members, {"c"}));
+  ASSERT_EQ(next_cursor, 0);
+
+  members.clear();
+  s = db.SRandmember("INLINE_KEY", 2, &members);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members.size(), 2);
+  ASSERT_TRUE(members_uniquen(members));
+  ASSERT_TRUE(members_contains(members, {"a", "b", "c"}));
+  members.clear();
+  s = db.SRandmember("INLINE_KEY", -5, &members);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members.size(), 5);
+  ASSERT_TRUE(members_contains(members, {"a", "b", "c"}));
+
+  // inline sets join with sets of data keys
+  db.SetInlineCollectionMaxEntries(0);
+  s = db.SAdd("DATA_KEY", {"b", "c", "d", "e", "f"}, &ret);
+  ASSERT_TRUE(s.ok());
+  db.SetInlineCollectionMaxEntries(4);
+  s = db.SInter({"INLINE_KEY", "DATA_KEY"}, &members);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(members_match(members, {"b", "c"}));
+  s = db.SDiff({"INLINE_KEY", "DATA_KEY"}, &members);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(members_match(members, {"a"}));
+  s = db.SDiff({"DATA_KEY", "INLINE_KEY"}, &members);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(members_match(members, {"d", "e", "f"}));
+
+  // a small result is stored inline, a large one in data keys
+  s = db.SInterstore("INLINE_DEST_KEY", {"INLINE_KEY", "DATA_KEY"}, value_to_dest, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 2);
+  ASSERT_TRUE(members_match(&db, "INLINE_DEST_KEY", {"b", "c"}));
+  s = db.SUnionstore("INLINE_DEST_KEY", {"INLINE_KEY", "DATA_KEY"}, value_to_dest, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 6);
+  ASSERT_TRUE(members_match(&db, "INLINE_DEST_KEY", {"a", "b", "c", "d", "e", "f"}));
+  s = db.SDiffstore("INLINE_DEST_KEY", {"DATA_KEY", "INLINE_KEY"}, value_to_dest, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 3);
+  ASSERT_TRUE(members_match(&db, "INLINE_DEST_KEY", {"d", "e", "f"}));
+
+  s = db.SMove("INLINE_KEY", "INLINE_DEST_KEY", "a", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  ASSERT_TRUE(members_match(&db, "INLINE_KEY", {"b", "c"}));
+  ASSERT_TRUE(members_match(&db, "INLINE_DEST_KEY", {"a", "d", "e", "f"}));
+
+  // too many members move the set to data keys
+  s = db.SAdd("INLINE_DEST_KEY", {"g"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  s = db.SRem("INLINE_DEST_KEY", {"a", "x"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  ASSERT_TRUE(members_match(&db, "INLINE_DEST_KEY", {"d", "e", "f", "g"}));
+
+  members.clear();
+  s = db.SPop("INLINE_KEY", &members, 1);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members.size(), 1);
+  ASSERT_TRUE(members_contains(members, {"b", "c"}));
+  ASSERT_TRUE(size_match(&db, "INLINE_KEY", 1));
+  members.clear();
+  s = db.SPop("INLINE_KEY", &members, 5);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(members.size(), 1);
+  ASSERT_TRUE(size_match(&db, "INLINE_KEY", 0));
+
+  // an expired inline set is gone, and a new one starts empty
+  s = db.SAdd("INLINE_KEY", {"x", "y"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(make_expired(&db, "INLINE_KEY"));
+  ASSERT_TRUE(members_match(&db, "INLINE_KEY", {}));
+  s = db.SAdd("INLINE_KEY", {"z"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  ASSERT_TRUE(members_match(&db, "INLINE_KEY", {"z"}));
+}
+
+// SInter with enough keys to fan out across the db instances
+TEST_F(SetsTest, SInterFanoutTest) {  // NOLINT
+  int32_t ret = 0;
+  std::vector<std::string> shared_members;
+  for (int32_t i = 0; i < 100; ++i) {
+    shared_members.push_back("MEMBER_" + std::to_string(i));
+  }
+  std::sort(shared_members.begin(), shared_members.end());
+
+  // every set holds the shared members plus one of its own
+  std::vector<std::string> keys;
+  for (int32_t i = 0; i < 80; ++i) {
+    keys.push_back("FANOUT_SINTER_KEY" + std::to_string(i));
+    std::vector<std::string> members = shared_members;
+    members.push_back("ONLY_" + std::to_string(i));
+    s = db.SAdd(keys.back(), members, &ret);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(ret, 101);
+  }
+  // a two-member set makes the members of the smallest set get looked up
+  // in the others instead of walking all of them
+  std::vector<std::string> probe_keys = keys;
+  probe_keys.push_back("FANOUT_SINTER_SMALL_KEY");
+  s = db.SAdd("FANOUT_SINTER_SMALL_KEY", {"MEMBER_0", "NOT_SHARED"}, &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 2);
+
+  auto check = [&]() {
+    std::vector<std::string> members_out;
+    s = db.SInter(keys, &members_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(members_out, shared_members);
+
+    members_out.clear();
+    s = db.SInter(probe_keys, &members_out);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(members_out, std::vector<std::string>{"MEMBER_0"});
+  };
+  check();
+
+  // fan-out disabled, the serial path gives the same answers
+  db.SetMultiKeyFanoutMinBatch(0);
+  check();
+}
+
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
     pstd::CreatePath("./log");
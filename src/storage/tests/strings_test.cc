@@ -79,6 +79,7 @@ TEST_F(StringsTest, AppendTest) {
   ASSERT_TRUE(s.ok());
   ASSERT_EQ(ret, 5);
   ASSERT_EQ(expired_timestamp_millsec, 0);
+  ASSERT_EQ(new_value, "HELLO");
 
   s = db.Append("GP1_APPEND_KEY", " WORLD", &ret, &expired_timestamp_millsec, new_value);
   ASSERT_TRUE(s.ok());
@@ -123,6 +124,7 @@ TEST_F(StringsTest, AppendTest) {
   ASSERT_TRUE(s.ok());
   ASSERT_EQ(ret, 5);
   ASSERT_EQ(expired_timestamp_millsec, 0);
+  ASSERT_EQ(new_value, "VALUE");
   s = db.Get("GP3_APPEND_KEY", &value);
   ASSERT_STREQ(value.c_str(), "VALUE");
 
@@ -440,6 +442,21 @@ TEST_F(StringsTest, IncrbyTest) {
   s = db.Get("GP4_INCRBY_KEY", &value);
   ASSERT_EQ(value, "100000");
   ASSERT_EQ(expired_timestamp_millsec, 0);
+
+  // ***************** Group 5 Test *****************
+  // The out param carries no timestamp of a previous call over to a new key
+  s = db.Set("GP5_INCRBY_KEY", "1");
+  ASSERT_TRUE(s.ok());
+  ret = db.Expire("GP5_INCRBY_KEY", 100 * 1000);
+  ASSERT_EQ(ret, 1);
+  s = db.Incrby("GP5_INCRBY_KEY", 1, &ret, &expired_timestamp_millsec);
+  ASSERT_TRUE(s.ok());
+  ASSERT_GT(expired_timestamp_millsec, 0);
+
+  s = db.Incrby("GP5_INCRBY_NEW_KEY", 1, &ret, &expired_timestamp_millsec);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(ret, 1);
+  ASSERT_EQ(expired_timestamp_millsec, 0);
 }
 
 // Incrbyfloat
@@ -571,6 +588,92 @@ TEST_F(StringsTest, MGetTest) {
   ASSERT_EQ(vss[3].value, "");
 }
 
+// MGet across every db instance, the batched lookups must line up with Get
+TEST_F(StringsTest, MGetBatchTest) {
+  std::vector<storage::ValueStatus> vss;
+
+  // ***************** Group 1 Test *****************
+  std::vector<storage::KeyValue> kvs;
+  std::vector<std::string> keys;
+  for (int i = 0; i < 300; ++i) {
+    std::string key = "GP1_MGET_BATCH_KEY" + std::to_string(i);
+    keys.push_back(key);
+    if (i % 3 != 0) {
+      kvs.push_back({key, "VALUE" + std::to_string(i)});
+    }
+  }
+  // duplicated keys keep their own slot in the reply
+  keys.push_back("GP1_MGET_BATCH_KEY1");
+  keys.push_back("GP1_MGET_BATCH_KEY1");
+  s = db.MSet(kvs);
+  ASSERT_TRUE(s.ok());
+
+  vss.clear();
+  s = db.MGet(keys, &vss);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(vss.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    std::string value;
+    Status get_status = db.Get(keys[i], &value);
+    if (get_status.ok()) {
+      ASSERT_TRUE(vss[i].status.ok());
+      ASSERT_EQ(vss[i].value, value);
+    } else {
+      ASSERT_TRUE(vss[i].status.IsNotFound());
+      ASSERT_EQ(vss[i].value, "");
+    }
+  }
+  ASSERT_EQ(vss[300].value, "VALUE1");
+  ASSERT_EQ(vss[301].value, "VALUE1");
+
+  // ***************** Group 2 Test *****************
+  // expired keys and keys holding other types are nil
+  int32_t ret = 0;
+  s = db.Set("GP2_MGET_BATCH_KEY1", "VALUE1");
+  ASSERT_TRUE(s.ok());
+  s = db.Set("GP2_MGET_BATCH_KEY2", "VALUE2");
+  ASSERT_TRUE(s.ok());
+  s = db.HSet("GP2_MGET_BATCH_HASH_KEY", "FIELD", "VALUE", &ret);
+  ASSERT_TRUE(s.ok());
+  ASSERT_TRUE(make_expired(&db, "GP2_MGET_BATCH_KEY2"));
+
+  std::vector<std::string> keys2{"GP2_MGET_BATCH_KEY1", "GP2_MGET_BATCH_KEY2", "GP2_MGET_BATCH_HASH_KEY",
+                                 "GP2_MGET_BATCH_NOT_EXIST_KEY"};
+  vss.clear();
+  s = db.MGet(keys2, &vss);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(vss.size(), 4);
+  ASSERT_TRUE(vss[0].status.ok());
+  ASSERT_EQ(vss[0].value, "VALUE1");
+  ASSERT_TRUE(vss[1].status.IsNotFound());
+  ASSERT_EQ(vss[1].value, "");
+  ASSERT_TRUE(vss[2].status.IsNotFound());
+  ASSERT_EQ(vss[2].value, "");
+  ASSERT_TRUE(vss[3].status.IsNotFound());
+  ASSERT_EQ(vss[3].value, "");
+
+  // ***************** Group 3 Test *****************
+  s = db.Setex("GP3_MGET_BATCH_KEY1", "VALUE1", 100 * 1000);
+  ASSERT_TRUE(s.ok());
+  std::vector<std::string> keys3{"GP2_MGET_BATCH_KEY1", "GP3_MGET_BATCH_KEY1", "GP2_MGET_BATCH_KEY2",
+                                 "GP2_MGET_BATCH_HASH_KEY"};
+  vss.clear();
+  s = db.MGetWithTTL(keys3, &vss);
+  ASSERT_TRUE(s.ok());
+  ASSERT_EQ(vss.size(), 4);
+  ASSERT_TRUE(vss[0].status.ok());
+  ASSERT_EQ(vss[0].value, "VALUE1");
+  ASSERT_EQ(vss[0].ttl_millsec, -1);
+  ASSERT_TRUE(vss[1].status.ok());
+  ASSERT_EQ(vss[1].value, "VALUE1");
+  ASSERT_GT(vss[1].ttl_millsec, 0);
+  ASSERT_LE(vss[1].ttl_millsec, 100 * 1000);
+  ASSERT_TRUE(vss[2].status.IsNotFound());
+  ASSERT_EQ(vss[2].ttl_millsec, -2);
+  ASSERT_TRUE(vss[3].status.IsNotFound());
+  ASSERT_EQ(vss[3].ttl_millsec, -2);
+}
+
 // MSet
 TEST_F(StringsTest, MSetTest) {
   std::vector<storage::KeyValue> kvs;
@@ -1047,6 +1150,50 @@ TEST_F(StringsTest, PKSetexAtTest) {
   ASSERT_EQ(ttl_ret, -2);
 }
 
+// MGet with enough keys to fan out across the db instances
+TEST_F(StringsTest, MGetFanoutTest) {
+  int32_t ret = 0;
+  std::vector<std::string> keys;
+  std::vector<storage::KeyValue> kvs;
+  for (int i = 0; i < 200; ++i) {
+    keys.push_back("FANOUT_MGET_KEY" + std::to_string(i));
+    if (i % 2 == 0) {
+      kvs.push_back({keys[i], "VALUE" + std::to_string(i)});
+    }
+  }
+  s = db.MSet(kvs);
+  ASSERT_TRUE(s.ok());
+  s = db.SAdd("FANOUT_MGET_SET_KEY", {"MEMBER"}, &ret);
+  ASSERT_TRUE(s.ok());
+  keys.push_back("FANOUT_MGET_SET_KEY");
+
+  auto check = [&](const std::vector<storage::ValueStatus>& vss) {
+    ASSERT_EQ(vss.size(), keys.size());
+    for (int i = 0; i < 200; ++i) {
+      if (i % 2 == 0) {
+        ASSERT_TRUE(vss[i].status.ok());
+        ASSERT_EQ(vss[i].value, "VALUE" + std::to_string(i));
+      } else {
+        ASSERT_TRUE(vss[i].status.IsNotFound());
+        ASSERT_EQ(vss[i].value, "");
+      }
+    }
+    ASSERT_TRUE(vss[200].status.IsNotFound());
+  };
+
+  std::vector<storage::ValueStatus> vss;
+  s = db.MGet(keys, &vss);
+  ASSERT_TRUE(s.ok());
+  check(vss);
+
+  // fan-out disabled, the serial path gives the same answers
+  db.SetMultiKeyFanoutMinBatch(0);
+  vss.clear();
+  s = db.MGet(keys, &vss);
+  ASSERT_TRUE(s.ok());
+  check(vss);
+}
+
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
     pstd::CreatePath("./log");
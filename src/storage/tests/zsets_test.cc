@@ -4,7 +4,11 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <iostream>
+#include <map>
+#include <random>
+#include <set>
 #include <thread>
 
 #include "glog/logging.h"
@@ -5235,6 +5239,220 @@ TEST_F(ZSetsTest, ZScanTest) {  // NOLINT
   ASSERT_TRUE(score_members_match(score_member_out, {}));
 }
 
+// ZRank, ZRevrank, ZRange, ZRevrange and ZRemrangebyrank through the rank index
+TEST_F(ZSetsTest, ZRankIndexTest) {  // NOLINT
+  std::set<std::pair<double, std::string>> model;
+  std::map<std::string, double> scores;
+  auto model_add = [&](const std::string& member, double score) {
+    if (scores.count(member) != 0U) {
+      model.erase({scores[member], member});
+    }
+    scores[member] = score;
+    model.insert({score, member});
+  };
+  auto model_rem = [&](const std::string& member) {
+    model.erase({scores[member], member});
+    scores.erase(member);
+  };
+  auto model_at = [&](int32_t rank) {
+    auto iter = model.begin();
+    std::advance(iter, rank);
+    return iter;
+  };
+
+  std::mt19937 rng(4);
+  int32_t ret = 0;
+  auto add_random = [&](int32_t num) {
+    std::vector<storage::ScoreMember> score_members;
+    for (int32_t i = 0; i < num; ++i) {
+      std::string member = "MEMBER_" + std::to_string(rng() % 20000);
+      double score = static_cast<double>(rng() % 1000);
+      if (std::any_of(score_members.begin(), score_members.end(),
+                      [&](const storage::ScoreMember& sm) { return sm.member == member; })) {
+        continue;
+      }
+      score_members.push_back({score, member});
+      model_add(member, score);
+    }
+    s = db.ZAdd("GP1_ZRANK_INDEX_KEY", score_members, &ret);
+    ASSERT_TRUE(s.ok());
+  };
+  auto check = [&]() {
+    int32_t count = static_cast<int32_t>(model.size());
+    for (int i = 0; i < 20; ++i) {
+      int32_t rank = static_cast<int32_t>(rng() % count);
+      int32_t rank_out = 0;
+      const std::string& member = model_at(rank)->second;
+      s = db.ZRank("GP1_ZRANK_INDEX_KEY", member, &rank_out);
+      ASSERT_TRUE(s.ok());
+      ASSERT_EQ(rank_out, rank);
+      s = db.ZRevrank("GP1_ZRANK_INDEX_KEY", member, &rank_out);
+      ASSERT_TRUE(s.ok());
+      ASSERT_EQ(rank_out, count - 1 - rank);
+    }
+    int32_t rank_out = 0;
+    s = db.ZRank("GP1_ZRANK_INDEX_KEY", "NOT_A_MEMBER", &rank_out);
+    ASSERT_TRUE(s.IsNotFound());
+
+    std::vector<storage::ScoreMember> score_members;
+    int32_t start = static_cast<int32_t>(rng() % count);
+    s = db.ZRange("GP1_ZRANK_INDEX_KEY", start, start + 9, &score_members);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(score_members.size(), std::min(10, count - start));
+    for (size_t i = 0; i < score_members.size(); ++i) {
+      ASSERT_EQ(score_members[i].member, model_at(start + static_cast<int32_t>(i))->second);
+    }
+    s = db.ZRevrange("GP1_ZRANK_INDEX_KEY", start, start + 9, &score_members);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(score_members.size(), std::min(10, count - start));
+    for (size_t i = 0; i < score_members.size(); ++i) {
+      ASSERT_EQ(score_members[i].member, model_at(count - 1 - start - static_cast<int32_t>(i))->second);
+    }
+  };
+
+  db.SetZSetRankIndexMinMembers(1);
+  for (int i = 0; i < 10; ++i) {
+    add_random(500);
+  }
+  check();
+
+  for (int step = 0; step < 300; ++step) {
+    int32_t count = static_cast<int32_t>(model.size());
+    switch (rng() % 6) {
+      case 0:
+        add_random(static_cast<int32_t>(rng() % 100) + 1);
+        break;
+      case 1: {
+        std::vector<std::string> members;
+        for (int i = 0; i < 20; ++i) {
+          std::string member = model_at(static_cast<int32_t>(rng() % model.size()))->second;
+          if (std::find(members.begin(), members.end(), member) == members.end()) {
+            members.push_back(member);
+          }
+        }
+        s = db.ZRem("GP1_ZRANK_INDEX_KEY", members, &ret);
+        ASSERT_TRUE(s.ok());
+        ASSERT_EQ(ret, members.size());
+        for (const auto& member : members) {
+          model_rem(member);
+        }
+        break;
+      }
+      case 2: {
+        std::string member = model_at(static_cast<int32_t>(rng() % count))->second;
+        double score = 0;
+        s = db.ZIncrby("GP1_ZRANK_INDEX_KEY", member, 7, &score);
+        ASSERT_TRUE(s.ok());
+        model_add(member, scores[member] + 7);
+        break;
+      }
+      case 3: {
+        int32_t start = static_cast<int32_t>(rng() % count);
+        int32_t stop = start + static_cast<int32_t>(rng() % 30);
+        s = db.ZRemrangebyrank("GP1_ZRANK_INDEX_KEY", start, stop, &ret);
+        ASSERT_TRUE(s.ok());
+        ASSERT_EQ(ret, std::min(stop, count - 1) - start + 1);
+        for (int32_t i = 0; i < ret; ++i) {
+          model_rem(model_at(start)->second);
+        }
+        break;
+      }
+      case 4: {
+        std::vector<storage::ScoreMember> score_members;
+        s = db.ZPopMin("GP1_ZRANK_INDEX_KEY", 3, &score_members);
+        ASSERT_TRUE(s.ok());
+        for (const auto& sm : score_members) {
+          ASSERT_EQ(sm.member, model.begin()->second);
+          model_rem(sm.member);
+        }
+        s = db.ZPopMax("GP1_ZRANK_INDEX_KEY", 3, &score_members);
+        ASSERT_TRUE(s.ok());
+        for (const auto& sm : score_members) {
+          ASSERT_EQ(sm.member, model.rbegin()->second);
+          model_rem(sm.member);
+        }
+        break;
+      }
+      case 5: {
+        double min = static_cast<double>(rng() % 1000);
+        s = db.ZRemrangebyscore("GP1_ZRANK_INDEX_KEY", min, min + 2, true, true, &ret);
+        ASSERT_TRUE(s.ok());
+        auto first = model.lower_bound({min, ""});
+        auto last = model.lower_bound({min + 3, ""});
+        ASSERT_EQ(ret, std::distance(first, last));
+        std::vector<std::string> members;
+        for (auto iter = first; iter != last; ++iter) {
+          members.push_back(iter->second);
+        }
+        for (const auto& member : members) {
+          model_rem(member);
+        }
+        break;
+      }
+    }
+    check();
+  }
+
+  // A write too large to update the index with drops it
+  add_random(3000);
+  check();
+
+  // The index of a deleted zset is not used for the new one
+  db.Del({"GP1_ZRANK_INDEX_KEY"});
+  model.clear();
+  scores.clear();
+  add_random(2000);
+  check();
+
+  // Same results with the index disabled
+  db.SetZSetRankIndexMinMembers(0);
+  check();
+}
+
+// ZUnionstore with enough keys to fan out across the db instances
+TEST_F(ZSetsTest, ZUnionstoreFanoutTest) {  // NOLINT
+  int32_t ret;
+  // key i holds {i, MM_i} and {1, SHARED}, weighted 1 or 2
+  std::vector<std::string> keys;
+  std::vector<double> weights;
+  for (int32_t i = 0; i < 80; ++i) {
+    keys.push_back("FANOUT_ZUNIONSTORE_KEY" + std::to_string(i));
+    weights.push_back(i % 2 == 0 ? 1 : 2);
+    s = db.ZAdd(keys.back(), {{static_cast<double>(i), "MM_" + std::to_string(i)}, {1, "SHARED"}}, &ret);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(ret, 2);
+  }
+  // missing keys add nothing
+  keys.push_back("FANOUT_ZUNIONSTORE_NOT_EXIST_KEY");
+
+  auto check = [&]() {
+    std::map<std::string, double> value_to_dest;
+    s = db.ZUnionstore("FANOUT_ZUNIONSTORE_DESTINATION", keys, weights, storage::SUM, value_to_dest, &ret);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(ret, 81);
+    ASSERT_TRUE(size_match(&db, "FANOUT_ZUNIONSTORE_DESTINATION", 81));
+    ASSERT_EQ(value_to_dest["SHARED"], 120);
+    for (int32_t i = 0; i < 80; ++i) {
+      ASSERT_EQ(value_to_dest["MM_" + std::to_string(i)], i * weights[i]);
+    }
+
+    s = db.ZUnionstore("FANOUT_ZUNIONSTORE_DESTINATION", keys, weights, storage::MAX, value_to_dest, &ret);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(ret, 81);
+    ASSERT_EQ(value_to_dest["SHARED"], 2);
+
+    s = db.ZUnionstore("FANOUT_ZUNIONSTORE_DESTINATION", keys, weights, storage::MIN, value_to_dest, &ret);
+    ASSERT_TRUE(s.ok());
+    ASSERT_EQ(ret, 81);
+    ASSERT_EQ(value_to_dest["SHARED"], 1);
+  };
+  check();
+
+  // fan-out disabled, the serial path gives the same answers
+  db.SetMultiKeyFanoutMinBatch(0);
+  check();
+}
+
 int main(int argc, char** argv) {
   if (!pstd::FileExists("./log")) {
     pstd::CreatePath("./log");
@@ -0,0 +1,103 @@
+package pika_integration
+
+import (
+	"context"
+	"time"
+
+	. "github.com/bsm/ginkgo/v2"
+	. "github.com/bsm/gomega"
+	"github.com/redis/go-redis/v9"
+)
+
+var _ = Describe("Pooled Cmd Test", func() {
+	ctx := context.TODO()
+
+	Describe("Single Instance", func() {
+		var client *redis.Client
+
+		BeforeEach(func() {
+			client = redis.NewClient(PikaOption(SINGLEADDR))
+			Expect(client.FlushDB(ctx).Err()).NotTo(HaveOccurred())
+			time.Sleep(1 * time.Second)
+		})
+
+		AfterEach(func() {
+			Expect(client.Close()).NotTo(HaveOccurred())
+		})
+
+		It("should not carry the options of an earlier SET into the next one", func() {
+			//the client holds one connection, so both SETs reuse the same pooled instance
+			Expect(client.SetEx(ctx, "pooled_ttl_key", "v", 100*time.Second).Err()).NotTo(HaveOccurred())
+			Expect(client.Set(ctx, "pooled_plain_key", "v", 0).Err()).NotTo(HaveOccurred())
+			Expect(client.Do(ctx, "ttl", "pooled_plain_key").Val()).To(Equal(int64(-1)))
+
+			Expect(client.SetNX(ctx, "pooled_nx_key", "v1", 0).Val()).To(BeTrue())
+			Expect(client.Set(ctx, "pooled_nx_key", "v2", 0).Err()).NotTo(HaveOccurred())
+			Expect(client.Get(ctx, "pooled_nx_key").Val()).To(Equal("v2"))
+		})
+
+		It("should reply to HSET and HGET of reused instances with their own fields", func() {
+			for i := 0; i < 20; i++ {
+				Expect(client.HSet(ctx, "pooled_hash", "f1", "v1").Err()).NotTo(HaveOccurred())
+				Expect(client.HSet(ctx, "pooled_hash", "f2", "v2").Err()).NotTo(HaveOccurred())
+				Expect(client.HGet(ctx, "pooled_hash", "f1").Val()).To(Equal("v1"))
+				Expect(client.HGet(ctx, "pooled_hash", "f2").Val()).To(Equal("v2"))
+				Expect(client.HGet(ctx, "pooled_hash", "f3").Err()).To(Equal(redis.Nil))
+			}
+		})
+	})
+
+	Describe("Master Slave", func() {
+		var (
+			slave  *redis.Client
+			master *redis.Client
+		)
+
+		BeforeEach(func() {
+			slave = redis.NewClient(PikaOption(SLAVEADDR))
+			master = redis.NewClient(PikaOption(MASTERADDR))
+		})
+
+		AfterEach(func() {
+			Expect(slave.Close()).NotTo(HaveOccurred())
+			Expect(master.Close()).NotTo(HaveOccurred())
+		})
+
+		It("slave should not inherit the ttl of an earlier INCR on another key", func() {
+			slave.SlaveOf(ctx, "no", "one")
+			slave.FlushDB(ctx)
+			master.FlushDB(ctx)
+			time.Sleep(3 * time.Second)
+			Expect(slave.Do(ctx, "slaveof", LOCALHOST, MASTERPORT).Err()).NotTo(HaveOccurred())
+			waitFullSyncDone(ctx, slave)
+
+			//INCR, INCRBY and APPEND reuse pooled command instances on the same
+			//connection, the binlog of the second key must not carry the ttl the
+			//first one was written with
+			Expect(master.SetEx(ctx, "pooled_ttl_key", "1", 100*time.Second).Err()).NotTo(HaveOccurred())
+			for i := 0; i < 20; i++ {
+				Expect(master.Incr(ctx, "pooled_ttl_key").Err()).NotTo(HaveOccurred())
+				Expect(master.IncrBy(ctx, "pooled_ttl_key", 2).Err()).NotTo(HaveOccurred())
+				Expect(master.Append(ctx, "pooled_ttl_key", "0").Err()).NotTo(HaveOccurred())
+				Expect(master.Del(ctx, "pooled_ttl_key").Err()).NotTo(HaveOccurred())
+				Expect(master.SetEx(ctx, "pooled_ttl_key", "1", 100*time.Second).Err()).NotTo(HaveOccurred())
+			}
+			Expect(master.Incr(ctx, "pooled_incr_key").Val()).To(Equal(int64(1)))
+			Expect(master.IncrBy(ctx, "pooled_incrby_key", 5).Val()).To(Equal(int64(5)))
+			Expect(master.Append(ctx, "pooled_append_key", "v").Val()).To(Equal(int64(1)))
+
+			expected := map[string]string{"pooled_incr_key": "1", "pooled_incrby_key": "5", "pooled_append_key": "v"}
+			for key, value := range expected {
+				Eventually(func() string {
+					return slave.Get(ctx, key).Val()
+				}, "60s", "100ms").Should(Equal(value))
+				Expect(master.Do(ctx, "ttl", key).Val()).To(Equal(int64(-1)))
+				Expect(slave.Do(ctx, "ttl", key).Val()).To(Equal(int64(-1)))
+			}
+
+			slave.SlaveOf(ctx, "no", "one")
+			slave.FlushDB(ctx)
+			master.FlushDB(ctx)
+		})
+	})
+})
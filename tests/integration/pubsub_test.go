@@ -4,6 +4,7 @@ import (
 	"bytes"
 	"context"
 	"net"
+	"strconv"
 	"sync"
 	"time"
 
@@ -16,6 +17,32 @@ func bigVal() []byte {
 	return bytes.Repeat([]byte{'*'}, 1<<17) // 128kb
 }
 
+func expectSubscription(ctx context.Context, pubsub *redis.PubSub, kind, channel string, count int) {
+	msgi, err := pubsub.ReceiveTimeout(ctx, time.Second)
+	Expect(err).NotTo(HaveOccurred())
+	subscr, ok := msgi.(*redis.Subscription)
+	Expect(ok).To(BeTrue())
+	Expect(subscr.Kind).To(Equal(kind))
+	Expect(subscr.Channel).To(Equal(channel))
+	Expect(subscr.Count).To(Equal(count))
+}
+
+// receiveMessages returns the next n messages, then expects no more
+func receiveMessages(ctx context.Context, pubsub *redis.PubSub, n int) []*redis.Message {
+	msgs := make([]*redis.Message, 0, n)
+	for i := 0; i < n; i++ {
+		msgi, err := pubsub.ReceiveTimeout(ctx, time.Second)
+		Expect(err).NotTo(HaveOccurred())
+		msg, ok := msgi.(*redis.Message)
+		Expect(ok).To(BeTrue())
+		msgs = append(msgs, msg)
+	}
+	_, err := pubsub.ReceiveTimeout(ctx, 500*time.Millisecond)
+	Expect(err).To(HaveOccurred())
+	Expect(err.(net.Error).Timeout()).To(Equal(true))
+	return msgs
+}
+
 var _ = Describe("PubSub", func() {
 	var client, client2 *redis.Client
 	ctx := context.TODO()
@@ -294,6 +321,187 @@ var _ = Describe("PubSub", func() {
 	//	Expect(stats.Misses).To(Equal(uint32(1)))
 	//})
 
+	It("should match patterns with and without a literal prefix", func() {
+		pubsub := client.PSubscribe(ctx, "*", "?x", "news.*")
+		defer pubsub.Close()
+		expectSubscription(ctx, pubsub, "psubscribe", "*", 1)
+		expectSubscription(ctx, pubsub, "psubscribe", "?x", 2)
+		expectSubscription(ctx, pubsub, "psubscribe", "news.*", 3)
+
+		// "*" and "news.*"
+		Expect(client2.Publish(ctx, "news.sport", "m1").Val()).To(Equal(int64(2)))
+		// "*" and "?x"
+		Expect(client2.Publish(ctx, "ax", "m2").Val()).To(Equal(int64(2)))
+		// only "*", "news" is shorter than the literal prefix "news."
+		Expect(client2.Publish(ctx, "news", "m3").Val()).To(Equal(int64(1)))
+
+		var got []string
+		for _, msg := range receiveMessages(ctx, pubsub, 5) {
+			got = append(got, msg.Pattern+" "+msg.Channel+" "+msg.Payload)
+		}
+		Expect(got).To(ConsistOf(
+			"* news.sport m1",
+			"news.* news.sport m1",
+			"* ax m2",
+			"?x ax m2",
+			"* news m3",
+		))
+	})
+
+	It("should deliver once per matching pattern", func() {
+		pubsub := client.PSubscribe(ctx, "ovl*", "ovl.*", "ovl.a*")
+		defer pubsub.Close()
+		expectSubscription(ctx, pubsub, "psubscribe", "ovl*", 1)
+		expectSubscription(ctx, pubsub, "psubscribe", "ovl.*", 2)
+		expectSubscription(ctx, pubsub, "psubscribe", "ovl.a*", 3)
+		// subscribing the same pattern again adds no receiver
+		Expect(pubsub.PSubscribe(ctx, "ovl*")).NotTo(HaveOccurred())
+		expectSubscription(ctx, pubsub, "psubscribe", "ovl*", 3)
+
+		Expect(client2.Publish(ctx, "ovl.abc", "hello").Val()).To(Equal(int64(3)))
+
+		var patterns []string
+		for _, msg := range receiveMessages(ctx, pubsub, 3) {
+			Expect(msg.Channel).To(Equal("ovl.abc"))
+			Expect(msg.Payload).To(Equal("hello"))
+			patterns = append(patterns, msg.Pattern)
+		}
+		Expect(patterns).To(ConsistOf("ovl*", "ovl.*", "ovl.a*"))
+	})
+
+	It("should drop the subscriptions of a disconnected client", func() {
+		numPat := client2.PubSubNumPat(ctx).Val()
+
+		pubsub := client.Subscribe(ctx, "disc_chan1", "disc_chan2")
+		expectSubscription(ctx, pubsub, "subscribe", "disc_chan1", 1)
+		expectSubscription(ctx, pubsub, "subscribe", "disc_chan2", 2)
+		Expect(pubsub.PSubscribe(ctx, "disc_*", "disc_chan?")).NotTo(HaveOccurred())
+		expectSubscription(ctx, pubsub, "psubscribe", "disc_*", 3)
+		expectSubscription(ctx, pubsub, "psubscribe", "disc_chan?", 4)
+
+		other := client2.Subscribe(ctx, "disc_chan1")
+		defer other.Close()
+		expectSubscription(ctx, other, "subscribe", "disc_chan1", 1)
+
+		Expect(client2.PubSubNumSub(ctx, "disc_chan1", "disc_chan2").Val()).To(Equal(map[string]int64{
+			"disc_chan1": 2,
+			"disc_chan2": 1,
+		}))
+		Expect(client2.PubSubNumPat(ctx).Val()).To(Equal(numPat + 2))
+
+		Expect(pubsub.Close()).NotTo(HaveOccurred())
+
+		Eventually(func() map[string]int64 {
+			return client2.PubSubNumSub(ctx, "disc_chan1", "disc_chan2").Val()
+		}, "5s", "100ms").Should(Equal(map[string]int64{
+			"disc_chan1": 1,
+			"disc_chan2": 0,
+		}))
+		Eventually(func() int64 {
+			return client2.PubSubNumPat(ctx).Val()
+		}, "5s", "100ms").Should(Equal(numPat))
+		Expect(client2.Publish(ctx, "disc_chan1", "hello").Val()).To(Equal(int64(1)))
+	})
+
+	It("should reply the current count to UNSUBSCRIBE of a channel not subscribed", func() {
+		pubsub := client.Subscribe(ctx, "unsub_chan1", "unsub_chan2")
+		defer pubsub.Close()
+		expectSubscription(ctx, pubsub, "subscribe", "unsub_chan1", 1)
+		expectSubscription(ctx, pubsub, "subscribe", "unsub_chan2", 2)
+
+		Expect(pubsub.Unsubscribe(ctx, "unsub_chan3")).NotTo(HaveOccurred())
+		expectSubscription(ctx, pubsub, "unsubscribe", "unsub_chan3", 2)
+
+		Expect(pubsub.PUnsubscribe(ctx, "unsub_*")).NotTo(HaveOccurred())
+		expectSubscription(ctx, pubsub, "punsubscribe", "unsub_*", 2)
+
+		Expect(pubsub.Unsubscribe(ctx, "unsub_chan1", "unsub_chan1")).NotTo(HaveOccurred())
+		expectSubscription(ctx, pubsub, "unsubscribe", "unsub_chan1", 1)
+		expectSubscription(ctx, pubsub, "unsubscribe", "unsub_chan1", 1)
+	})
+
+	It("should list the channels matching a glob", func() {
+		pubsub := client.Subscribe(ctx, "glob.a", "glob.b", "glob_c", "other.a")
+		defer pubsub.Close()
+		expectSubscription(ctx, pubsub, "subscribe", "glob.a", 1)
+		expectSubscription(ctx, pubsub, "subscribe", "glob.b", 2)
+		expectSubscription(ctx, pubsub, "subscribe", "glob_c", 3)
+		expectSubscription(ctx, pubsub, "subscribe", "other.a", 4)
+
+		Expect(client2.PubSubChannels(ctx, "glob.*").Val()).To(ConsistOf("glob.a", "glob.b"))
+		Expect(client2.PubSubChannels(ctx, "glob?[bc]").Val()).To(ConsistOf("glob.b", "glob_c"))
+		Expect(client2.PubSubChannels(ctx, "*.a").Val()).To(ConsistOf("glob.a", "other.a"))
+		Expect(client2.PubSubChannels(ctx, "glob.a").Val()).To(ConsistOf("glob.a"))
+		Expect(client2.PubSubChannels(ctx, "nomatch*").Val()).To(BeEmpty())
+	})
+
+	It("should return the number of channel and pattern receivers from PUBLISH", func() {
+		Expect(client2.Publish(ctx, "pubret", "none").Val()).To(Equal(int64(0)))
+
+		byChannel := client.Subscribe(ctx, "pubret")
+		defer byChannel.Close()
+		expectSubscription(ctx, byChannel, "subscribe", "pubret", 1)
+		byPattern := client.PSubscribe(ctx, "pubret*")
+		defer byPattern.Close()
+		expectSubscription(ctx, byPattern, "psubscribe", "pubret*", 1)
+		byBoth := client.Subscribe(ctx, "pubret")
+		defer byBoth.Close()
+		expectSubscription(ctx, byBoth, "subscribe", "pubret", 1)
+		Expect(byBoth.PSubscribe(ctx, "pub*")).NotTo(HaveOccurred())
+		expectSubscription(ctx, byBoth, "psubscribe", "pub*", 2)
+
+		Expect(client2.Publish(ctx, "pubret", "hello").Val()).To(Equal(int64(4)))
+		Expect(client2.Publish(ctx, "pubret2", "hello2").Val()).To(Equal(int64(2)))
+
+		msgs := receiveMessages(ctx, byChannel, 1)
+		Expect(msgs[0].Channel).To(Equal("pubret"))
+		Expect(msgs[0].Payload).To(Equal("hello"))
+
+		msgs = receiveMessages(ctx, byPattern, 2)
+		Expect(msgs[0].Pattern).To(Equal("pubret*"))
+		Expect(msgs[0].Payload).To(Equal("hello"))
+		Expect(msgs[1].Pattern).To(Equal("pubret*"))
+		Expect(msgs[1].Payload).To(Equal("hello2"))
+
+		var got []string
+		for _, msg := range receiveMessages(ctx, byBoth, 3) {
+			got = append(got, msg.Pattern+" "+msg.Channel+" "+msg.Payload)
+		}
+		Expect(got).To(ConsistOf(" pubret hello", "pub* pubret hello", "pub* pubret2 hello2"))
+	})
+
+	It("should keep the publish order for every subscriber", func() {
+		const N = 2000
+
+		byChannel := client.Subscribe(ctx, "order1", "order2")
+		defer byChannel.Close()
+		expectSubscription(ctx, byChannel, "subscribe", "order1", 1)
+		expectSubscription(ctx, byChannel, "subscribe", "order2", 2)
+		byPattern := client.PSubscribe(ctx, "order*")
+		defer byPattern.Close()
+		expectSubscription(ctx, byPattern, "psubscribe", "order*", 1)
+
+		// pipelined, so the messages reach the pubsub thread in batches
+		pipe := client2.Pipeline()
+		for i := 0; i < N; i++ {
+			pipe.Publish(ctx, "order"+strconv.Itoa(i%2+1), strconv.Itoa(i))
+		}
+		cmds, err := pipe.Exec(ctx)
+		Expect(err).NotTo(HaveOccurred())
+		for _, cmd := range cmds {
+			Expect(cmd.(*redis.IntCmd).Val()).To(Equal(int64(2)))
+		}
+
+		for _, pubsub := range []*redis.PubSub{byChannel, byPattern} {
+			for i := 0; i < N; i++ {
+				msg, err := pubsub.ReceiveMessage(ctx)
+				Expect(err).NotTo(HaveOccurred())
+				Expect(msg.Channel).To(Equal("order" + strconv.Itoa(i%2+1)))
+				Expect(msg.Payload).To(Equal(strconv.Itoa(i)))
+			}
+		}
+	})
+
 	It("should ping/pong", func() {
 		_ = client.Subscribe(ctx, "mychannel")
 		res := client.Do(ctx, "ping")
@@ -0,0 +1,76 @@
+package pika_integration
+
+import (
+	"context"
+	"strconv"
+	"time"
+
+	. "github.com/bsm/ginkgo/v2"
+	. "github.com/bsm/gomega"
+	"github.com/redis/go-redis/v9"
+)
+
+var _ = Describe("Replication Apply Test", func() {
+	ctx := context.TODO()
+	var (
+		slave  *redis.Client
+		master *redis.Client
+	)
+
+	BeforeEach(func() {
+		slave = redis.NewClient(PikaOption(SLAVEADDR))
+		master = redis.NewClient(PikaOption(MASTERADDR))
+	})
+
+	AfterEach(func() {
+		Expect(slave.Close()).NotTo(HaveOccurred())
+		Expect(master.Close()).NotTo(HaveOccurred())
+	})
+
+	It("slave should apply multi key commands in binlog order", func() {
+		slave.SlaveOf(ctx, "no", "one")
+		slave.FlushDB(ctx)
+		master.FlushDB(ctx)
+		time.Sleep(3 * time.Second)
+		Expect(slave.Do(ctx, "slaveof", LOCALHOST, MASTERPORT).Err()).NotTo(HaveOccurred())
+		waitFullSyncDone(ctx, slave)
+
+		//every command below touches keys the others also touch, a slave applying
+		//them out of order ends up with different values than the master
+		for i := 0; i < 2000; i++ {
+			pipe := master.Pipeline()
+			pipe.MSet(ctx, "apply_k1", strconv.Itoa(i), "apply_k2", strconv.Itoa(i))
+			pipe.Del(ctx, "apply_k2", "apply_k3")
+			pipe.Set(ctx, "apply_k3", strconv.Itoa(i), 0)
+			pipe.LPush(ctx, "apply_list1", i)
+			pipe.RPopLPush(ctx, "apply_list1", "apply_list2")
+			pipe.SAdd(ctx, "apply_set1", i%50)
+			pipe.SMove(ctx, "apply_set1", "apply_set2", (i+25)%50)
+			_, err := pipe.Exec(ctx)
+			Expect(err).NotTo(HaveOccurred())
+		}
+		//the slave applies unrelated keys in parallel, so each key is waited for on its own
+		for _, key := range []string{"apply_k1", "apply_k2", "apply_k3"} {
+			expected := master.Get(ctx, key).Val()
+			Eventually(func() string {
+				return slave.Get(ctx, key).Val()
+			}, "60s", "100ms").Should(Equal(expected))
+		}
+		for _, key := range []string{"apply_list1", "apply_list2"} {
+			expected := master.LRange(ctx, key, 0, -1).Val()
+			Eventually(func() []string {
+				return slave.LRange(ctx, key, 0, -1).Val()
+			}, "60s", "100ms").Should(Equal(expected))
+		}
+		for _, key := range []string{"apply_set1", "apply_set2"} {
+			expected := master.SMembers(ctx, key).Val()
+			Eventually(func() []string {
+				return slave.SMembers(ctx, key).Val()
+			}, "60s", "100ms").Should(ConsistOf(expected))
+		}
+
+		slave.SlaveOf(ctx, "no", "one")
+		slave.FlushDB(ctx)
+		master.FlushDB(ctx)
+	})
+})
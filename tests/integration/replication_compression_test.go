@@ -0,0 +1,67 @@
+package pika_integration
+
+import (
+	"context"
+	"strconv"
+	"strings"
+	"time"
+
+	. "github.com/bsm/ginkgo/v2"
+	. "github.com/bsm/gomega"
+	"github.com/redis/go-redis/v9"
+)
+
+var _ = Describe("Replication Compression Test", func() {
+	ctx := context.TODO()
+	var (
+		slave  *redis.Client
+		master *redis.Client
+	)
+
+	BeforeEach(func() {
+		slave = redis.NewClient(PikaOption(SLAVEADDR))
+		master = redis.NewClient(PikaOption(MASTERADDR))
+	})
+
+	AfterEach(func() {
+		Expect(master.ConfigSet(ctx, "replication-binlog-compression", "none").Err()).NotTo(HaveOccurred())
+		Expect(master.ConfigSet(ctx, "replication-batch-bytes", "0").Err()).NotTo(HaveOccurred())
+		Expect(slave.Close()).NotTo(HaveOccurred())
+		Expect(master.Close()).NotTo(HaveOccurred())
+	})
+
+	It("master should send compressed binlog batches to the slave", func() {
+		Expect(master.ConfigSet(ctx, "replication-binlog-compression", "gzip").Err()).To(HaveOccurred())
+		Expect(master.ConfigSet(ctx, "replication-binlog-compression", "zstd").Err()).NotTo(HaveOccurred())
+		Expect(master.ConfigSet(ctx, "replication-batch-bytes", "65536").Err()).NotTo(HaveOccurred())
+		Expect(master.ConfigGet(ctx, "replication-binlog-compression").Val()).To(
+			Equal(map[string]string{"replication-binlog-compression": "zstd"}))
+
+		//the compression is agreed on in meta sync, so the slave has to connect after the change
+		slave.SlaveOf(ctx, "no", "one")
+		slave.FlushDB(ctx)
+		master.FlushDB(ctx)
+		time.Sleep(3 * time.Second)
+		Expect(slave.Do(ctx, "slaveof", LOCALHOST, MASTERPORT).Err()).NotTo(HaveOccurred())
+		waitFullSyncDone(ctx, slave)
+
+		savedBefore, err := strconv.Atoi(infoField(master.Info(ctx, "stats").Val(), "total_net_repl_saved_bytes"))
+		Expect(err).NotTo(HaveOccurred())
+		value := strings.Repeat("compressible", 50)
+		for i := 0; i < 1000; i++ {
+			Expect(master.Set(ctx, "compress_key"+strconv.Itoa(i), value, 0).Err()).NotTo(HaveOccurred())
+		}
+		Eventually(func() string {
+			return slave.Get(ctx, "compress_key999").Val()
+		}, "30s", "100ms").Should(Equal(value))
+		Expect(slave.Get(ctx, "compress_key0").Val()).To(Equal(value))
+
+		savedAfter, err := strconv.Atoi(infoField(master.Info(ctx, "stats").Val(), "total_net_repl_saved_bytes"))
+		Expect(err).NotTo(HaveOccurred())
+		Expect(savedAfter).To(BeNumerically(">", savedBefore))
+
+		slave.SlaveOf(ctx, "no", "one")
+		slave.FlushDB(ctx)
+		master.FlushDB(ctx)
+	})
+})
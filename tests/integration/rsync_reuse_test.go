@@ -0,0 +1,83 @@
+package pika_integration
+
+import (
+	"context"
+	"strconv"
+	"strings"
+	"time"
+
+	. "github.com/bsm/ginkgo/v2"
+	. "github.com/bsm/gomega"
+	"github.com/redis/go-redis/v9"
+)
+
+func infoField(info string, field string) string {
+	for _, line := range strings.Split(info, "\r\n") {
+		if strings.HasPrefix(line, field+":") {
+			return strings.TrimPrefix(line, field+":")
+		}
+	}
+	return ""
+}
+
+func waitFullSyncDone(ctx context.Context, slave *redis.Client) {
+	Eventually(func() string {
+		return slave.Info(ctx, "replication").Val()
+	}, "120s", "500ms").Should(ContainSubstring("master_link_status:up"))
+}
+
+var _ = Describe("Rsync Reuse Test", func() {
+	ctx := context.TODO()
+	var (
+		slave  *redis.Client
+		master *redis.Client
+	)
+
+	BeforeEach(func() {
+		slave = redis.NewClient(PikaOption(SLAVEADDR))
+		master = redis.NewClient(PikaOption(MASTERADDR))
+	})
+
+	AfterEach(func() {
+		Expect(slave.Close()).NotTo(HaveOccurred())
+		Expect(master.Close()).NotTo(HaveOccurred())
+	})
+
+	It("full sync should link the sst files the slave already has", func() {
+		slave.SlaveOf(ctx, "no", "one")
+		slave.FlushDB(ctx)
+		master.FlushDB(ctx)
+		time.Sleep(3 * time.Second)
+		RefillMaster(MASTERADDR, 2, ctx)
+		Expect(master.Set(ctx, "rsync_reuse_key1", "value1", 0).Err()).NotTo(HaveOccurred())
+
+		//the first full sync has to fetch every file from master
+		Expect(slave.Do(ctx, "slaveof", LOCALHOST, MASTERPORT, "force").Err()).NotTo(HaveOccurred())
+		waitFullSyncDone(ctx, slave)
+		Eventually(func() string {
+			return slave.Get(ctx, "rsync_reuse_key1").Val()
+		}, "10s", "100ms").Should(Equal("value1"))
+
+		Expect(slave.SlaveOf(ctx, "no", "one").Err()).NotTo(HaveOccurred())
+		Expect(master.Set(ctx, "rsync_reuse_key2", "value2", 0).Err()).NotTo(HaveOccurred())
+		time.Sleep(3 * time.Second)
+
+		//the second full sync only fetches what the slave is missing
+		Expect(slave.Do(ctx, "slaveof", LOCALHOST, MASTERPORT, "force").Err()).NotTo(HaveOccurred())
+		waitFullSyncDone(ctx, slave)
+		info := slave.Info(ctx, "replication").Val()
+		reusedFiles, err := strconv.Atoi(infoField(info, "full_sync_reused_files"))
+		Expect(err).NotTo(HaveOccurred())
+		Expect(reusedFiles).To(BeNumerically(">", 0))
+
+		Eventually(func() string {
+			return slave.Get(ctx, "rsync_reuse_key2").Val()
+		}, "10s", "100ms").Should(Equal("value2"))
+		Expect(slave.Get(ctx, "rsync_reuse_key1").Val()).To(Equal("value1"))
+
+		slave.SlaveOf(ctx, "no", "one")
+		//clear the data to avoid disk run out in github action
+		slave.FlushDB(ctx)
+		master.FlushDB(ctx)
+	})
+})
@@ -2,6 +2,8 @@ package pika_integration
 
 import (
 	"context"
+	"io"
+	"net"
 	"strconv"
 	"strings"
 	"time"
@@ -453,6 +455,42 @@ var _ = Describe("Server", func() {
 			Expect(configSet.Val()).To(Equal("OK"))
 		})
 
+		It("should apply max-client-response-size to open connections", func() {
+			origin := client.ConfigGet(ctx, "max-client-response-size").Val()["max-client-response-size"]
+			defer func() {
+				Expect(client.ConfigSet(ctx, "max-client-response-size", origin).Err()).NotTo(HaveOccurred())
+			}()
+			Expect(client.Set(ctx, "big_reply_key", strings.Repeat("v", 1<<20), 0).Err()).NotTo(HaveOccurred())
+
+			// connected before the limit is lowered
+			conn, err := net.Dial("tcp", SINGLEADDR)
+			Expect(err).NotTo(HaveOccurred())
+			defer conn.Close()
+			_, err = conn.Write([]byte("PING\r\n"))
+			Expect(err).NotTo(HaveOccurred())
+			pong := make([]byte, 7)
+			_, err = io.ReadFull(conn, pong)
+			Expect(err).NotTo(HaveOccurred())
+			Expect(string(pong)).To(Equal("+PONG\r\n"))
+
+			Expect(client.ConfigSet(ctx, "max-client-response-size", strconv.Itoa(4<<20)).Err()).NotTo(HaveOccurred())
+
+			// 64MB of replies to a reader that does not read, the server
+			// closes the connection once more than 4MB are pending
+			const replies = 64
+			_, err = conn.Write([]byte(strings.Repeat("GET big_reply_key\r\n", replies)))
+			Expect(err).NotTo(HaveOccurred())
+			time.Sleep(2 * time.Second)
+
+			Expect(conn.SetReadDeadline(time.Now().Add(10 * time.Second))).NotTo(HaveOccurred())
+			received, err := io.Copy(io.Discard, conn)
+			if err != nil {
+				netErr, ok := err.(net.Error)
+				Expect(ok && netErr.Timeout()).To(BeFalse())
+			}
+			Expect(received).To(BeNumerically("<", replies<<20))
+		})
+
 		It("should ConfigGet slotmigrate-thread-num", func() {
 			configGet1 := client.ConfigGet(ctx, "slotmigrate-thread-num")
 			Expect(configGet1.Err()).NotTo(HaveOccurred())
@@ -0,0 +1,103 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/pika_binlog.h"
+#include "include/pika_binlog_reader.h"
+#include "pstd/include/env.h"
+
+using namespace std::chrono;
+
+const int ITEM_NUM = 400000;
+const int ITEM_LENGTH = 128;
+const std::vector<int> WRITER_NUMS = {1, 8, 32};
+const std::vector<int> READER_NUMS = {1, 6, 12};
+
+// Every reader reads the whole binlog from the first offset,
+// like slaves catching up after a restart of the master
+static void CatchUp(const std::shared_ptr<Binlog>& binlog, int reader_num) {
+  std::atomic<uint64_t> read = 0;
+  std::vector<std::thread> readers;
+  auto start = steady_clock::now();
+  for (int i = 0; i < reader_num; ++i) {
+    readers.emplace_back([&binlog, &read] {
+      PikaBinlogReader reader;
+      if (reader.Seek(binlog, 0, 0) != 0) {
+        return;
+      }
+      std::string msg;
+      uint32_t filenum = 0;
+      uint64_t offset = 0;
+      while (reader.Get(&msg, &filenum, &offset).ok()) {
+        read++;
+      }
+    });
+  }
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  auto cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+  std::cout << reader_num << " readers, " << read << " items in " << cost / 1000 << "ms, "
+            << read * 1000000 / (cost + 1) << " items/s" << std::endl;
+}
+
+// Binlog::Put throughput with 1, 8 and 32 concurrent writers,
+// the total number of items is the same for every round,
+// then the catch up of 1, 6 and 12 readers from the first offset
+int main(int argc, char** argv) {
+  std::string item = "*3\r\n$3\r\nset\r\n$16\r\nbinlog_bench_key\r\n$" + std::to_string(ITEM_LENGTH) + "\r\n" +
+                     std::string(ITEM_LENGTH, 'v') + "\r\n";
+  for (int writer_num : WRITER_NUMS) {
+    std::string path = "./binlog_bench_" + std::to_string(writer_num) + "/";
+    pstd::DeleteDirIfExist(path);
+    {
+      Binlog binlog(path);
+      std::atomic<int> failed = 0;
+      std::vector<std::thread> writers;
+      auto start = steady_clock::now();
+      for (int i = 0; i < writer_num; ++i) {
+        writers.emplace_back([&binlog, &item, &failed, writer_num] {
+          for (int j = 0; j < ITEM_NUM / writer_num; ++j) {
+            if (!binlog.Put(item).ok()) {
+              failed++;
+            }
+          }
+        });
+      }
+      for (auto& writer : writers) {
+        writer.join();
+      }
+      auto cost = duration_cast<microseconds>(steady_clock::now() - start).count();
+
+      uint32_t filenum = 0;
+      uint64_t offset = 0;
+      uint64_t logic_id = 0;
+      binlog.GetProducerStatus(&filenum, &offset, nullptr, &logic_id);
+      std::cout << writer_num << " writers, " << logic_id << " items in " << cost / 1000 << "ms, "
+                << logic_id * 1000000 / (cost + 1) << " items/s, failed: " << failed << std::endl;
+    }
+    pstd::DeleteDirIfExist(path);
+  }
+
+  std::string path = "./binlog_bench_readers/";
+  pstd::DeleteDirIfExist(path);
+  {
+    auto binlog = std::make_shared<Binlog>(path);
+    for (int i = 0; i < ITEM_NUM; ++i) {
+      binlog->Put(item);
+    }
+    for (int reader_num : READER_NUMS) {
+      CatchUp(binlog, reader_num);
+    }
+  }
+  pstd::DeleteDirIfExist(path);
+  return 0;
+}
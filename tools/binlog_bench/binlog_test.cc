@@ -0,0 +1,87 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/pika_binlog.h"
+#include "include/pika_binlog_reader.h"
+#include "include/pika_binlog_transverter.h"
+#include "pstd/include/env.h"
+
+const int kWriterNum = 8;
+const int kItemsPerWriter = 2000;
+// small files, so groups roll to the next file half way
+const int kBinlogFileSize = 1024 * 1024;
+
+// Items of concurrent writers get consecutive logic ids in the order
+// they are in the binlog, the items of each writer keep their order,
+// and the producer status saved once per group survives a restart
+TEST(BinlogTest, ConcurrentPutTest) {
+  std::string path = "./binlog_test_put/";
+  pstd::DeleteDirIfExist(path);
+  const uint64_t total = kWriterNum * kItemsPerWriter;
+  {
+    auto binlog = std::make_shared<Binlog>(path, kBinlogFileSize);
+    std::vector<std::thread> writers;
+    for (int i = 0; i < kWriterNum; ++i) {
+      writers.emplace_back([&binlog, i] {
+        for (int j = 0; j < kItemsPerWriter; ++j) {
+          std::string item = std::to_string(i) + ":" + std::to_string(j) + ":" + std::string(j % 600, 'v');
+          ASSERT_TRUE(binlog->Put(item).ok());
+        }
+      });
+    }
+    for (auto& writer : writers) {
+      writer.join();
+    }
+
+    uint32_t filenum = 0;
+    uint64_t offset = 0;
+    uint64_t logic_id = 0;
+    ASSERT_TRUE(binlog->GetProducerStatus(&filenum, &offset, nullptr, &logic_id).ok());
+    ASSERT_EQ(logic_id, total);
+    ASSERT_GT(filenum, 0);
+
+    PikaBinlogReader reader;
+    ASSERT_EQ(reader.Seek(binlog, 0, 0), 0);
+    std::map<int, int> last_seq;
+    std::string msg;
+    uint32_t read_filenum = 0;
+    uint64_t read_offset = 0;
+    for (uint64_t i = 1; i <= total; ++i) {
+      ASSERT_TRUE(reader.Get(&msg, &read_filenum, &read_offset).ok());
+      BinlogItem item;
+      ASSERT_TRUE(PikaBinlogTransverter::BinlogDecode(TypeFirst, msg, &item));
+      ASSERT_EQ(item.logic_id(), i);
+      std::string content = item.content();
+      size_t delim = content.find(':');
+      int writer = std::stoi(content.substr(0, delim));
+      int seq = std::stoi(content.substr(delim + 1, content.find(':', delim + 1) - delim - 1));
+      auto iter = last_seq.find(writer);
+      ASSERT_EQ(seq, iter == last_seq.end() ? 0 : iter->second + 1);
+      last_seq[writer] = seq;
+    }
+    ASSERT_EQ(read_filenum, filenum);
+    ASSERT_EQ(read_offset, offset);
+    ASSERT_TRUE(reader.Get(&msg, &read_filenum, &read_offset).IsEndFile());
+  }
+  {
+    Binlog binlog(path, kBinlogFileSize);
+    uint32_t filenum = 0;
+    uint64_t offset = 0;
+    uint64_t logic_id = 0;
+    ASSERT_TRUE(binlog.GetProducerStatus(&filenum, &offset, nullptr, &logic_id).ok());
+    ASSERT_EQ(logic_id, total);
+    ASSERT_TRUE(binlog.Put("after restart").ok());
+    ASSERT_TRUE(binlog.GetProducerStatus(&filenum, &offset, nullptr, &logic_id).ok());
+    ASSERT_EQ(logic_id, total + 1);
+  }
+  pstd::DeleteDirIfExist(path);
+}
@@ -0,0 +1,311 @@
+//  Copyright (c) 2023-present, Qihoo, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+// Counts heap allocations per request of the pooled commands, a Clone() per
+// request against a cmd taken from the per thread free list. The Cmd, CmdRes
+// and command members mirror include/pika_command.h, include/pika_kv.h and
+// include/pika_hash.h, the free list and recycle logic follow
+// src/pika_cmd_table_manager.cc. Keep them in sync when those change.
+//
+//   g++ -std=c++17 -O2 cmd_pool_alloc.cc -o cmd_pool_alloc && ./cmd_pool_alloc [key_size]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+static thread_local bool counting = false;
+static size_t g_allocs = 0;
+static size_t g_bytes = 0;
+
+void* operator new(size_t n) {
+  if (counting) {
+    g_allocs++;
+    g_bytes += n;
+  }
+  void* p = malloc(n);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// an OK rocksdb::Status holds no heap state
+struct Status {
+  int code = 0;
+  const char* state = nullptr;
+};
+struct DB {};
+struct SyncMasterDB {};
+struct NetConn {};
+
+static const size_t kCmdPoolMaxFreePerCmd = 16;
+static const size_t kCmdPoolMaxArgvBytes = 16 * 1024;
+
+void RedisAppendContent(std::string& str, const std::string& value) {
+  str.append(value.data(), value.size());
+  str.append("\r\n");
+}
+
+void RedisAppendLen(std::string& str, int64_t ori, const std::string& prefix) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%ld", static_cast<long>(ori));
+  str.append(prefix);
+  str.append(buf);
+  str.append("\r\n");
+}
+
+class CmdRes {
+ public:
+  void clear() { message_.clear(); }
+  void ShrinkToFit(size_t max_capacity) {
+    if (message_.capacity() > max_capacity) {
+      std::string().swap(message_);
+    }
+  }
+  void AppendContent(const std::string& value) { RedisAppendContent(message_, value); }
+  void AppendStringLen(int64_t ori) { RedisAppendLen(message_, ori, "$"); }
+
+ private:
+  std::string message_;
+};
+
+class Cmd {
+ public:
+  Cmd(std::string name, uint32_t cmd_id) : name_(std::move(name)), cmdId_(cmd_id) {}
+  virtual ~Cmd() = default;
+  virtual Cmd* Clone() = 0;
+  virtual void DoInitial() = 0;
+  virtual void Do() = 0;
+  virtual void Clear() {}
+
+  void Initial(const std::vector<std::string>& argv, const std::string& db_name, const std::shared_ptr<DB>& db,
+               const std::shared_ptr<SyncMasterDB>& sync_db) {
+    argv_ = argv;
+    db_name_ = db_name;
+    res_.clear();
+    db_ = db;
+    sync_db_ = sync_db;
+    Clear();
+    DoInitial();
+  }
+  void Reset() {
+    argv_.clear();
+    res_.clear();
+    res_.ShrinkToFit(kCmdPoolMaxArgvBytes);
+    db_name_.clear();
+    s_ = Status();
+    db_.reset();
+    sync_db_.reset();
+    conn_.reset();
+    resp_.reset();
+    stage_ = 0;
+    do_duration_ = 0;
+    Clear();
+  }
+  uint32_t GetCmdId() const { return cmdId_; }
+  const std::vector<std::string>& argv() const { return argv_; }
+
+ protected:
+  std::string name_;
+  int arity_ = -2;
+  uint32_t flag_ = 0;
+  std::vector<std::string> subCmdName_;
+  CmdRes res_;
+  std::vector<std::string> argv_;
+  std::string db_name_;
+  Status s_;
+  std::shared_ptr<DB> db_;
+  std::shared_ptr<SyncMasterDB> sync_db_;
+  std::weak_ptr<NetConn> conn_;
+  std::weak_ptr<std::string> resp_;
+  int stage_ = 0;
+  uint64_t do_duration_ = 0;
+  uint32_t cmdId_ = 0;
+};
+
+class SetCmd : public Cmd {
+ public:
+  using Cmd::Cmd;
+  Cmd* Clone() override { return new SetCmd(*this); }
+  void DoInitial() override {
+    key_ = argv_[1];
+    value_ = argv_[2];
+  }
+  void Do() override { res_.AppendContent("+OK"); }
+  void Clear() override { ttl_ = 0; }
+
+ private:
+  std::string key_;
+  std::string value_;
+  std::string target_;
+  int64_t ttl_ = 0;
+};
+
+class GetCmd : public Cmd {
+ public:
+  using Cmd::Cmd;
+  Cmd* Clone() override { return new GetCmd(*this); }
+  void DoInitial() override { key_ = argv_[1]; }
+  // storage()->GetWithTTL assigns the stored value into value_
+  void Do() override {
+    value_.assign(stored_value);
+    res_.AppendStringLen(static_cast<int64_t>(value_.size()));
+    res_.AppendContent(value_);
+  }
+  static std::string stored_value;
+
+ private:
+  std::string key_;
+  std::string value_;
+  int64_t ttl_ = 0;
+};
+std::string GetCmd::stored_value(64, 'v');
+
+class IncrCmd : public Cmd {
+ public:
+  using Cmd::Cmd;
+  Cmd* Clone() override { return new IncrCmd(*this); }
+  void DoInitial() override { key_ = argv_[1]; }
+  void Do() override { res_.AppendContent(":" + std::to_string(++new_value_)); }
+
+ private:
+  std::string key_;
+  int64_t new_value_ = 0;
+};
+
+class HSetCmd : public Cmd {
+ public:
+  using Cmd::Cmd;
+  Cmd* Clone() override { return new HSetCmd(*this); }
+  void DoInitial() override {
+    key_ = argv_[1];
+    field_ = argv_[2];
+    value_ = argv_[3];
+  }
+  // storage()->HSet reports 1 for a new field, 0 for an overwrite
+  void Do() override { res_.AppendContent(":" + std::to_string(1)); }
+
+ private:
+  std::string key_;
+  std::string field_;
+  std::string value_;
+  Status s_;
+};
+
+class CmdFreeLists {
+ public:
+  ~CmdFreeLists() {
+    for (auto& free_list : free_lists_) {
+      for (Cmd* cmd : free_list) {
+        delete cmd;
+      }
+    }
+  }
+  Cmd* Pop(uint32_t cmd_id) {
+    if (cmd_id >= free_lists_.size() || free_lists_[cmd_id].empty()) {
+      return nullptr;
+    }
+    Cmd* cmd = free_lists_[cmd_id].back();
+    free_lists_[cmd_id].pop_back();
+    return cmd;
+  }
+  bool Push(Cmd* cmd) {
+    uint32_t cmd_id = cmd->GetCmdId();
+    if (cmd_id >= free_lists_.size()) {
+      free_lists_.resize(cmd_id + 1);
+    }
+    if (free_lists_[cmd_id].size() >= kCmdPoolMaxFreePerCmd) {
+      return false;
+    }
+    free_lists_[cmd_id].push_back(cmd);
+    return true;
+  }
+
+ private:
+  std::vector<std::vector<Cmd*>> free_lists_;
+};
+thread_local CmdFreeLists tls_cmd_free_lists;
+
+void RecyclePooledCmd(Cmd* cmd) {
+  size_t argv_bytes = 0;
+  for (const auto& arg : cmd->argv()) {
+    argv_bytes += arg.size();
+  }
+  if (argv_bytes > kCmdPoolMaxArgvBytes) {
+    delete cmd;
+    return;
+  }
+  cmd->Reset();
+  if (!tls_cmd_free_lists.Push(cmd)) {
+    delete cmd;
+  }
+}
+
+std::shared_ptr<Cmd> AcquirePooledCmd(Cmd* prototype) {
+  Cmd* cmd = tls_cmd_free_lists.Pop(prototype->GetCmdId());
+  if (cmd == nullptr) {
+    cmd = prototype->Clone();
+  }
+  return std::shared_ptr<Cmd>(cmd, &RecyclePooledCmd);
+}
+
+std::shared_ptr<Cmd> NewCmd(Cmd* prototype, bool pooled) {
+  return pooled ? AcquirePooledCmd(prototype) : std::shared_ptr<Cmd>(prototype->Clone());
+}
+
+struct Case {
+  const char* name;
+  std::unique_ptr<Cmd> prototype;
+  std::vector<std::string> argv;
+};
+
+int main(int argc, char* argv[]) {
+  const int requests = 100000;
+  // 16 bytes is past the SSO buffer, so each key copy allocates
+  size_t key_size = argc > 1 ? atoi(argv[1]) : 16;
+  std::string key(key_size, 'k');
+  std::string field(key_size, 'f');
+  std::string value(64, 'v');
+  std::string db_name = "db0";
+  auto db = std::make_shared<DB>();
+  auto sync_db = std::make_shared<SyncMasterDB>();
+
+  std::vector<Case> cases;
+  cases.push_back({"SET", std::make_unique<SetCmd>("set", 1), {"set", key, value}});
+  cases.push_back({"GET", std::make_unique<GetCmd>("get", 2), {"get", key}});
+  cases.push_back({"INCR", std::make_unique<IncrCmd>("incr", 3), {"incr", key}});
+  cases.push_back({"HSET", std::make_unique<HSetCmd>("hset", 4), {"hset", key, field, value}});
+
+  printf("key size %zu, %d requests per run\n", key_size, requests);
+  printf("%-5s %-7s %12s %12s\n", "cmd", "mode", "allocs/req", "bytes/req");
+  for (auto& c : cases) {
+    for (bool pooled : {false, true}) {
+      // run once untimed so the pooled free list holds an instance
+      {
+        auto cmd = NewCmd(c.prototype.get(), pooled);
+        cmd->Initial(c.argv, db_name, db, sync_db);
+        cmd->Do();
+      }
+      g_allocs = 0;
+      g_bytes = 0;
+      counting = true;
+      for (int i = 0; i < requests; i++) {
+        auto cmd = NewCmd(c.prototype.get(), pooled);
+        cmd->Initial(c.argv, db_name, db, sync_db);
+        cmd->Do();
+      }
+      counting = false;
+      printf("%-5s %-7s %12.2f %12.1f\n", c.name, pooled ? "pooled" : "clone", static_cast<double>(g_allocs) / requests,
+             static_cast<double>(g_bytes) / requests);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,141 @@
+#!/bin/bash
+
+# Replays a write load against a master with memtier_benchmark and samples how
+# far the slave's applied data is behind. A marker key holding the current time
+# in milliseconds is written to the master every interval, the lag of a sample
+# is the time now minus the marker value the slave returns. The slave applies
+# binlog in order per key, so the marker shows when everything written before
+# it on the same key has been applied.
+
+masterHost=127.0.0.1
+masterPort=9221
+slaveHost=127.0.0.1
+slavePort=9231
+requests=200000
+clients=50
+threads=4
+dataSize=32
+keyMaximum=1000000
+interval=0.1
+
+usage() {
+    echo "Usage: $0 [-masterHost <host>] [-masterPort <port>] [-slaveHost <host>] [-slavePort <port>] [-requests <requests>] [-clients <clients>] [-threads <threads>] [-dataSize <dataSize>] [-keyMaximum <keyMaximum>] [-interval <seconds>]"
+    echo ""
+    echo "Options:"
+    echo "  -masterHost <host>        Master hostname, default: $masterHost"
+    echo "  -masterPort <port>        Master port, default: $masterPort"
+    echo "  -slaveHost <host>         Slave hostname, default: $slaveHost"
+    echo "  -slavePort <port>         Slave port, default: $slavePort"
+    echo "  -requests <requests>      Requests per client, default: $requests"
+    echo "  -clients <clients>        Number of concurrent clients per thread, default: $clients"
+    echo "  -threads <threads>        Number of threads, default: $threads"
+    echo "  -dataSize <dataSize>      Data size, default: $dataSize"
+    echo "  -keyMaximum <keyMaximum>  Key space of the load, smaller means more conflicting keys, default: $keyMaximum"
+    echo "  -interval <seconds>       Lag sampling interval, default: $interval"
+    echo ""
+    exit 1
+}
+
+while [[ $# -gt 0 ]]; do
+  case $1 in
+    -masterHost)
+      shift
+      masterHost=$1
+      ;;
+    -masterPort)
+      shift
+      masterPort=$1
+      ;;
+    -slaveHost)
+      shift
+      slaveHost=$1
+      ;;
+    -slavePort)
+      shift
+      slavePort=$1
+      ;;
+    -requests)
+      shift
+      requests=$1
+      ;;
+    -clients)
+      shift
+      clients=$1
+      ;;
+    -threads)
+      shift
+      threads=$1
+      ;;
+    -dataSize)
+      shift
+      dataSize=$1
+      ;;
+    -keyMaximum)
+      shift
+      keyMaximum=$1
+      ;;
+    -interval)
+      shift
+      interval=$1
+      ;;
+    *)
+      echo "Unknown option: $1" >&2
+      usage
+      ;;
+  esac
+  shift
+done
+
+marker=repl_lag_marker
+pwd=$(pwd)
+mkdir -p $pwd/bench_data
+load_out=$pwd/bench_data/repl_lag_load.txt
+samples=$pwd/bench_data/repl_lag_samples.txt
+: > $samples
+
+now_ms() {
+    date +%s%3N
+}
+
+sample_lag() {
+    local now
+    now=$(now_ms)
+    redis-cli -h $masterHost -p $masterPort set $marker $now > /dev/null
+    local applied
+    applied=$(redis-cli -h $slaveHost -p $slavePort get $marker)
+    if [[ -n "$applied" ]]; then
+        echo $(( $(now_ms) - applied )) >> $samples
+    fi
+    echo $now
+}
+
+echo "slave of $masterHost:$masterPort: $(redis-cli -h $slaveHost -p $slavePort info replication | grep -E 'master_link_status' | tr -d '\r')"
+
+memtier_benchmark --server=$masterHost --port=$masterPort --clients=$clients --requests=$requests --data-size=$dataSize \
+    --threads=$threads --ratio=1:0 --key-pattern=R:R --key-maximum=$keyMaximum --select-db=0 --hide-histogram > $load_out 2>&1 &
+load_pid=$!
+
+while kill -0 $load_pid 2> /dev/null; do
+    sample_lag > /dev/null
+    sleep $interval
+done
+wait $load_pid
+
+# how long the slave needs to catch up once the master stops taking writes
+last=$(sample_lag)
+load_end=$(now_ms)
+until [[ "$(redis-cli -h $slaveHost -p $slavePort get $marker)" == "$last" ]]; do
+    sleep 0.01
+done
+drain=$(( $(now_ms) - load_end ))
+
+grep -E "^(Sets|Totals)" $load_out
+sort -n $samples | awk -v drain=$drain '
+    { lag[NR] = $1; sum += $1 }
+    END {
+        if (NR == 0) { print "no lag samples"; exit 1 }
+        p50 = lag[int(NR * 0.50) > 0 ? int(NR * 0.50) : 1]
+        p99 = lag[int(NR * 0.99) > 0 ? int(NR * 0.99) : 1]
+        printf "lag samples: %d, avg: %.1f ms, p50: %d ms, p99: %d ms, max: %d ms, drain after load: %d ms\n",
+               NR, sum / NR, p50, p99, lag[NR], drain
+    }'